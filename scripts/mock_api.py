@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""
+Minimal stand-in for the global API, for testing the plugin's connection, replay uploads and rating requests locally.
+Requires the `websockets` package (13 or newer).
+
+Usage:
+    python mock_api.py [--port 8080] [--out replays] [--drop-after BYTES]
+
+Point the plugin at it with `"apiUrl" "http://127.0.0.1:8080"` and any `apiKey` in cfg/cs2kz-server-config.txt.
+Completed uploads are written to the output directory as <uuid>.replay.
+With --drop-after, the connection is closed once after that many bytes of replay data, to test resuming uploads.
+With --no-batch, the batched rating route answers 404 like an API without it.
+"""
+
+import argparse
+import asyncio
+import hashlib
+import json
+import os
+import struct
+import urllib.parse
+import uuid
+from http import HTTPStatus
+
+import websockets
+
+CHUNK_HEADER = struct.Struct("<16sI")
+
+# Replay data received so far, by replay UUID. Survives reconnects like the real API.
+uploads = {}
+record_id = 0
+
+
+def answer(message_id, data):
+    return json.dumps({"id": message_id, "data": data})
+
+
+async def handle(socket, args):
+    global record_id
+
+    async for raw in socket:
+        if isinstance(raw, bytes):
+            replay, offset = CHUNK_HEADER.unpack_from(raw)
+            upload = uploads.get(str(uuid.UUID(bytes=replay)))
+            if upload is None or offset != len(upload["data"]):
+                print(f"unexpected chunk at offset {offset}")
+                continue
+            upload["data"] += raw[CHUNK_HEADER.size :]
+            if args.drop_after and not args.dropped and len(upload["data"]) >= args.drop_after:
+                args.dropped = True
+                print("dropping the connection")
+                await socket.close(1001)
+                return
+            continue
+
+        message = json.loads(raw)
+        event = message.get("event")
+        message_id = message["id"]
+        data = message.get("data", {})
+
+        if event is None:
+            # The handshake is the only message without an event.
+            print(f"hello from plugin {message.get('plugin_version')}")
+            await socket.send(
+                json.dumps({"id": message_id, "heartbeat_interval": 30, "map": None, "modes": [], "styles": [], "announcements": []})
+            )
+        elif event == "map-change":
+            await socket.send(answer(message_id, {"map": None}))
+        elif event == "player-join":
+            await socket.send(answer(message_id, {"is_banned": False, "preferences": {}}))
+        elif event == "new-record":
+            record_id += 1
+            await socket.send(answer(message_id, {"record_id": record_id}))
+        elif event == "replay-upload-start":
+            upload = uploads.setdefault(data["replay_id"], {"data": b""})
+            if upload.get("size") != data["size"] or upload.get("md5") != data["md5"]:
+                upload.update(data=b"", size=data["size"], md5=data["md5"])
+            print(f"upload of {data['replay_id']} ({data['size']} bytes) starts at {len(upload['data'])}")
+            await socket.send(answer(message_id, {"offset": len(upload["data"])}))
+        elif event == "replay-upload-finish":
+            upload = uploads.pop(data["replay_id"], {"data": b"", "md5": None})
+            ok = hashlib.md5(upload["data"]).hexdigest() == upload["md5"]
+            if ok:
+                with open(os.path.join(args.out, data["replay_id"] + ".replay"), "wb") as file:
+                    file.write(upload["data"])
+            print(f"upload of {data['replay_id']} finished, checksum {'ok' if ok else 'mismatch'}")
+            await socket.send(answer(message_id, {"ok": ok}))
+        else:
+            print(f"ignoring {event}")
+
+
+def rating(steam_id):
+    # Stable made up rating per player.
+    return float(steam_id % 400000)
+
+
+def process_request(connection, request, args):
+    url = urllib.parse.urlsplit(request.path)
+    query = urllib.parse.parse_qs(url.query)
+    parts = url.path.strip("/").split("/")
+
+    if parts == ["players", "profiles"]:
+        if args.no_batch:
+            return connection.respond(HTTPStatus.NOT_FOUND, "")
+        players = [int(player) for player in query.get("players", [""])[0].split(",") if player]
+        print(f"batched rating request for {len(players)} players")
+        return connection.respond(HTTPStatus.OK, json.dumps({"values": [{"id": player, "rating": rating(player)} for player in players]}))
+    if len(parts) == 3 and parts[0] == "players" and parts[2] == "profile":
+        print(f"rating request for {parts[1]}")
+        return connection.respond(HTTPStatus.OK, json.dumps({"rating": rating(int(parts[1]))}))
+    # Anything else is the websocket handshake.
+    return None
+
+
+async def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--out", default="replays")
+    parser.add_argument("--drop-after", type=int, default=0)
+    parser.add_argument("--no-batch", action="store_true")
+    args = parser.parse_args()
+    args.dropped = False
+    os.makedirs(args.out, exist_ok=True)
+
+    async with websockets.serve(
+        lambda socket: handle(socket, args),
+        "127.0.0.1",
+        args.port,
+        max_size=None,
+        process_request=lambda connection, request: process_request(connection, request, args),
+    ):
+        print(f"mock API listening on ws://127.0.0.1:{args.port}/auth/cs2")
+        await asyncio.Future()
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
@@ -7,6 +7,7 @@
 #include "utils/utils.h"
 #include "utils/hooks.h"
 #include "utils/gameconfig.h"
+#include "utils/executor.h"
 
 #include "movement/movement.h"
 #include "kz/kz.h"
@@ -28,6 +29,8 @@
 #include "kz/recording/kz_recording.h"
 #include "kz/replays/kz_replaysystem.h"
 #include "kz/racing/kz_racing.h"
+#include "kz/saveloc/kz_saveloc.h"
+#include "kz/jumpstats/collision.h"
 
 #include <vendor/MultiAddonManager/public/imultiaddonmanager.h>
 #include <vendor/ClientCvarValue/public/iclientcvarvalue.h>
@@ -52,6 +55,7 @@ bool KZPlugin::Load(PluginId id, ISmmAPI *ismm, char *error, size_t maxlen, bool
 		return false;
 	}
 	ConVar_Register();
+	executor::Init();
 	hooks::Initialize();
 	ix::initNetSystem();
 	movement::InitDetours();
@@ -103,6 +107,7 @@ bool KZPlugin::Unload(char *error, size_t maxlen)
 	KZ::misc::UnrestrictTimeLimit();
 	KZRecordingService::Shutdown();
 	KZRacingService::Cleanup();
+	KZSavelocService::Cleanup();
 	ix::uninitNetSystem();
 	hooks::Cleanup();
 	KZ::mode::EnableReplicatedModeCvars();
@@ -115,7 +120,9 @@ bool KZPlugin::Unload(char *error, size_t maxlen)
 	KZLanguageService::Cleanup();
 	KZOptionService::Cleanup();
 	KZ::replaysystem::Cleanup();
+	KZ::collision::Cleanup();
 	KZAnticheatService::CleanupSvCheatsWatcher();
+	executor::Shutdown();
 	ConVar_Unregister();
 	return true;
 }
@@ -221,10 +221,10 @@ void KZBeamService::Reset()
 
 void KZBeamService::UpdateBeams()
 {
-	for (i32 i = 0; i < MAXPLAYERS + 1; i++)
+	FOR_EACH_VEC(g_pKZPlayerManager->activePlayers, i)
 	{
-		KZPlayer *player = g_pKZPlayerManager->ToPlayer(i);
-		if (!player || !player->IsInGame())
+		KZPlayer *player = g_pKZPlayerManager->ToKZPlayer(g_pKZPlayerManager->activePlayers[i]);
+		if (!player->IsInGame())
 		{
 			continue;
 		}
@@ -62,6 +62,11 @@ public:
 		return this->tpCount;
 	}
 
+	void SetTeleportCount(u32 count)
+	{
+		this->tpCount = count;
+	}
+
 	i32 GetCurrentCpIndex()
 	{
 		if (this->checkpoints.Count() > 0)
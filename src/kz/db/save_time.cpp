@@ -17,6 +17,14 @@ void KZDatabaseService::SaveTime(const char *runUUID, u64 steamID, u32 courseID,
 		return;
 	}
 
+	// Forward the insertion to listeners before handing the results to the caller.
+	auto forwardInsertion = [steamID, courseID, modeID, time, teleportsUsed, styleIDs]()
+	{
+		Player *player = g_pPlayerManager->SteamIdToPlayer(steamID, false);
+		u64 runtimeMS = (u64)(time * 1000.0);
+		CALL_FORWARD(eventListeners, OnTimeInserted, player, steamID, currentMapID, courseID, modeID, styleIDs, runtimeMS, (u32)teleportsUsed);
+	};
+
 	char query[1024];
 	Transaction txn;
 
@@ -25,7 +33,12 @@ void KZDatabaseService::SaveTime(const char *runUUID, u64 steamID, u32 courseID,
 	txn.queries.push_back(query);
 	if (styleIDs != 0)
 	{
-		KZDatabaseService::GetDatabaseConnection()->ExecuteTransaction(txn, OnGenericTxnSuccess, OnGenericTxnFailure);
+		auto onInserted = [forwardInsertion](std::vector<ISQLQuery *> queries)
+		{
+			forwardInsertion();
+			OnGenericTxnSuccess(queries);
+		};
+		KZDatabaseService::GetDatabaseConnection()->ExecuteTransaction(txn, onInserted, OnGenericTxnFailure);
 	}
 	else
 	{
@@ -50,6 +63,11 @@ void KZDatabaseService::SaveTime(const char *runUUID, u64 steamID, u32 courseID,
 			V_snprintf(query, sizeof(query), sql_getlowestmaprankpro, courseID, modeID);
 			txn.queries.push_back(query);
 		}
-		KZDatabaseService::GetDatabaseConnection()->ExecuteTransaction(txn, onSuccess, onFailure);
+		auto onInserted = [forwardInsertion, onSuccess](std::vector<ISQLQuery *> queries)
+		{
+			forwardInsertion();
+			onSuccess(queries);
+		};
+		KZDatabaseService::GetDatabaseConnection()->ExecuteTransaction(txn, onInserted, onFailure);
 	}
 }
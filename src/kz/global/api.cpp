@@ -37,108 +37,71 @@ bool KZ::API::DecodeStyleString(std::string_view styleString, Style &style)
 	}
 }
 
-bool KZ::API::PlayerInfo::FromJson(const Json &json)
+// Player IDs are sent either as SteamID64 or as SteamID2 strings.
+static_function bool DecodeSteamID(const JsonScalar &value, u64 &id)
 {
-	if (!json.Get("id", this->id))
+	if (value.type == JsonScalar::Type::Unsigned)
 	{
-		std::string id;
-
-		if (!json.Get("id", id))
-		{
-			return false;
-		}
-
-		if (!utils::ParseSteamID2(id, this->id))
-		{
-			META_CONPRINTF("[KZ::Global] Failed to parse SteamID2.\n");
-			return false;
-		}
-	}
-
-	return json.Get("name", this->name);
-}
-
-bool KZ::API::Player::FromJson(const Json &json)
-{
-	bool success = true;
-
-	if (!json.Get("id", this->id))
-	{
-		std::string id;
-
-		if (!json.Get("id", id))
-		{
-			return false;
-		}
-
-		if (!utils::ParseSteamID2(id, this->id))
-		{
-			META_CONPRINTF("[KZ::Global] Failed to parse SteamID2.\n");
-			return false;
-		}
-	}
-
-	success &= json.Get("name", this->name);
-	success &= json.Get("is_banned", this->isBanned);
-
-	return success;
-}
-
-bool KZ::API::Map::FromJson(const Json &json)
-{
-	if (!json.Get("id", this->id))
-	{
-		return false;
-	}
-
-	if (!json.Get("workshop_id", this->workshopId))
-	{
-		return false;
-	}
-
-	if (!json.Get("name", this->name))
-	{
-		return false;
-	}
-
-	if (!json.Get("description", this->description))
-	{
-		return false;
-	}
-
-	std::string state;
-
-	if (!json.Get("state", state))
-	{
-		return false;
+		id = value.uinteger;
+		return true;
 	}
 
-	if (!DecodeStateString(state, this->state))
+	if (value.type != JsonScalar::Type::String)
 	{
 		return false;
 	}
 
-	if (!json.Get("vpk_checksum", this->vpkChecksum))
+	if (!utils::ParseSteamID2(value.string, id))
 	{
+		META_CONPRINTF("[KZ::Global] Failed to parse SteamID2.\n");
 		return false;
 	}
 
-	if (!json.Get("mappers", this->mappers))
-	{
-		return false;
-	}
+	return true;
+}
 
-	if (!json.Get("courses", this->courses))
-	{
-		return false;
-	}
+const JsonFieldTable &KZ::API::PlayerInfo::JsonFields()
+{
+	// clang-format off
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD_DECODE("id", &PlayerInfo::id, &DecodeSteamID),
+		JSON_FIELD("name", &PlayerInfo::name),
+	};
+	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
+}
 
-	if (!json.Get("approved_at", this->approvedAt))
-	{
-		return false;
-	}
+const JsonFieldTable &KZ::API::Player::JsonFields()
+{
+	// clang-format off
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD_DECODE("id", &Player::id, &DecodeSteamID),
+		JSON_FIELD("name", &Player::name),
+		JSON_FIELD("is_banned", &Player::isBanned),
+	};
+	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
+}
 
-	return true;
+const JsonFieldTable &KZ::API::Map::JsonFields()
+{
+	// clang-format off
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD("id", &Map::id),
+		JSON_FIELD("workshop_id", &Map::workshopId),
+		JSON_FIELD("name", &Map::name),
+		JSON_FIELD("description", &Map::description),
+		JSON_FIELD_DECODE("state", &Map::state, &Map::DecodeStateString),
+		JSON_FIELD("vpk_checksum", &Map::vpkChecksum),
+		JSON_FIELD("mappers", &Map::mappers),
+		JSON_FIELD("courses", &Map::courses),
+		JSON_FIELD("approved_at", &Map::approvedAt),
+	};
+	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
 bool KZ::API::Map::DecodeStateString(std::string_view stateString, State &state)
@@ -164,71 +127,41 @@ bool KZ::API::Map::DecodeStateString(std::string_view stateString, State &state)
 	return true;
 }
 
-bool KZ::API::Map::Course::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::Map::Course::JsonFields()
 {
 	// clang-format off
-	return json.Get("id", this->id)
-		&& json.Get("name", this->name)
-		&& json.Get("description", this->description)
-		&& json.Get("mappers", this->mappers)
-		&& json.Get("filters", this->filters);
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD("id", &Course::id),
+		JSON_FIELD("name", &Course::name),
+		JSON_FIELD("description", &Course::description),
+		JSON_FIELD("mappers", &Course::mappers),
+		JSON_FIELD("filters", &Course::filters),
+	};
 	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::API::Map::Course::Filters::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::Map::Course::Filters::JsonFields()
 {
-	return json.Get("vanilla", this->vanilla) && json.Get("classic", this->classic);
+	static_persist constexpr JsonField fields[] = {JSON_FIELD("vanilla", &Filters::vanilla), JSON_FIELD("classic", &Filters::classic)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::API::Map::Course::Filter::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::Map::Course::Filter::JsonFields()
 {
-	if (!json.Get("id", this->id))
-	{
-		return false;
-	}
-
-	std::string nubTier;
-
-	if (!json.Get("nub_tier", nubTier))
-	{
-		return false;
-	}
-
-	if (!DecodeTierString(nubTier, this->nubTier))
-	{
-		return false;
-	}
-
-	std::string proTier;
-
-	if (!json.Get("pro_tier", proTier))
-	{
-		return false;
-	}
-
-	if (!DecodeTierString(proTier, this->proTier))
-	{
-		return false;
-	}
-
-	std::string state;
-
-	if (!json.Get("state", state))
-	{
-		return false;
-	}
-
-	if (!DecodeStateString(state, this->state))
-	{
-		return false;
-	}
-
-	if (!json.Get("notes", this->notes))
-	{
-		return false;
-	}
-
-	return true;
+	// clang-format off
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD("id", &Filter::id),
+		JSON_FIELD_DECODE("nub_tier", &Filter::nubTier, &Filter::DecodeTierString),
+		JSON_FIELD_DECODE("pro_tier", &Filter::proTier, &Filter::DecodeTierString),
+		JSON_FIELD_DECODE("state", &Filter::state, &Filter::DecodeStateString),
+		JSON_FIELD("notes", &Filter::notes),
+	};
+	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
 bool KZ::API::Map::Course::Filter::DecodeTierString(std::string_view tierString, Tier &tier)
@@ -305,83 +238,40 @@ bool KZ::API::Map::Course::Filter::DecodeStateString(std::string_view stateStrin
 	return true;
 }
 
-bool KZ::API::Record::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::Record::JsonFields()
 {
-	if (!json.Get("id", this->id))
-	{
-		return false;
-	}
-
-	if (!json.Get("player", this->player))
-	{
-		return false;
-	}
-
-	if (!json.Get("map", this->map))
-	{
-		return false;
-	}
-
-	if (!json.Get("course", this->course))
-	{
-		return false;
-	}
-
-	std::string mode = "";
-
-	if (!json.Get("mode", mode))
-	{
-		return false;
-	}
-
-	if (!DecodeModeString(mode, this->mode))
-	{
-		return false;
-	}
-
-	if (!json.Get("teleports", this->teleports))
-	{
-		return false;
-	}
-
-	if (!json.Get("time", this->time))
-	{
-		return false;
-	}
-
-	if (json.Get("nub_rank", this->nubRank))
-	{
-		if (!json.Get("nub_points", this->nubPoints))
-		{
-			return false;
-		}
-		if (!json.Get("nub_max_rank", this->nubMaxRank))
-		{
-			return false;
-		}
-	}
-
-	if (json.Get("pro_rank", this->proRank))
-	{
-		if (!json.Get("pro_points", this->proPoints))
-		{
-			return false;
-		}
-		if (!json.Get("pro_max_rank", this->proMaxRank))
-		{
-			return false;
-		}
-	}
-
-	return true;
+	// The ranks and points of a leaderboard are only sent if the record is on it.
+	// clang-format off
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD("id", &Record::id),
+		JSON_FIELD("player", &Record::player),
+		JSON_FIELD("map", &Record::map),
+		JSON_FIELD("course", &Record::course),
+		JSON_FIELD_DECODE("mode", &Record::mode, &DecodeModeString),
+		JSON_FIELD("teleports", &Record::teleports),
+		JSON_FIELD("time", &Record::time),
+		JSON_OPTIONAL_FIELD("nub_rank", &Record::nubRank),
+		JSON_OPTIONAL_FIELD("nub_points", &Record::nubPoints),
+		JSON_OPTIONAL_FIELD("nub_max_rank", &Record::nubMaxRank),
+		JSON_OPTIONAL_FIELD("pro_rank", &Record::proRank),
+		JSON_OPTIONAL_FIELD("pro_points", &Record::proPoints),
+		JSON_OPTIONAL_FIELD("pro_max_rank", &Record::proMaxRank),
+	};
+	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::API::Record::MapInfo::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::Record::MapInfo::JsonFields()
 {
-	return json.Get("id", this->id) && json.Get("name", this->name);
+	static_persist constexpr JsonField fields[] = {JSON_FIELD("id", &MapInfo::id), JSON_FIELD("name", &MapInfo::name)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::API::Record::CourseInfo::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::Record::CourseInfo::JsonFields()
 {
-	return json.Get("id", this->id) && json.Get("name", this->name);
+	static_persist constexpr JsonField fields[] = {JSON_FIELD("id", &CourseInfo::id), JSON_FIELD("name", &CourseInfo::name)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
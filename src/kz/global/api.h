@@ -32,7 +32,7 @@ namespace KZ::API
 		u64 id {};
 		std::string name {};
 
-		bool FromJson(const Json &json);
+		static const JsonFieldTable &JsonFields();
 	};
 
 	struct Player
@@ -41,7 +41,7 @@ namespace KZ::API
 		std::string name {};
 		bool isBanned {};
 
-		bool FromJson(const Json &json);
+		static const JsonFieldTable &JsonFields();
 	};
 
 	struct Map
@@ -84,7 +84,7 @@ namespace KZ::API
 				State state;
 				std::optional<std::string> notes {};
 
-				bool FromJson(const Json &json);
+				static const JsonFieldTable &JsonFields();
 				static bool DecodeTierString(std::string_view tierString, Tier &tier);
 				static bool DecodeStateString(std::string_view stateString, State &state);
 			};
@@ -94,7 +94,7 @@ namespace KZ::API
 				Filter vanilla;
 				Filter classic;
 
-				bool FromJson(const Json &json);
+				static const JsonFieldTable &JsonFields();
 			};
 
 			u16 id;
@@ -103,7 +103,7 @@ namespace KZ::API
 			std::vector<PlayerInfo> mappers {};
 			Filters filters;
 
-			bool FromJson(const Json &json);
+			static const JsonFieldTable &JsonFields();
 		};
 
 		u16 id;
@@ -116,7 +116,7 @@ namespace KZ::API
 		std::vector<Course> courses {};
 		std::string approvedAt;
 
-		bool FromJson(const Json &json);
+		static const JsonFieldTable &JsonFields();
 		static bool DecodeStateString(std::string_view stateString, State &state);
 	};
 
@@ -127,7 +127,7 @@ namespace KZ::API
 			u16 id;
 			std::string name;
 
-			bool FromJson(const Json &json);
+			static const JsonFieldTable &JsonFields();
 		};
 
 		struct CourseInfo
@@ -135,7 +135,7 @@ namespace KZ::API
 			u16 id;
 			std::string name;
 
-			bool FromJson(const Json &json);
+			static const JsonFieldTable &JsonFields();
 		};
 
 		u32 id;
@@ -152,6 +152,6 @@ namespace KZ::API
 		f64 proPoints = -1;
 		u32 proMaxRank = 0;
 
-		bool FromJson(const Json &json);
+		static const JsonFieldTable &JsonFields();
 	};
 } // namespace KZ::API
@@ -1,16 +1,18 @@
 #include "events.h"
 
-bool KZ::API::events::MapChange::ToJson(Json &json) const
+bool KZ::API::events::MapChange::ToJson(JsonWriter &json) const
 {
 	return json.Set("new_map", this->mapName);
 }
 
-bool KZ::API::events::MapInfo::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::events::MapInfo::JsonFields()
 {
-	return json.Get("map", this->data);
+	static_persist constexpr JsonField fields[] = {JSON_FIELD("map", &MapInfo::data)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::API::events::PlayerJoin::ToJson(Json &json) const
+bool KZ::API::events::PlayerJoin::ToJson(JsonWriter &json) const
 {
 	// clang-format off
 	return json.Set("id", this->steamID)
@@ -19,12 +21,19 @@ bool KZ::API::events::PlayerJoin::ToJson(Json &json) const
 	// clang-format on
 }
 
-bool KZ::API::events::PlayerJoinAck::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::events::PlayerJoinAck::JsonFields()
 {
-	return json.Get("is_banned", this->isBanned) && json.Get("preferences", this->preferences);
+	// clang-format off
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD("is_banned", &PlayerJoinAck::isBanned),
+		JSON_FIELD("preferences", &PlayerJoinAck::preferences),
+	};
+	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::API::events::PlayerLeave::ToJson(Json &json) const
+bool KZ::API::events::PlayerLeave::ToJson(JsonWriter &json) const
 {
 	// clang-format off
 	return json.Set("id", this->steamID)
@@ -33,7 +42,7 @@ bool KZ::API::events::PlayerLeave::ToJson(Json &json) const
 	// clang-format on
 }
 
-bool KZ::API::events::NewRecord::ToJson(Json &json) const
+bool KZ::API::events::NewRecord::ToJson(JsonWriter &json) const
 {
 	// clang-format off
 	return json.Set("player_id", this->playerID)
@@ -42,111 +51,79 @@ bool KZ::API::events::NewRecord::ToJson(Json &json) const
 		&& json.Set("teleports", this->teleports)
 		&& json.Set("time", this->time)
 		&& json.Set("styles", this->styles)
-		&& json.Set("metadata", this->metadata);
+		&& json.Set("metadata", this->metadata)
+		&& (this->journalID == 0 || json.Set("journal_id", this->journalID));
 	// clang-format on
 }
 
-bool KZ::API::events::NewRecord::StyleInfo::ToJson(Json &json) const
+bool KZ::API::events::NewRecord::StyleInfo::ToJson(JsonWriter &json) const
 {
 	return json.Set("style", this->name) && json.Set("checksum", this->checksum);
 }
 
-bool KZ::API::events::NewRecordAck::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::events::NewRecordAck::JsonFields()
 {
-	if (!json.Get("record_id", this->recordId))
-	{
-		return false;
-	}
-
-	Json pbData;
-
-	if (!json.Get("pb_data", pbData))
-	{
-		return true;
-	}
-
-	if (!pbData.Get("player_rating", this->playerRating))
-	{
-		return false;
-	}
-
-	if (pbData.Get("nub_rank", this->overallData.rank))
-	{
-		if (!pbData.Get("nub_points", this->overallData.points))
-		{
-			return false;
-		}
-
-		if (!pbData.Get("nub_leaderboard_size", this->overallData.leaderboardSize))
-		{
-			return false;
-		}
-	}
-
-	if (pbData.Get("pro_rank", this->proData.rank))
-	{
-		if (!pbData.Get("pro_points", this->proData.points))
-		{
-			return false;
-		}
-
-		if (!pbData.Get("pro_leaderboard_size", this->proData.leaderboardSize))
-		{
-			return false;
-		}
-	}
+	// clang-format off
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD("record_id", &NewRecordAck::recordId),
+		JSON_NESTED("pb_data", &NewRecordAck::PBDataFields),
+	};
+	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
+}
 
-	return true;
+const JsonFieldTable &KZ::API::events::NewRecordAck::PBDataFields()
+{
+	// clang-format off
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD("player_rating", &NewRecordAck::playerRating),
+		JSON_OPTIONAL_FIELD("nub_rank", &NewRecordAck::overallData, &RecordData::rank),
+		JSON_OPTIONAL_FIELD("nub_points", &NewRecordAck::overallData, &RecordData::points),
+		JSON_OPTIONAL_FIELD("nub_leaderboard_size", &NewRecordAck::overallData, &RecordData::leaderboardSize),
+		JSON_OPTIONAL_FIELD("pro_rank", &NewRecordAck::proData, &RecordData::rank),
+		JSON_OPTIONAL_FIELD("pro_points", &NewRecordAck::proData, &RecordData::points),
+		JSON_OPTIONAL_FIELD("pro_leaderboard_size", &NewRecordAck::proData, &RecordData::leaderboardSize),
+	};
+	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::API::events::WantWorldRecordsForCache::ToJson(Json &json) const
+bool KZ::API::events::WantWorldRecordsForCache::ToJson(JsonWriter &json) const
 {
 	return json.Set("map_id", this->mapID);
 }
 
-bool KZ::API::events::WorldRecordsForCache::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::events::WorldRecordsForCache::JsonFields()
 {
-	return json.Get("records", this->records);
+	static_persist constexpr JsonField fields[] = {JSON_FIELD("records", &WorldRecordsForCache::records)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::API::events::MapDetails::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::events::MapDetails::JsonFields()
 {
-	return json.Get("id", this->id) && json.Get("name", this->name);
+	static_persist constexpr JsonField fields[] = {JSON_FIELD("id", &MapDetails::id), JSON_FIELD("name", &MapDetails::name)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::API::events::CourseDetails::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::events::CourseDetails::JsonFields()
 {
-	if (!(json.Get("id", this->id) && json.Get("name", this->name)))
-	{
-		return false;
-	}
-
-	std::string tier;
-
-	if (!json.Get("nub_tier", tier))
-	{
-		return false;
-	}
-
-	if (!KZ::API::Map::Course::Filter::DecodeTierString(tier, this->nubTier))
-	{
-		return false;
-	}
-
-	if (!json.Get("pro_tier", tier))
-	{
-		return false;
-	}
-
-	if (!KZ::API::Map::Course::Filter::DecodeTierString(tier, this->proTier))
-	{
-		return false;
-	}
-
-	return true;
+	// clang-format off
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD("id", &CourseDetails::id),
+		JSON_FIELD("name", &CourseDetails::name),
+		JSON_FIELD_DECODE("nub_tier", &CourseDetails::nubTier, &KZ::API::Map::Course::Filter::DecodeTierString),
+		JSON_FIELD_DECODE("pro_tier", &CourseDetails::proTier, &KZ::API::Map::Course::Filter::DecodeTierString),
+	};
+	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::API::events::WantCourseTop::ToJson(Json &json) const
+bool KZ::API::events::WantCourseTop::ToJson(JsonWriter &json) const
 {
 	// clang-format off
 	return json.Set("map_name", this->mapName)
@@ -157,17 +134,21 @@ bool KZ::API::events::WantCourseTop::ToJson(Json &json) const
 	// clang-format on
 }
 
-bool KZ::API::events::CourseTop::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::events::CourseTop::JsonFields()
 {
 	// clang-format off
-	return json.Get("map", this->map)
-		&& json.Get("course", this->course)
-		&& json.Get("overall", this->overall)
-		&& json.Get("pro", this->pro);
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD("map", &CourseTop::map),
+		JSON_FIELD("course", &CourseTop::course),
+		JSON_FIELD("overall", &CourseTop::overall),
+		JSON_FIELD("pro", &CourseTop::pro),
+	};
 	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::API::events::WantWorldRecords::ToJson(Json &json) const
+bool KZ::API::events::WantWorldRecords::ToJson(JsonWriter &json) const
 {
 	// clang-format off
 	return json.Set("map", this->mapName)
@@ -176,17 +157,21 @@ bool KZ::API::events::WantWorldRecords::ToJson(Json &json) const
 	// clang-format on
 }
 
-bool KZ::API::events::WorldRecords::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::events::WorldRecords::JsonFields()
 {
 	// clang-format off
-	return json.Get("map", this->map)
-		&& json.Get("course", this->course)
-		&& json.Get("overall", this->overall)
-		&& json.Get("pro", this->pro);
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD("map", &WorldRecords::map),
+		JSON_FIELD("course", &WorldRecords::course),
+		JSON_FIELD("overall", &WorldRecords::overall),
+		JSON_FIELD("pro", &WorldRecords::pro),
+	};
 	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::API::events::WantPersonalBest::ToJson(Json &json) const
+bool KZ::API::events::WantPersonalBest::ToJson(JsonWriter &json) const
 {
 	bool success = true;
 
@@ -207,23 +192,96 @@ bool KZ::API::events::WantPersonalBest::ToJson(Json &json) const
 	return success;
 }
 
-bool KZ::API::events::PersonalBest::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::events::PersonalBest::JsonFields()
 {
 	// clang-format off
-	return json.Get("player", this->player)
-		&& json.Get("map", this->map)
-		&& json.Get("course", this->course)
-		&& json.Get("overall", this->overall)
-		&& json.Get("pro", this->pro);
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD("player", &PersonalBest::player),
+		JSON_FIELD("map", &PersonalBest::map),
+		JSON_FIELD("course", &PersonalBest::course),
+		JSON_FIELD("overall", &PersonalBest::overall),
+		JSON_FIELD("pro", &PersonalBest::pro),
+	};
 	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::API::events::WantPlayerRecords::ToJson(Json &json) const
+bool KZ::API::events::WantPlayerRecords::ToJson(JsonWriter &json) const
 {
 	return json.Set("map_id", this->mapID) && json.Set("player_id", this->playerID);
 }
 
-bool KZ::API::events::PlayerRecords::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::events::PlayerRecords::JsonFields()
+{
+	static_persist constexpr JsonField fields[] = {JSON_FIELD("records", &PlayerRecords::records)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
+}
+
+bool KZ::API::events::NewInfraction::ToJson(JsonWriter &json) const
+{
+	// clang-format off
+	return json.Set("player_id", this->playerID)
+		&& json.Set("reason", this->reason)
+		&& json.Set("details", this->details)
+		&& (this->journalID == 0 || json.Set("journal_id", this->journalID));
+	// clang-format on
+}
+
+const JsonFieldTable &KZ::API::events::NewInfractionAck::JsonFields()
+{
+	static_persist constexpr JsonField fields[] = {JSON_FIELD("infraction_id", &NewInfractionAck::infractionID)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
+}
+
+bool KZ::API::events::Backlog::ToJson(JsonWriter &json) const
+{
+	return json.Set("events", this->events);
+}
+
+bool KZ::API::events::Backlog::Event::ToJson(JsonWriter &json) const
+{
+	// clang-format off
+	return json.Set("id", this->id)
+		&& json.Set("event", this->event)
+		&& json.Set("data", this->data);
+	// clang-format on
+}
+
+const JsonFieldTable &KZ::API::events::BacklogAck::JsonFields()
+{
+	static_persist constexpr JsonField fields[] = {JSON_FIELD("ids", &BacklogAck::ids)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
+}
+
+bool KZ::API::events::ReplayUploadStart::ToJson(JsonWriter &json) const
+{
+	// clang-format off
+	return json.Set("replay_id", this->replayID)
+		&& (this->recordID == 0 || json.Set("record_id", this->recordID))
+		&& json.Set("size", this->size)
+		&& json.Set("md5", this->checksum);
+	// clang-format on
+}
+
+const JsonFieldTable &KZ::API::events::ReplayUploadStartAck::JsonFields()
+{
+	static_persist constexpr JsonField fields[] = {JSON_FIELD("offset", &ReplayUploadStartAck::offset)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
+}
+
+bool KZ::API::events::ReplayUploadFinish::ToJson(JsonWriter &json) const
+{
+	return json.Set("replay_id", this->replayID);
+}
+
+const JsonFieldTable &KZ::API::events::ReplayUploadFinishAck::JsonFields()
 {
-	return json.Get("records", this->records);
+	static_persist constexpr JsonField fields[] = {JSON_FIELD("ok", &ReplayUploadFinishAck::ok)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
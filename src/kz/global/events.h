@@ -13,14 +13,14 @@ namespace KZ::API::events
 
 		MapChange(std::string_view mapName) : mapName(mapName) {}
 
-		bool ToJson(Json &json) const;
+		bool ToJson(JsonWriter &json) const;
 	};
 
 	struct MapInfo
 	{
 		std::optional<KZ::API::Map> data;
 
-		bool FromJson(const Json &json);
+		static const JsonFieldTable &JsonFields();
 	};
 
 	struct PlayerJoin
@@ -29,24 +29,24 @@ namespace KZ::API::events
 		std::string name;
 		std::string ipAddress;
 
-		bool ToJson(Json &json) const;
+		bool ToJson(JsonWriter &json) const;
 	};
 
 	struct PlayerJoinAck
 	{
 		bool isBanned;
-		Json preferences;
+		RawJson preferences;
 
-		bool FromJson(const Json &json);
+		static const JsonFieldTable &JsonFields();
 	};
 
 	struct PlayerLeave
 	{
 		u64 steamID;
 		std::string name;
-		Json preferences;
+		RawJson preferences;
 
-		bool ToJson(Json &json) const;
+		bool ToJson(JsonWriter &json) const;
 	};
 
 	struct NewRecord
@@ -56,7 +56,7 @@ namespace KZ::API::events
 			std::string_view name;
 			std::string_view checksum;
 
-			bool ToJson(Json &json) const;
+			bool ToJson(JsonWriter &json) const;
 		};
 
 		u64 playerID;
@@ -66,8 +66,10 @@ namespace KZ::API::events
 		f64 time;
 		std::vector<StyleInfo> styles;
 		std::string_view metadata;
+		// Same ID the entry has in the backlog, so the API can skip a record it already got live. 0 when written to the journal.
+		u64 journalID {};
 
-		bool ToJson(Json &json) const;
+		bool ToJson(JsonWriter &json) const;
 	};
 
 	struct NewRecordAck
@@ -84,21 +86,23 @@ namespace KZ::API::events
 		RecordData overallData {};
 		RecordData proData {};
 
-		bool FromJson(const Json &json);
+		static const JsonFieldTable &JsonFields();
+		// Keys of the `pb_data` object, absent if the record is not a personal best.
+		static const JsonFieldTable &PBDataFields();
 	};
 
 	struct WantWorldRecordsForCache
 	{
 		u16 mapID;
 
-		bool ToJson(Json &json) const;
+		bool ToJson(JsonWriter &json) const;
 	};
 
 	struct WorldRecordsForCache
 	{
 		std::vector<KZ::API::Record> records {};
 
-		bool FromJson(const Json &json);
+		static const JsonFieldTable &JsonFields();
 	};
 
 	struct MapDetails
@@ -106,7 +110,7 @@ namespace KZ::API::events
 		u16 id;
 		std::string name;
 
-		bool FromJson(const Json &json);
+		static const JsonFieldTable &JsonFields();
 	};
 
 	struct CourseDetails
@@ -116,7 +120,7 @@ namespace KZ::API::events
 		KZ::API::Map::Course::Filter::Tier nubTier;
 		KZ::API::Map::Course::Filter::Tier proTier;
 
-		bool FromJson(const Json &json);
+		static const JsonFieldTable &JsonFields();
 	};
 
 	struct WantCourseTop
@@ -127,7 +131,7 @@ namespace KZ::API::events
 		u32 limit;
 		u32 offset;
 
-		bool ToJson(Json &json) const;
+		bool ToJson(JsonWriter &json) const;
 	};
 
 	struct CourseTop
@@ -137,7 +141,7 @@ namespace KZ::API::events
 		std::vector<Record> overall;
 		std::vector<Record> pro;
 
-		bool FromJson(const Json &json);
+		static const JsonFieldTable &JsonFields();
 	};
 
 	struct WantWorldRecords
@@ -146,7 +150,7 @@ namespace KZ::API::events
 		std::string_view courseNameOrNumber;
 		Mode mode;
 
-		bool ToJson(Json &json) const;
+		bool ToJson(JsonWriter &json) const;
 	};
 
 	struct WorldRecords
@@ -156,7 +160,7 @@ namespace KZ::API::events
 		std::optional<Record> overall;
 		std::optional<Record> pro;
 
-		bool FromJson(const Json &json);
+		static const JsonFieldTable &JsonFields();
 	};
 
 	struct WantPersonalBest
@@ -168,7 +172,7 @@ namespace KZ::API::events
 		Mode mode;
 		std::vector<std::string> styles;
 
-		bool ToJson(Json &json) const;
+		bool ToJson(JsonWriter &json) const;
 	};
 
 	struct PersonalBest
@@ -179,7 +183,7 @@ namespace KZ::API::events
 		std::optional<Record> overall;
 		std::optional<Record> pro;
 
-		bool FromJson(const Json &json);
+		static const JsonFieldTable &JsonFields();
 	};
 
 	struct WantPlayerRecords
@@ -187,13 +191,91 @@ namespace KZ::API::events
 		u16 mapID;
 		u64 playerID;
 
-		bool ToJson(Json &json) const;
+		bool ToJson(JsonWriter &json) const;
 	};
 
 	struct PlayerRecords
 	{
 		std::vector<Record> records {};
 
-		bool FromJson(const Json &json);
+		static const JsonFieldTable &JsonFields();
+	};
+
+	struct NewInfraction
+	{
+		u64 playerID;
+		std::string reason;
+		std::string details;
+		// See NewRecord::journalID.
+		u64 journalID {};
+
+		bool ToJson(JsonWriter &json) const;
+	};
+
+	struct NewInfractionAck
+	{
+		u32 infractionID {};
+
+		static const JsonFieldTable &JsonFields();
+	};
+
+	// Journal entries the API did not acknowledge before, e.g. records set while the connection was down.
+	struct Backlog
+	{
+		struct Event
+		{
+			// Stays the same when an entry is sent more than once, the API ignores entries it already processed.
+			u64 id;
+			std::string event;
+			RawJson data;
+
+			bool ToJson(JsonWriter &json) const;
+		};
+
+		std::vector<Event> events;
+
+		bool ToJson(JsonWriter &json) const;
+	};
+
+	struct BacklogAck
+	{
+		// Entries the API processed, the others are sent again with a later batch.
+		std::vector<u64> ids {};
+
+		static const JsonFieldTable &JsonFields();
+	};
+
+	struct ReplayUploadStart
+	{
+		std::string replayID;
+		// 0 if the replay does not belong to a submitted record (e.g. cheater replays).
+		u32 recordID;
+		u32 size;
+		std::string checksum;
+
+		bool ToJson(JsonWriter &json) const;
+	};
+
+	struct ReplayUploadStartAck
+	{
+		// Bytes of the replay the API already received during an earlier attempt.
+		u32 offset {};
+
+		static const JsonFieldTable &JsonFields();
+	};
+
+	struct ReplayUploadFinish
+	{
+		std::string replayID;
+
+		bool ToJson(JsonWriter &json) const;
+	};
+
+	struct ReplayUploadFinishAck
+	{
+		// False if the received data does not match the checksum, the API discards it.
+		bool ok {};
+
+		static const JsonFieldTable &JsonFields();
 	};
 } // namespace KZ::API::events
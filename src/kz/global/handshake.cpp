@@ -1,6 +1,6 @@
 #include "handshake.h"
 
-bool KZ::API::handshake::Hello::ToJson(Json &json) const
+bool KZ::API::handshake::Hello::ToJson(JsonWriter &json) const
 {
 	// clang-format off
 	return json.Set("plugin_version", PLUGIN_FULL_VERSION)
@@ -10,67 +10,63 @@ bool KZ::API::handshake::Hello::ToJson(Json &json) const
 	// clang-format on
 }
 
-bool KZ::API::handshake::Hello::PlayerInfo::ToJson(Json &json) const
+bool KZ::API::handshake::Hello::PlayerInfo::ToJson(JsonWriter &json) const
 {
 	return json.Set("id", this->id) && json.Set("name", this->name);
 }
 
-bool KZ::API::handshake::HelloAck::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::handshake::HelloAck::JsonFields()
 {
-	f64 heartbeatInterval;
-
-	if (!json.Get("heartbeat_interval", heartbeatInterval))
-	{
-		return false;
-	}
-
-	this->heartbeatInterval = heartbeatInterval;
-
-	return json.Get("map", this->mapInfo) && json.Get("modes", this->modes) && json.Get("styles", this->styles)
-		   && json.Get("announcements", this->announcements);
+	// clang-format off
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD("heartbeat_interval", &HelloAck::heartbeatInterval),
+		JSON_FIELD("map", &HelloAck::mapInfo),
+		JSON_FIELD("modes", &HelloAck::modes),
+		JSON_FIELD("styles", &HelloAck::styles),
+		JSON_FIELD("announcements", &HelloAck::announcements),
+	};
+	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::API::handshake::HelloAck::ModeInfo::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::handshake::HelloAck::ModeInfo::JsonFields()
 {
-	std::string mode;
-
-	if (!json.Get("mode", mode))
-	{
-		return false;
-	}
-
-	if (!KZ::API::DecodeModeString(mode, this->mode))
-	{
-		return false;
-	}
-
-	return json.Get("linux_checksum", this->linuxChecksum) && json.Get("windows_checksum", this->windowsChecksum);
+	// clang-format off
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD_DECODE("mode", &ModeInfo::mode, &KZ::API::DecodeModeString),
+		JSON_FIELD("linux_checksum", &ModeInfo::linuxChecksum),
+		JSON_FIELD("windows_checksum", &ModeInfo::windowsChecksum),
+	};
+	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::API::handshake::HelloAck::StyleInfo::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::handshake::HelloAck::StyleInfo::JsonFields()
 {
-	std::string style;
-
-	if (!json.Get("style", style))
-	{
-		return false;
-	}
-
-	if (!KZ::API::DecodeStyleString(style, this->style))
-	{
-		return false;
-	}
-
-	return json.Get("linux_checksum", this->linuxChecksum) && json.Get("windows_checksum", this->windowsChecksum);
+	// clang-format off
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD_DECODE("style", &StyleInfo::style, &KZ::API::DecodeStyleString),
+		JSON_FIELD("linux_checksum", &StyleInfo::linuxChecksum),
+		JSON_FIELD("windows_checksum", &StyleInfo::windowsChecksum),
+	};
+	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::API::handshake::HelloAck::Announcement::FromJson(const Json &json)
+const JsonFieldTable &KZ::API::handshake::HelloAck::Announcement::JsonFields()
 {
 	// clang-format off
-	return json.Get("id", this->id)
-		&& json.Get("title", this->title)
-		&& json.Get("body", this->body)
-		&& json.Get("starts_at", this->startsAt)
-		&& json.Get("expires_at", this->expiresAt);
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD("id", &Announcement::id),
+		JSON_FIELD("title", &Announcement::title),
+		JSON_FIELD("body", &Announcement::body),
+		JSON_FIELD("starts_at", &Announcement::startsAt),
+		JSON_FIELD("expires_at", &Announcement::expiresAt),
+	};
 	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
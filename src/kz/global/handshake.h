@@ -15,7 +15,7 @@ namespace KZ::API::handshake
 			u64 id;
 			std::string_view name;
 
-			bool ToJson(Json &json) const;
+			bool ToJson(JsonWriter &json) const;
 		};
 
 		std::string_view checksum;
@@ -29,7 +29,7 @@ namespace KZ::API::handshake
 			this->players[id] = {id, name};
 		}
 
-		bool ToJson(Json &json) const;
+		bool ToJson(JsonWriter &json) const;
 	};
 
 	struct HelloAck
@@ -40,7 +40,7 @@ namespace KZ::API::handshake
 			std::string linuxChecksum {};
 			std::string windowsChecksum {};
 
-			bool FromJson(const Json &json);
+			static const JsonFieldTable &JsonFields();
 		};
 
 		struct StyleInfo
@@ -49,7 +49,7 @@ namespace KZ::API::handshake
 			std::string linuxChecksum {};
 			std::string windowsChecksum {};
 
-			bool FromJson(const Json &json);
+			static const JsonFieldTable &JsonFields();
 		};
 
 		struct Announcement
@@ -60,7 +60,7 @@ namespace KZ::API::handshake
 			u64 startsAt;
 			u64 expiresAt;
 
-			bool FromJson(const Json &json);
+			static const JsonFieldTable &JsonFields();
 		};
 
 		// seconds
@@ -70,6 +70,6 @@ namespace KZ::API::handshake
 		std::vector<StyleInfo> styles {};
 		std::vector<Announcement> announcements {};
 
-		bool FromJson(const Json &json);
+		static const JsonFieldTable &JsonFields();
 	};
 } // namespace KZ::API::handshake
@@ -0,0 +1,354 @@
+#include <ctime>
+#include <map>
+#include <mutex>
+
+#include "journal.h"
+#include "cs2kz.h"
+#include "utils/executor.h"
+#include "utils/plat.h"
+
+enum : u32
+{
+	JOURNAL_MAGIC = 0x4A475A4B, // KZGJ
+	JOURNAL_OP_APPEND = 0,
+	JOURNAL_OP_ACK = 1,
+};
+
+struct JournalRecordHeader
+{
+	u32 magic;
+	u32 op;
+	u64 id;
+	// Size of the event name and its data following the header, separated by a null byte. Acknowledgements have none.
+	u32 size;
+	// Of the header with this field set to 0 and of the payload. Records torn by a crash fail it.
+	u32 checksum;
+};
+
+static_global constexpr f64 FLUSH_INTERVAL = 0.25;
+// Payloads are small JSON objects, anything bigger is garbage.
+static_global constexpr u32 MAX_PAYLOAD_SIZE = 1024 * 1024;
+// The journal is rewritten with only the pending entries once it grows past this, or twice its size after the last rewrite.
+static_global constexpr u32 COMPACT_SIZE = 1024 * 1024;
+
+struct PendingEntry
+{
+	std::string event;
+	std::string data;
+	bool inFlight {};
+};
+
+static_global std::mutex journalMutex;
+// Ordered by ID, which is also the order the entries were appended in.
+static_global std::map<u64, PendingEntry> pendingEntries;
+// Records appended since the last flush.
+static_global std::string unwrittenRecords;
+static_global u64 nextID;
+
+// Only used by the flush, which runs on the global executor queue or after it is stopped.
+static_global FILE *journalFile;
+static_global u32 journalSize;
+static_global u32 compactedSize;
+// A failed write may have left a torn record, anything appended after it would be lost when the journal is loaded.
+static_global bool journalTorn;
+static_global char journalPath[MAX_PATH];
+static_global char journalTempPath[MAX_PATH];
+static_global executor::TimerID flushTimer;
+
+static_function u32 Checksum(u32 hash, const void *data, size_t size)
+{
+	// FNV-1a
+	const u8 *bytes = static_cast<const u8 *>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash = (hash ^ bytes[i]) * 16777619u;
+	}
+	return hash;
+}
+
+static_function void WriteRecord(std::string &out, u32 op, u64 id, std::string_view event = {}, std::string_view data = {})
+{
+	std::string payload;
+	if (op == JOURNAL_OP_APPEND)
+	{
+		payload.reserve(event.size() + 1 + data.size());
+		payload.append(event);
+		payload.push_back('\0');
+		payload.append(data);
+	}
+
+	JournalRecordHeader header {JOURNAL_MAGIC, op, id, (u32)payload.size(), 0};
+	header.checksum = Checksum(Checksum(2166136261u, &header, sizeof(header)), payload.data(), payload.size());
+	out.append(reinterpret_cast<const char *>(&header), sizeof(header));
+	out.append(payload);
+}
+
+// Read every intact record, stops at the first one that is not.
+static_function void LoadJournal(FILE *file)
+{
+	JournalRecordHeader header;
+	std::string payload;
+	while (fread(&header, sizeof(header), 1, file) == 1)
+	{
+		if (header.magic != JOURNAL_MAGIC || header.size > MAX_PAYLOAD_SIZE)
+		{
+			break;
+		}
+		payload.resize(header.size);
+		if (header.size > 0 && fread(payload.data(), header.size, 1, file) != 1)
+		{
+			break;
+		}
+		u32 checksum = header.checksum;
+		header.checksum = 0;
+		if (Checksum(Checksum(2166136261u, &header, sizeof(header)), payload.data(), payload.size()) != checksum)
+		{
+			break;
+		}
+
+		nextID = MAX(nextID, header.id + 1);
+		if (header.op == JOURNAL_OP_ACK)
+		{
+			pendingEntries.erase(header.id);
+			continue;
+		}
+		size_t separator = payload.find('\0');
+		if (header.op != JOURNAL_OP_APPEND || separator == std::string::npos)
+		{
+			continue;
+		}
+		pendingEntries[header.id] = {payload.substr(0, separator), payload.substr(separator + 1), false};
+	}
+}
+
+// Replace the journal with the given records. The new file is complete on disk before it takes the place of the old one.
+static_function bool RewriteJournal(const std::string &records)
+{
+	FILE *file = fopen(journalTempPath, "wb");
+	if (!file)
+	{
+		return false;
+	}
+	bool success = fwrite(records.data(), 1, records.size(), file) == records.size() && Plat_SyncFile(file);
+	fclose(file);
+	if (!success)
+	{
+		remove(journalTempPath);
+		return false;
+	}
+
+#ifdef _WIN32
+	// Windows cannot replace a file that is still open.
+	if (journalFile)
+	{
+		fclose(journalFile);
+		journalFile = nullptr;
+	}
+#endif
+	if (!Plat_ReplaceFile(journalTempPath, journalPath))
+	{
+		// The old journal is still in place, keep appending to it.
+		remove(journalTempPath);
+		if (!journalFile)
+		{
+			journalFile = fopen(journalPath, "ab");
+		}
+		return false;
+	}
+	if (journalFile)
+	{
+		fclose(journalFile);
+	}
+	journalFile = fopen(journalPath, "ab");
+	journalSize = compactedSize = (u32)records.size();
+	return journalFile != nullptr;
+}
+
+static_function void FlushJournal()
+{
+	std::string records;
+	std::string appended;
+	bool compact = false;
+	{
+		std::lock_guard<std::mutex> lock(journalMutex);
+		if (unwrittenRecords.empty())
+		{
+			return;
+		}
+		// Keep the unwritten records until they are on disk in one form or another.
+		appended.swap(unwrittenRecords);
+		if (journalTorn || journalSize + appended.size() > MAX(COMPACT_SIZE, 2 * compactedSize))
+		{
+			// Everything that was appended is either pending or acknowledged, the unwritten records are not needed.
+			for (auto &[id, entry] : pendingEntries)
+			{
+				WriteRecord(records, JOURNAL_OP_APPEND, id, entry.event, entry.data);
+			}
+			compact = true;
+		}
+	}
+
+	if (compact)
+	{
+		if (RewriteJournal(records))
+		{
+			journalTorn = false;
+			return;
+		}
+		META_CONPRINTF("[KZ::Global] Failed to rewrite the journal at %s.\n", journalPath);
+		if (journalTorn)
+		{
+			std::lock_guard<std::mutex> lock(journalMutex);
+			unwrittenRecords.insert(0, appended);
+			return;
+		}
+	}
+	if (!journalFile)
+	{
+		journalFile = fopen(journalPath, "ab");
+	}
+	if (!journalFile || fwrite(appended.data(), 1, appended.size(), journalFile) != appended.size() || !Plat_SyncFile(journalFile))
+	{
+		META_CONPRINTF("[KZ::Global] Failed to write %u bytes to the journal at %s.\n", (u32)appended.size(), journalPath);
+		// The next flush rewrites the journal from the pending entries.
+		journalTorn = true;
+		std::lock_guard<std::mutex> lock(journalMutex);
+		unwrittenRecords.insert(0, appended);
+		return;
+	}
+	journalSize += (u32)appended.size();
+}
+
+namespace KZ::API::journal
+{
+	void Init()
+	{
+		if (flushTimer)
+		{
+			return;
+		}
+
+		g_SMAPI->PathFormat(journalPath, sizeof(journalPath), "%s/addons/cs2kz/data/global-journal.bin", g_SMAPI->GetBaseDir());
+		V_snprintf(journalTempPath, sizeof(journalTempPath), "%s.tmp", journalPath);
+		// The API may still know IDs of entries acknowledged before the last restart, never hand them out again.
+		nextID = MAX(nextID, (u64)time(nullptr) << 20);
+
+		std::string records;
+		{
+			std::lock_guard<std::mutex> lock(journalMutex);
+			// A crash during a rewrite can leave only the new journal.
+			FILE *file = fopen(journalPath, "rb");
+			if (!file)
+			{
+				file = fopen(journalTempPath, "rb");
+			}
+			if (file)
+			{
+				LoadJournal(file);
+				fclose(file);
+			}
+			for (auto &[id, entry] : pendingEntries)
+			{
+				WriteRecord(records, JOURNAL_OP_APPEND, id, entry.event, entry.data);
+			}
+		}
+
+		// Start from a journal that only holds what is still pending, without any torn record at its end.
+		if (!RewriteJournal(records))
+		{
+			META_CONPRINTF("[KZ::Global] Failed to open the journal at %s, events will not survive a restart.\n", journalPath);
+		}
+		if (!pendingEntries.empty())
+		{
+			META_CONPRINTF("[KZ::Global] %u events from the journal will be sent to the API.\n", (u32)pendingEntries.size());
+		}
+
+		flushTimer = executor::AddTimer(executor::Queue::Global, FLUSH_INTERVAL, FLUSH_INTERVAL, FlushJournal);
+	}
+
+	void Shutdown()
+	{
+		if (!flushTimer)
+		{
+			return;
+		}
+
+		executor::RemoveTimer(flushTimer);
+		flushTimer = 0;
+		executor::WaitIdle(executor::Queue::Global);
+		FlushJournal();
+		if (journalFile)
+		{
+			fclose(journalFile);
+			journalFile = nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(journalMutex);
+		pendingEntries.clear();
+		unwrittenRecords.clear();
+		journalSize = 0;
+		journalTorn = false;
+	}
+
+	u64 Append(std::string_view event, std::string data, bool inFlight)
+	{
+		std::lock_guard<std::mutex> lock(journalMutex);
+		u64 id = nextID++;
+		WriteRecord(unwrittenRecords, JOURNAL_OP_APPEND, id, event, data);
+		pendingEntries[id] = {std::string(event), std::move(data), inFlight};
+		return id;
+	}
+
+	void Acknowledge(const std::vector<u64> &ids)
+	{
+		std::lock_guard<std::mutex> lock(journalMutex);
+		for (u64 id : ids)
+		{
+			if (pendingEntries.erase(id))
+			{
+				WriteRecord(unwrittenRecords, JOURNAL_OP_ACK, id);
+			}
+		}
+	}
+
+	void TakeBacklog(std::vector<Entry> &outEntries, u32 max)
+	{
+		std::lock_guard<std::mutex> lock(journalMutex);
+		for (auto it = pendingEntries.begin(); it != pendingEntries.end() && outEntries.size() < max; ++it)
+		{
+			if (!it->second.inFlight)
+			{
+				it->second.inFlight = true;
+				outEntries.push_back({it->first, it->second.event, it->second.data});
+			}
+		}
+	}
+
+	void ResetInFlight(const std::vector<u64> &ids)
+	{
+		std::lock_guard<std::mutex> lock(journalMutex);
+		for (u64 id : ids)
+		{
+			auto it = pendingEntries.find(id);
+			if (it != pendingEntries.end())
+			{
+				it->second.inFlight = false;
+			}
+		}
+	}
+
+	void ResetInFlight()
+	{
+		std::lock_guard<std::mutex> lock(journalMutex);
+		for (auto &[id, entry] : pendingEntries)
+		{
+			entry.inFlight = false;
+		}
+	}
+
+	u32 NumPending()
+	{
+		std::lock_guard<std::mutex> lock(journalMutex);
+		return (u32)pendingEntries.size();
+	}
+} // namespace KZ::API::journal
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common.h"
+
+// Events that have to reach the API (records, infractions) are written to an append-only file before they are sent,
+// and only dropped from it once the API acknowledged them. Whatever was not acknowledged before a disconnect, crash or restart
+// is sent again in batches after the next handshake.
+// Appends are cheap and never touch the disk on the calling thread: they are written and synced to disk together every few hundred milliseconds.
+namespace KZ::API::journal
+{
+	struct Entry
+	{
+		u64 id {};
+		std::string event;
+		// JSON object sent as the `data` of the event.
+		std::string data;
+	};
+
+	// Load the entries that were not acknowledged yet and start writing the journal.
+	void Init();
+	// Write and sync the entries appended since the last flush, then close the journal.
+	void Shutdown();
+
+	// Returns the ID the API acknowledges the entry with. Entries that are sent right away are in flight until acknowledged or reset.
+	u64 Append(std::string_view event, std::string data, bool inFlight);
+	void Acknowledge(const std::vector<u64> &ids);
+
+	// Up to `max` entries that are neither acknowledged nor in flight, oldest first. They are in flight afterwards.
+	void TakeBacklog(std::vector<Entry> &outEntries, u32 max);
+	// Entries in flight lost their answer (e.g. the connection dropped), send them again with the backlog.
+	void ResetInFlight(const std::vector<u64> &ids);
+	void ResetInFlight();
+
+	u32 NumPending();
+} // namespace KZ::API::journal
@@ -126,6 +126,8 @@ void KZGlobalService::Init()
 		url += "auth/cs2";
 	}
 
+	KZ::API::journal::Init();
+
 	KZGlobalService::socket = new ix::WebSocket();
 	KZGlobalService::socket->setUrl(url);
 
@@ -155,6 +157,15 @@ void KZGlobalService::Cleanup()
 
 	KZGlobalService::RestoreConVars();
 
+	// The heartbeat uses the socket, make sure it is not running before the socket goes away.
+	executor::RemoveTimer(KZGlobalService::heartbeatTimer.exchange(0));
+	executor::RemoveTimer(KZGlobalService::replayUploadTimer.exchange(0));
+	executor::RemoveTimer(KZGlobalService::backlogTimer.exchange(0));
+	executor::WaitIdle(executor::Queue::Global);
+	executor::WaitIdle(executor::Queue::ReplayUpload);
+	KZGlobalService::StopReplayUploads();
+	KZ::API::journal::Shutdown();
+
 	if (KZGlobalService::socket != nullptr)
 	{
 		KZGlobalService::socket->stop();
@@ -167,6 +178,11 @@ void KZGlobalService::Cleanup()
 
 void KZGlobalService::OnServerGamePostSimulate()
 {
+	if (KZGlobalService::state.load() != KZGlobalService::State::HandshakeCompleted)
+	{
+		return;
+	}
+
 	std::vector<std::function<void()>> callbacks;
 
 	{
@@ -174,21 +190,14 @@ void KZGlobalService::OnServerGamePostSimulate()
 
 		if (lock.try_lock())
 		{
-			KZGlobalService::mainThreadCallbacks.queue.swap(callbacks);
-
-			if (KZGlobalService::state.load() == KZGlobalService::State::HandshakeCompleted)
-			{
-				callbacks.reserve(callbacks.size() + KZGlobalService::mainThreadCallbacks.whenConnectedQueue.size());
-				callbacks.insert(callbacks.end(), KZGlobalService::mainThreadCallbacks.whenConnectedQueue.begin(),
-								 KZGlobalService::mainThreadCallbacks.whenConnectedQueue.end());
-				KZGlobalService::mainThreadCallbacks.whenConnectedQueue.clear();
-			}
+			KZGlobalService::mainThreadCallbacks.whenConnectedQueue.swap(callbacks);
 		}
 	}
 
-	for (const std::function<void()> &callback : callbacks)
+	// Run through the executor so a reconnect flushing a long backlog stays within the frame budget.
+	for (std::function<void()> &callback : callbacks)
 	{
-		callback();
+		executor::RunOnMainThread(std::move(callback));
 	}
 }
 
@@ -308,12 +317,12 @@ void KZGlobalService::OnPlayerAuthorized()
 
 					if (record.nubPoints != 0)
 					{
-						player->timerService->InsertPBToCache(record.time, course, modeID, true, true, "", record.nubPoints);
+						player->timerService->InsertPBToCache(record.time, course, modeID, true, true, nullptr, record.nubPoints);
 					}
 
 					if (record.proPoints != 0)
 					{
-						player->timerService->InsertPBToCache(record.time, course, modeID, false, true, "", record.proPoints);
+						player->timerService->InsertPBToCache(record.time, course, modeID, false, true, nullptr, record.proPoints);
 					}
 				}
 			};
@@ -387,7 +396,7 @@ void KZGlobalService::OnClientDisconnect()
 	KZ::API::events::PlayerLeave data;
 	data.steamID = this->player->GetSteamId64();
 	data.name = this->player->GetName();
-	data.preferences = Json(getPrefsResult.Get());
+	data.preferences = RawJson(getPrefsResult.Get());
 
 	switch (KZGlobalService::state.load())
 	{
@@ -402,7 +411,25 @@ void KZGlobalService::OnClientDisconnect()
 
 void KZGlobalService::SubmitBan(u64 steamID, std::string reason, std::string details)
 {
-	// TODO Anticheat: Implement this!
+	if (!KZGlobalService::MayBecomeAvailable())
+	{
+		return;
+	}
+
+	KZ::API::events::NewInfraction data {steamID, std::move(reason), std::move(details)};
+	bool sendNow = KZGlobalService::IsAvailable();
+	u64 journalID = KZGlobalService::AddToJournal("new-infraction", data, sendNow);
+
+	if (sendNow)
+	{
+		data.journalID = journalID;
+		auto callback = [journalID](KZ::API::events::NewInfractionAck &ack)
+		{
+			META_CONPRINTF("[KZ::Global] Infraction submitted under ID %u\n", ack.infractionID);
+			KZ::API::journal::Acknowledge({journalID});
+		};
+		KZGlobalService::SendMessage("new-infraction", data, callback);
+	}
 }
 
 void KZGlobalService::OnWebSocketMessage(const ix::WebSocketMessagePtr &message)
@@ -504,15 +531,13 @@ void KZGlobalService::OnWebSocketMessage(const ix::WebSocketMessagePtr &message)
 		{
 			META_CONPRINTF("[KZ::Global] Received WebSocket message:\n-----\n%s\n------\n", message->str.c_str());
 
-			Json payload(message->str);
-
 			switch (KZGlobalService::state.load())
 			{
 				case KZGlobalService::State::HandshakeInitiated:
 				{
 					KZ::API::handshake::HelloAck helloAck;
 
-					if (!helloAck.FromJson(payload))
+					if (!JsonDecode(message->str, helloAck))
 					{
 						META_CONPRINTF("[KZ::Global] Failed to decode 'HelloAck'\n");
 						break;
@@ -524,21 +549,16 @@ void KZGlobalService::OnWebSocketMessage(const ix::WebSocketMessagePtr &message)
 
 				case KZGlobalService::State::HandshakeCompleted:
 				{
-					if (!payload.IsValid())
-					{
-						META_CONPRINTF("[KZ::Global] WebSocket message is not valid JSON.\n");
-						break;
-					}
-
+					// Only the ID is read here, the rest of the payload is decoded by the callback waiting for it.
 					u32 messageID = 0;
 
-					if (!payload.Get("id", messageID))
+					if (!JsonDecodeField(message->str, "id", messageID))
 					{
 						META_CONPRINTF("[KZ::Global] Ignoring message without valid ID\n");
 						break;
 					}
 
-					KZGlobalService::AddMainThreadCallback([=]() { KZGlobalService::ExecuteMessageCallback(messageID, payload); });
+					KZGlobalService::ExecuteMessageCallback(messageID, message->str);
 				}
 				break;
 			}
@@ -585,20 +605,101 @@ void KZGlobalService::InitiateHandshake()
 	KZGlobalService::state.store(State::HandshakeInitiated);
 }
 
+void KZGlobalService::SendHeartbeat(f64 interval)
+{
+	if (KZGlobalService::state.load() != State::HandshakeCompleted)
+	{
+		executor::RemoveTimer(KZGlobalService::heartbeatTimer.exchange(0));
+		return;
+	}
+
+	KZGlobalService::socket->ping("");
+	META_CONPRINTF("[KZ::Global] Sent heartbeat. (interval=%is)\n", (i32)interval);
+}
+
+void KZGlobalService::SendBacklog()
+{
+	if (KZGlobalService::state.load() != State::HandshakeCompleted)
+	{
+		executor::RemoveTimer(KZGlobalService::backlogTimer.exchange(0));
+		return;
+	}
+
+	std::unique_lock lock(KZGlobalService::backlog.mutex);
+	f64 now = Plat_FloatTime();
+	if (!KZGlobalService::backlog.ids.empty())
+	{
+		if (now - KZGlobalService::backlog.sentAt < 30.0)
+		{
+			return;
+		}
+		// No answer, send the entries again with the next batch.
+		KZ::API::journal::ResetInFlight(KZGlobalService::backlog.ids);
+		KZGlobalService::backlog.ids.clear();
+	}
+
+	std::vector<KZ::API::journal::Entry> entries;
+	KZ::API::journal::TakeBacklog(entries, 50);
+	if (entries.empty())
+	{
+		return;
+	}
+
+	KZ::API::events::Backlog data;
+	for (KZ::API::journal::Entry &entry : entries)
+	{
+		KZGlobalService::backlog.ids.push_back(entry.id);
+		data.events.push_back({entry.id, std::move(entry.event), RawJson(std::move(entry.data))});
+	}
+	KZGlobalService::backlog.sentAt = now;
+	u32 batch = ++KZGlobalService::backlog.batch;
+
+	auto callback = [batch](KZ::API::events::BacklogAck &ack)
+	{
+		KZ::API::journal::Acknowledge(ack.ids);
+		{
+			std::unique_lock lock(KZGlobalService::backlog.mutex);
+			if (KZGlobalService::backlog.batch != batch)
+			{
+				return;
+			}
+			// Entries the API did not take are sent again later.
+			KZ::API::journal::ResetInFlight(KZGlobalService::backlog.ids);
+			KZGlobalService::backlog.ids.clear();
+		}
+		META_CONPRINTF("[KZ::Global] API acknowledged %u backlog events, %u left.\n", (u32)ack.ids.size(), KZ::API::journal::NumPending());
+		executor::Submit(executor::Queue::Global, KZGlobalService::SendBacklog);
+	};
+
+	if (!KZGlobalService::SendMessage("backlog", data, callback))
+	{
+		KZ::API::journal::ResetInFlight(KZGlobalService::backlog.ids);
+		KZGlobalService::backlog.ids.clear();
+	}
+}
+
 void KZGlobalService::CompleteHandshake(KZ::API::handshake::HelloAck &ack)
 {
 	KZGlobalService::state.store(State::HandshakeCompleted);
 
-	// clang-format off
-	std::thread([heartbeatInterval = std::chrono::milliseconds(static_cast<i64>(ack.heartbeatInterval * 800))]()
+	f64 heartbeatInterval = ack.heartbeatInterval * 0.8;
+	executor::TimerID heartbeatTimer =
+		executor::AddTimer(executor::Queue::Global, 0.0, heartbeatInterval, [heartbeatInterval]() { KZGlobalService::SendHeartbeat(heartbeatInterval); });
+	executor::RemoveTimer(KZGlobalService::heartbeatTimer.exchange(heartbeatTimer));
+
+	executor::TimerID replayUploadTimer = executor::AddTimer(executor::Queue::ReplayUpload, 0.0, KZGlobalService::replayUploadInterval,
+															 []() { KZGlobalService::UploadReplays(KZGlobalService::replayUploadInterval); });
+	executor::RemoveTimer(KZGlobalService::replayUploadTimer.exchange(replayUploadTimer));
+
+	// Whatever was in flight on the previous connection never got an answer.
 	{
-		while (KZGlobalService::state.load() == State::HandshakeCompleted) {
-			KZGlobalService::socket->ping("");
-			META_CONPRINTF("[KZ::Global] Sent heartbeat. (interval=%is)\n", std::chrono::duration_cast<std::chrono::seconds>(heartbeatInterval).count());
-			std::this_thread::sleep_for(heartbeatInterval);
-		}
-	}).detach();
-	// clang-format on
+		std::unique_lock lock(KZGlobalService::backlog.mutex);
+		KZGlobalService::backlog.ids.clear();
+		KZGlobalService::backlog.batch++;
+	}
+	KZ::API::journal::ResetInFlight();
+	executor::TimerID backlogTimer = executor::AddTimer(executor::Queue::Global, 0.0, 1.0, KZGlobalService::SendBacklog);
+	executor::RemoveTimer(KZGlobalService::backlogTimer.exchange(backlogTimer));
 
 	if (ack.mapInfo.has_value() && ack.mapInfo->name == g_pKZUtils->GetCurrentMapName().Get())
 	{
@@ -632,13 +733,13 @@ void KZGlobalService::CompleteHandshake(KZ::API::handshake::HelloAck &ack)
 	KZGlobalService::OnActivateServer();
 }
 
-void KZGlobalService::ExecuteMessageCallback(u32 messageID, const Json &payload)
+void KZGlobalService::ExecuteMessageCallback(u32 messageID, std::string_view payload)
 {
-	std::function<void(u32, const Json &)> callback;
+	std::function<void(u32, std::string_view)> callback;
 
 	{
 		std::unique_lock lock(KZGlobalService::messageCallbacks.mutex);
-		std::unordered_map<u32, std::function<void(u32, const Json &)>> &callbacks = KZGlobalService::messageCallbacks.queue;
+		std::unordered_map<u32, std::function<void(u32, std::string_view)>> &callbacks = KZGlobalService::messageCallbacks.queue;
 
 		if (auto found = callbacks.extract(messageID); !found.empty())
 		{
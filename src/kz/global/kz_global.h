@@ -9,12 +9,15 @@
 
 #include <vendor/ixwebsocket/ixwebsocket/IXWebSocket.h>
 
+#include "utils/executor.h"
 #include "utils/json.h"
+#include "utils/uuid.h"
 
 #include "kz/kz.h"
 #include "kz/global/api.h"
 #include "kz/global/handshake.h"
 #include "kz/global/events.h"
+#include "kz/global/journal.h"
 #include "kz/timer/announce.h"
 
 class KZGlobalService : public KZBaseService
@@ -87,6 +90,14 @@ public:
 	 */
 	static void UpdateRecordCache();
 
+	/**
+	 * Queues a replay to be uploaded to the API.
+	 *
+	 * Replays are streamed in binary chunks in the background and resume where they left off after a reconnect.
+	 * `recordID` links the replay to a submitted record, 0 if there is none.
+	 */
+	static void QueueReplayUpload(const UUID_t &uuid, u32 recordID = 0);
+
 public:
 	static void Init();
 	static void Cleanup();
@@ -173,14 +184,24 @@ public:
 		switch (KZGlobalService::state.load())
 		{
 			case KZGlobalService::State::HandshakeCompleted:
-				KZGlobalService::SendMessage("new-record", data, cb);
+			{
+				u64 journalID = KZGlobalService::AddToJournal("new-record", data, true);
+				data.journalID = journalID;
+				auto callback = [journalID, cb = std::forward<CB>(cb)](KZ::API::events::NewRecordAck &ack) mutable
+				{
+					KZ::API::journal::Acknowledge({journalID});
+					cb(ack);
+				};
+				KZGlobalService::SendMessage("new-record", data, callback);
 				return SubmitRecordResult::Submitted;
+			}
 
 			case KZGlobalService::State::Disconnected:
 				return SubmitRecordResult::NotConnected;
 
 			default:
-				KZGlobalService::AddMainThreadCallback([=]() { KZGlobalService::SendMessage("new-record", data, cb); });
+				// Sent with the backlog once the handshake is completed, even if the server restarts in the meantime.
+				KZGlobalService::AddToJournal("new-record", data, false);
 				return SubmitRecordResult::Queued;
 		}
 	}
@@ -286,17 +307,27 @@ private:
 	{
 		std::mutex mutex;
 
-		/**
-		 * Callbacks to execute on the main thread as soon as possible
-		 */
-		std::vector<std::function<void()>> queue;
-
 		/**
 		 * Callbacks to execute on the main thread as soon as we are fully connected to the API
 		 */
 		std::vector<std::function<void()>> whenConnectedQueue;
 	} mainThreadCallbacks {};
 
+	/**
+	 * Executor timer pinging the API while the handshake is completed, 0 if not running.
+	 */
+	static inline std::atomic<executor::TimerID> heartbeatTimer {};
+
+	/**
+	 * Executor timer streaming queued replays while the handshake is completed, 0 if not running.
+	 */
+	static inline std::atomic<executor::TimerID> replayUploadTimer {};
+
+	/**
+	 * How often the upload timer runs, in seconds. Short so the bandwidth cap is spread evenly.
+	 */
+	static constexpr f64 replayUploadInterval = 0.1;
+
 	// invariant: should be `nullptr` if `state == Uninitialized` and otherwise a valid pointer
 	static inline ix::WebSocket *socket = nullptr;
 
@@ -309,12 +340,12 @@ private:
 	 * Callbacks to execute when we receive responses to messages we sent earlier.
 	 *
 	 * The key is the message ID we're looking for, and the callback will be
-	 * invoked with that message ID and the payload.
+	 * invoked with that message ID and the raw payload on the WebSocket thread.
 	 */
 	static inline struct
 	{
 		std::mutex mutex;
-		std::unordered_map<u32, std::function<void(u32, const Json &)>> queue;
+		std::unordered_map<u32, std::function<void(u32, std::string_view)>> queue;
 	} messageCallbacks {};
 
 	/**
@@ -350,6 +381,22 @@ private:
 		std::vector<KZ::API::handshake::HelloAck::Announcement> data;
 	} announcements;
 
+	/**
+	 * The batch of journal entries waiting for an answer from the API.
+	 */
+	static inline struct
+	{
+		std::mutex mutex;
+		u32 batch {};
+		std::vector<u64> ids;
+		f64 sentAt {};
+	} backlog;
+
+	/**
+	 * Executor timer sending the journal backlog while the handshake is completed, 0 if not running.
+	 */
+	static inline std::atomic<executor::TimerID> backlogTimer {};
+
 public:
 	void PrintAnnouncements();
 
@@ -378,14 +425,54 @@ private:
 	 */
 	static void CompleteHandshake(KZ::API::handshake::HelloAck &ack);
 
+	/**
+	 * Pings the API, runs on the executor every `interval` seconds after the handshake.
+	 */
+	static void SendHeartbeat(f64 interval);
+
+	/**
+	 * Sends the oldest journal entries the API has not acknowledged yet, one batch at a time.
+	 *
+	 * Runs on the executor, every second and as soon as the previous batch was acknowledged.
+	 */
+	static void SendBacklog();
+
+	/**
+	 * Writes an event to the journal, so it is sent again after a disconnect or restart until the API acknowledges it.
+	 */
+	template<typename T>
+	static u64 AddToJournal(std::string_view event, const T &data, bool inFlight)
+	{
+		JsonWriter json;
+		data.ToJson(json);
+		return KZ::API::journal::Append(event, json.Finish(), inFlight);
+	}
+
+	/**
+	 * Sends the next chunks of the current replay upload within the bandwidth budget, runs on the executor every `interval` seconds.
+	 *
+	 * Defined in `upload.cpp`, like the rest of the replay upload.
+	 */
+	static void UploadReplays(f64 interval);
+
+	/**
+	 * Handles the API's answers to the start and end of an upload, on the executor.
+	 */
+	static void OnReplayUploadStarted(u32 attempt, u32 offset);
+	static void OnReplayUploadFinished(u32 attempt, bool ok);
+
+	/**
+	 * Closes the replay being uploaded. Has to be called after the upload timer is stopped.
+	 */
+	static void StopReplayUploads();
+
 	/**
 	 * Queues a callback to be executed on the main thread as soon as possible.
 	 */
 	template<typename CB>
 	static void AddMainThreadCallback(CB &&callback)
 	{
-		std::unique_lock lock(KZGlobalService::mainThreadCallbacks.mutex);
-		KZGlobalService::mainThreadCallbacks.queue.emplace_back(std::move(callback));
+		executor::RunOnMainThread(std::move(callback));
 	}
 
 	/**
@@ -413,16 +500,16 @@ private:
 	/**
 	 * Executes the callback with the given ID, if any.
 	 *
-	 * The callback will be executed on the main thread.
+	 * The payload is decoded on the WebSocket thread, the callback itself will be executed on the main thread.
 	 */
-	static void ExecuteMessageCallback(u32 messageID, const Json &payload);
+	static void ExecuteMessageCallback(u32 messageID, std::string_view payload);
 
 	/**
 	 * Prepares a message to be sent to the API.
 	 *
 	 * Note: we specialize `handshake::Hello` here because the format is slightly different from all other messages
 	 */
-	static bool PrepareMessage(std::string_view event, u32 messageID, const KZ::API::handshake::Hello &data, Json &payload)
+	static bool PrepareMessage(std::string_view event, u32 messageID, const KZ::API::handshake::Hello &data, JsonWriter &payload)
 	{
 		if (KZGlobalService::state.load() != State::Connected)
 		{
@@ -437,7 +524,7 @@ private:
 	 * Prepares a message to be sent to the API.
 	 */
 	template<typename T>
-	static bool PrepareMessage(std::string_view event, u32 messageID, const T &data, Json &payload)
+	static bool PrepareMessage(std::string_view event, u32 messageID, const T &data, JsonWriter &payload)
 	{
 		if (KZGlobalService::state.load() != State::HandshakeCompleted)
 		{
@@ -465,14 +552,14 @@ private:
 	template<typename T>
 	static bool SendMessage(std::string_view event, const T &data)
 	{
-		Json payload;
+		JsonWriter payload;
 
 		if (!KZGlobalService::PrepareMessage(event, KZGlobalService::nextMessageID++, data, payload))
 		{
 			return false;
 		}
 
-		KZGlobalService::socket->send(payload.ToString());
+		KZGlobalService::socket->send(payload.Finish());
 		return true;
 	}
 
@@ -483,7 +570,7 @@ private:
 	static bool SendMessage(std::string_view event, const T &data, CB &&callback)
 	{
 		u32 messageID = KZGlobalService::nextMessageID++;
-		Json payload;
+		JsonWriter payload;
 
 		if (!KZGlobalService::PrepareMessage(event, messageID, data, payload))
 		{
@@ -491,27 +578,21 @@ private:
 		}
 
 		// clang-format off
-		KZGlobalService::AddMessageCallback(messageID, [callback = std::move(callback)](u32 messageID, const Json& payload)
+		KZGlobalService::AddMessageCallback(messageID, [callback = std::move(callback)](u32 messageID, std::string_view payload) mutable
 		{
-			if (!payload.IsValid())
-			{
-				META_CONPRINTF("[KZ::Global] WebSocket message is not valid JSON.\n");
-				return;
-			}
-
 			std::remove_reference_t<typename decltype(std::function(callback))::argument_type> decoded;
 
-			if (!payload.Get("data", decoded))
+			if (!JsonDecodeField(payload, "data", decoded))
 			{
 				META_CONPRINTF("[KZ::Global] WebSocket message does not contain a valid `data` field.\n");
 				return;
 			}
 
-			callback(decoded);
+			KZGlobalService::AddMainThreadCallback([callback = std::move(callback), decoded = std::move(decoded)]() mutable { callback(decoded); });
 		});
 		// clang-format on
 
-		KZGlobalService::socket->send(payload.ToString());
+		KZGlobalService::socket->send(payload.Finish());
 		return true;
 	}
 };
@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <deque>
+
+#include "common.h"
+#include "kz_global.h"
+#include "kz/global/events.h"
+#include "kz/replays/packfile.h"
+#include "filesystem.h"
+#include "checksum_md5.h"
+
+CConVar<i32> kz_replay_upload_rate("kz_replay_upload_rate", FCVAR_NONE, "Bandwidth used to upload replays to the global API, in KiB/s.", 256, true,
+								   16, false, 0);
+
+// Chunks are binary frames: the 16 bytes of the replay UUID, the offset of the chunk as a little endian u32, then the data.
+static_global constexpr u32 CHUNK_HEADER_SIZE = 16 + sizeof(u32);
+static_global constexpr u32 CHUNK_SIZE = 64 * 1024;
+// Messages sent after a chunk wait until the socket has sent it, keep little enough buffered that records are never stuck behind a replay.
+static_global constexpr size_t MAX_BUFFERED = 2 * CHUNK_SIZE;
+// The upload starts over if the API does not answer the start or the end of an upload within this long.
+static_global constexpr f64 ACK_TIMEOUT = 30.0;
+// Run replays are only written a few seconds after their record is submitted, retry until they exist.
+static_global constexpr f64 RETRY_DELAY = 10.0;
+static_global constexpr u32 MAX_ATTEMPTS = 10;
+
+struct PendingUpload
+{
+	UUID_t uuid;
+	u32 recordID {};
+	u32 attempts {};
+	f64 notBefore {};
+};
+
+static_global struct
+{
+	std::mutex mutex;
+	std::deque<PendingUpload> queue;
+} pendingUploads;
+
+enum class UploadPhase
+{
+	Idle,
+	// Waiting for the API to tell how much of the replay it already has.
+	Starting,
+	Sending,
+	// Waiting for the API to verify the checksum.
+	Finishing,
+};
+
+// The upload in progress, only used on the replay upload queue which runs one task at a time.
+static_global struct
+{
+	UploadPhase phase = UploadPhase::Idle;
+	PendingUpload upload;
+	KZ::replaysystem::pack::Reader reader;
+	bool isOpen {};
+	u32 offset {};
+	// Answers to an earlier attempt at the same replay are ignored.
+	u32 attempt {};
+	f64 waitingSince {};
+	// Bytes that may still be sent, negative after a chunk larger than what was left.
+	f64 budget {};
+	std::string chunk;
+} currentUpload;
+
+static_function void CloseCurrentUpload()
+{
+	if (currentUpload.isOpen)
+	{
+		KZ::replaysystem::pack::Close(currentUpload.reader);
+		currentUpload.isOpen = false;
+	}
+	currentUpload.phase = UploadPhase::Idle;
+}
+
+// Put the current upload back into the queue. Uploads interrupted by a disconnect keep their attempts.
+static_function void RequeueCurrentUpload(bool failed, f64 delay)
+{
+	PendingUpload upload = currentUpload.upload;
+	CloseCurrentUpload();
+	if (failed && ++upload.attempts >= MAX_ATTEMPTS)
+	{
+		META_CONPRINTF("[KZ::Global] Giving up on uploading replay %s.\n", upload.uuid.ToString().c_str());
+		return;
+	}
+
+	upload.notBefore = Plat_FloatTime() + delay;
+	std::unique_lock lock(pendingUploads.mutex);
+	pendingUploads.queue.push_front(upload);
+}
+
+static_function bool ReadCurrentUpload(u32 offset, void *buffer, u32 size)
+{
+	g_pFullFileSystem->Seek(currentUpload.reader.file, currentUpload.reader.offset + offset, FILESYSTEM_SEEK_HEAD);
+	return (u32)g_pFullFileSystem->Read(buffer, size, currentUpload.reader.file) == size;
+}
+
+void KZGlobalService::QueueReplayUpload(const UUID_t &uuid, u32 recordID)
+{
+	if (!KZGlobalService::MayBecomeAvailable())
+	{
+		return;
+	}
+
+	std::unique_lock lock(pendingUploads.mutex);
+	for (const PendingUpload &upload : pendingUploads.queue)
+	{
+		if (upload.uuid == uuid)
+		{
+			return;
+		}
+	}
+	pendingUploads.queue.push_back({uuid, recordID, 0, 0.0});
+}
+
+void KZGlobalService::UploadReplays(f64 interval)
+{
+	if (KZGlobalService::state.load() != State::HandshakeCompleted)
+	{
+		// The API keeps what it received, the upload resumes from there once the timer is restarted by the next handshake.
+		executor::RemoveTimer(KZGlobalService::replayUploadTimer.exchange(0));
+		if (currentUpload.phase != UploadPhase::Idle)
+		{
+			RequeueCurrentUpload(false, 0.0);
+		}
+		return;
+	}
+
+	f64 now = Plat_FloatTime();
+	switch (currentUpload.phase)
+	{
+		case UploadPhase::Idle:
+		{
+			{
+				std::unique_lock lock(pendingUploads.mutex);
+				auto it = std::find_if(pendingUploads.queue.begin(), pendingUploads.queue.end(),
+									   [now](const PendingUpload &upload) { return upload.notBefore <= now; });
+				if (it == pendingUploads.queue.end())
+				{
+					return;
+				}
+				currentUpload.upload = *it;
+				pendingUploads.queue.erase(it);
+			}
+
+			if (!KZ::replaysystem::pack::Open(currentUpload.upload.uuid, currentUpload.reader))
+			{
+				RequeueCurrentUpload(true, RETRY_DELAY);
+				return;
+			}
+			currentUpload.isOpen = true;
+
+			// Hash the replay in chunks, it is never loaded as a whole.
+			u32 size = currentUpload.reader.length;
+			currentUpload.chunk.resize(CHUNK_HEADER_SIZE + CHUNK_SIZE);
+			MD5Context_t ctx;
+			unsigned char digest[MD5_DIGEST_LENGTH];
+			memset(&ctx, 0, sizeof(MD5Context_t));
+			MD5Init(&ctx);
+			for (u32 offset = 0; offset < size; offset += CHUNK_SIZE)
+			{
+				u32 length = MIN(CHUNK_SIZE, size - offset);
+				if (!ReadCurrentUpload(offset, currentUpload.chunk.data(), length))
+				{
+					RequeueCurrentUpload(true, RETRY_DELAY);
+					return;
+				}
+				MD5Update(&ctx, (unsigned char *)currentUpload.chunk.data(), length);
+			}
+			MD5Final(digest, &ctx);
+
+			KZ::API::events::ReplayUploadStart data;
+			data.replayID = currentUpload.upload.uuid.ToString();
+			data.recordID = currentUpload.upload.recordID;
+			data.size = size;
+			data.checksum = MD5_Print(digest, sizeof(digest));
+
+			u32 attempt = ++currentUpload.attempt;
+			auto callback = [attempt](KZ::API::events::ReplayUploadStartAck &ack)
+			{
+				executor::Submit(executor::Queue::ReplayUpload,
+								 [attempt, offset = ack.offset]() { KZGlobalService::OnReplayUploadStarted(attempt, offset); });
+			};
+
+			currentUpload.phase = UploadPhase::Starting;
+			currentUpload.waitingSince = now;
+			KZGlobalService::SendMessage("replay-upload-start", data, callback);
+		}
+		break;
+
+		case UploadPhase::Sending:
+		{
+			// Allow one full chunk even at low rates, the debt is paid back before the next one.
+			f64 rate = kz_replay_upload_rate.Get() * 1024.0;
+			currentUpload.budget = MIN(currentUpload.budget + rate * interval, (f64)CHUNK_SIZE);
+
+			u32 size = currentUpload.reader.length;
+			while (currentUpload.offset < size && currentUpload.budget > 0.0 && KZGlobalService::socket->bufferedAmount() < MAX_BUFFERED)
+			{
+				u32 length = MIN(CHUNK_SIZE, size - currentUpload.offset);
+				currentUpload.chunk.resize(CHUNK_HEADER_SIZE + length);
+				char *header = currentUpload.chunk.data();
+				V_memcpy(header, currentUpload.upload.uuid.bytes, 16);
+				for (u32 i = 0; i < sizeof(u32); i++)
+				{
+					header[16 + i] = (char)((currentUpload.offset >> (i * 8)) & 0xFF);
+				}
+				if (!ReadCurrentUpload(currentUpload.offset, header + CHUNK_HEADER_SIZE, length))
+				{
+					RequeueCurrentUpload(true, RETRY_DELAY);
+					return;
+				}
+
+				KZGlobalService::socket->sendBinary(currentUpload.chunk);
+				currentUpload.offset += length;
+				currentUpload.budget -= length;
+			}
+
+			if (currentUpload.offset < size)
+			{
+				return;
+			}
+
+			KZ::API::events::ReplayUploadFinish data;
+			data.replayID = currentUpload.upload.uuid.ToString();
+
+			u32 attempt = currentUpload.attempt;
+			auto callback = [attempt](KZ::API::events::ReplayUploadFinishAck &ack)
+			{
+				executor::Submit(executor::Queue::ReplayUpload, [attempt, ok = ack.ok]() { KZGlobalService::OnReplayUploadFinished(attempt, ok); });
+			};
+
+			currentUpload.phase = UploadPhase::Finishing;
+			currentUpload.waitingSince = now;
+			KZGlobalService::SendMessage("replay-upload-finish", data, callback);
+		}
+		break;
+
+		case UploadPhase::Starting: /* fall-through */
+		case UploadPhase::Finishing:
+		{
+			if (now - currentUpload.waitingSince > ACK_TIMEOUT)
+			{
+				META_CONPRINTF("[KZ::Global] API did not answer the upload of replay %s, retrying.\n", currentUpload.upload.uuid.ToString().c_str());
+				RequeueCurrentUpload(true, RETRY_DELAY);
+			}
+		}
+		break;
+	}
+}
+
+void KZGlobalService::OnReplayUploadStarted(u32 attempt, u32 offset)
+{
+	if (currentUpload.phase != UploadPhase::Starting || currentUpload.attempt != attempt)
+	{
+		return;
+	}
+
+	if (offset > currentUpload.reader.length)
+	{
+		META_CONPRINTF("[KZ::Global] API has more of replay %s than it contains, sending it again.\n", currentUpload.upload.uuid.ToString().c_str());
+		offset = 0;
+	}
+	else if (offset > 0)
+	{
+		META_CONPRINTF("[KZ::Global] Resuming upload of replay %s at %u/%u bytes.\n", currentUpload.upload.uuid.ToString().c_str(), offset,
+					   currentUpload.reader.length);
+	}
+
+	currentUpload.offset = offset;
+	currentUpload.budget = 0.0;
+	currentUpload.phase = UploadPhase::Sending;
+}
+
+void KZGlobalService::OnReplayUploadFinished(u32 attempt, bool ok)
+{
+	if (currentUpload.phase != UploadPhase::Finishing || currentUpload.attempt != attempt)
+	{
+		return;
+	}
+
+	if (!ok)
+	{
+		META_CONPRINTF("[KZ::Global] Checksum mismatch for replay %s, uploading it again.\n", currentUpload.upload.uuid.ToString().c_str());
+		RequeueCurrentUpload(true, 0.0);
+		return;
+	}
+
+	META_CONPRINTF("[KZ::Global] Uploaded replay %s (%u bytes).\n", currentUpload.upload.uuid.ToString().c_str(), currentUpload.reader.length);
+	CloseCurrentUpload();
+}
+
+void KZGlobalService::StopReplayUploads()
+{
+	CloseCurrentUpload();
+	std::unique_lock lock(pendingUploads.mutex);
+	pendingUploads.queue.clear();
+}
@@ -0,0 +1,683 @@
+#include "collision.h"
+#include "sdk/physicsgamesystem.h"
+#include "utils/executor.h"
+#include "vprof.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <xmmintrin.h>
+
+#include "tier0/memdbgon.h"
+
+// Floor checks probe this far above and below the expected floor height.
+#define FLOOR_PROBE_HEIGHT 2.0f
+// Step used to find the floor edge before refining it.
+#define EDGE_SEARCH_STEP 1.0f
+// Edges are refined to 1/256 units.
+#define EDGE_REFINE_ITERATIONS 8
+// Level triangles are copied out of the engine on the main thread, at most this many corners per frame.
+#define COLLECT_CORNERS_PER_FRAME (3 * 32768)
+
+#define BVH_LEAF_SIZE 4
+#define BVH_WIDTH     4
+#define BVH_MAX_DEPTH 64
+
+struct BVHTriangle
+{
+	Vector v0;
+	Vector e1;
+	Vector e2;
+};
+
+struct Bounds
+{
+	Vector mins = Vector(FLT_MAX, FLT_MAX, FLT_MAX);
+	Vector maxs = Vector(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	void Add(const Vector &point)
+	{
+		mins = Vector(MIN(mins.x, point.x), MIN(mins.y, point.y), MIN(mins.z, point.z));
+		maxs = Vector(MAX(maxs.x, point.x), MAX(maxs.y, point.y), MAX(maxs.z, point.z));
+	}
+
+	void Add(const Bounds &other)
+	{
+		Add(other.mins);
+		Add(other.maxs);
+	}
+
+	f32 SurfaceArea() const
+	{
+		Vector size = maxs - mins;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+};
+
+// 4-wide node, child bounds are stored as SoA so a ray can be tested against all of them at once.
+struct alignas(16) BVHNode
+{
+	static constexpr i32 EMPTY = INT32_MIN;
+
+	f32 minX[BVH_WIDTH];
+	f32 minY[BVH_WIDTH];
+	f32 minZ[BVH_WIDTH];
+	f32 maxX[BVH_WIDTH];
+	f32 maxY[BVH_WIDTH];
+	f32 maxZ[BVH_WIDTH];
+	// >= 0: inner node index, < 0: ~leaf index, EMPTY: unused slot.
+	i32 children[BVH_WIDTH];
+};
+
+struct BVHLeaf
+{
+	u32 first;
+	u32 count;
+};
+
+class CollisionBVH
+{
+public:
+	// Takes a flat list of triangle corners.
+	void Build(const std::vector<Vector> &corners);
+
+	f32 TraceRay(const Vector &start, const Vector &end) const;
+
+	u32 GetTriangleCount() const
+	{
+		return (u32)this->triangles.size();
+	}
+
+	u32 GetNodeCount() const
+	{
+		return (u32)this->nodes.size();
+	}
+
+private:
+	struct BuildNode
+	{
+		Bounds bounds;
+		i32 left = -1;
+		i32 right = -1;
+		u32 first {};
+		u32 count {};
+
+		bool IsLeaf() const
+		{
+			return left < 0;
+		}
+	};
+
+	struct BuildRef
+	{
+		Bounds bounds;
+		Vector centroid;
+		u32 triangle;
+	};
+
+	i32 BuildBinary(std::vector<BuildNode> &buildNodes, std::vector<BuildRef> &refs, u32 first, u32 count, u32 depth);
+	// Turns the binary tree into 4-wide nodes.
+	i32 CollapseNode(const std::vector<BuildNode> &buildNodes, i32 buildIndex);
+	i32 CollapseChild(const std::vector<BuildNode> &buildNodes, i32 buildIndex);
+
+	std::vector<BVHTriangle> triangles;
+	std::vector<u32> triangleOrder;
+	std::vector<BVHNode> nodes;
+	std::vector<BVHLeaf> leaves;
+	i32 root = BVHNode::EMPTY;
+};
+
+i32 CollisionBVH::BuildBinary(std::vector<BuildNode> &buildNodes, std::vector<BuildRef> &refs, u32 first, u32 count, u32 depth)
+{
+	i32 index = (i32)buildNodes.size();
+	buildNodes.emplace_back();
+	Bounds bounds, centroidBounds;
+	for (u32 i = first; i < first + count; i++)
+	{
+		bounds.Add(refs[i].bounds);
+		centroidBounds.Add(refs[i].centroid);
+	}
+	buildNodes[index].bounds = bounds;
+
+	if (count <= BVH_LEAF_SIZE || depth >= BVH_MAX_DEPTH)
+	{
+		buildNodes[index].first = first;
+		buildNodes[index].count = count;
+		return index;
+	}
+
+	// Median split on the widest centroid axis. Map geometry is built once per map, so this favours a simple build over a perfect tree.
+	Vector extent = centroidBounds.maxs - centroidBounds.mins;
+	u32 axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+	u32 half = count / 2;
+	std::nth_element(refs.begin() + first, refs.begin() + first + half, refs.begin() + first + count,
+					 [axis](const BuildRef &a, const BuildRef &b) { return a.centroid[axis] < b.centroid[axis]; });
+
+	i32 left = this->BuildBinary(buildNodes, refs, first, half, depth + 1);
+	i32 right = this->BuildBinary(buildNodes, refs, first + half, count - half, depth + 1);
+	buildNodes[index].left = left;
+	buildNodes[index].right = right;
+	return index;
+}
+
+i32 CollisionBVH::CollapseChild(const std::vector<BuildNode> &buildNodes, i32 buildIndex)
+{
+	const BuildNode &buildNode = buildNodes[buildIndex];
+	if (!buildNode.IsLeaf())
+	{
+		return this->CollapseNode(buildNodes, buildIndex);
+	}
+	this->leaves.push_back({buildNode.first, buildNode.count});
+	return ~(i32)(this->leaves.size() - 1);
+}
+
+i32 CollisionBVH::CollapseNode(const std::vector<BuildNode> &buildNodes, i32 buildIndex)
+{
+	const BuildNode &buildNode = buildNodes[buildIndex];
+	i32 slots[BVH_WIDTH] = {buildIndex};
+	u32 slotCount = 1;
+	if (!buildNode.IsLeaf())
+	{
+		slots[0] = buildNode.left;
+		slots[1] = buildNode.right;
+		slotCount = 2;
+	}
+
+	// Pull grandchildren up until the node is full, always opening the largest inner child.
+	while (slotCount < BVH_WIDTH)
+	{
+		i32 best = -1;
+		f32 bestArea = -1.0f;
+		for (u32 i = 0; i < slotCount; i++)
+		{
+			const BuildNode &candidate = buildNodes[slots[i]];
+			if (!candidate.IsLeaf() && candidate.bounds.SurfaceArea() > bestArea)
+			{
+				best = (i32)i;
+				bestArea = candidate.bounds.SurfaceArea();
+			}
+		}
+		if (best < 0)
+		{
+			break;
+		}
+		const BuildNode &opened = buildNodes[slots[best]];
+		slots[best] = opened.left;
+		slots[slotCount++] = opened.right;
+	}
+
+	i32 index = (i32)this->nodes.size();
+	this->nodes.emplace_back();
+	for (u32 i = 0; i < BVH_WIDTH; i++)
+	{
+		BVHNode &node = this->nodes[index];
+		if (i >= slotCount)
+		{
+			node.minX[i] = node.minY[i] = node.minZ[i] = FLT_MAX;
+			node.maxX[i] = node.maxY[i] = node.maxZ[i] = -FLT_MAX;
+			node.children[i] = BVHNode::EMPTY;
+			continue;
+		}
+		const Bounds &bounds = buildNodes[slots[i]].bounds;
+		node.minX[i] = bounds.mins.x;
+		node.minY[i] = bounds.mins.y;
+		node.minZ[i] = bounds.mins.z;
+		node.maxX[i] = bounds.maxs.x;
+		node.maxY[i] = bounds.maxs.y;
+		node.maxZ[i] = bounds.maxs.z;
+		// The vector may reallocate while collapsing the child, so don't hold on to the node.
+		i32 child = this->CollapseChild(buildNodes, slots[i]);
+		this->nodes[index].children[i] = child;
+	}
+	return index;
+}
+
+void CollisionBVH::Build(const std::vector<Vector> &corners)
+{
+	u32 count = (u32)(corners.size() / 3);
+	this->triangles.clear();
+	this->triangles.reserve(count);
+	std::vector<BuildRef> refs;
+	refs.reserve(count);
+	for (u32 i = 0; i < count; i++)
+	{
+		const Vector &a = corners[i * 3];
+		const Vector &b = corners[i * 3 + 1];
+		const Vector &c = corners[i * 3 + 2];
+		BuildRef ref;
+		ref.bounds.Add(a);
+		ref.bounds.Add(b);
+		ref.bounds.Add(c);
+		ref.centroid = (a + b + c) / 3.0f;
+		ref.triangle = (u32)this->triangles.size();
+		refs.push_back(ref);
+		this->triangles.push_back({a, b - a, c - a});
+	}
+
+	this->nodes.clear();
+	this->leaves.clear();
+	this->root = BVHNode::EMPTY;
+	if (refs.empty())
+	{
+		return;
+	}
+
+	std::vector<BuildNode> buildNodes;
+	buildNodes.reserve(count * 2 / BVH_LEAF_SIZE + 1);
+	i32 buildRoot = this->BuildBinary(buildNodes, refs, 0, count, 0);
+
+	this->triangleOrder.resize(count);
+	for (u32 i = 0; i < count; i++)
+	{
+		this->triangleOrder[i] = refs[i].triangle;
+	}
+
+	// The root is always a node, even for tiny maps, so traversal doesn't need a special case.
+	this->root = this->CollapseNode(buildNodes, buildRoot);
+}
+
+static_function f32 SafeInverse(f32 value)
+{
+	// Avoid infinities so 0 * inv never turns into a NaN on slab boundaries.
+	if (fabs(value) < 1e-12f)
+	{
+		return value < 0.0f ? -1e30f : 1e30f;
+	}
+	return 1.0f / value;
+}
+
+f32 CollisionBVH::TraceRay(const Vector &start, const Vector &end) const
+{
+	if (this->root == BVHNode::EMPTY)
+	{
+		return 1.0f;
+	}
+
+	Vector delta = end - start;
+	f32 best = 1.0f;
+
+	const __m128 originX = _mm_set1_ps(start.x);
+	const __m128 originY = _mm_set1_ps(start.y);
+	const __m128 originZ = _mm_set1_ps(start.z);
+	const __m128 invX = _mm_set1_ps(SafeInverse(delta.x));
+	const __m128 invY = _mm_set1_ps(SafeInverse(delta.y));
+	const __m128 invZ = _mm_set1_ps(SafeInverse(delta.z));
+	const __m128 zero = _mm_setzero_ps();
+
+	i32 stack[BVH_MAX_DEPTH * BVH_WIDTH];
+	u32 stackSize = 0;
+	stack[stackSize++] = this->root;
+	while (stackSize)
+	{
+		const BVHNode &node = this->nodes[stack[--stackSize]];
+
+		// Slab test against the four children at once.
+		__m128 tx0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minX), originX), invX);
+		__m128 tx1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxX), originX), invX);
+		__m128 ty0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minY), originY), invY);
+		__m128 ty1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxY), originY), invY);
+		__m128 tz0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minZ), originZ), invZ);
+		__m128 tz1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxZ), originZ), invZ);
+		__m128 tNear = _mm_max_ps(_mm_max_ps(_mm_min_ps(tx0, tx1), _mm_min_ps(ty0, ty1)), _mm_max_ps(_mm_min_ps(tz0, tz1), zero));
+		__m128 tFar = _mm_min_ps(_mm_min_ps(_mm_max_ps(tx0, tx1), _mm_max_ps(ty0, ty1)), _mm_min_ps(_mm_max_ps(tz0, tz1), _mm_set1_ps(best)));
+		i32 hitMask = _mm_movemask_ps(_mm_cmple_ps(tNear, tFar));
+
+		for (u32 i = 0; i < BVH_WIDTH; i++)
+		{
+			if (!(hitMask & (1 << i)) || node.children[i] == BVHNode::EMPTY)
+			{
+				continue;
+			}
+			if (node.children[i] >= 0)
+			{
+				if (stackSize < sizeof(stack) / sizeof(stack[0]))
+				{
+					stack[stackSize++] = node.children[i];
+				}
+				continue;
+			}
+
+			const BVHLeaf &leaf = this->leaves[~node.children[i]];
+			for (u32 j = leaf.first; j < leaf.first + leaf.count; j++)
+			{
+				// Moller-Trumbore, both faces count as a hit.
+				const BVHTriangle &triangle = this->triangles[this->triangleOrder[j]];
+				Vector p = delta.Cross(triangle.e2);
+				f32 det = triangle.e1.Dot(p);
+				if (fabs(det) < 1e-8f)
+				{
+					continue;
+				}
+				f32 invDet = 1.0f / det;
+				Vector t = start - triangle.v0;
+				f32 u = t.Dot(p) * invDet;
+				if (u < 0.0f || u > 1.0f)
+				{
+					continue;
+				}
+				Vector q = t.Cross(triangle.e1);
+				f32 v = delta.Dot(q) * invDet;
+				if (v < 0.0f || u + v > 1.0f)
+				{
+					continue;
+				}
+				f32 fraction = triangle.e2.Dot(q) * invDet;
+				if (fraction >= 0.0f && fraction < best)
+				{
+					best = fraction;
+				}
+			}
+		}
+	}
+	return best;
+}
+
+static_global std::shared_ptr<const CollisionBVH> currentTree;
+// Bumped on every rebuild, a worker only publishes its tree if it is still the latest one.
+static_global std::atomic<u32> buildGeneration;
+static_global CPhysicsGameSystem *lastPhysicsGameSystem;
+static_global i32 lastSpawnGroupCount = -1;
+
+using SpawnGroupIndex = decltype(CPhysicsGameSystem::m_PhysicsSpawnGroups)::IndexType_t;
+
+// Triangles copied so far for the build in progress. Only touched on the main thread, the worker gets the finished copy.
+static_global struct
+{
+	bool active;
+	u32 generation;
+	SpawnGroupIndex group;
+	i32 part;
+	std::vector<Vector> corners;
+} collection;
+
+static_function std::shared_ptr<const CollisionBVH> GetTree()
+{
+	return std::atomic_load(&currentTree);
+}
+
+static_function bool IsPlayerSolid(const CPhysAggregateData *aggregateData, u32 attributeIndex)
+{
+	if (attributeIndex >= (u32)aggregateData->m_CollisionAttributes.Count())
+	{
+		return false;
+	}
+	const RnCollisionAttr_t &collisionAttr = aggregateData->m_CollisionAttributes[attributeIndex];
+	return collisionAttr.HasInteractsAsLayer(LAYER_INDEX_CONTENTS_SOLID) || collisionAttr.HasInteractsAsLayer(LAYER_INDEX_CONTENTS_PLAYER_CLIP);
+}
+
+static_function void AppendHullTriangles(const RnHull_t &hull, std::vector<Vector> &corners)
+{
+	i32 vertexCount = hull.m_VertexPositions.Count();
+	i32 edgeCount = hull.m_Edges.Count();
+	FOR_EACH_VEC(hull.m_Faces, i)
+	{
+		// Hull faces are convex polygons described by a half-edge loop, fan them out from the first vertex.
+		u8 first = hull.m_Faces[i].m_nEdge;
+		if (first >= edgeCount)
+		{
+			continue;
+		}
+		u8 anchor = hull.m_Edges[first].m_nOrigin;
+		u8 edge = hull.m_Edges[first].m_nNext;
+		for (u32 guard = 0; guard < 256 && edge < edgeCount && edge != first; guard++)
+		{
+			u8 next = hull.m_Edges[edge].m_nNext;
+			if (next >= edgeCount || next == first)
+			{
+				break;
+			}
+			u8 b = hull.m_Edges[edge].m_nOrigin;
+			u8 c = hull.m_Edges[next].m_nOrigin;
+			if (anchor < vertexCount && b < vertexCount && c < vertexCount)
+			{
+				corners.push_back(hull.m_VertexPositions[anchor]);
+				corners.push_back(hull.m_VertexPositions[b]);
+				corners.push_back(hull.m_VertexPositions[c]);
+			}
+			edge = next;
+		}
+	}
+}
+
+static_function void AppendMeshTriangles(const RnMesh_t &mesh, std::vector<Vector> &corners)
+{
+	i32 vertexCount = mesh.m_Vertices.Count();
+	FOR_EACH_VEC(mesh.m_Triangles, i)
+	{
+		const RnTriangle_t &triangle = mesh.m_Triangles[i];
+		if (triangle.m_nIndex[0] >= vertexCount || triangle.m_nIndex[1] >= vertexCount || triangle.m_nIndex[2] >= vertexCount)
+		{
+			continue;
+		}
+		corners.push_back(mesh.m_Vertices[triangle.m_nIndex[0]]);
+		corners.push_back(mesh.m_Vertices[triangle.m_nIndex[1]]);
+		corners.push_back(mesh.m_Vertices[triangle.m_nIndex[2]]);
+	}
+}
+
+static_function void AppendPartTriangles(const CPhysAggregateData *aggregateData, const VPhysXBodyPart_t *part, std::vector<Vector> &corners)
+{
+	FOR_EACH_VEC(part->m_rnShape.m_hulls, k)
+	{
+		const RnHullDesc_t &hull = part->m_rnShape.m_hulls[k];
+		if (IsPlayerSolid(aggregateData, hull.m_nCollisionAttributeIndex))
+		{
+			AppendHullTriangles(hull.m_Hull, corners);
+		}
+	}
+	FOR_EACH_VEC(part->m_rnShape.m_meshes, k)
+	{
+		const RnMeshDesc_t &mesh = part->m_rnShape.m_meshes[k];
+		if (IsPlayerSolid(aggregateData, mesh.m_nCollisionAttributeIndex))
+		{
+			AppendMeshTriangles(mesh.m_Mesh, corners);
+		}
+	}
+}
+
+static_function void SubmitBuild(u32 generation, std::vector<Vector> corners)
+{
+	executor::Submit(
+		executor::Queue::Collision,
+		[generation, corners = std::move(corners)]()
+		{
+			// Spawn groups tend to load in bursts, only the last queued build is worth doing.
+			if (generation != buildGeneration.load())
+			{
+				return;
+			}
+			f64 startTime = Plat_FloatTime();
+			auto tree = std::make_shared<CollisionBVH>();
+			tree->Build(corners);
+			if (generation != buildGeneration.load())
+			{
+				return;
+			}
+			META_CONPRINTF("[KZ::Jumpstats] Built collision tree with %u triangles and %u nodes in %.1fms.\n", tree->GetTriangleCount(),
+						   tree->GetNodeCount(), (Plat_FloatTime() - startTime) * 1000.0);
+			std::atomic_store(&currentTree, std::shared_ptr<const CollisionBVH>(std::move(tree)));
+		});
+}
+
+static_function void StartCollection(CPhysicsGameSystem *gs)
+{
+	collection.active = true;
+	collection.generation = ++buildGeneration;
+	collection.group = gs->m_PhysicsSpawnGroups.FirstInorder();
+	collection.part = 0;
+	collection.corners.clear();
+	std::atomic_store(&currentTree, std::shared_ptr<const CollisionBVH>());
+}
+
+// Copy the next parts of the level, and hand the triangles to the worker once every spawn group is done.
+// The spawn groups cannot change in between without their count changing, which starts the collection over.
+static_function void ContinueCollection(CPhysicsGameSystem *gs)
+{
+	if (!collection.active)
+	{
+		return;
+	}
+	VPROF_BUDGET(__func__, "CS2KZ");
+	auto &groups = gs->m_PhysicsSpawnGroups;
+	size_t budget = collection.corners.size() + COLLECT_CORNERS_PER_FRAME;
+	for (; collection.group != groups.InvalidIndex(); collection.group = groups.NextInorder(collection.group), collection.part = 0)
+	{
+		CPhysAggregateInstance *instance = groups[collection.group].m_pLevelAggregateInstance;
+		CPhysAggregateData *aggregateData = instance ? instance->aggregateData : nullptr;
+		if (!aggregateData)
+		{
+			continue;
+		}
+		for (; collection.part < aggregateData->m_Parts.Count(); collection.part++)
+		{
+			if (collection.corners.size() >= budget)
+			{
+				return;
+			}
+			const VPhysXBodyPart_t *part = aggregateData->m_Parts[collection.part];
+			if (part)
+			{
+				AppendPartTriangles(aggregateData, part, collection.corners);
+			}
+		}
+	}
+	collection.active = false;
+	SubmitBuild(collection.generation, std::move(collection.corners));
+	collection.corners = {};
+}
+
+void KZ::collision::OnPhysicsGameSystemFrameBoundary(CPhysicsGameSystem *gs)
+{
+	if (!gs)
+	{
+		return;
+	}
+	// Spawn groups can finish loading after the first frame, rebuild whenever their count changes.
+	i32 spawnGroupCount = gs->m_PhysicsSpawnGroups.Count();
+	if (gs != lastPhysicsGameSystem || spawnGroupCount != lastSpawnGroupCount)
+	{
+		lastPhysicsGameSystem = gs;
+		lastSpawnGroupCount = spawnGroupCount;
+		StartCollection(gs);
+	}
+	ContinueCollection(gs);
+}
+
+void KZ::collision::OnActivateServer()
+{
+	// The physics game system can survive a map change, force a rebuild on the next frame.
+	lastSpawnGroupCount = -1;
+}
+
+void KZ::collision::Cleanup()
+{
+	buildGeneration++;
+	executor::WaitIdle(executor::Queue::Collision);
+	std::atomic_store(&currentTree, std::shared_ptr<const CollisionBVH>());
+	lastPhysicsGameSystem = nullptr;
+	lastSpawnGroupCount = -1;
+	collection.active = false;
+	collection.corners = {};
+}
+
+bool KZ::collision::IsReady()
+{
+	return GetTree() != nullptr;
+}
+
+f32 KZ::collision::TraceRay(const Vector &start, const Vector &end)
+{
+	auto tree = GetTree();
+	return tree ? tree->TraceRay(start, end) : 1.0f;
+}
+
+// Whether the leading face of the hull, moved distance units along dir, still has floor under it.
+// The hull stays supported as long as any part of that face is, so both corners and the middle are probed.
+static_function bool HasFloor(const CollisionBVH &tree, const Vector &origin, const Vector &dir, f32 halfWidth, f32 distance)
+{
+	Vector front = origin + dir * (halfWidth + distance);
+	Vector side(-dir.y, dir.x, 0.0f);
+	for (f32 offset : {0.0f, -halfWidth, halfWidth})
+	{
+		Vector point = front + side * offset;
+		Vector start = point + Vector(0.0f, 0.0f, FLOOR_PROBE_HEIGHT);
+		Vector end = point - Vector(0.0f, 0.0f, FLOOR_PROBE_HEIGHT);
+		if (tree.TraceRay(start, end) < 1.0f)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Walk along dir from the leading face of the hull until the floor ends, then bisect the last step.
+static_function bool FindFloorEnd(const CollisionBVH &tree, const Vector &origin, const Vector &dir, f32 halfWidth, f32 maxDistance,
+								  f32 &distance)
+{
+	f32 inside = -1.0f;
+	f32 outside = -1.0f;
+	if (HasFloor(tree, origin, dir, halfWidth, 0.0f))
+	{
+		inside = 0.0f;
+		for (f32 step = EDGE_SEARCH_STEP; step <= maxDistance; step += EDGE_SEARCH_STEP)
+		{
+			if (!HasFloor(tree, origin, dir, halfWidth, step))
+			{
+				outside = step;
+				break;
+			}
+			inside = step;
+		}
+		if (outside < 0.0f)
+		{
+			return false;
+		}
+	}
+	else
+	{
+		// The leading face already hangs over the edge, walk back until it is over the floor again. The edge comes out negative.
+		bool found = false;
+		outside = 0.0f;
+		for (f32 step = -EDGE_SEARCH_STEP; step >= -2.0f * halfWidth; step -= EDGE_SEARCH_STEP)
+		{
+			if (HasFloor(tree, origin, dir, halfWidth, step))
+			{
+				inside = step;
+				found = true;
+				break;
+			}
+			outside = step;
+		}
+		if (!found)
+		{
+			return false;
+		}
+	}
+	for (u32 i = 0; i < EDGE_REFINE_ITERATIONS; i++)
+	{
+		f32 middle = (inside + outside) * 0.5f;
+		if (HasFloor(tree, origin, dir, halfWidth, middle))
+		{
+			inside = middle;
+		}
+		else
+		{
+			outside = middle;
+		}
+	}
+	distance = (inside + outside) * 0.5f;
+	return true;
+}
+
+bool KZ::collision::FindTakeoffEdge(const Vector &origin, f32 halfWidth, const Vector &dir, f32 maxDistance, f32 &edge)
+{
+	auto tree = GetTree();
+	return tree && FindFloorEnd(*tree, origin, dir, halfWidth, maxDistance, edge);
+}
+
+bool KZ::collision::FindLandingEdge(const Vector &origin, f32 halfWidth, const Vector &dir, f32 maxDistance, f32 &edge)
+{
+	auto tree = GetTree();
+	return tree && FindFloorEnd(*tree, origin, -dir, halfWidth, maxDistance, edge);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "common.h"
+
+class CPhysicsGameSystem;
+
+// Static world collision of the current map, kept on the plugin side so jumpstats can measure blocks and edges without engine traces.
+// The level geometry is copied out over a few frames whenever it changes, then the tree is built on a worker thread. Queries fail until it is ready.
+namespace KZ::collision
+{
+	void OnPhysicsGameSystemFrameBoundary(CPhysicsGameSystem *gs);
+	void OnActivateServer();
+	void Cleanup();
+
+	bool IsReady();
+
+	// Returns the fraction of the segment travelled before hitting the world, or 1 if nothing was hit.
+	f32 TraceRay(const Vector &start, const Vector &end);
+
+	// Distance from the leading face of a hull with the given half width to the end of the floor it stands on,
+	// along dir (normalized, horizontal). Negative if the face already hangs over the edge.
+	// Fails if the hull does not stand on a floor, or no edge is found within maxDistance.
+	bool FindTakeoffEdge(const Vector &origin, f32 halfWidth, const Vector &dir, f32 maxDistance, f32 &edge);
+
+	// Distance from the start of the floor to the trailing face of a landing hull, along dir (the jump direction).
+	bool FindLandingEdge(const Vector &origin, f32 halfWidth, const Vector &dir, f32 maxDistance, f32 &edge);
+} // namespace KZ::collision
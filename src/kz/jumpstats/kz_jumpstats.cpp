@@ -3,6 +3,7 @@
 #include "utils/simplecmds.h"
 
 #include "kz_jumpstats.h"
+#include "collision.h"
 #include "kz/anticheat/kz_anticheat.h"
 #include "kz/mode/kz_mode.h"
 #include "kz/style/kz_style.h"
@@ -533,6 +534,7 @@ void Jump::End()
 	}
 	this->serverTick = g_pKZUtils->GetServerGlobals()->tickcount;
 	this->airtime = this->player->landingTimeActual - this->player->takeoffTime;
+	this->CalcBlockStats();
 }
 
 Strafe *Jump::GetCurrentStrafe()
@@ -580,10 +582,39 @@ f32 Jump::GetDistance(bool useDistbugFix, bool disableAddDist, i32 floorLevel)
 	return floorLevel < 0 ? dist : floor(dist * pow(10, floorLevel)) / pow(10, floorLevel);
 }
 
-// TODO
-f32 Jump::GetEdge(bool landing)
+void Jump::CalcBlockStats()
 {
-	return 0.0f;
+	switch (this->jumpType)
+	{
+		case JumpType_LongJump:
+		case JumpType_Bhop:
+		case JumpType_MultiBhop:
+		case JumpType_WeirdJump:
+		case JumpType_Jumpbug:
+			break;
+		default:
+			return;
+	}
+
+	// Blocks are measured along the dominant axis, the same way the gaps are built.
+	Vector delta = this->adjustedLandingOrigin - this->adjustedTakeoffOrigin;
+	Vector dir = fabs(delta.x) > fabs(delta.y) ? Vector(delta.x > 0.0f ? 1.0f : -1.0f, 0.0f, 0.0f)
+											   : Vector(0.0f, delta.y > 0.0f ? 1.0f : -1.0f, 0.0f);
+	// Edges are measured from the faces of the hull, not from its origin.
+	bbox_t bounds;
+	this->player->GetBBoxBounds(&bounds);
+	f32 halfWidth = bounds.maxs.x;
+	f32 edge, landingEdge;
+	bool hasEdge = KZ::collision::FindTakeoffEdge(this->adjustedTakeoffOrigin, halfWidth, dir, JS_MAX_BLOCK_EDGE, edge);
+	bool hasLandingEdge = KZ::collision::FindLandingEdge(this->adjustedLandingOrigin, halfWidth, dir, JS_MAX_BLOCK_EDGE, landingEdge);
+	// A face hanging over the edge still counts as being right on it.
+	this->edge = hasEdge ? MAX(edge, 0.0f) : -1.0f;
+	this->landingEdge = hasLandingEdge ? MAX(landingEdge, 0.0f) : -1.0f;
+	// Only same height jumps have a block.
+	if (hasEdge && hasLandingEdge && fabs(this->GetOffset()) < JS_EPSILON)
+	{
+		this->block = roundf(delta.Dot(dir) - 2.0f * halfWidth - edge - landingEdge);
+	}
 }
 
 f32 Jump::GetAirPath()
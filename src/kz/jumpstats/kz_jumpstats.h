@@ -46,6 +46,7 @@ enum DistanceTier : u8
 #define JS_TOUCH_GRACE_PERIOD           0.04f
 #define JS_SPEED_MODIFICATION_TOLERANCE 0.1f
 #define JS_TELEPORT_DISTANCE_SQUARED    4096.0f * 4096.0f * ENGINE_FIXED_TICK_INTERVAL
+#define JS_MAX_BLOCK_EDGE               32.0f
 
 extern const char *jumpTypeStr[JUMPTYPE_COUNT];
 extern const char *jumpTypeShortStr[JUMPTYPE_COUNT];
@@ -241,6 +242,11 @@ public:
 	char invalidateReason[256] {};
 	bool trackingRelease = true;
 
+	// Block stats, -1 when they couldn't be measured.
+	f32 edge = -1.0f;
+	f32 landingEdge = -1.0f;
+	f32 block = -1.0f;
+
 public:
 	Jump() = default;
 
@@ -336,7 +342,17 @@ public:
 		return this->width;
 	}
 
-	f32 GetEdge(bool landing);
+	f32 GetEdge(bool landing)
+	{
+		return landing ? this->landingEdge : this->edge;
+	}
+
+	f32 GetBlock()
+	{
+		return this->block;
+	}
+
+	void CalcBlockStats();
 
 	f32 GetGainEfficiency()
 	{
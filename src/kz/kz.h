@@ -55,6 +55,70 @@ class KZPistolService;
 class KZRecordingService;
 class KZFOVService;
 
+// Movement hooks a mode or style implements, see GetMovementHooks(). Hooks that are not part of the mask are never called.
+enum KZMovementHook : u64
+{
+	MOVEMENT_HOOK_PHYSICS_SIMULATE = 1ull << 0,
+	MOVEMENT_HOOK_PHYSICS_SIMULATE_POST = 1ull << 1,
+	MOVEMENT_HOOK_PROCESS_USERCMDS = 1ull << 2,
+	MOVEMENT_HOOK_PROCESS_USERCMDS_POST = 1ull << 3,
+	MOVEMENT_HOOK_SETUP_MOVE = 1ull << 4,
+	MOVEMENT_HOOK_SETUP_MOVE_POST = 1ull << 5,
+	MOVEMENT_HOOK_PROCESS_MOVEMENT = 1ull << 6,
+	MOVEMENT_HOOK_PROCESS_MOVEMENT_POST = 1ull << 7,
+	MOVEMENT_HOOK_PLAYER_MOVE = 1ull << 8,
+	MOVEMENT_HOOK_PLAYER_MOVE_POST = 1ull << 9,
+	MOVEMENT_HOOK_CHECK_PARAMETERS = 1ull << 10,
+	MOVEMENT_HOOK_CHECK_PARAMETERS_POST = 1ull << 11,
+	MOVEMENT_HOOK_CAN_MOVE = 1ull << 12,
+	MOVEMENT_HOOK_CAN_MOVE_POST = 1ull << 13,
+	MOVEMENT_HOOK_FULL_WALK_MOVE = 1ull << 14,
+	MOVEMENT_HOOK_FULL_WALK_MOVE_POST = 1ull << 15,
+	MOVEMENT_HOOK_MOVE_INIT = 1ull << 16,
+	MOVEMENT_HOOK_MOVE_INIT_POST = 1ull << 17,
+	MOVEMENT_HOOK_CHECK_WATER = 1ull << 18,
+	MOVEMENT_HOOK_CHECK_WATER_POST = 1ull << 19,
+	MOVEMENT_HOOK_WATER_MOVE = 1ull << 20,
+	MOVEMENT_HOOK_WATER_MOVE_POST = 1ull << 21,
+	MOVEMENT_HOOK_CHECK_VELOCITY = 1ull << 22,
+	MOVEMENT_HOOK_CHECK_VELOCITY_POST = 1ull << 23,
+	MOVEMENT_HOOK_DUCK = 1ull << 24,
+	MOVEMENT_HOOK_DUCK_POST = 1ull << 25,
+	MOVEMENT_HOOK_CAN_UNDUCK = 1ull << 26,
+	MOVEMENT_HOOK_CAN_UNDUCK_POST = 1ull << 27,
+	MOVEMENT_HOOK_LADDER_MOVE = 1ull << 28,
+	MOVEMENT_HOOK_LADDER_MOVE_POST = 1ull << 29,
+	MOVEMENT_HOOK_CHECK_JUMP_BUTTON_LEGACY = 1ull << 30,
+	MOVEMENT_HOOK_CHECK_JUMP_BUTTON_LEGACY_POST = 1ull << 31,
+	MOVEMENT_HOOK_CHECK_JUMP_BUTTON_MODERN = 1ull << 32,
+	MOVEMENT_HOOK_CHECK_JUMP_BUTTON_MODERN_POST = 1ull << 33,
+	MOVEMENT_HOOK_JUMP_LEGACY = 1ull << 34,
+	MOVEMENT_HOOK_JUMP_LEGACY_POST = 1ull << 35,
+	MOVEMENT_HOOK_JUMP_MODERN = 1ull << 36,
+	MOVEMENT_HOOK_JUMP_MODERN_POST = 1ull << 37,
+	MOVEMENT_HOOK_AIR_MOVE = 1ull << 38,
+	MOVEMENT_HOOK_AIR_MOVE_POST = 1ull << 39,
+	MOVEMENT_HOOK_AIR_ACCELERATE = 1ull << 40,
+	MOVEMENT_HOOK_AIR_ACCELERATE_POST = 1ull << 41,
+	MOVEMENT_HOOK_FRICTION = 1ull << 42,
+	MOVEMENT_HOOK_FRICTION_POST = 1ull << 43,
+	MOVEMENT_HOOK_WALK_MOVE = 1ull << 44,
+	MOVEMENT_HOOK_WALK_MOVE_POST = 1ull << 45,
+	MOVEMENT_HOOK_TRY_PLAYER_MOVE = 1ull << 46,
+	MOVEMENT_HOOK_TRY_PLAYER_MOVE_POST = 1ull << 47,
+	MOVEMENT_HOOK_CATEGORIZE_POSITION = 1ull << 48,
+	MOVEMENT_HOOK_CATEGORIZE_POSITION_POST = 1ull << 49,
+	MOVEMENT_HOOK_FINISH_GRAVITY = 1ull << 50,
+	MOVEMENT_HOOK_FINISH_GRAVITY_POST = 1ull << 51,
+	MOVEMENT_HOOK_CHECK_FALLING = 1ull << 52,
+	MOVEMENT_HOOK_CHECK_FALLING_POST = 1ull << 53,
+	MOVEMENT_HOOK_POST_PLAYER_MOVE = 1ull << 54,
+	MOVEMENT_HOOK_POST_PLAYER_MOVE_POST = 1ull << 55,
+	MOVEMENT_HOOK_POST_THINK = 1ull << 56,
+	MOVEMENT_HOOK_POST_THINK_POST = 1ull << 57,
+	MOVEMENT_HOOK_ALL = ~0ull,
+};
+
 class KZPlayer : public MovementPlayer
 {
 public:
@@ -63,6 +127,8 @@ public:
 		this->Init();
 	}
 
+	virtual ~KZPlayer() override;
+
 	// General events
 	virtual void Init() override;
 	virtual void Reset() override;
@@ -146,6 +212,10 @@ private:
 	f64 lastTeleportTime {};
 	f32 lastValidYaw {};
 	bool oldUsingTurnbinds {};
+	// Single block holding every built-in service of this player, see KZ_PLAYER_SERVICES.
+	u8 *serviceArena {};
+
+	void DestroyServices();
 
 public:
 	KZAnticheatService *anticheatService {};
@@ -175,6 +245,13 @@ public:
 	KZRecordingService *recordingService {};
 	KZFOVService *fovService {};
 
+	// Movement hooks of the mode, of any of the styles, and of each style in the same order as styleServices.
+	// Refreshed by UpdateMovementHooks() whenever the mode or styles change.
+	u64 modeMovementHooks = MOVEMENT_HOOK_ALL;
+	u64 styleMovementHooks = MOVEMENT_HOOK_ALL;
+	CUtlVector<u64> styleServiceMovementHooks {};
+	void UpdateMovementHooks();
+
 	void DisableTurnbinds();
 	void EnableGodMode();
 
@@ -267,5 +344,11 @@ namespace KZ
 		void UnrestrictTimeLimit();
 		void OnPhysicsGameSystemFrameBoundary(void *pThis);
 		void HandleTeleportToCourse(KZPlayer *player, const CCommand *args);
+
+		// Cached versions of the utils functions of the same name, the results are stored per map on disk.
+		void LoadSpawnCache();
+		void PrecomputeSpawnCache();
+		bool FindValidSpawn(Vector &origin, QAngle &angles, bool ignoreStuckCheck = false);
+		bool FindValidPositionForTrigger(CBaseTrigger *trigger, Vector &originDest, QAngle &anglesDest);
 	} // namespace misc
 }; // namespace KZ
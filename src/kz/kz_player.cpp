@@ -24,72 +24,123 @@
 #include "replays/kz_replaysystem.h"
 #include "global/kz_global.h"
 #include "racing/kz_racing.h"
+#include "saveloc/kz_saveloc.h"
 #include "profile/kz_profile.h"
 #include "pistol/kz_pistol.h"
 #include "fov/kz_fov.h"
+#include "profiler/kz_profiler.h"
 
 #include "sdk/datatypes.h"
 #include "sdk/entity/cbasetrigger.h"
 #include "vprof.h"
 #include "steam/isteamgameserver.h"
+#include <cstddef>
 #include "tier0/memdbgon.h"
 extern CSteamGameServerAPIContext g_steamAPI;
 
+// Only the mode and the styles that implement a movement hook are called, see KZMovementHook.
+#define KZ_MODE_HOOK(hook, call) \
+	if (this->modeMovementHooks & (hook)) \
+	{ \
+		call; \
+	}
+
+// `call` can refer to the style through this->styleServices[i].
+#define KZ_STYLE_HOOK(hook, call) \
+	if (this->styleMovementHooks & (hook)) \
+	{ \
+		FOR_EACH_VEC(this->styleServices, i) \
+		{ \
+			if (this->styleServiceMovementHooks[i] & (hook)) \
+			{ \
+				call; \
+			} \
+		} \
+	}
+
+// Built-in services, in the order the tick callbacks reach them.
+// They are constructed back to back in a single block per player, so the per-tick fan-out walks one allocation instead of scattered heap objects.
+#define KZ_PLAYER_SERVICES(X) \
+	X(KZRecordingService, recordingService) \
+	X(KZTriggerService, triggerService) \
+	X(KZHUDService, hudService) \
+	X(KZNoclipService, noclipService) \
+	X(KZFOVService, fovService) \
+	X(KZAnticheatService, anticheatService) \
+	X(KZTelemetryService, telemetryService) \
+	X(KZTimerService, timerService) \
+	X(KZSpecService, specService) \
+	X(KZMeasureService, measureService) \
+	X(KZQuietService, quietService) \
+	X(KZProfileService, profileService) \
+	X(KZJumpstatsService, jumpstatsService) \
+	X(KZCheckpointService, checkpointService) \
+	X(KZSavelocService, savelocService) \
+	X(KZOptionService, optionService) \
+	X(KZLanguageService, languageService) \
+	X(KZBeamService, beamService) \
+	X(KZDatabaseService, databaseService) \
+	X(KZGotoService, gotoService) \
+	X(KZTipService, tipService) \
+	X(KZGlobalService, globalService) \
+	X(KZRacingService, racingService) \
+	X(KZPistolService, pistolService)
+
+static_function constexpr size_t AlignServiceSize(size_t size)
+{
+	return (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+}
+
+#define KZ_SERVICE_SIZE(type, name) +AlignServiceSize(sizeof(type))
+static_global constexpr size_t serviceArenaSize = 0 KZ_PLAYER_SERVICES(KZ_SERVICE_SIZE);
+#undef KZ_SERVICE_SIZE
+
+#define KZ_SERVICE_ALIGNMENT_CHECK(type, name) static_assert(alignof(type) <= alignof(std::max_align_t), #type " is over-aligned for the service arena");
+KZ_PLAYER_SERVICES(KZ_SERVICE_ALIGNMENT_CHECK)
+#undef KZ_SERVICE_ALIGNMENT_CHECK
+
 void KZPlayer::Init()
 {
 	MovementPlayer::Init();
 
-	// TODO: initialize every service.
-	delete this->anticheatService;
-	delete this->beamService;
-	delete this->checkpointService;
-	delete this->jumpstatsService;
-	delete this->languageService;
-	delete this->databaseService;
-	delete this->quietService;
-	delete this->hudService;
-	delete this->specService;
-	delete this->timerService;
-	delete this->optionService;
-	delete this->noclipService;
-	delete this->tipService;
-	delete this->telemetryService;
-	delete this->triggerService;
-	delete this->recordingService;
-	delete this->globalService;
-	delete this->racingService;
-	delete this->measureService;
-	delete this->profileService;
-	delete this->pistolService;
-	delete this->fovService;
-
-	this->anticheatService = new KZAnticheatService(this);
-	this->beamService = new KZBeamService(this);
-	this->checkpointService = new KZCheckpointService(this);
-	this->jumpstatsService = new KZJumpstatsService(this);
-	this->databaseService = new KZDatabaseService(this);
-	this->languageService = new KZLanguageService(this);
-	this->noclipService = new KZNoclipService(this);
-	this->quietService = new KZQuietService(this);
-	this->hudService = new KZHUDService(this);
-	this->specService = new KZSpecService(this);
-	this->gotoService = new KZGotoService(this);
-	this->timerService = new KZTimerService(this);
-	this->optionService = new KZOptionService(this);
-	this->tipService = new KZTipService(this);
-	this->telemetryService = new KZTelemetryService(this);
-	this->triggerService = new KZTriggerService(this);
-	this->recordingService = new KZRecordingService(this);
-	this->globalService = new KZGlobalService(this);
-	this->racingService = new KZRacingService(this);
-	this->measureService = new KZMeasureService(this);
-	this->profileService = new KZProfileService(this);
-	this->pistolService = new KZPistolService(this);
-	this->fovService = new KZFOVService(this);
+	if (this->serviceArena)
+	{
+		this->DestroyServices();
+	}
+	else
+	{
+		// operator new[] is aligned for any fundamental type, which the static_asserts above rely on.
+		this->serviceArena = new u8[serviceArenaSize];
+	}
+
+	u8 *cursor = this->serviceArena;
+#define KZ_CONSTRUCT_SERVICE(type, name) \
+	this->name = new (cursor) type(this); \
+	cursor += AlignServiceSize(sizeof(type));
+	KZ_PLAYER_SERVICES(KZ_CONSTRUCT_SERVICE)
+#undef KZ_CONSTRUCT_SERVICE
 
 	KZ::mode::InitModeService(this);
 }
 
+KZPlayer::~KZPlayer()
+{
+	if (this->serviceArena)
+	{
+		this->DestroyServices();
+		delete[] this->serviceArena;
+	}
+}
+
+void KZPlayer::DestroyServices()
+{
+#define KZ_DESTROY_SERVICE(type, name) \
+	this->name->~type(); \
+	this->name = nullptr;
+	KZ_PLAYER_SERVICES(KZ_DESTROY_SERVICE)
+#undef KZ_DESTROY_SERVICE
+}
+
 void KZPlayer::Reset()
 {
 	MovementPlayer::Reset();
@@ -101,6 +152,7 @@ void KZPlayer::Reset()
 	this->modeService->Reset();
 	this->optionService->Reset();
 	this->checkpointService->Reset();
+	this->savelocService->Reset();
 	this->noclipService->Reset();
 	this->quietService->Reset();
 	this->jumpstatsService->Reset();
@@ -122,6 +174,18 @@ void KZPlayer::Reset()
 	}
 }
 
+void KZPlayer::UpdateMovementHooks()
+{
+	this->modeMovementHooks = this->modeService ? this->modeService->GetMovementHooks() : 0;
+	this->styleMovementHooks = 0;
+	this->styleServiceMovementHooks.SetCount(this->styleServices.Count());
+	FOR_EACH_VEC(this->styleServices, i)
+	{
+		this->styleServiceMovementHooks[i] = this->styleServices[i]->GetMovementHooks();
+		this->styleMovementHooks |= this->styleServiceMovementHooks[i];
+	}
+}
+
 void KZPlayer::OnPlayerConnect(u64 steamID64)
 {
 	this->languageService->OnPlayerConnect(steamID64);
@@ -156,91 +220,76 @@ void KZPlayer::OnPhysicsSimulate()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer::OnPhysicsSimulate();
-	this->recordingService->OnPhysicsSimulate();
-	this->triggerService->OnPhysicsSimulate();
-	this->modeService->OnPhysicsSimulate();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnPhysicsSimulate();
-	}
-	this->hudService->OnPhysicsSimulate();
-	this->noclipService->HandleMoveCollision();
+	KZ_PROFILE(this, "Recording", this->recordingService->OnPhysicsSimulate());
+	KZ_PROFILE(this, "Trigger", this->triggerService->OnPhysicsSimulate());
+	KZ_MODE_HOOK(MOVEMENT_HOOK_PHYSICS_SIMULATE, KZ_PROFILE(this, "Mode", this->modeService->OnPhysicsSimulate()));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_PHYSICS_SIMULATE, KZ_PROFILE(this, "Style", this->styleServices[i]->OnPhysicsSimulate()));
+	KZ_PROFILE(this, "HUD", this->hudService->OnPhysicsSimulate());
+	KZ_PROFILE(this, "Noclip", this->noclipService->HandleMoveCollision());
 	this->EnableGodMode();
 	this->UpdatePlayerModelAlpha();
-	this->fovService->OnPhysicsSimulate();
-	KZ::replaysystem::OnPhysicsSimulate(this);
+	KZ_PROFILE(this, "FOV", this->fovService->OnPhysicsSimulate());
+	KZ_PROFILE(this, "Replay", KZ::replaysystem::OnPhysicsSimulate(this));
 }
 
 void KZPlayer::OnPhysicsSimulatePost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer::OnPhysicsSimulatePost();
-	this->anticheatService->OnPhysicsSimulatePost();
-	this->recordingService->OnPhysicsSimulatePost();
-	this->triggerService->OnPhysicsSimulatePost();
-	this->telemetryService->OnPhysicsSimulatePost();
-	this->modeService->OnPhysicsSimulatePost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnPhysicsSimulatePost();
-	}
-	this->timerService->OnPhysicsSimulatePost();
-	KZ::replaysystem::OnPhysicsSimulatePost(this);
-	if (this->specService->GetSpectatedPlayer())
-	{
-		KZHUDService::DrawPanels(this->specService->GetSpectatedPlayer(), this);
-	}
-	else if (this->IsAlive())
-	{
-		KZHUDService::DrawPanels(this, this);
+	KZ_PROFILE(this, "Anticheat", this->anticheatService->OnPhysicsSimulatePost());
+	KZ_PROFILE(this, "Recording", this->recordingService->OnPhysicsSimulatePost());
+	KZ_PROFILE(this, "Trigger", this->triggerService->OnPhysicsSimulatePost());
+	KZ_PROFILE(this, "Telemetry", this->telemetryService->OnPhysicsSimulatePost());
+	KZ_MODE_HOOK(MOVEMENT_HOOK_PHYSICS_SIMULATE_POST, KZ_PROFILE(this, "Mode", this->modeService->OnPhysicsSimulatePost()));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_PHYSICS_SIMULATE_POST, KZ_PROFILE(this, "Style", this->styleServices[i]->OnPhysicsSimulatePost()));
+	KZ_PROFILE(this, "Timer", this->timerService->OnPhysicsSimulatePost());
+	KZ_PROFILE(this, "Replay", KZ::replaysystem::OnPhysicsSimulatePost(this));
+	{
+		KZ_PROFILE_SCOPE(this, "HUD");
+		if (this->specService->GetSpectatedPlayer())
+		{
+			KZHUDService::DrawPanels(this->specService->GetSpectatedPlayer(), this);
+		}
+		else if (this->IsAlive())
+		{
+			KZHUDService::DrawPanels(this, this);
+		}
 	}
-	this->measureService->OnPhysicsSimulatePost();
-	this->quietService->OnPhysicsSimulatePost();
-	this->profileService->OnPhysicsSimulatePost();
+	KZ_PROFILE(this, "Measure", this->measureService->OnPhysicsSimulatePost());
+	KZ_PROFILE(this, "Quiet", this->quietService->OnPhysicsSimulatePost());
+	KZ_PROFILE(this, "Profile", this->profileService->OnPhysicsSimulatePost());
 }
 
 void KZPlayer::OnProcessUsercmds(PlayerCommand *cmds, int numcmds)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->recordingService->OnProcessUsercmds(cmds, numcmds);
+	KZ_PROFILE(this, "Recording", this->recordingService->OnProcessUsercmds(cmds, numcmds));
 	// this->anticheatService->OnProcessUsercmds(cmds, numcmds);
-	this->modeService->OnProcessUsercmds(cmds, numcmds);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnProcessUsercmds(cmds, numcmds);
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_PROCESS_USERCMDS, KZ_PROFILE(this, "Mode", this->modeService->OnProcessUsercmds(cmds, numcmds)));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_PROCESS_USERCMDS, KZ_PROFILE(this, "Style", this->styleServices[i]->OnProcessUsercmds(cmds, numcmds)));
 }
 
 void KZPlayer::OnProcessUsercmdsPost(PlayerCommand *cmds, int numcmds)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnProcessUsercmdsPost(cmds, numcmds);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnProcessUsercmdsPost(cmds, numcmds);
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_PROCESS_USERCMDS_POST, this->modeService->OnProcessUsercmdsPost(cmds, numcmds));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_PROCESS_USERCMDS_POST, this->styleServices[i]->OnProcessUsercmdsPost(cmds, numcmds));
 }
 
 void KZPlayer::OnSetupMove(PlayerCommand *pc)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->anticheatService->OnSetupMove(pc);
-	this->recordingService->OnSetupMove(pc);
-	this->modeService->OnSetupMove(pc);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnSetupMove(pc);
-	}
+	KZ_PROFILE(this, "Anticheat", this->anticheatService->OnSetupMove(pc));
+	KZ_PROFILE(this, "Recording", this->recordingService->OnSetupMove(pc));
+	KZ_MODE_HOOK(MOVEMENT_HOOK_SETUP_MOVE, KZ_PROFILE(this, "Mode", this->modeService->OnSetupMove(pc)));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_SETUP_MOVE, KZ_PROFILE(this, "Style", this->styleServices[i]->OnSetupMove(pc)));
 }
 
 void KZPlayer::OnSetupMovePost(PlayerCommand *pc)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnSetupMovePost(pc);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnSetupMovePost(pc);
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_SETUP_MOVE_POST, this->modeService->OnSetupMovePost(pc));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_SETUP_MOVE_POST, this->styleServices[i]->OnSetupMovePost(pc));
 }
 
 void KZPlayer::OnProcessMovement()
@@ -249,287 +298,206 @@ void KZPlayer::OnProcessMovement()
 	MovementPlayer::OnProcessMovement();
 
 	KZ::mode::ApplyModeSettings(this);
-	KZ::replaysystem::OnProcessMovement(this);
+	KZ_PROFILE(this, "Replay", KZ::replaysystem::OnProcessMovement(this));
 
 	this->DisableTurnbinds();
-	this->anticheatService->OnProcessMovement();
-	this->triggerService->OnProcessMovement();
-	this->modeService->OnProcessMovement();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnProcessMovement();
-	}
+	KZ_PROFILE(this, "Anticheat", this->anticheatService->OnProcessMovement());
+	KZ_PROFILE(this, "Trigger", this->triggerService->OnProcessMovement());
+	KZ_MODE_HOOK(MOVEMENT_HOOK_PROCESS_MOVEMENT, KZ_PROFILE(this, "Mode", this->modeService->OnProcessMovement()));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_PROCESS_MOVEMENT, KZ_PROFILE(this, "Style", this->styleServices[i]->OnProcessMovement()));
 
-	this->jumpstatsService->OnProcessMovement();
-	this->checkpointService->TpHoldPlayerStill();
+	KZ_PROFILE(this, "Jumpstats", this->jumpstatsService->OnProcessMovement());
+	KZ_PROFILE(this, "Checkpoint", this->checkpointService->TpHoldPlayerStill());
 }
 
 void KZPlayer::OnProcessMovementPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 
-	this->anticheatService->OnProcessMovementPost();
-	this->jumpstatsService->UpdateJump();
-	this->modeService->OnProcessMovementPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnProcessMovementPost();
-	}
-	this->jumpstatsService->OnProcessMovementPost();
-	this->triggerService->OnProcessMovementPost();
-	KZ::replaysystem::OnProcessMovementPost(this);
+	KZ_PROFILE(this, "Anticheat", this->anticheatService->OnProcessMovementPost());
+	KZ_PROFILE(this, "Jumpstats", this->jumpstatsService->UpdateJump());
+	KZ_MODE_HOOK(MOVEMENT_HOOK_PROCESS_MOVEMENT_POST, KZ_PROFILE(this, "Mode", this->modeService->OnProcessMovementPost()));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_PROCESS_MOVEMENT_POST, KZ_PROFILE(this, "Style", this->styleServices[i]->OnProcessMovementPost()));
+	KZ_PROFILE(this, "Jumpstats", this->jumpstatsService->OnProcessMovementPost());
+	KZ_PROFILE(this, "Trigger", this->triggerService->OnProcessMovementPost());
+	KZ_PROFILE(this, "Replay", KZ::replaysystem::OnProcessMovementPost(this));
 	MovementPlayer::OnProcessMovementPost();
 }
 
 void KZPlayer::OnPlayerMove()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnPlayerMove();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnPlayerMove();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_PLAYER_MOVE, this->modeService->OnPlayerMove());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_PLAYER_MOVE, this->styleServices[i]->OnPlayerMove());
 }
 
 void KZPlayer::OnPlayerMovePost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnPlayerMovePost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnPlayerMovePost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_PLAYER_MOVE_POST, this->modeService->OnPlayerMovePost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_PLAYER_MOVE_POST, this->styleServices[i]->OnPlayerMovePost());
 }
 
 void KZPlayer::OnCheckParameters()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckParameters();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckParameters();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CHECK_PARAMETERS, this->modeService->OnCheckParameters());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CHECK_PARAMETERS, this->styleServices[i]->OnCheckParameters());
 }
 
 void KZPlayer::OnCheckParametersPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckParametersPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckParametersPost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CHECK_PARAMETERS_POST, this->modeService->OnCheckParametersPost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CHECK_PARAMETERS_POST, this->styleServices[i]->OnCheckParametersPost());
 }
 
 void KZPlayer::OnCanMove()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCanMove();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCanMove();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CAN_MOVE, this->modeService->OnCanMove());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CAN_MOVE, this->styleServices[i]->OnCanMove());
 }
 
 void KZPlayer::OnCanMovePost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCanMovePost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCanMovePost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CAN_MOVE_POST, this->modeService->OnCanMovePost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CAN_MOVE_POST, this->styleServices[i]->OnCanMovePost());
 }
 
 void KZPlayer::OnFullWalkMove(bool &ground)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnFullWalkMove(ground);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnFullWalkMove(ground);
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_FULL_WALK_MOVE, this->modeService->OnFullWalkMove(ground));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_FULL_WALK_MOVE, this->styleServices[i]->OnFullWalkMove(ground));
 }
 
 void KZPlayer::OnFullWalkMovePost(bool ground)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnFullWalkMovePost(ground);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnFullWalkMovePost(ground);
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_FULL_WALK_MOVE_POST, this->modeService->OnFullWalkMovePost(ground));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_FULL_WALK_MOVE_POST, this->styleServices[i]->OnFullWalkMovePost(ground));
 }
 
 void KZPlayer::OnMoveInit()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnMoveInit();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnMoveInit();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_MOVE_INIT, this->modeService->OnMoveInit());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_MOVE_INIT, this->styleServices[i]->OnMoveInit());
 }
 
 void KZPlayer::OnMoveInitPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnMoveInitPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnMoveInitPost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_MOVE_INIT_POST, this->modeService->OnMoveInitPost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_MOVE_INIT_POST, this->styleServices[i]->OnMoveInitPost());
 }
 
 void KZPlayer::OnCheckWater()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckWater();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckWater();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CHECK_WATER, this->modeService->OnCheckWater());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CHECK_WATER, this->styleServices[i]->OnCheckWater());
 }
 
 void KZPlayer::OnWaterMove()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnWaterMove();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnWaterMove();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_WATER_MOVE, this->modeService->OnWaterMove());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_WATER_MOVE, this->styleServices[i]->OnWaterMove());
 }
 
 void KZPlayer::OnWaterMovePost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnWaterMovePost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnWaterMovePost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_WATER_MOVE_POST, this->modeService->OnWaterMovePost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_WATER_MOVE_POST, this->styleServices[i]->OnWaterMovePost());
 }
 
 void KZPlayer::OnCheckWaterPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckWaterPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckWaterPost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CHECK_WATER_POST, this->modeService->OnCheckWaterPost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CHECK_WATER_POST, this->styleServices[i]->OnCheckWaterPost());
 }
 
 void KZPlayer::OnCheckVelocity(const char *a3)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckVelocity(a3);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckVelocity(a3);
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CHECK_VELOCITY, this->modeService->OnCheckVelocity(a3));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CHECK_VELOCITY, this->styleServices[i]->OnCheckVelocity(a3));
 }
 
 void KZPlayer::OnCheckVelocityPost(const char *a3)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckVelocityPost(a3);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckVelocityPost(a3);
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CHECK_VELOCITY_POST, this->modeService->OnCheckVelocityPost(a3));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CHECK_VELOCITY_POST, this->styleServices[i]->OnCheckVelocityPost(a3));
 }
 
 void KZPlayer::OnDuck()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnDuck();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnDuck();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_DUCK, this->modeService->OnDuck());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_DUCK, this->styleServices[i]->OnDuck());
 }
 
 void KZPlayer::OnDuckPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnDuckPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnDuckPost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_DUCK_POST, this->modeService->OnDuckPost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_DUCK_POST, this->styleServices[i]->OnDuckPost());
 }
 
 void KZPlayer::OnCanUnduck()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCanUnduck();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCanUnduck();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CAN_UNDUCK, this->modeService->OnCanUnduck());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CAN_UNDUCK, this->styleServices[i]->OnCanUnduck());
 }
 
 void KZPlayer::OnCanUnduckPost(bool &ret)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCanUnduckPost(ret);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCanUnduckPost(ret);
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CAN_UNDUCK_POST, this->modeService->OnCanUnduckPost(ret));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CAN_UNDUCK_POST, this->styleServices[i]->OnCanUnduckPost(ret));
 }
 
 void KZPlayer::OnLadderMove()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnLadderMove();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnLadderMove();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_LADDER_MOVE, this->modeService->OnLadderMove());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_LADDER_MOVE, this->styleServices[i]->OnLadderMove());
 }
 
 void KZPlayer::OnLadderMovePost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnLadderMovePost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnLadderMovePost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_LADDER_MOVE_POST, this->modeService->OnLadderMovePost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_LADDER_MOVE_POST, this->styleServices[i]->OnLadderMovePost());
 }
 
 void KZPlayer::OnCheckJumpButtonLegacy()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckJumpButtonLegacy();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckJumpButtonLegacy();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CHECK_JUMP_BUTTON_LEGACY, this->modeService->OnCheckJumpButtonLegacy());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CHECK_JUMP_BUTTON_LEGACY, this->styleServices[i]->OnCheckJumpButtonLegacy());
 	this->triggerService->OnCheckJumpButton();
 }
 
 void KZPlayer::OnCheckJumpButtonLegacyPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckJumpButtonLegacyPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckJumpButtonLegacyPost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CHECK_JUMP_BUTTON_LEGACY_POST, this->modeService->OnCheckJumpButtonLegacyPost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CHECK_JUMP_BUTTON_LEGACY_POST, this->styleServices[i]->OnCheckJumpButtonLegacyPost());
 }
 
 void KZPlayer::OnCheckJumpButtonModern()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckJumpButtonModern();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckJumpButtonModern();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CHECK_JUMP_BUTTON_MODERN, this->modeService->OnCheckJumpButtonModern());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CHECK_JUMP_BUTTON_MODERN, this->styleServices[i]->OnCheckJumpButtonModern());
 	this->triggerService->OnCheckJumpButton();
 	this->hudService->OnJump(true);
 }
@@ -537,22 +505,16 @@ void KZPlayer::OnCheckJumpButtonModern()
 void KZPlayer::OnCheckJumpButtonModernPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckJumpButtonModernPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckJumpButtonModernPost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CHECK_JUMP_BUTTON_MODERN_POST, this->modeService->OnCheckJumpButtonModernPost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CHECK_JUMP_BUTTON_MODERN_POST, this->styleServices[i]->OnCheckJumpButtonModernPost());
 }
 
 void KZPlayer::OnJumpLegacy()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	this->telemetryService->OnJumpLegacy();
-	this->modeService->OnJumpLegacy();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnJumpLegacy();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_JUMP_LEGACY, this->modeService->OnJumpLegacy());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_JUMP_LEGACY, this->styleServices[i]->OnJumpLegacy());
 	this->hudService->OnJump();
 }
 
@@ -560,237 +522,168 @@ void KZPlayer::OnJumpLegacyPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	this->telemetryService->OnJumpLegacyPost();
-	this->modeService->OnJumpLegacyPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnJumpLegacyPost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_JUMP_LEGACY_POST, this->modeService->OnJumpLegacyPost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_JUMP_LEGACY_POST, this->styleServices[i]->OnJumpLegacyPost());
 }
 
 void KZPlayer::OnJumpModern()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	this->telemetryService->OnJumpModern();
-	this->modeService->OnJumpModern();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnJumpModern();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_JUMP_MODERN, this->modeService->OnJumpModern());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_JUMP_MODERN, this->styleServices[i]->OnJumpModern());
 }
 
 void KZPlayer::OnJumpModernPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	this->telemetryService->OnJumpModernPost();
-	this->modeService->OnJumpModernPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnJumpModernPost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_JUMP_MODERN_POST, this->modeService->OnJumpModernPost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_JUMP_MODERN_POST, this->styleServices[i]->OnJumpModernPost());
 }
 
 void KZPlayer::OnAirMove()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	this->anticheatService->OnAirMove();
-	this->modeService->OnAirMove();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnAirMove();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_AIR_MOVE, this->modeService->OnAirMove());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_AIR_MOVE, this->styleServices[i]->OnAirMove());
 }
 
 void KZPlayer::OnAirMovePost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnAirMovePost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnAirMovePost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_AIR_MOVE_POST, this->modeService->OnAirMovePost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_AIR_MOVE_POST, this->styleServices[i]->OnAirMovePost());
 }
 
 void KZPlayer::OnAirAccelerate(Vector &wishdir, f32 &wishspeed, f32 &accel)
 {
-	this->modeService->OnAirAccelerate(wishdir, wishspeed, accel);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnAirAccelerate(wishdir, wishspeed, accel);
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_AIR_ACCELERATE, this->modeService->OnAirAccelerate(wishdir, wishspeed, accel));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_AIR_ACCELERATE, this->styleServices[i]->OnAirAccelerate(wishdir, wishspeed, accel));
 	this->jumpstatsService->OnAirAccelerate();
 }
 
 void KZPlayer::OnAirAcceleratePost(Vector wishdir, f32 wishspeed, f32 accel)
 {
-	this->modeService->OnAirAcceleratePost(wishdir, wishspeed, accel);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnAirAcceleratePost(wishdir, wishspeed, accel);
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_AIR_ACCELERATE_POST, this->modeService->OnAirAcceleratePost(wishdir, wishspeed, accel));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_AIR_ACCELERATE_POST, this->styleServices[i]->OnAirAcceleratePost(wishdir, wishspeed, accel));
 	this->jumpstatsService->OnAirAcceleratePost(wishdir, wishspeed, accel);
 }
 
 void KZPlayer::OnFriction()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnFriction();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnFriction();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_FRICTION, this->modeService->OnFriction());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_FRICTION, this->styleServices[i]->OnFriction());
 }
 
 void KZPlayer::OnFrictionPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnFrictionPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnFrictionPost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_FRICTION_POST, this->modeService->OnFrictionPost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_FRICTION_POST, this->styleServices[i]->OnFrictionPost());
 }
 
 void KZPlayer::OnWalkMove()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnWalkMove();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnWalkMove();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_WALK_MOVE, this->modeService->OnWalkMove());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_WALK_MOVE, this->styleServices[i]->OnWalkMove());
 }
 
 void KZPlayer::OnWalkMovePost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnWalkMovePost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnWalkMovePost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_WALK_MOVE_POST, this->modeService->OnWalkMovePost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_WALK_MOVE_POST, this->styleServices[i]->OnWalkMovePost());
 }
 
 void KZPlayer::OnTryPlayerMove(Vector *pFirstDest, trace_t *pFirstTrace, bool *bIsSurfing)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnTryPlayerMove(pFirstDest, pFirstTrace, bIsSurfing);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnTryPlayerMove(pFirstDest, pFirstTrace, bIsSurfing);
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_TRY_PLAYER_MOVE, this->modeService->OnTryPlayerMove(pFirstDest, pFirstTrace, bIsSurfing));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_TRY_PLAYER_MOVE, this->styleServices[i]->OnTryPlayerMove(pFirstDest, pFirstTrace, bIsSurfing));
 	this->jumpstatsService->OnTryPlayerMove();
 }
 
 void KZPlayer::OnTryPlayerMovePost(Vector *pFirstDest, trace_t *pFirstTrace, bool *bIsSurfing)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnTryPlayerMovePost(pFirstDest, pFirstTrace, bIsSurfing);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnTryPlayerMovePost(pFirstDest, pFirstTrace, bIsSurfing);
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_TRY_PLAYER_MOVE_POST, this->modeService->OnTryPlayerMovePost(pFirstDest, pFirstTrace, bIsSurfing));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_TRY_PLAYER_MOVE_POST, this->styleServices[i]->OnTryPlayerMovePost(pFirstDest, pFirstTrace, bIsSurfing));
 	this->jumpstatsService->OnTryPlayerMovePost();
 }
 
 void KZPlayer::OnCategorizePosition(bool bStayOnGround)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCategorizePosition(bStayOnGround);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCategorizePosition(bStayOnGround);
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CATEGORIZE_POSITION, this->modeService->OnCategorizePosition(bStayOnGround));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CATEGORIZE_POSITION, this->styleServices[i]->OnCategorizePosition(bStayOnGround));
 }
 
 void KZPlayer::OnCategorizePositionPost(bool bStayOnGround)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCategorizePositionPost(bStayOnGround);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCategorizePositionPost(bStayOnGround);
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CATEGORIZE_POSITION_POST, this->modeService->OnCategorizePositionPost(bStayOnGround));
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CATEGORIZE_POSITION_POST, this->styleServices[i]->OnCategorizePositionPost(bStayOnGround));
 }
 
 void KZPlayer::OnFinishGravity()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnFinishGravity();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnFinishGravity();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_FINISH_GRAVITY, this->modeService->OnFinishGravity());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_FINISH_GRAVITY, this->styleServices[i]->OnFinishGravity());
 }
 
 void KZPlayer::OnFinishGravityPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnFinishGravityPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnFinishGravityPost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_FINISH_GRAVITY_POST, this->modeService->OnFinishGravityPost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_FINISH_GRAVITY_POST, this->styleServices[i]->OnFinishGravityPost());
 }
 
 void KZPlayer::OnCheckFalling()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckFalling();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckFalling();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CHECK_FALLING, this->modeService->OnCheckFalling());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CHECK_FALLING, this->styleServices[i]->OnCheckFalling());
 }
 
 void KZPlayer::OnCheckFallingPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckFallingPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckFallingPost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_CHECK_FALLING_POST, this->modeService->OnCheckFallingPost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_CHECK_FALLING_POST, this->styleServices[i]->OnCheckFallingPost());
 }
 
 void KZPlayer::OnPostPlayerMove()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnPostPlayerMove();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnPostPlayerMove();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_POST_PLAYER_MOVE, this->modeService->OnPostPlayerMove());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_POST_PLAYER_MOVE, this->styleServices[i]->OnPostPlayerMove());
 }
 
 void KZPlayer::OnPostPlayerMovePost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnPostPlayerMovePost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnPostPlayerMovePost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_POST_PLAYER_MOVE_POST, this->modeService->OnPostPlayerMovePost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_POST_PLAYER_MOVE_POST, this->styleServices[i]->OnPostPlayerMovePost());
 }
 
 void KZPlayer::OnPostThink()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnPostThink();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnPostThink();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_POST_THINK, this->modeService->OnPostThink());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_POST_THINK, this->styleServices[i]->OnPostThink());
 	MovementPlayer::OnPostThink();
 }
 
 void KZPlayer::OnPostThinkPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnPostThinkPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnPostThinkPost();
-	}
+	KZ_MODE_HOOK(MOVEMENT_HOOK_POST_THINK_POST, this->modeService->OnPostThinkPost());
+	KZ_STYLE_HOOK(MOVEMENT_HOOK_POST_THINK_POST, this->styleServices[i]->OnPostThinkPost());
 }
 
 void KZPlayer::OnStartTouchGround()
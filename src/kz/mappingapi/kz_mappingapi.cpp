@@ -734,7 +734,7 @@ void KZ::mapapi::CheckEndTimerTrigger(CBaseTrigger *trigger)
 		{
 			return;
 		}
-		desc->hasEndPosition = utils::FindValidPositionForTrigger(trigger, desc->endPosition, desc->endAngles);
+		desc->hasEndPosition = KZ::misc::FindValidPositionForTrigger(trigger, desc->endPosition, desc->endAngles);
 	}
 }
 
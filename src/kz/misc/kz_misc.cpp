@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <vector>
+
 #include "src/common.h"
 #include "utils/utils.h"
 #include "utils/ctimer.h"
@@ -24,6 +27,7 @@
 #include "kz/profile/kz_profile.h"
 #include "kz/pistol/kz_pistol.h"
 #include "kz/racing/kz_racing.h"
+#include "kz/misc/overlay.h"
 
 #include "sdk/gamerules.h"
 #include "sdk/physicsgamesystem.h"
@@ -213,14 +217,14 @@ void KZ::misc::HandleTeleportToCourse(KZPlayer *player, const CCommand *args)
 	// If this fails, we just try to find any valid spawn.
 	Vector spawnOrigin;
 	QAngle spawnAngles;
-	if (utils::FindValidSpawn(spawnOrigin, spawnAngles))
+	if (KZ::misc::FindValidSpawn(spawnOrigin, spawnAngles))
 	{
 		player->Teleport(&spawnOrigin, &spawnAngles, &vec3_origin);
 		return;
 	}
 
 	// Attempt to just find any spawn at all, ignoring stuck checks.
-	if (utils::FindValidSpawn(spawnOrigin, spawnAngles, true))
+	if (KZ::misc::FindValidSpawn(spawnOrigin, spawnAngles, true))
 	{
 		player->Teleport(&spawnOrigin, &spawnAngles, &vec3_origin);
 		return;
@@ -383,7 +387,7 @@ void KZ::misc::JoinTeam(KZPlayer *player, int newTeam, bool restorePos)
 			// Need to teleport the player to a valid one.
 			Vector spawnOrigin {};
 			QAngle spawnAngles {};
-			if (utils::FindValidSpawn(spawnOrigin, spawnAngles))
+			if (KZ::misc::FindValidSpawn(spawnOrigin, spawnAngles))
 			{
 				auto pawn = player->GetPlayerPawn();
 				pawn->Teleport(&spawnOrigin, &spawnAngles, &vec3_origin);
@@ -462,11 +466,9 @@ void KZ::misc::ProcessConCommand(ConCommandRef cmd, const CCommandContext &ctx,
 		// say /<insert text>
 		i32 argLen = strlen(args.ArgS());
 		p = args.ArgS();
-		bool wrappedInQuotes = false;
 		if (args.ArgS()[0] == '"' && args.ArgS()[argLen - 1] == '"')
 		{
 			argLen -= 2;
-			wrappedInQuotes = true;
 			p += 1;
 		}
 		if (argLen < 1 || args[1][0] == SCMD_CHAT_SILENT_TRIGGER)
@@ -475,10 +477,8 @@ void KZ::misc::ProcessConCommand(ConCommandRef cmd, const CCommandContext &ctx,
 			return;
 		}
 
-		CUtlString message;
-		message.SetDirect(p, strlen(p) - wrappedInQuotes);
 		auto name = player->GetName();
-		std::string text = message.Get();
+		std::string text(p, argLen);
 
 		// We have to replace these CS2 quotes with normal quotes.
 		size_t pos = 0;
@@ -522,14 +522,32 @@ void KZ::misc::OnRoundStart()
 	}
 }
 
+// Overlays are drawn a few hundred shapes per frame, complex maps have thousands and drawing them at once hitches the server.
+#define OVERLAY_SHAPES_PER_FRAME 256
+
 static_global bool clipsDrawn = false;
 static_global bool triggersDrawn = false;
+// Clip geometry is part of the map and is only extracted once per map, or again when its spawn groups change.
+static_global std::vector<KZ::misc::overlay::Shape> clipShapes;
+static_global bool clipShapesExtracted = false;
+// Shapes waiting to be drawn, nearest to the listen server host first.
+static_global std::vector<KZ::misc::overlay::Shape> pendingShapes;
+static_global u32 nextPendingShape;
+
+static_function void ResetClipShapes()
+{
+	clipShapes.clear();
+	clipShapesExtracted = false;
+	clipsDrawn = false;
+}
 
 static_function void ResetOverlays()
 {
 	g_pKZUtils->ClearOverlays();
 	clipsDrawn = false;
 	triggersDrawn = false;
+	pendingShapes.clear();
+	nextPendingShape = 0;
 }
 
 void OnDebugColorCvarChanged(CConVar<Color> *ref, CSplitScreenSlot nSlot, const Color *pNewValue, const Color *pOldValue)
@@ -575,12 +593,20 @@ CConVar<Color> kz_trigger_multiple_colors[KZTRIGGER_COUNT] =
 
 // clang-format on
 
-static_function void DrawClipMeshes(CPhysicsGameSystem *gs)
+static_function bool IsPlayerClip(const RnCollisionAttr_t &collisionAttr)
 {
-	if (clipsDrawn)
+	return collisionAttr.HasInteractsAsLayer(LAYER_INDEX_CONTENTS_PLAYER_CLIP);
+}
+
+static_function void ExtractClipShapes(CPhysicsGameSystem *gs)
+{
+	if (clipShapesExtracted)
 	{
 		return;
 	}
+	clipShapes.clear();
+	CTransform transform;
+	transform.SetToIdentity();
 	FOR_EACH_MAP(gs->m_PhysicsSpawnGroups, i)
 	{
 		CPhysicsGameSystem::PhysicsSpawnGroups_t &group = gs->m_PhysicsSpawnGroups[i];
@@ -591,51 +617,22 @@ static_function void DrawClipMeshes(CPhysicsGameSystem *gs)
 			META_CONPRINTF("PhysicsSpawnGroup %i: No aggregate data found for instance %p\n", i, instance);
 			continue;
 		}
-		FOR_EACH_VEC(aggregateData->m_Parts, i)
-		{
-			const VPhysXBodyPart_t *part = aggregateData->m_Parts[i];
-			if (!part)
-			{
-				continue;
-			}
-			clipsDrawn = true;
-			FOR_EACH_VEC(part->m_rnShape.m_hulls, j)
-			{
-				const RnHullDesc_t &hull = part->m_rnShape.m_hulls[j];
-				const RnCollisionAttr_t &collisionAttr = aggregateData->m_CollisionAttributes[hull.m_nCollisionAttributeIndex];
-				if (collisionAttr.HasInteractsAsLayer(LAYER_INDEX_CONTENTS_PLAYER_CLIP))
-				{
-					CTransform transform;
-					transform.SetToIdentity();
-					Ray_t ray;
-					ray.Init(hull.m_Hull.m_Bounds.m_vMinBounds, hull.m_Hull.m_Bounds.m_vMaxBounds, hull.m_Hull.m_VertexPositions.Base(),
-							 hull.m_Hull.m_VertexPositions.Count());
-					g_pKZUtils->DebugDrawMesh(transform, ray, kz_playerclip_color.Get().r(), kz_playerclip_color.Get().g(),
-											  kz_playerclip_color.Get().b(), kz_playerclip_color.Get().a(), true, false, -1.0f);
-				}
-			}
-			FOR_EACH_VEC(part->m_rnShape.m_meshes, j)
-			{
-				const RnMeshDesc_t &mesh = part->m_rnShape.m_meshes[j];
-				const RnCollisionAttr_t &collisionAttr = aggregateData->m_CollisionAttributes[mesh.m_nCollisionAttributeIndex];
-				if (collisionAttr.HasInteractsAsLayer(LAYER_INDEX_CONTENTS_PLAYER_CLIP))
-				{
-					CTransform transform;
-					transform.SetToIdentity();
-					FOR_EACH_VEC(mesh.m_Mesh.m_Triangles, k)
-					{
-						const RnTriangle_t &triangle = mesh.m_Mesh.m_Triangles[k];
-						g_pKZUtils->AddTriangleOverlay(mesh.m_Mesh.m_Vertices[triangle.m_nIndex[0]], mesh.m_Mesh.m_Vertices[triangle.m_nIndex[1]],
-													   mesh.m_Mesh.m_Vertices[triangle.m_nIndex[2]], kz_playerclip_color.Get().r(),
-													   kz_playerclip_color.Get().g(), kz_playerclip_color.Get().b(), kz_playerclip_color.Get().a(),
-													   false, -1.0f);
-					}
-				}
-			}
-		}
+		clipShapesExtracted |= KZ::misc::overlay::ExtractAggregate(clipShapes, *aggregateData, transform, &kz_playerclip_color, IsPlayerClip);
+	}
+}
+
+static_function void DrawClipMeshes(CPhysicsGameSystem *gs)
+{
+	if (clipsDrawn)
+	{
+		return;
 	}
+	ExtractClipShapes(gs);
+	pendingShapes.insert(pendingShapes.end(), clipShapes.begin(), clipShapes.end());
+	clipsDrawn = clipShapesExtracted;
 }
 
+// Triggers are respawned on every round restart, so unlike clips they are extracted each time they are drawn.
 static_function void DrawTriggers()
 {
 	if (triggersDrawn || !GameEntitySystem())
@@ -651,18 +648,18 @@ static_function void DrawTriggers()
 			CSkeletonInstance *pSkeleton = static_cast<CSkeletonInstance *>(pTrigger->m_CBodyComponent()->m_pSceneNode());
 			CPhysAggregateInstance *pPhysInstance = pSkeleton ? (CPhysAggregateInstance *)pSkeleton->m_modelState().m_pVPhysicsAggregate() : nullptr;
 			const KzTrigger *kzTrigger = KZ::mapapi::GetKzTrigger(pTrigger);
-			Color triggerColor;
+			CConVar<Color> *triggerColor;
 			if (KZ_STREQI(pEnt->GetClassname(), "trigger_teleport"))
 			{
-				triggerColor = kz_trigger_teleport_color.Get();
+				triggerColor = &kz_trigger_teleport_color;
 			}
 			else if (kzTrigger)
 			{
-				triggerColor = kz_trigger_multiple_colors[kzTrigger->type].Get();
+				triggerColor = &kz_trigger_multiple_colors[kzTrigger->type];
 			}
 			else
 			{
-				triggerColor = kz_trigger_multiple_colors[0].Get();
+				triggerColor = &kz_trigger_multiple_colors[0];
 			}
 			auto *aggregateData = pPhysInstance ? pPhysInstance->aggregateData : nullptr;
 			if (!aggregateData)
@@ -670,62 +667,73 @@ static_function void DrawTriggers()
 				META_CONPRINTF("Trigger %i: No aggregate data found for instance %p\n", pTrigger->entindex(), pPhysInstance);
 				continue;
 			}
-			FOR_EACH_VEC(aggregateData->m_Parts, i)
-			{
-				const VPhysXBodyPart_t *part = aggregateData->m_Parts[i];
-				if (!part)
-				{
-					continue;
-				}
-				triggersDrawn = true;
-				FOR_EACH_VEC(part->m_rnShape.m_hulls, j)
-				{
-					const RnHullDesc_t &hull = part->m_rnShape.m_hulls[j];
-					const RnCollisionAttr_t &collisionAttr = aggregateData->m_CollisionAttributes[hull.m_nCollisionAttributeIndex];
-
-					CTransform transform;
-					transform.SetToIdentity();
-					transform.m_vPosition = pTrigger->m_CBodyComponent()->m_pSceneNode()->m_vecAbsOrigin();
-					transform.m_orientation = Quaternion(pTrigger->m_CBodyComponent()->m_pSceneNode()->m_angAbsRotation());
-					Ray_t ray;
-					ray.Init(hull.m_Hull.m_Bounds.m_vMinBounds, hull.m_Hull.m_Bounds.m_vMaxBounds, hull.m_Hull.m_VertexPositions.Base(),
-							 hull.m_Hull.m_Vertices.Count());
-					g_pKZUtils->DebugDrawMesh(transform, ray, triggerColor.r(), triggerColor.g(), triggerColor.b(), triggerColor.a(), true, false,
-											  -1.0f);
-				}
-				FOR_EACH_VEC(part->m_rnShape.m_meshes, j)
-				{
-					const RnMeshDesc_t &mesh = part->m_rnShape.m_meshes[j];
-					const RnCollisionAttr_t &collisionAttr = aggregateData->m_CollisionAttributes[mesh.m_nCollisionAttributeIndex];
-					CTransform transform;
-					transform.SetToIdentity();
-					transform.m_vPosition = pTrigger->m_CBodyComponent()->m_pSceneNode()->m_vecAbsOrigin();
-					transform.m_orientation = Quaternion(pTrigger->m_CBodyComponent()->m_pSceneNode()->m_angAbsRotation());
-					FOR_EACH_VEC(mesh.m_Mesh.m_Triangles, k)
-					{
-						const RnTriangle_t &triangle = mesh.m_Mesh.m_Triangles[k];
-						Vector tri[3] = {utils::TransformPoint(transform, mesh.m_Mesh.m_Vertices[triangle.m_nIndex[0]]),
-										 utils::TransformPoint(transform, mesh.m_Mesh.m_Vertices[triangle.m_nIndex[1]]),
-										 utils::TransformPoint(transform, mesh.m_Mesh.m_Vertices[triangle.m_nIndex[2]])};
-						g_pKZUtils->AddTriangleOverlay(tri[0], tri[1], tri[2], triggerColor.r(), triggerColor.g(), triggerColor.b(), triggerColor.a(),
-													   false, -1.0f);
-					}
-				}
-			}
+			CTransform transform;
+			transform.SetToIdentity();
+			transform.m_vPosition = pTrigger->m_CBodyComponent()->m_pSceneNode()->m_vecAbsOrigin();
+			transform.m_orientation = Quaternion(pTrigger->m_CBodyComponent()->m_pSceneNode()->m_angAbsRotation());
+			triggersDrawn |= KZ::misc::overlay::ExtractAggregate(pendingShapes, *aggregateData, transform, triggerColor);
 		}
 	}
 }
 
+// Draw what is nearest to the host first, so the area they are looking at fills in right away.
+static_function void SortPendingShapes(u32 firstNewShape)
+{
+	KZPlayer *host = g_pKZPlayerManager->ToPlayer(CPlayerSlot(0));
+	if (!host || !host->GetPlayerPawn() || firstNewShape >= pendingShapes.size())
+	{
+		return;
+	}
+	Vector origin;
+	host->GetOrigin(&origin);
+	for (u32 i = nextPendingShape; i < pendingShapes.size(); i++)
+	{
+		pendingShapes[i].distanceSqr = (pendingShapes[i].center - origin).LengthSqr();
+	}
+	std::sort(pendingShapes.begin() + nextPendingShape, pendingShapes.end(),
+			  [](const KZ::misc::overlay::Shape &a, const KZ::misc::overlay::Shape &b) { return a.distanceSqr < b.distanceSqr; });
+}
+
+static_function void DrawPendingShapes()
+{
+	u32 end = MIN(nextPendingShape + OVERLAY_SHAPES_PER_FRAME, (u32)pendingShapes.size());
+	for (; nextPendingShape < end; nextPendingShape++)
+	{
+		KZ::misc::overlay::Shape &shape = pendingShapes[nextPendingShape];
+		Color color = shape.color->Get();
+		if (shape.hullVertices)
+		{
+			Ray_t ray;
+			ray.Init(shape.hullMins, shape.hullMaxs, shape.hullVertices->data(), (i32)shape.hullVertices->size());
+			g_pKZUtils->DebugDrawMesh(shape.transform, ray, color.r(), color.g(), color.b(), color.a(), true, false, -1.0f);
+		}
+		else
+		{
+			g_pKZUtils->AddTriangleOverlay(shape.triangle[0], shape.triangle[1], shape.triangle[2], color.r(), color.g(), color.b(), color.a(),
+										   false, -1.0f);
+		}
+	}
+	if (nextPendingShape == pendingShapes.size())
+	{
+		pendingShapes.clear();
+		nextPendingShape = 0;
+	}
+}
+
 void KZ::misc::OnPhysicsGameSystemFrameBoundary(void *pThis)
 {
 	static_persist CPhysicsGameSystem *physicsGameSystem = nullptr;
-	// Map probably reloaded, mark clips as not drawn.
-	if (pThis != physicsGameSystem)
+	static_persist i32 spawnGroupCount = -1;
+	CPhysicsGameSystem *gs = (CPhysicsGameSystem *)pThis;
+	// Map probably reloaded, or level geometry was added or removed. Extract the clips again next time they are drawn.
+	if (gs != physicsGameSystem || (gs && gs->m_PhysicsSpawnGroups.Count() != spawnGroupCount))
 	{
-		physicsGameSystem = (CPhysicsGameSystem *)pThis;
-		g_pKZUtils->ClearOverlays();
-		clipsDrawn = false;
+		physicsGameSystem = gs;
+		spawnGroupCount = gs ? gs->m_PhysicsSpawnGroups.Count() : -1;
+		ResetOverlays();
+		ResetClipShapes();
 	}
+	u32 firstNewShape = (u32)pendingShapes.size();
 	if (kz_showtriggers.Get())
 	{
 		DrawTriggers();
@@ -734,12 +742,16 @@ void KZ::misc::OnPhysicsGameSystemFrameBoundary(void *pThis)
 	{
 		DrawClipMeshes(physicsGameSystem);
 	}
+	SortPendingShapes(firstNewShape);
+	DrawPendingShapes();
 }
 
 void KZ::misc::OnActivateServer()
 {
 	KZ::misc::EnforceTimeLimit();
 	g_pKZUtils->UpdateCurrentMapMD5();
+	KZ::misc::LoadSpawnCache();
+	KZ::misc::PrecomputeSpawnCache();
 
 	interfaces::pEngine->ServerCommand("exec cs2kz.cfg");
 	KZ::misc::InitTimeLimit();
@@ -748,4 +760,6 @@ void KZ::misc::OnActivateServer()
 	interfaces::pEngine->ServerCommand("mp_restartgame 1");
 	kz_showplayerclips.Set(false);
 	kz_showtriggers.Set(false);
+	// The physics game system can survive a map change, don't draw the previous map's clips.
+	ResetClipShapes();
 }
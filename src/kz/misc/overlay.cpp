@@ -0,0 +1,94 @@
+#include "overlay.h"
+#include "utils/utils.h"
+
+#include "tier0/memdbgon.h"
+
+using namespace KZ::misc::overlay;
+
+void KZ::misc::overlay::AddHull(std::vector<Shape> &shapes, const RnHull_t &hull, const CTransform &transform, CConVar<Color> *color)
+{
+	if (hull.m_VertexPositions.Count() == 0)
+	{
+		return;
+	}
+	Shape &shape = shapes.emplace_back();
+	shape.hullVertices =
+		std::make_shared<const std::vector<Vector>>(hull.m_VertexPositions.Base(), hull.m_VertexPositions.Base() + hull.m_VertexPositions.Count());
+	shape.hullMins = hull.m_Bounds.m_vMinBounds;
+	shape.hullMaxs = hull.m_Bounds.m_vMaxBounds;
+	shape.transform = transform;
+	shape.color = color;
+	shape.center = utils::TransformPoint(transform, (hull.m_Bounds.m_vMinBounds + hull.m_Bounds.m_vMaxBounds) * 0.5f);
+}
+
+void KZ::misc::overlay::AddTriangle(std::vector<Shape> &shapes, const Vector &p1, const Vector &p2, const Vector &p3, CConVar<Color> *color)
+{
+	// Degenerate triangles draw nothing.
+	if (p1 == p2 || p2 == p3 || p1 == p3)
+	{
+		return;
+	}
+	Shape &shape = shapes.emplace_back();
+	shape.triangle[0] = p1;
+	shape.triangle[1] = p2;
+	shape.triangle[2] = p3;
+	shape.color = color;
+	shape.center = (p1 + p2 + p3) / 3.0f;
+}
+
+static_function bool PassesFilter(const CPhysAggregateData &aggregateData, u32 attributeIndex, ShapeFilter filter)
+{
+	if (!filter)
+	{
+		return true;
+	}
+	if (attributeIndex >= (u32)aggregateData.m_CollisionAttributes.Count())
+	{
+		return false;
+	}
+	return filter(aggregateData.m_CollisionAttributes[attributeIndex]);
+}
+
+bool KZ::misc::overlay::ExtractAggregate(std::vector<Shape> &shapes, const CPhysAggregateData &aggregateData, const CTransform &transform,
+										 CConVar<Color> *color, ShapeFilter filter)
+{
+	bool hasParts = false;
+	FOR_EACH_VEC(aggregateData.m_Parts, i)
+	{
+		const VPhysXBodyPart_t *part = aggregateData.m_Parts[i];
+		if (!part)
+		{
+			continue;
+		}
+		hasParts = true;
+		FOR_EACH_VEC(part->m_rnShape.m_hulls, j)
+		{
+			const RnHullDesc_t &hull = part->m_rnShape.m_hulls[j];
+			if (PassesFilter(aggregateData, hull.m_nCollisionAttributeIndex, filter))
+			{
+				AddHull(shapes, hull.m_Hull, transform, color);
+			}
+		}
+		FOR_EACH_VEC(part->m_rnShape.m_meshes, j)
+		{
+			const RnMeshDesc_t &mesh = part->m_rnShape.m_meshes[j];
+			if (!PassesFilter(aggregateData, mesh.m_nCollisionAttributeIndex, filter))
+			{
+				continue;
+			}
+			i32 vertexCount = mesh.m_Mesh.m_Vertices.Count();
+			FOR_EACH_VEC(mesh.m_Mesh.m_Triangles, k)
+			{
+				const RnTriangle_t &triangle = mesh.m_Mesh.m_Triangles[k];
+				if (triangle.m_nIndex[0] >= vertexCount || triangle.m_nIndex[1] >= vertexCount || triangle.m_nIndex[2] >= vertexCount)
+				{
+					continue;
+				}
+				AddTriangle(shapes, utils::TransformPoint(transform, mesh.m_Mesh.m_Vertices[triangle.m_nIndex[0]]),
+							utils::TransformPoint(transform, mesh.m_Mesh.m_Vertices[triangle.m_nIndex[1]]),
+							utils::TransformPoint(transform, mesh.m_Mesh.m_Vertices[triangle.m_nIndex[2]]), color);
+			}
+		}
+	}
+	return hasParts;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "common.h"
+#include "sdk/physicsgamesystem.h"
+
+// Debug overlay geometry, copied out of the physics data so it can be kept around and drawn over several frames.
+// Extraction only reads the data it is given and never touches the engine, so it works on hand built hulls and meshes too.
+namespace KZ::misc::overlay
+{
+	struct Shape
+	{
+		// Hull vertices in model space, drawn in one call. Null for a single mesh triangle, which is stored in world space.
+		std::shared_ptr<const std::vector<Vector>> hullVertices;
+		Vector hullMins;
+		Vector hullMaxs;
+		CTransform transform;
+		Vector triangle[3];
+		CConVar<Color> *color;
+		Vector center;
+		f32 distanceSqr;
+	};
+
+	// Decides whether a hull or mesh with these collision attributes is extracted.
+	using ShapeFilter = bool (*)(const RnCollisionAttr_t &collisionAttr);
+
+	void AddHull(std::vector<Shape> &shapes, const RnHull_t &hull, const CTransform &transform, CConVar<Color> *color);
+	void AddTriangle(std::vector<Shape> &shapes, const Vector &p1, const Vector &p2, const Vector &p3, CConVar<Color> *color);
+
+	// Add the hulls and mesh triangles of every part of the aggregate, skipping those rejected by the filter if there is one.
+	// Returns false if the aggregate has no parts yet.
+	bool ExtractAggregate(std::vector<Shape> &shapes, const CPhysAggregateData &aggregateData, const CTransform &transform,
+						  CConVar<Color> *color, ShapeFilter filter = nullptr);
+} // namespace KZ::misc::overlay
@@ -0,0 +1,315 @@
+#include "common.h"
+#include "utils/utils.h"
+#include "kz/kz.h"
+#include "utils/ctimer.h"
+#include "filesystem.h"
+
+#include "sdk/entity/cbasetrigger.h"
+
+#include "tier0/memdbgon.h"
+
+// Positions found by tracing (valid spawns, trigger end positions) only depend on the map, so they are stored per map on disk.
+// The cache belongs to a map file through its MD5, any change to the map throws it away.
+#define SPAWN_CACHE_PATH "addons/cs2kz/data/spawncache"
+
+enum : u32
+{
+	SPAWN_CACHE_MAGIC = 0x43535A4B, // KZSC
+	SPAWN_CACHE_VERSION = 1,
+};
+
+enum SpawnCacheEntryType : u32
+{
+	SPAWN_CACHE_VALID_SPAWN,
+	SPAWN_CACHE_ANY_SPAWN,
+	SPAWN_CACHE_TRIGGER,
+};
+
+struct SpawnCacheHeader
+{
+	u32 magic;
+	u32 version;
+	char md5[33];
+	u32 numEntries;
+};
+
+struct SpawnCacheEntry
+{
+	SpawnCacheEntryType type;
+	// Origin, mins and maxs of the trigger, unused for spawns.
+	Vector key[3];
+	// Always true for entries written now, only positions that were found are cached. Older files can still have misses.
+	bool found;
+	Vector origin;
+	QAngle angles;
+};
+
+static_global struct
+{
+	// Empty if the cache is not loaded for the current map yet.
+	CUtlString mapName;
+	char md5[33];
+	bool dirty;
+	bool savePending;
+	CUtlVector<SpawnCacheEntry> entries;
+} spawnCache;
+
+static_function bool IsSpawnCacheReady()
+{
+	return !spawnCache.mapName.IsEmpty() && spawnCache.mapName == g_pKZUtils->GetCurrentMapName();
+}
+
+static_function void GetSpawnCachePath(char *buffer, u32 size)
+{
+	char mapName[MAX_PATH];
+	V_strncpy(mapName, spawnCache.mapName.Get(), sizeof(mapName));
+	// Workshop maps can be loaded by path.
+	V_FixSlashes(mapName, '_');
+	V_snprintf(buffer, size, SPAWN_CACHE_PATH "/%s.bin", mapName);
+}
+
+static_function void GetTriggerKey(CBaseTrigger *trigger, Vector *key)
+{
+	key[0] = trigger->m_CBodyComponent->m_pSceneNode->m_vecAbsOrigin();
+	key[1] = trigger->m_pCollision()->m_vecMins();
+	key[2] = trigger->m_pCollision()->m_vecMaxs();
+}
+
+static_function void ScheduleSave();
+
+static_function SpawnCacheEntry *FindEntry(SpawnCacheEntryType type, const Vector *key = nullptr)
+{
+	FOR_EACH_VEC(spawnCache.entries, i)
+	{
+		SpawnCacheEntry &entry = spawnCache.entries[i];
+		if (entry.type == type && (!key || (entry.key[0] == key[0] && entry.key[1] == key[1] && entry.key[2] == key[2])))
+		{
+			return &entry;
+		}
+	}
+	return nullptr;
+}
+
+// Misses are not stored: whatever blocked the search may be gone next time, and a cached miss would keep it failing for good.
+static_function void StoreEntry(SpawnCacheEntryType type, const Vector *key, const Vector &origin, const QAngle &angles)
+{
+	SpawnCacheEntry entry = {type, {}, true, origin, angles};
+	if (key)
+	{
+		entry.key[0] = key[0];
+		entry.key[1] = key[1];
+		entry.key[2] = key[2];
+	}
+	SpawnCacheEntry *existing = FindEntry(type, key);
+	if (existing)
+	{
+		*existing = entry;
+	}
+	else
+	{
+		spawnCache.entries.AddToTail(entry);
+	}
+	spawnCache.dirty = true;
+	ScheduleSave();
+}
+
+static_function void SaveSpawnCache()
+{
+	if (!spawnCache.dirty || !IsSpawnCacheReady())
+	{
+		return;
+	}
+	spawnCache.dirty = false;
+
+	char path[MAX_PATH];
+	GetSpawnCachePath(path, sizeof(path));
+	g_pFullFileSystem->CreateDirHierarchy(SPAWN_CACHE_PATH, "GAME");
+	FileHandle_t file = g_pFullFileSystem->Open(path, "wb", "GAME");
+	if (!file)
+	{
+		META_CONPRINTF("[KZ] Failed to write the spawn cache to %s.\n", path);
+		return;
+	}
+
+	SpawnCacheHeader header = {SPAWN_CACHE_MAGIC, SPAWN_CACHE_VERSION, {}, (u32)spawnCache.entries.Count()};
+	V_strncpy(header.md5, spawnCache.md5, sizeof(header.md5));
+	g_pFullFileSystem->Write(&header, sizeof(header), file);
+	g_pFullFileSystem->Write(spawnCache.entries.Base(), spawnCache.entries.Count() * sizeof(SpawnCacheEntry), file);
+	g_pFullFileSystem->Close(file);
+}
+
+static_function f64 SaveSpawnCacheTimer()
+{
+	spawnCache.savePending = false;
+	SaveSpawnCache();
+	return 0.0;
+}
+
+// New entries tend to come in bursts (every end trigger respawns on round start), write them out together.
+static_function void ScheduleSave()
+{
+	if (!spawnCache.savePending)
+	{
+		spawnCache.savePending = true;
+		StartTimer(SaveSpawnCacheTimer, 1.0, false);
+	}
+}
+
+void KZ::misc::LoadSpawnCache()
+{
+	spawnCache.entries.RemoveAll();
+	spawnCache.dirty = false;
+	// Timers that are not persistent do not survive a map change.
+	spawnCache.savePending = false;
+	spawnCache.mapName = "";
+
+	bool success = false;
+	CUtlString mapName = g_pKZUtils->GetCurrentMapName(&success);
+	char md5[33];
+	if (!success || !g_pKZUtils->GetCurrentMapMD5(md5, sizeof(md5)))
+	{
+		// Without knowing which map file this is, the cache can't be trusted.
+		return;
+	}
+	spawnCache.mapName = mapName;
+	V_strncpy(spawnCache.md5, md5, sizeof(spawnCache.md5));
+
+	char path[MAX_PATH];
+	GetSpawnCachePath(path, sizeof(path));
+	FileHandle_t file = g_pFullFileSystem->Open(path, "rb", "GAME");
+	if (!file)
+	{
+		return;
+	}
+
+	SpawnCacheHeader header;
+	if (g_pFullFileSystem->Read(&header, sizeof(header), file) == sizeof(header) && header.magic == SPAWN_CACHE_MAGIC
+		&& header.version == SPAWN_CACHE_VERSION && KZ_STREQ(header.md5, md5) && header.numEntries < 4096)
+	{
+		spawnCache.entries.SetCount(header.numEntries);
+		u32 size = header.numEntries * sizeof(SpawnCacheEntry);
+		if ((u32)g_pFullFileSystem->Read(spawnCache.entries.Base(), size, file) != size)
+		{
+			spawnCache.entries.RemoveAll();
+		}
+	}
+	g_pFullFileSystem->Close(file);
+}
+
+void KZ::misc::PrecomputeSpawnCache()
+{
+	if (!IsSpawnCacheReady())
+	{
+		return;
+	}
+
+	// Trigger positions follow when the triggers respawn on the first round start.
+	Vector origin;
+	QAngle angles;
+	KZ::misc::FindValidSpawn(origin, angles);
+	KZ::misc::FindValidSpawn(origin, angles, true);
+}
+
+bool KZ::misc::FindValidSpawn(Vector &origin, QAngle &angles, bool ignoreStuckCheck)
+{
+	if (!IsSpawnCacheReady())
+	{
+		return utils::FindValidSpawn(origin, angles, ignoreStuckCheck);
+	}
+
+	SpawnCacheEntryType type = ignoreStuckCheck ? SPAWN_CACHE_ANY_SPAWN : SPAWN_CACHE_VALID_SPAWN;
+	SpawnCacheEntry *entry = FindEntry(type);
+	if (!entry || !entry->found)
+	{
+		bool found = utils::FindValidSpawn(origin, angles, ignoreStuckCheck);
+		if (found)
+		{
+			StoreEntry(type, nullptr, origin, angles);
+		}
+		return found;
+	}
+
+	// Spawns can still be blocked by something that is not part of the map, check with one trace instead of searching again.
+	if (!ignoreStuckCheck && !utils::IsSpawnValid(entry->origin))
+	{
+		return utils::FindValidSpawn(origin, angles, ignoreStuckCheck);
+	}
+	origin = entry->origin;
+	angles = entry->angles;
+	return true;
+}
+
+bool KZ::misc::FindValidPositionForTrigger(CBaseTrigger *trigger, Vector &originDest, QAngle &anglesDest)
+{
+	if (!trigger)
+	{
+		return false;
+	}
+	if (!IsSpawnCacheReady())
+	{
+		return utils::FindValidPositionForTrigger(trigger, originDest, anglesDest);
+	}
+
+	Vector key[3];
+	GetTriggerKey(trigger, key);
+	SpawnCacheEntry *entry = FindEntry(SPAWN_CACHE_TRIGGER, key);
+	if (entry && entry->found)
+	{
+		originDest = entry->origin;
+		anglesDest = entry->angles;
+		return true;
+	}
+
+	bool found = utils::FindValidPositionForTrigger(trigger, originDest, anglesDest);
+	if (found)
+	{
+		StoreEntry(SPAWN_CACHE_TRIGGER, key, originDest, anglesDest);
+	}
+	return found;
+}
+
+static_function bool SamePosition(bool found, const Vector &origin, const QAngle &angles, const SpawnCacheEntry &entry)
+{
+	return found == entry.found && (!found || (origin == entry.origin && angles == entry.angles));
+}
+
+CON_COMMAND_F(kz_spawncache_verify, "Trace the cached spawn and trigger positions of the current map again and report differences.", FCVAR_NONE)
+{
+	if (!IsSpawnCacheReady())
+	{
+		META_CONPRINTF("[KZ] The spawn cache is not loaded for this map.\n");
+		return;
+	}
+
+	u32 checked = 0;
+	u32 mismatches = 0;
+	Vector origin;
+	QAngle angles;
+	FOR_EACH_VEC(spawnCache.entries, i)
+	{
+		const SpawnCacheEntry &entry = spawnCache.entries[i];
+		if (entry.type != SPAWN_CACHE_TRIGGER)
+		{
+			bool found = utils::FindValidSpawn(origin, angles, entry.type == SPAWN_CACHE_ANY_SPAWN);
+			mismatches += !SamePosition(found, origin, angles, entry);
+			checked++;
+		}
+	}
+
+	// Trigger entries can only be checked against the triggers that exist right now.
+	CBaseEntity *entity = nullptr;
+	while ((entity = utils::FindEntityByClassname(entity, "trigger_multiple")))
+	{
+		CBaseTrigger *trigger = static_cast<CBaseTrigger *>(entity);
+		Vector key[3];
+		GetTriggerKey(trigger, key);
+		SpawnCacheEntry *entry = FindEntry(SPAWN_CACHE_TRIGGER, key);
+		if (entry)
+		{
+			bool found = utils::FindValidPositionForTrigger(trigger, origin, angles);
+			mismatches += !SamePosition(found, origin, angles, *entry);
+			checked++;
+		}
+	}
+	META_CONPRINTF("[KZ] Spawn cache: checked %u of %i entries, %u differ from a fresh trace.\n", checked, spawnCache.entries.Count(), mismatches);
+}
@@ -5,7 +5,7 @@
 #include "../jumpstats/kz_jumpstats.h"
 #include "UtlStringMap.h"
 
-#define KZ_MODE_MANAGER_INTERFACE "KZModeManagerInterface"
+#define KZ_MODE_MANAGER_INTERFACE "KZModeManagerInterface002"
 
 enum KzModeCvars
 {
@@ -210,6 +210,12 @@ public:
 
 	// Other events
 	virtual void OnTeleport(const Vector *newPosition, const QAngle *newAngles, const Vector *newVelocity) {}
+
+	// Movement hooks this mode overrides, the others are skipped by the player.
+	virtual u64 GetMovementHooks()
+	{
+		return MOVEMENT_HOOK_ALL;
+	}
 };
 
 typedef KZModeService *(*ModeServiceFactory)(KZPlayer *player);
@@ -340,4 +346,6 @@ namespace KZ::mode
 	KZModeManager::ModePluginInfo GetModeInfo(KZ::API::Mode mode);
 	KZModeManager::ModePluginInfo GetModeInfo(CUtlString modeName);
 	KZModeManager::ModePluginInfo GetModeInfoFromDatabaseID(i32 id);
+	// Position of a loaded mode in the mode list, -1 if not loaded. Stays the same for a mode across plugin reloads.
+	i32 GetModeIndex(PluginId id);
 }; // namespace KZ::mode
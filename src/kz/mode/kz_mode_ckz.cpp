@@ -3,6 +3,7 @@
 #include "utils/addresses.h"
 #include "utils/interfaces.h"
 #include "utils/gameconfig.h"
+#include "utils/schema.h"
 #include "sdk/usercmd.h"
 #include "sdk/tracefilter.h"
 #include "sdk/entity/cbasetrigger.h"
@@ -47,6 +48,7 @@ bool KZClassicModePlugin::Load(PluginId id, ISmmAPI *ismm, char *error, size_t m
 		V_snprintf(error, maxlen, "Failed to initialize interfaces");
 		return false;
 	}
+	schema::ResolveFields();
 
 	if (nullptr == (g_pGameConfig = g_pKZUtils->GetGameConfig()))
 	{
@@ -103,7 +105,8 @@ void KZClassicModeService::Reset()
 	this->forcedUnduck = {};
 	this->postProcessMovementZSpeed = {};
 
-	this->angleHistory.RemoveAll();
+	this->angleHistoryStart = 0;
+	this->angleHistoryCount = 0;
 	this->leftPreRatio = {};
 	this->rightPreRatio = {};
 	this->bonusSpeed = {};
@@ -401,23 +404,25 @@ void KZClassicModeService::ReduceDuckSlowdown()
 void KZClassicModeService::UpdateAngleHistory()
 {
 	CMoveData *mv = this->player->currentMoveData;
-	u32 oldEntries = 0;
-	FOR_EACH_VEC(this->angleHistory, i)
+	while (this->angleHistoryCount > 0
+		   && this->angleHistory[this->angleHistoryStart].when + PS_TURN_RATE_WINDOW < g_pKZUtils->GetGlobals()->curtime)
 	{
-		if (this->angleHistory[i].when + PS_TURN_RATE_WINDOW < g_pKZUtils->GetGlobals()->curtime)
-		{
-			oldEntries++;
-			continue;
-		}
-		break;
+		this->angleHistoryStart = (this->angleHistoryStart + 1) % ANGLE_HISTORY_SIZE;
+		this->angleHistoryCount--;
 	}
-	this->angleHistory.RemoveMultipleFromHead(oldEntries);
 	if ((this->player->GetPlayerPawn()->m_fFlags & FL_ONGROUND) == 0)
 	{
 		return;
 	}
 
-	AngleHistory *angHist = this->angleHistory.AddToTailGetPtr();
+	if (this->angleHistoryCount == ANGLE_HISTORY_SIZE)
+	{
+		// Drop the oldest sample rather than growing.
+		this->angleHistoryStart = (this->angleHistoryStart + 1) % ANGLE_HISTORY_SIZE;
+		this->angleHistoryCount--;
+	}
+	AngleHistory *angHist = &this->angleHistory[(this->angleHistoryStart + this->angleHistoryCount) % ANGLE_HISTORY_SIZE];
+	this->angleHistoryCount++;
 	angHist->when = g_pKZUtils->GetGlobals()->curtime;
 	angHist->duration = g_pKZUtils->GetGlobals()->frametime;
 
@@ -478,10 +483,12 @@ void KZClassicModeService::CalcPrestrafe()
 {
 	f32 totalDuration = 0;
 	f32 sumWeightedAngles = 0;
-	FOR_EACH_VEC(this->angleHistory, i)
+	// Summed oldest first like the samples were added, so the result does not depend on where the ring wraps.
+	for (u32 i = 0; i < this->angleHistoryCount; i++)
 	{
-		sumWeightedAngles += this->angleHistory[i].rate * this->angleHistory[i].duration;
-		totalDuration += this->angleHistory[i].duration;
+		const AngleHistory &entry = this->angleHistory[(this->angleHistoryStart + i) % ANGLE_HISTORY_SIZE];
+		sumWeightedAngles += entry.rate * entry.duration;
+		totalDuration += entry.duration;
 	}
 	f32 averageRate;
 	if (totalDuration == 0)
@@ -624,7 +631,54 @@ static_function void ClipVelocity(Vector &in, Vector &normal, Vector &out)
 	out = normal * backoff + in;
 }
 
-static_function bool IsValidMovementTrace(trace_t &tr, bbox_t bounds, CTraceFilterPlayerMovementCS *filter)
+// The ramp pierce search keeps checking whether the hull fits at the same positions, e.g. every offset that traces back
+// to the start ends there. Nothing moves during a single TryPlayerMove, so the results of these unswept traces are kept
+// for the duration of the call and are exactly what tracing again would return.
+struct UnsweptTraceCache
+{
+	static constexpr u32 SIZE = 32;
+	Vector origins[SIZE];
+	bool clear[SIZE];
+	u32 count;
+	u32 next;
+};
+
+static_global u64 numUnsweptTraces;
+static_global u64 numUnsweptTracesSaved;
+
+static_function bool IsHullClear(const Vector &origin, bbox_t bounds, CTraceFilterPlayerMovementCS *filter, UnsweptTraceCache &cache)
+{
+	numUnsweptTraces++;
+	for (u32 i = 0; i < cache.count; i++)
+	{
+		if (cache.origins[i] == origin)
+		{
+			numUnsweptTracesSaved++;
+			return cache.clear[i];
+		}
+	}
+
+	trace_t stuck;
+	g_pKZUtils->TracePlayerBBox(origin, origin, bounds, filter, stuck);
+	bool clear = !(stuck.m_bStartInSolid || stuck.m_flFraction < 1.0f - FLT_EPSILON);
+
+	cache.origins[cache.next] = origin;
+	cache.clear[cache.next] = clear;
+	cache.next = (cache.next + 1) % UnsweptTraceCache::SIZE;
+	cache.count = MIN(cache.count + 1, UnsweptTraceCache::SIZE);
+	return clear;
+}
+
+CON_COMMAND_F(kz_ckz_tpm_trace_stats, "Print how many unswept traces the Classic TryPlayerMove saved by reusing results, and reset the counters.",
+			  FCVAR_NONE)
+{
+	META_CONPRINTF("[KZ::CKZ] %llu unswept traces requested, %llu (%.1f%%) reused from the same move.\n", numUnsweptTraces, numUnsweptTracesSaved,
+				   numUnsweptTraces ? 100.0 * numUnsweptTracesSaved / numUnsweptTraces : 0.0);
+	numUnsweptTraces = 0;
+	numUnsweptTracesSaved = 0;
+}
+
+static_function bool IsValidMovementTrace(trace_t &tr, bbox_t bounds, CTraceFilterPlayerMovementCS *filter, UnsweptTraceCache &cache)
 {
 	trace_t stuck;
 	// Maybe we don't need this one.
@@ -652,8 +706,7 @@ static_function bool IsValidMovementTrace(trace_t &tr, bbox_t bounds, CTraceFilt
 	}
 
 	// Do an unswept trace and a backward trace just to be sure.
-	g_pKZUtils->TracePlayerBBox(tr.m_vEndPos, tr.m_vEndPos, bounds, filter, stuck);
-	if (stuck.m_bStartInSolid || stuck.m_flFraction < 1.0f - FLT_EPSILON)
+	if (!IsHullClear(tr.m_vEndPos, bounds, filter, cache))
 	{
 		return false;
 	}
@@ -703,6 +756,7 @@ void KZClassicModeService::OnTryPlayerMove(Vector *pFirstDest, trace_t *pFirstTr
 	this->player->GetBBoxBounds(&bounds);
 
 	CTraceFilterPlayerMovementCS filter(pawn);
+	UnsweptTraceCache traceCache {};
 
 	bool potentiallyStuck {};
 
@@ -723,7 +777,7 @@ void KZClassicModeService::OnTryPlayerMove(Vector *pFirstDest, trace_t *pFirstTr
 			{
 				continue;
 			}
-			if (IsValidMovementTrace(pm, bounds, &filter) && pm.m_flFraction == 1.0f)
+			if (IsValidMovementTrace(pm, bounds, &filter, traceCache) && pm.m_flFraction == 1.0f)
 			{
 				// Player won't hit anything, nothing to do.
 				break;
@@ -760,7 +814,7 @@ void KZClassicModeService::OnTryPlayerMove(Vector *pFirstDest, trace_t *pFirstTr
 								}
 								trace_t test;
 								g_pKZUtils->TracePlayerBBox(start + offsetDirection * RAMP_PIERCE_DISTANCE, start, bounds, &filter, test);
-								if (!IsValidMovementTrace(test, bounds, &filter))
+								if (!IsValidMovementTrace(test, bounds, &filter, traceCache))
 								{
 									continue;
 								}
@@ -772,7 +826,7 @@ void KZClassicModeService::OnTryPlayerMove(Vector *pFirstDest, trace_t *pFirstTr
 							{
 								g_pKZUtils->TracePlayerBBox(start + offsetDirection * RAMP_PIERCE_DISTANCE * ratio,
 															end + offsetDirection * RAMP_PIERCE_DISTANCE * ratio, bounds, &filter, pierce);
-								if (!IsValidMovementTrace(pierce, bounds, &filter))
+								if (!IsValidMovementTrace(pierce, bounds, &filter, traceCache))
 								{
 									continue;
 								}
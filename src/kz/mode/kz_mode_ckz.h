@@ -155,7 +155,12 @@ class KZClassicModeService : public KZModeService
 		f32 duration;
 	};
 
-	CUtlVector<AngleHistory> angleHistory;
+	// Fixed ring of the samples from the last PS_TURN_RATE_WINDOW seconds, oldest first from angleHistoryStart.
+	// The window only spans a couple of ticks, the capacity leaves room for bursts of commands processed at the same time.
+	static constexpr u32 ANGLE_HISTORY_SIZE = 64;
+	AngleHistory angleHistory[ANGLE_HISTORY_SIZE];
+	u32 angleHistoryStart {};
+	u32 angleHistoryCount {};
 	f32 leftPreRatio {};
 	f32 rightPreRatio {};
 	f32 bonusSpeed {};
@@ -184,6 +189,21 @@ public:
 	virtual DistanceTier GetDistanceTier(JumpType jumpType, f32 distance) override;
 	virtual const CVValue_t *GetModeConVarValues() override;
 
+	virtual u64 GetMovementHooks() override
+	{
+		// clang-format off
+		return MOVEMENT_HOOK_PHYSICS_SIMULATE | MOVEMENT_HOOK_PHYSICS_SIMULATE_POST
+			| MOVEMENT_HOOK_SETUP_MOVE
+			| MOVEMENT_HOOK_PROCESS_MOVEMENT | MOVEMENT_HOOK_PROCESS_MOVEMENT_POST
+			| MOVEMENT_HOOK_PLAYER_MOVE
+			| MOVEMENT_HOOK_CATEGORIZE_POSITION
+			| MOVEMENT_HOOK_DUCK_POST
+			| MOVEMENT_HOOK_AIR_MOVE | MOVEMENT_HOOK_AIR_MOVE_POST
+			| MOVEMENT_HOOK_WATER_MOVE | MOVEMENT_HOOK_WATER_MOVE_POST
+			| MOVEMENT_HOOK_TRY_PLAYER_MOVE | MOVEMENT_HOOK_TRY_PLAYER_MOVE_POST;
+		// clang-format on
+	}
+
 	virtual void OnPhysicsSimulate() override;
 	virtual void OnPhysicsSimulatePost() override;
 	virtual void OnSetupMove(PlayerCommand *pc) override;
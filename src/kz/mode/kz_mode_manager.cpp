@@ -116,6 +116,7 @@ void KZ::mode::InitModeService(KZPlayer *player)
 {
 	delete player->modeService;
 	player->modeService = new KZVanillaModeService(player);
+	player->UpdateMovementHooks();
 }
 
 void KZ::mode::DisableReplicatedModeCvars()
@@ -288,6 +289,7 @@ bool KZModeManager::SwitchToMode(KZPlayer *player, const char *modeName, bool si
 	player->modeService->Cleanup();
 	delete player->modeService;
 	player->modeService = factory(player);
+	player->UpdateMovementHooks();
 	player->timerService->TimerStop();
 	player->modeService->Init();
 
@@ -433,6 +435,23 @@ KZModeManager::ModePluginInfo KZ::mode::GetModeInfoFromDatabaseID(i32 id)
 	return KZModeManager::ModePluginInfo();
 }
 
+i32 KZ::mode::GetModeIndex(PluginId id)
+{
+	// -1 and -2 are not loaded modes.
+	if (id < 0)
+	{
+		return -1;
+	}
+	FOR_EACH_VEC(modeInfos, i)
+	{
+		if (modeInfos[i].id == id)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
 void KZDatabaseServiceEventListener_Modes::OnDatabaseSetup()
 {
 	FOR_EACH_VEC(modeInfos, i)
@@ -65,6 +65,17 @@ public:
 	virtual DistanceTier GetDistanceTier(JumpType jumpType, f32 distance) override;
 	virtual const CVValue_t *GetModeConVarValues() override;
 
+	virtual u64 GetMovementHooks() override
+	{
+		// clang-format off
+		return MOVEMENT_HOOK_PLAYER_MOVE
+			| MOVEMENT_HOOK_PROCESS_MOVEMENT_POST
+			| MOVEMENT_HOOK_DUCK_POST
+			| MOVEMENT_HOOK_AIR_MOVE | MOVEMENT_HOOK_AIR_MOVE_POST
+			| MOVEMENT_HOOK_TRY_PLAYER_MOVE | MOVEMENT_HOOK_TRY_PLAYER_MOVE_POST;
+		// clang-format on
+	}
+
 	// Triggerfix
 	virtual void OnPlayerMove() override;
 	virtual void OnProcessMovementPost() override;
@@ -1,5 +1,6 @@
 #include "kz_profile.h"
 #include "utils/http.h"
+#include "utils/json.h"
 #include "kz/anticheat/kz_anticheat.h"
 #include "kz/mode/kz_mode.h"
 #include "kz/style/kz_style.h"
@@ -48,12 +49,19 @@ static_global const char *rankColors[NUM_RANKS] = {"{default}", "{grey}", "{grey
 
 CConVar<bool> kz_profile_rating_badge_enabled("kz_profile_rating_badge_enabled", FCVAR_NONE, "Whether to show competitive rank in scoreboard.", true);
 
+// Set when a displayed ranking changed, the reveal makes clients show it on the scoreboard.
+static_global bool rankRevealPending;
+
+static_function void FlushRatingRequests();
+
 void KZProfileService::OnGameFrame()
 {
-	if (g_pKZUtils->GetServerGlobals()->tickcount % 64 != 0)
+	FlushRatingRequests();
+	if (!rankRevealPending || g_pKZUtils->GetServerGlobals()->tickcount % 64 != 0)
 	{
 		return;
 	}
+	rankRevealPending = false;
 	CBroadcastRecipientFilter filter;
 	INetworkMessageInternal *netmsg = g_pNetworkMessages->FindNetworkMessagePartial("CCSUsrMsg_ServerRankRevealAll");
 	CNetMessage *msg = netmsg->AllocateMessage();
@@ -63,10 +71,10 @@ void KZProfileService::OnGameFrame()
 
 void KZProfileService::OnCheckTransmit()
 {
-	for (i32 i = 0; i < MAXPLAYERS + 1; i++)
+	FOR_EACH_VEC(g_pKZPlayerManager->activePlayers, i)
 	{
-		KZPlayer *player = g_pKZPlayerManager->ToPlayer(i);
-		if (player && player->profileService)
+		KZPlayer *player = g_pKZPlayerManager->ToKZPlayer(g_pKZPlayerManager->activePlayers[i]);
+		if (player->profileService)
 		{
 			player->profileService->UpdateCompetitiveRank();
 		}
@@ -75,61 +83,85 @@ void KZProfileService::OnCheckTransmit()
 
 CConVar<bool> kz_profile_debug("kz_profile_debug", FCVAR_NONE, "Enable profile debug messages.", false);
 
-void KZProfileService::RequestRating()
+// Players mostly join in bursts (map changes, mode changes after a restart), so rating requests are collected for a short while
+// and sent as one request per mode.
+#define RATING_BATCH_WINDOW 0.5f // seconds
+
+struct PendingRatingRequest
 {
-	if (!KZGlobalService::IsAvailable())
+	u64 steamID64;
+	KZ::API::Mode mode;
+};
+
+static_global CUtlVector<PendingRatingRequest> pendingRatingRequests;
+static_global f32 ratingBatchDeadline;
+// Cleared if the API does not know the batch route, every player is requested on its own from then on.
+static_global bool ratingBatchSupported = true;
+
+struct RatingBatchResponse
+{
+	struct Profile
 	{
-		if (kz_profile_debug.GetBool())
+		u64 id;
+		f64 rating;
+
+		static const JsonFieldTable &JsonFields()
 		{
-			META_CONPRINTF("[KZ::Profile] Global service not available, cannot request rating for player %s.\n", this->player->GetName());
+			// clang-format off
+			static_persist constexpr JsonField fields[] = {
+				JSON_FIELD("id", &Profile::id),
+				JSON_FIELD("rating", &Profile::rating),
+			};
+			// clang-format on
+			static_persist constexpr JsonFieldTable table(fields);
+			return table;
 		}
-		return;
-	}
-	if (!this->player->IsAuthenticated() || !this->player->IsConnected())
+	};
+
+	std::vector<Profile> values;
+
+	static const JsonFieldTable &JsonFields()
 	{
-		if (kz_profile_debug.GetBool())
-		{
-			META_CONPRINTF("[KZ::Profile] Player %s not authenticated or not connected, cannot request rating.\n", this->player->GetName());
-		}
-		return;
+		static_persist constexpr JsonField fields[] = {JSON_FIELD("values", &RatingBatchResponse::values)};
+		static_persist constexpr JsonFieldTable table(fields);
+		return table;
 	}
-	KZ::API::Mode mode;
-	if (!KZ::API::DecodeModeString(this->player->modeService->GetModeShortName(), mode))
+};
+
+static_function void ApplyRating(u64 steamID64, KZ::API::Mode mode, f64 rating)
+{
+	KZPlayer *player = g_pKZPlayerManager->SteamIdToPlayer(steamID64);
+	if (player == nullptr)
 	{
 		if (kz_profile_debug.GetBool())
 		{
-			META_CONPRINTF("[KZ::Profile] Player %s has invalid mode '%s', cannot request rating.\n", this->player->GetName(),
-						   this->player->modeService->GetModeShortName());
+			META_CONPRINTF("[KZ::Profile] Player not found for SteamID %llu.\n", steamID64);
 		}
 		return;
 	}
-	this->desiredMode = static_cast<u8>(mode);
-	u64 steamID64 = this->player->GetSteamId64();
-	if (steamID64 == 0)
+	// The player mode has changed since the request was made.
+	if (player->profileService->desiredMode != static_cast<u8>(mode))
 	{
 		if (kz_profile_debug.GetBool())
 		{
-			META_CONPRINTF("[KZ::Profile] Player %s has invalid SteamID, cannot request rating.\n", this->player->GetName());
+			META_CONPRINTF("[KZ::Profile] Player %s mode changed since request, ignoring response.\n", player->GetName());
 		}
 		return;
 	}
-	if (this->player->styleServices.Count() > 0)
+	player->profileService->currentRating = rating;
+	if (kz_profile_debug.GetBool())
 	{
-		if (kz_profile_debug.GetBool())
-		{
-			META_CONPRINTF("[KZ::Profile] Player %s has styles enabled, skipping rating request.\n", this->player->GetName());
-		}
-		return;
+		META_CONPRINTF("[KZ::Profile] Updating rating for player %s: %.2f.\n", player->GetName(), player->profileService->currentRating * 0.1f);
 	}
-	this->timeToNextRatingRefresh = g_pKZUtils->GetServerGlobals()->realtime + RATING_REFRESH_PERIOD + RandomFloat(-30.0f, 30.0f);
+	player->profileService->UpdateCompetitiveRank();
+	player->profileService->UpdateClantag();
+}
+
+static_function void SendRatingRequest(u64 steamID64, KZ::API::Mode mode)
+{
 	std::string url = std::string(KZOptionService::GetOptionStr("apiUrl", "https://api.cs2kz.org")) + "/players/" + std::to_string(steamID64)
 					  + "/profile?mode=" + std::to_string(static_cast<u8>(mode));
 	HTTP::Request request(HTTP::Method::GET, url);
-	if (kz_profile_debug.GetBool())
-	{
-		META_CONPRINTF("[KZ::Profile] Requesting rating for player %s (%llu) in mode %d.\n", this->player->GetName(), steamID64,
-					   static_cast<u8>(mode));
-	}
 	auto callback = [steamID64, mode](HTTP::Response response)
 	{
 		if (kz_profile_debug.GetBool())
@@ -144,42 +176,173 @@ void KZProfileService::RequestRating()
 			}
 			return;
 		}
-		KZPlayer *player = g_pKZPlayerManager->SteamIdToPlayer(steamID64);
-		if (player == nullptr)
+		f64 rating;
+		if (!JsonDecodeField(response.Body().value_or(""), "rating", rating))
 		{
 			if (kz_profile_debug.GetBool())
 			{
-				META_CONPRINTF("[KZ::Profile] Player not found for SteamID %llu.\n", steamID64);
+				META_CONPRINTF("[KZ::Profile] Failed to parse rating from response for player %llu.\n", steamID64);
 			}
 			return;
 		}
-		// The player mode has changed since the request was made.
-		if (player->profileService->desiredMode != static_cast<u8>(mode))
+		ApplyRating(steamID64, mode, rating);
+	};
+	request.Send(callback);
+}
+
+static_function void SendRatingBatchRequest(KZ::API::Mode mode, const std::vector<u64> &steamIDs)
+{
+	std::string players;
+	for (u64 steamID64 : steamIDs)
+	{
+		if (!players.empty())
+		{
+			players += ',';
+		}
+		players += std::to_string(steamID64);
+	}
+	// The public API does not document a batch route yet, so it is off (empty) unless the server config sets one.
+	std::string url = std::string(KZOptionService::GetOptionStr("apiUrl", "https://api.cs2kz.org"))
+					  + KZOptionService::GetOptionStr("ratingBatchRoute", "");
+	HTTP::Request request(HTTP::Method::GET, url);
+	request.SetQuery("mode", std::to_string(static_cast<u8>(mode)));
+	request.SetQuery("players", players);
+	if (kz_profile_debug.GetBool())
+	{
+		META_CONPRINTF("[KZ::Profile] Requesting ratings for %u players in mode %d.\n", (u32)steamIDs.size(), static_cast<u8>(mode));
+	}
+	auto callback = [steamIDs, mode](HTTP::Response response)
+	{
+		RatingBatchResponse batch;
+		if (response.status != 200 || !JsonDecode(response.Body().value_or(""), batch))
 		{
+			// Fall back to one request per player. Only stop batching if the route does not exist, other failures can be transient.
 			if (kz_profile_debug.GetBool())
 			{
-				META_CONPRINTF("[KZ::Profile] Player %s mode changed since request, ignoring response.\n", player->GetName());
+				META_CONPRINTF("[KZ::Profile] Batched rating request failed (status %d), requesting players one by one.\n", response.status);
+			}
+			if (response.status == 404 || response.status == 405)
+			{
+				ratingBatchSupported = false;
+			}
+			for (u64 steamID64 : steamIDs)
+			{
+				SendRatingRequest(steamID64, mode);
 			}
 			return;
 		}
-		Json json(response.Body().value_or(""));
+		for (const RatingBatchResponse::Profile &profile : batch.values)
+		{
+			ApplyRating(profile.id, mode, profile.rating);
+		}
+	};
+	request.Send(callback);
+}
 
-		if (!json.Get("rating", player->profileService->currentRating))
+static_function void QueueRatingRequest(u64 steamID64, KZ::API::Mode mode)
+{
+	FOR_EACH_VEC(pendingRatingRequests, i)
+	{
+		if (pendingRatingRequests[i].steamID64 == steamID64)
 		{
-			if (kz_profile_debug.GetBool())
+			pendingRatingRequests[i].mode = mode;
+			return;
+		}
+	}
+	if (pendingRatingRequests.Count() == 0)
+	{
+		ratingBatchDeadline = g_pKZUtils->GetServerGlobals()->realtime + RATING_BATCH_WINDOW;
+	}
+	pendingRatingRequests.AddToTail({steamID64, mode});
+}
+
+static_function void FlushRatingRequests()
+{
+	if (pendingRatingRequests.Count() == 0 || g_pKZUtils->GetServerGlobals()->realtime < ratingBatchDeadline)
+	{
+		return;
+	}
+
+	std::vector<u64> steamIDs;
+	while (pendingRatingRequests.Count() > 0)
+	{
+		KZ::API::Mode mode = pendingRatingRequests[0].mode;
+		steamIDs.clear();
+		FOR_EACH_VEC_BACK(pendingRatingRequests, i)
+		{
+			if (pendingRatingRequests[i].mode == mode)
 			{
-				META_CONPRINTF("[KZ::Profile] Failed to parse rating from response for player %s.\n", player->GetName());
+				steamIDs.push_back(pendingRatingRequests[i].steamID64);
+				pendingRatingRequests.Remove(i);
 			}
-			return;
 		}
+		if (steamIDs.size() == 1 || !ratingBatchSupported || KZ_STREQ(KZOptionService::GetOptionStr("ratingBatchRoute", ""), ""))
+		{
+			for (u64 steamID64 : steamIDs)
+			{
+				SendRatingRequest(steamID64, mode);
+			}
+		}
+		else
+		{
+			SendRatingBatchRequest(mode, steamIDs);
+		}
+	}
+}
+
+void KZProfileService::RequestRating()
+{
+	if (!KZGlobalService::IsAvailable())
+	{
 		if (kz_profile_debug.GetBool())
 		{
-			META_CONPRINTF("[KZ::Profile] Updating rating for player %s: %.2f.\n", player->GetName(), player->profileService->currentRating * 0.1f);
+			META_CONPRINTF("[KZ::Profile] Global service not available, cannot request rating for player %s.\n", this->player->GetName());
 		}
-		player->profileService->UpdateCompetitiveRank();
-		player->profileService->UpdateClantag();
-	};
-	request.Send(callback);
+		return;
+	}
+	if (!this->player->IsAuthenticated() || !this->player->IsConnected())
+	{
+		if (kz_profile_debug.GetBool())
+		{
+			META_CONPRINTF("[KZ::Profile] Player %s not authenticated or not connected, cannot request rating.\n", this->player->GetName());
+		}
+		return;
+	}
+	KZ::API::Mode mode;
+	if (!KZ::API::DecodeModeString(this->player->modeService->GetModeShortName(), mode))
+	{
+		if (kz_profile_debug.GetBool())
+		{
+			META_CONPRINTF("[KZ::Profile] Player %s has invalid mode '%s', cannot request rating.\n", this->player->GetName(),
+						   this->player->modeService->GetModeShortName());
+		}
+		return;
+	}
+	this->desiredMode = static_cast<u8>(mode);
+	u64 steamID64 = this->player->GetSteamId64();
+	if (steamID64 == 0)
+	{
+		if (kz_profile_debug.GetBool())
+		{
+			META_CONPRINTF("[KZ::Profile] Player %s has invalid SteamID, cannot request rating.\n", this->player->GetName());
+		}
+		return;
+	}
+	if (this->player->styleServices.Count() > 0)
+	{
+		if (kz_profile_debug.GetBool())
+		{
+			META_CONPRINTF("[KZ::Profile] Player %s has styles enabled, skipping rating request.\n", this->player->GetName());
+		}
+		return;
+	}
+	this->timeToNextRatingRefresh = g_pKZUtils->GetServerGlobals()->realtime + RATING_REFRESH_PERIOD + RandomFloat(-30.0f, 30.0f);
+	if (kz_profile_debug.GetBool())
+	{
+		META_CONPRINTF("[KZ::Profile] Queueing rating request for player %s (%llu) in mode %d.\n", this->player->GetName(), steamID64,
+					   static_cast<u8>(mode));
+	}
+	QueueRatingRequest(steamID64, mode);
 }
 
 bool KZProfileService::CanDisplayRank()
@@ -214,6 +377,7 @@ void KZProfileService::UpdateClantag()
 		}
 		return;
 	}
+	char newClanTag[sizeof(this->clanTag)];
 	if (this->CanDisplayRank())
 	{
 		i32 rank = Ranks::Unknown;
@@ -225,19 +389,21 @@ void KZProfileService::UpdateClantag()
 				break;
 			}
 		}
-		V_snprintf(this->clanTag, sizeof(this->clanTag), "[%s %s]", this->player->modeService->GetModeShortName(), rankNames[rank]);
+		V_snprintf(newClanTag, sizeof(newClanTag), "[%s %s]", this->player->modeService->GetModeShortName(), rankNames[rank]);
 	}
 	else
 	{
-		V_snprintf(this->clanTag, sizeof(this->clanTag), "[%s%s]", this->player->modeService->GetModeShortName(),
+		V_snprintf(newClanTag, sizeof(newClanTag), "[%s%s]", this->player->modeService->GetModeShortName(),
 				   this->player->styleServices.Count() > 0 ? "*" : "");
 	}
 
-	if (this->clanTag[0] == '\0')
+	// Only touch the networked clan tag if it actually changed. Compare against the controller, other plugins may have set it since.
+	CCSPlayerController *controller = this->player->GetController();
+	if (newClanTag[0] == '\0' || (controller && KZ_STREQ(newClanTag, controller->m_szClan().String())))
 	{
 		return;
 	}
-	this->SetClantag(this->clanTag);
+	this->SetClantag(newClanTag);
 }
 
 void KZProfileService::OnPhysicsSimulatePost()
@@ -255,8 +421,16 @@ void KZProfileService::UpdateCompetitiveRank()
 		return;
 	}
 	i32 rating = this->CanDisplayRank() ? static_cast<i32>(floor(this->currentRating * 0.1f)) : 0;
+	// The controller resets these on its own (e.g. on reconnect), so compare against what is actually networked.
+	if (rating == this->displayedRanking && rating == this->player->GetController()->m_iCompetitiveRanking()
+		&& this->player->GetController()->m_iCompetitiveRankType() == 11)
+	{
+		return;
+	}
+	this->displayedRanking = rating;
 	this->player->GetController()->m_iCompetitiveRankType(11);
 	this->player->GetController()->m_iCompetitiveRanking(rating);
+	rankRevealPending = true;
 }
 
 std::string KZProfileService::GetPrefix(bool colors)
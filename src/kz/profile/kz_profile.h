@@ -16,12 +16,15 @@ public:
 		desiredMode = 0;
 		timeToNextRatingRefresh = 0.0f;
 		currentRating = -1.0f;
+		displayedRanking = -1;
 	}
 
 	char clanTag[32] {};
 	u8 desiredMode {};
 	f32 timeToNextRatingRefresh = 0.0f;
 	f64 currentRating = -1.0f;
+	// Ranking last written to the controller, -1 if it has to be written again.
+	i32 displayedRanking = -1;
 
 	void RequestRating();
 	bool CanDisplayRank();
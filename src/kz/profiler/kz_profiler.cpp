@@ -0,0 +1,711 @@
+#include "kz_profiler.h"
+#include "kz/kz.h"
+#include "filesystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "tier0/memdbgon.h"
+
+#define KZ_PROFILE_PATH "kzprofiles"
+
+using namespace KZ::profiler;
+
+// Log-linear buckets with 4 sub-buckets per power of two, giving a worst case error of 25% over the whole u64 range.
+static_global constexpr u32 HISTOGRAM_SUB_BITS = 2;
+static_global constexpr u32 HISTOGRAM_SUB_COUNT = 1 << HISTOGRAM_SUB_BITS;
+static_global constexpr u32 HISTOGRAM_BUCKETS = (64 - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_COUNT;
+
+// Trace events per thread, the oldest ones get overwritten.
+static_global constexpr u32 TRACE_CAPACITY = 1 << 16;
+
+static_function u32 HighestBit(u64 value)
+{
+#ifdef _WIN32
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return (u32)index;
+#else
+	return 63 - (u32)__builtin_clzll(value);
+#endif
+}
+
+static_function u32 BucketIndex(u64 value)
+{
+	if (value < HISTOGRAM_SUB_COUNT)
+	{
+		return (u32)value;
+	}
+	u32 exponent = HighestBit(value);
+	u32 sub = (u32)(value >> (exponent - HISTOGRAM_SUB_BITS)) & (HISTOGRAM_SUB_COUNT - 1);
+	return (exponent - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_COUNT + sub;
+}
+
+// Largest value that falls in the bucket.
+static_function u64 BucketUpperBound(u32 index)
+{
+	if (index < HISTOGRAM_SUB_COUNT)
+	{
+		return index;
+	}
+	u32 exponent = index / HISTOGRAM_SUB_COUNT + HISTOGRAM_SUB_BITS - 1;
+	u64 sub = index % HISTOGRAM_SUB_COUNT;
+	u64 shift = exponent - HISTOGRAM_SUB_BITS;
+	return ((HISTOGRAM_SUB_COUNT + sub + 1) << shift) - 1;
+}
+
+// Only the owning thread writes, so relaxed load/store pairs are enough and other threads can still read it without tearing.
+struct Histogram
+{
+	std::atomic<u32> buckets[HISTOGRAM_BUCKETS];
+	std::atomic<u64> count;
+	std::atomic<u64> total;
+	std::atomic<u64> max;
+
+	void Clear()
+	{
+		for (auto &bucket : buckets)
+		{
+			bucket.store(0, std::memory_order_relaxed);
+		}
+		count.store(0, std::memory_order_relaxed);
+		total.store(0, std::memory_order_relaxed);
+		max.store(0, std::memory_order_relaxed);
+	}
+
+	void Add(u64 value)
+	{
+		auto &bucket = buckets[BucketIndex(value)];
+		bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		total.store(total.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		if (value > max.load(std::memory_order_relaxed))
+		{
+			max.store(value, std::memory_order_relaxed);
+		}
+	}
+};
+
+// Merged view of the histograms of every thread.
+struct HistogramSnapshot
+{
+	u64 buckets[HISTOGRAM_BUCKETS] {};
+	u64 count {};
+	u64 total {};
+	u64 max {};
+
+	void Merge(const Histogram &histogram)
+	{
+		for (u32 i = 0; i < HISTOGRAM_BUCKETS; i++)
+		{
+			buckets[i] += histogram.buckets[i].load(std::memory_order_relaxed);
+		}
+		count += histogram.count.load(std::memory_order_relaxed);
+		total += histogram.total.load(std::memory_order_relaxed);
+		max = std::max(max, histogram.max.load(std::memory_order_relaxed));
+	}
+
+	u64 Percentile(f64 percentile) const
+	{
+		if (count == 0)
+		{
+			return 0;
+		}
+		u64 target = (u64)(percentile * (count - 1)) + 1;
+		u64 seen = 0;
+		for (u32 i = 0; i < HISTOGRAM_BUCKETS; i++)
+		{
+			seen += buckets[i];
+			if (seen >= target)
+			{
+				return std::min(BucketUpperBound(i), max);
+			}
+		}
+		return max;
+	}
+};
+
+struct TraceEvent
+{
+	u64 start;
+	u64 duration;
+	SectionID section;
+	i16 slot;
+};
+
+struct ThreadData
+{
+	std::atomic<u32> generation;
+	u32 threadIndex {};
+	Histogram sections[MAX_SECTIONS];
+	Histogram players[MAXPLAYERS];
+	// Cost accumulated by each player during the current tick.
+	u64 tickCost[MAXPLAYERS];
+	std::unique_ptr<TraceEvent[]> traceEvents;
+	std::atomic<u64> traceCount;
+
+	void Clear()
+	{
+		for (auto &histogram : sections)
+		{
+			histogram.Clear();
+		}
+		for (auto &histogram : players)
+		{
+			histogram.Clear();
+		}
+		memset(tickCost, 0, sizeof(tickCost));
+		traceCount.store(0, std::memory_order_relaxed);
+	}
+};
+
+struct SectionInfo
+{
+	std::string service;
+	std::string callback;
+};
+
+static_global std::mutex registryMutex;
+static_global std::vector<SectionInfo> sectionInfos;
+static_global std::vector<std::unique_ptr<ThreadData>> threadDatas;
+static_global thread_local ThreadData *localThreadData;
+
+// Bumped on every start, threads lazily clear their own data when they notice.
+static_global std::atomic<u32> generation = 0;
+static_global u64 startTimestamp;
+static_global f64 startTime;
+static_global u64 stopTimestamp;
+static_global f64 stopTime;
+// Game frames seen while profiling, section costs are compared per tick so runs of different length can be compared.
+static_global u64 profiledTicks;
+
+static_function ThreadData *GetThreadData()
+{
+	if (!localThreadData)
+	{
+		std::lock_guard lock(registryMutex);
+		threadDatas.push_back(std::make_unique<ThreadData>());
+		localThreadData = threadDatas.back().get();
+		localThreadData->threadIndex = (u32)threadDatas.size() - 1;
+		localThreadData->generation.store(0, std::memory_order_relaxed);
+		localThreadData->Clear();
+	}
+	u32 currentGeneration = generation.load(std::memory_order_acquire);
+	if (localThreadData->generation.load(std::memory_order_relaxed) != currentGeneration)
+	{
+		localThreadData->Clear();
+		if (tracing && !localThreadData->traceEvents)
+		{
+			localThreadData->traceEvents = std::make_unique<TraceEvent[]>(TRACE_CAPACITY);
+		}
+		localThreadData->generation.store(currentGeneration, std::memory_order_release);
+	}
+	return localThreadData;
+}
+
+SectionID KZ::profiler::RegisterSection(const char *service, const char *callback)
+{
+	std::lock_guard lock(registryMutex);
+	for (u32 i = 0; i < sectionInfos.size(); i++)
+	{
+		if (sectionInfos[i].service == service && sectionInfos[i].callback == callback)
+		{
+			return (SectionID)i;
+		}
+	}
+	if (sectionInfos.size() >= MAX_SECTIONS)
+	{
+		// Share the last section rather than failing, this only costs accuracy.
+		Warning("[KZ::Profiler] Too many profiler sections, %s::%s will be merged into %s::%s.\n", service, callback,
+				sectionInfos.back().service.c_str(), sectionInfos.back().callback.c_str());
+		return (SectionID)(MAX_SECTIONS - 1);
+	}
+	sectionInfos.push_back({service, callback});
+	return (SectionID)(sectionInfos.size() - 1);
+}
+
+void KZ::profiler::Record(SectionID section, i32 slot, u64 start, u64 end)
+{
+	ThreadData *data = GetThreadData();
+	u64 duration = end > start ? end - start : 0;
+	data->sections[section].Add(duration);
+	if (slot >= 0 && slot < MAXPLAYERS)
+	{
+		data->tickCost[slot] += duration;
+	}
+	if (tracing && data->traceEvents)
+	{
+		u64 count = data->traceCount.load(std::memory_order_relaxed);
+		data->traceEvents[count % TRACE_CAPACITY] = {start, duration, section, (i16)slot};
+		data->traceCount.store(count + 1, std::memory_order_release);
+	}
+}
+
+void KZ::profiler::OnGameFrame()
+{
+	if (!enabled)
+	{
+		return;
+	}
+	profiledTicks++;
+	// Player callbacks run on the game thread, so its data holds the whole tick.
+	ThreadData *data = GetThreadData();
+	for (i32 i = 0; i < MAXPLAYERS; i++)
+	{
+		if (data->tickCost[i])
+		{
+			data->players[i].Add(data->tickCost[i]);
+			data->tickCost[i] = 0;
+		}
+	}
+}
+
+static_function f64 GetCyclesPerMicrosecond()
+{
+	u64 endTimestamp = enabled ? ReadTimestamp() : stopTimestamp;
+	f64 endTime = enabled ? Plat_FloatTime() : stopTime;
+	f64 elapsed = endTime - startTime;
+	if (elapsed <= 0.0 || endTimestamp <= startTimestamp)
+	{
+		return 0.0;
+	}
+	return (f64)(endTimestamp - startTimestamp) / (elapsed * 1e6);
+}
+
+static_function void PrintHistogram(const char *name, const HistogramSnapshot &snapshot, f64 cyclesPerMicrosecond)
+{
+	META_CONPRINTF("%-40s %10llu %10.2f %10.2f %10.2f %12.1f\n", name, snapshot.count, snapshot.Percentile(0.5) / cyclesPerMicrosecond,
+				   snapshot.Percentile(0.99) / cyclesPerMicrosecond, snapshot.max / cyclesPerMicrosecond, snapshot.total / cyclesPerMicrosecond);
+}
+
+static_function void Start(bool trace)
+{
+	tracing = trace;
+	startTimestamp = ReadTimestamp();
+	startTime = Plat_FloatTime();
+	profiledTicks = 0;
+	generation.fetch_add(1, std::memory_order_release);
+	enabled = true;
+	META_CONPRINTF("[KZ::Profiler] Profiling started%s.\n", trace ? " with tracing" : "");
+}
+
+static_function void Stop()
+{
+	enabled = false;
+	tracing = false;
+	stopTimestamp = ReadTimestamp();
+	stopTime = Plat_FloatTime();
+	META_CONPRINTF("[KZ::Profiler] Profiling stopped after %.2fs.\n", stopTime - startTime);
+}
+
+// Merge the histograms of every thread. The registry mutex must be held.
+static_function void CollectSnapshots(std::vector<std::unique_ptr<HistogramSnapshot>> &sections, std::unique_ptr<HistogramSnapshot> *players)
+{
+	sections.resize(sectionInfos.size());
+	u32 currentGeneration = generation.load(std::memory_order_acquire);
+	for (auto &data : threadDatas)
+	{
+		if (data->generation.load(std::memory_order_acquire) != currentGeneration)
+		{
+			continue;
+		}
+		for (u32 i = 0; i < sections.size(); i++)
+		{
+			if (!data->sections[i].count.load(std::memory_order_relaxed))
+			{
+				continue;
+			}
+			if (!sections[i])
+			{
+				sections[i] = std::make_unique<HistogramSnapshot>();
+			}
+			sections[i]->Merge(data->sections[i]);
+		}
+		for (u32 i = 0; i < MAXPLAYERS && players; i++)
+		{
+			if (!data->players[i].count.load(std::memory_order_relaxed))
+			{
+				continue;
+			}
+			if (!players[i])
+			{
+				players[i] = std::make_unique<HistogramSnapshot>();
+			}
+			players[i]->Merge(data->players[i]);
+		}
+	}
+}
+
+static_function void Dump(u32 maxRows)
+{
+	f64 cyclesPerMicrosecond = GetCyclesPerMicrosecond();
+	if (cyclesPerMicrosecond <= 0.0)
+	{
+		META_CONPRINTF("[KZ::Profiler] No samples collected yet.\n");
+		return;
+	}
+
+	std::lock_guard lock(registryMutex);
+	std::vector<std::unique_ptr<HistogramSnapshot>> sections;
+	std::unique_ptr<HistogramSnapshot> players[MAXPLAYERS];
+	CollectSnapshots(sections, players);
+
+	std::vector<u32> order;
+	for (u32 i = 0; i < sections.size(); i++)
+	{
+		if (sections[i])
+		{
+			order.push_back(i);
+		}
+	}
+	std::sort(order.begin(), order.end(), [&](u32 a, u32 b) { return sections[a]->total > sections[b]->total; });
+
+	META_CONPRINTF("[KZ::Profiler] Sections (microseconds, sorted by total):\n");
+	META_CONPRINTF("%-40s %10s %10s %10s %10s %12s\n", "Section", "Calls", "p50", "p99", "Max", "Total");
+	for (u32 i = 0; i < order.size() && i < maxRows; i++)
+	{
+		char name[128];
+		V_snprintf(name, sizeof(name), "%s::%s", sectionInfos[order[i]].service.c_str(), sectionInfos[order[i]].callback.c_str());
+		PrintHistogram(name, *sections[order[i]], cyclesPerMicrosecond);
+	}
+
+	META_CONPRINTF("[KZ::Profiler] Players (microseconds per tick):\n");
+	META_CONPRINTF("%-40s %10s %10s %10s %10s %12s\n", "Player", "Ticks", "p50", "p99", "Max", "Total");
+	for (u32 i = 0; i < MAXPLAYERS; i++)
+	{
+		if (!players[i])
+		{
+			continue;
+		}
+		char name[128];
+		KZPlayer *player = g_pKZPlayerManager->ToPlayer(CPlayerSlot(i));
+		V_snprintf(name, sizeof(name), "%u %s", i, player && player->IsConnected() ? player->GetName() : "<disconnected>");
+		PrintHistogram(name, *players[i], cyclesPerMicrosecond);
+	}
+}
+
+// Output names are plain file names inside KZ_PROFILE_PATH, they must not be able to point anywhere else.
+static_function bool IsValidOutputName(const char *name)
+{
+	if (!name[0] || V_strstr(name, ".."))
+	{
+		return false;
+	}
+	// ':' covers drive letters, which would make the path absolute on Windows.
+	for (const char *c = name; *c; c++)
+	{
+		if (*c == '/' || *c == '\\' || *c == ':')
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static_function bool ExportTrace(const char *fileName)
+{
+	f64 cyclesPerMicrosecond = GetCyclesPerMicrosecond();
+	if (cyclesPerMicrosecond <= 0.0)
+	{
+		META_CONPRINTF("[KZ::Profiler] No samples collected yet.\n");
+		return false;
+	}
+
+	// Chrome trace event format, each player gets its own track.
+	std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+	char buffer[512];
+	std::lock_guard lock(registryMutex);
+	u32 currentGeneration = generation.load(std::memory_order_acquire);
+	for (auto &data : threadDatas)
+	{
+		if (data->generation.load(std::memory_order_acquire) != currentGeneration || !data->traceEvents)
+		{
+			continue;
+		}
+		u64 count = data->traceCount.load(std::memory_order_acquire);
+		u64 begin = count > TRACE_CAPACITY ? count - TRACE_CAPACITY : 0;
+		for (u64 i = begin; i < count; i++)
+		{
+			const TraceEvent &event = data->traceEvents[i % TRACE_CAPACITY];
+			const SectionInfo &info = sectionInfos[event.section];
+			V_snprintf(buffer, sizeof(buffer), "%s{\"name\":\"%s::%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%u,\"tid\":%d}",
+					   first ? "" : ",", info.service.c_str(), info.callback.c_str(), info.service.c_str(),
+					   (event.start - startTimestamp) / cyclesPerMicrosecond, event.duration / cyclesPerMicrosecond, data->threadIndex, event.slot);
+			json += buffer;
+			first = false;
+		}
+	}
+	json += "]}";
+
+	char path[512];
+	V_snprintf(path, sizeof(path), "%s/%s.json", KZ_PROFILE_PATH, fileName);
+	g_pFullFileSystem->CreateDirHierarchy(KZ_PROFILE_PATH, "GAME");
+	FileHandle_t file = g_pFullFileSystem->Open(path, "wb", "GAME");
+	if (!file)
+	{
+		META_CONPRINTF("[KZ::Profiler] Failed to open %s for writing.\n", path);
+		return false;
+	}
+	g_pFullFileSystem->Write(json.data(), (i32)json.size(), file);
+	g_pFullFileSystem->Close(file);
+	META_CONPRINTF("[KZ::Profiler] Wrote trace to %s (%u bytes).\n", path, (u32)json.size());
+	return true;
+}
+
+// Baselines keep the cost per tick and the call count of every section, so a run on a new build can be compared against one on the old build.
+// Replaying the same replays on both builds should reach every section the same number of times per tick.
+struct BaselineSection
+{
+	std::string name;
+	u64 calls;
+	f64 totalNs;
+};
+
+static_function void GetBaselinePath(const char *name, char *buffer, u32 size)
+{
+	V_snprintf(buffer, size, "%s/%s.baseline", KZ_PROFILE_PATH, name);
+}
+
+static_function bool SaveBaseline(const char *name)
+{
+	f64 cyclesPerNanosecond = GetCyclesPerMicrosecond() / 1000.0;
+	if (cyclesPerNanosecond <= 0.0 || profiledTicks == 0)
+	{
+		META_CONPRINTF("[KZ::Profiler] No samples collected yet.\n");
+		return false;
+	}
+
+	char line[512];
+	V_snprintf(line, sizeof(line), "ticks %llu\n", profiledTicks);
+	std::string out = line;
+	{
+		std::lock_guard lock(registryMutex);
+		std::vector<std::unique_ptr<HistogramSnapshot>> sections;
+		CollectSnapshots(sections, nullptr);
+		for (u32 i = 0; i < sections.size(); i++)
+		{
+			if (!sections[i])
+			{
+				continue;
+			}
+			V_snprintf(line, sizeof(line), "%s::%s %llu %.1f\n", sectionInfos[i].service.c_str(), sectionInfos[i].callback.c_str(),
+					   sections[i]->count, sections[i]->total / cyclesPerNanosecond);
+			out += line;
+		}
+	}
+
+	char path[512];
+	GetBaselinePath(name, path, sizeof(path));
+	g_pFullFileSystem->CreateDirHierarchy(KZ_PROFILE_PATH, "GAME");
+	FileHandle_t file = g_pFullFileSystem->Open(path, "wb", "GAME");
+	if (!file)
+	{
+		META_CONPRINTF("[KZ::Profiler] Failed to open %s for writing.\n", path);
+		return false;
+	}
+	g_pFullFileSystem->Write(out.data(), (i32)out.size(), file);
+	g_pFullFileSystem->Close(file);
+	META_CONPRINTF("[KZ::Profiler] Wrote baseline of %llu ticks to %s.\n", profiledTicks, path);
+	return true;
+}
+
+static_function bool LoadBaseline(const char *name, u64 &ticks, std::vector<BaselineSection> &sections)
+{
+	char path[512];
+	GetBaselinePath(name, path, sizeof(path));
+	FileHandle_t file = g_pFullFileSystem->Open(path, "rb", "GAME");
+	if (!file)
+	{
+		META_CONPRINTF("[KZ::Profiler] Failed to open %s.\n", path);
+		return false;
+	}
+	std::string contents(g_pFullFileSystem->Size(file), '\0');
+	g_pFullFileSystem->Read(contents.data(), (i32)contents.size(), file);
+	g_pFullFileSystem->Close(file);
+
+	ticks = 0;
+	size_t start = 0;
+	while (start < contents.size())
+	{
+		size_t end = contents.find('\n', start);
+		if (end == std::string::npos)
+		{
+			end = contents.size();
+		}
+		std::string line = contents.substr(start, end - start);
+		start = end + 1;
+
+		char sectionName[256];
+		unsigned long long count;
+		BaselineSection section {};
+		if (sscanf(line.c_str(), "ticks %llu", &count) == 1)
+		{
+			ticks = count;
+			continue;
+		}
+		if (sscanf(line.c_str(), "%255s %llu %lf", sectionName, &count, &section.totalNs) == 3)
+		{
+			section.name = sectionName;
+			section.calls = count;
+			sections.push_back(section);
+		}
+	}
+	if (ticks == 0)
+	{
+		META_CONPRINTF("[KZ::Profiler] %s is not a valid baseline.\n", path);
+		return false;
+	}
+	return true;
+}
+
+static_function void CompareBaseline(const char *name, f64 threshold)
+{
+	f64 cyclesPerNanosecond = GetCyclesPerMicrosecond() / 1000.0;
+	if (cyclesPerNanosecond <= 0.0 || profiledTicks == 0)
+	{
+		META_CONPRINTF("[KZ::Profiler] No samples collected yet.\n");
+		return;
+	}
+	u64 baselineTicks;
+	std::vector<BaselineSection> baseline;
+	if (!LoadBaseline(name, baselineTicks, baseline))
+	{
+		return;
+	}
+
+	std::lock_guard lock(registryMutex);
+	std::vector<std::unique_ptr<HistogramSnapshot>> sections;
+	CollectSnapshots(sections, nullptr);
+
+	u32 slower = 0;
+	u32 callsDiffer = 0;
+	std::vector<bool> matched(baseline.size());
+	META_CONPRINTF("[KZ::Profiler] Compared to %s (nanoseconds per tick, %llu ticks now, %llu in the baseline):\n", name, profiledTicks,
+				   baselineTicks);
+	META_CONPRINTF("%-40s %12s %12s %9s %12s %12s %s\n", "Section", "Baseline", "Now", "Change", "Calls/tick", "Now", "");
+	for (u32 i = 0; i < sections.size(); i++)
+	{
+		if (!sections[i])
+		{
+			continue;
+		}
+		char sectionName[128];
+		V_snprintf(sectionName, sizeof(sectionName), "%s::%s", sectionInfos[i].service.c_str(), sectionInfos[i].callback.c_str());
+		f64 nsPerTick = sections[i]->total / cyclesPerNanosecond / profiledTicks;
+		f64 callsPerTick = (f64)sections[i]->count / profiledTicks;
+
+		const BaselineSection *base = nullptr;
+		for (u32 j = 0; j < baseline.size(); j++)
+		{
+			if (baseline[j].name == sectionName)
+			{
+				base = &baseline[j];
+				matched[j] = true;
+				break;
+			}
+		}
+		if (!base)
+		{
+			META_CONPRINTF("%-40s %12s %12.1f %9s %12s %12.3f %s\n", sectionName, "-", nsPerTick, "-", "-", callsPerTick, "new");
+			callsDiffer++;
+			continue;
+		}
+
+		f64 baseNsPerTick = base->totalNs / baselineTicks;
+		f64 baseCallsPerTick = (f64)base->calls / baselineTicks;
+		f64 change = baseNsPerTick > 0.0 ? (nsPerTick / baseNsPerTick - 1.0) * 100.0 : 0.0;
+		bool isSlower = change > threshold;
+		// Runs don't stop on the exact same tick, allow for a little difference.
+		bool isCallsDiffer = fabs(callsPerTick - baseCallsPerTick) > baseCallsPerTick * 0.01;
+		slower += isSlower;
+		callsDiffer += isCallsDiffer;
+		META_CONPRINTF("%-40s %12.1f %12.1f %8.1f%% %12.3f %12.3f %s%s\n", sectionName, baseNsPerTick, nsPerTick, change, baseCallsPerTick,
+					   callsPerTick, isSlower ? "slower " : "", isCallsDiffer ? "calls" : "");
+	}
+	for (u32 j = 0; j < baseline.size(); j++)
+	{
+		if (!matched[j])
+		{
+			META_CONPRINTF("%-40s %12.1f %12s %9s %12.3f %12s %s\n", baseline[j].name.c_str(), baseline[j].totalNs / baselineTicks, "-", "-",
+						   (f64)baseline[j].calls / baselineTicks, "-", "missing");
+			callsDiffer++;
+		}
+	}
+	META_CONPRINTF("[KZ::Profiler] %u sections are more than %.0f%% slower per tick, %u are reached a different number of times.\n", slower,
+				   threshold, callsDiffer);
+}
+
+CON_COMMAND_F(kz_profile_start, "Start profiling player service callbacks. Pass 'trace' to also collect events for kz_profile_export.", FCVAR_NONE)
+{
+	Start(args.ArgC() >= 2 && !V_stricmp(args.Arg(1), "trace"));
+}
+
+CON_COMMAND_F(kz_profile_stop, "Stop profiling player service callbacks.", FCVAR_NONE)
+{
+	if (!enabled)
+	{
+		META_CONPRINTF("[KZ::Profiler] Profiler is not running.\n");
+		return;
+	}
+	Stop();
+}
+
+CON_COMMAND_F(kz_profile_dump, "Print p50/p99/max cost per service callback and per player. Usage: kz_profile_dump [rows]", FCVAR_NONE)
+{
+	Dump(args.ArgC() >= 2 ? (u32)atoi(args.Arg(1)) : 25);
+}
+
+CON_COMMAND_F(kz_profile_export, "Export collected trace events as Chrome trace JSON. Usage: kz_profile_export <name>", FCVAR_NONE)
+{
+	if (args.ArgC() != 2)
+	{
+		META_CONPRINTF("[KZ::Profiler] Usage: kz_profile_export <name>\n");
+		return;
+	}
+	if (!IsValidOutputName(args.Arg(1)))
+	{
+		META_CONPRINTF("[KZ::Profiler] Invalid name '%s', use a plain file name without path separators.\n", args.Arg(1));
+		return;
+	}
+	if (enabled)
+	{
+		META_CONPRINTF("[KZ::Profiler] Stop the profiler with kz_profile_stop before exporting.\n");
+		return;
+	}
+	ExportTrace(args.Arg(1));
+}
+
+CON_COMMAND_F(kz_profile_save, "Save the cost per tick and call count of every section as a baseline. Usage: kz_profile_save <name>", FCVAR_NONE)
+{
+	if (args.ArgC() != 2)
+	{
+		META_CONPRINTF("[KZ::Profiler] Usage: kz_profile_save <name>\n");
+		return;
+	}
+	if (!IsValidOutputName(args.Arg(1)))
+	{
+		META_CONPRINTF("[KZ::Profiler] Invalid name '%s', use a plain file name without path separators.\n", args.Arg(1));
+		return;
+	}
+	SaveBaseline(args.Arg(1));
+}
+
+CON_COMMAND_F(kz_profile_compare, "Compare the current samples against a saved baseline. Usage: kz_profile_compare <name> [threshold]", FCVAR_NONE)
+{
+	if (args.ArgC() < 2)
+	{
+		META_CONPRINTF("[KZ::Profiler] Usage: kz_profile_compare <name> [threshold percent]\n");
+		return;
+	}
+	if (!IsValidOutputName(args.Arg(1)))
+	{
+		META_CONPRINTF("[KZ::Profiler] Invalid name '%s', use a plain file name without path separators.\n", args.Arg(1));
+		return;
+	}
+	CompareBaseline(args.Arg(1), args.ArgC() >= 3 ? atof(args.Arg(2)) : 10.0);
+}
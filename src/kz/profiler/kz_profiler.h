@@ -0,0 +1,83 @@
+#pragma once
+#include "common.h"
+
+#ifdef _WIN32
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+// Sampling profiler for the per-player service callbacks.
+// Disabled by default, a disabled scope costs a single branch. Samples are stored in per-thread histograms so recording never takes a lock.
+namespace KZ::profiler
+{
+	// Sections are identified by a small index, registered once per call site.
+	using SectionID = u16;
+	inline constexpr u32 MAX_SECTIONS = 256;
+
+	inline bool enabled = false;
+	inline bool tracing = false;
+
+	SectionID RegisterSection(const char *service, const char *callback);
+
+	void Record(SectionID section, i32 slot, u64 start, u64 end);
+
+	inline u64 ReadTimestamp()
+	{
+		return __rdtsc();
+	}
+
+	// Flush the per-tick cost of every player into their histogram.
+	void OnGameFrame();
+
+	class Scope
+	{
+	public:
+		Scope() = default;
+
+		// Only called while the profiler is enabled, an idle scope records nothing.
+		void Start(SectionID section, i32 slot)
+		{
+			this->section = section;
+			this->slot = slot;
+			this->start = ReadTimestamp();
+		}
+
+		~Scope()
+		{
+			if (this->start)
+			{
+				Record(this->section, this->slot, this->start, ReadTimestamp());
+			}
+		}
+
+		Scope(const Scope &) = delete;
+		Scope &operator=(const Scope &) = delete;
+
+	private:
+		SectionID section {};
+		i32 slot {};
+		u64 start {};
+	};
+} // namespace KZ::profiler
+
+#define KZ_PROFILE_CONCAT_INNER(a, b) a##b
+#define KZ_PROFILE_CONCAT(a, b)       KZ_PROFILE_CONCAT_INNER(a, b)
+
+// Time the enclosing scope as <service>::<current function> for this player.
+// Nothing but the enabled check runs while the profiler is off, the section is registered the first time it is profiled.
+#define KZ_PROFILE_SCOPE(player, service) \
+	KZ::profiler::Scope KZ_PROFILE_CONCAT(kzProfileScope, __LINE__); \
+	if (KZ::profiler::enabled) \
+	{ \
+		static_persist const KZ::profiler::SectionID kzProfileSection = KZ::profiler::RegisterSection(service, __func__); \
+		KZ_PROFILE_CONCAT(kzProfileScope, __LINE__).Start(kzProfileSection, (player)->GetPlayerSlot().Get()); \
+	}
+
+// Time a single statement as <service>::<current function> for this player.
+#define KZ_PROFILE(player, service, ...) \
+	do \
+	{ \
+		KZ_PROFILE_SCOPE(player, service); \
+		__VA_ARGS__; \
+	} while (0)
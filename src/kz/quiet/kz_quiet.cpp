@@ -123,12 +123,12 @@ void KZ::quiet::OnCheckTransmit(CCheckTransmitInfo **pInfo, int infoCount)
 
 static void FilterQuietClients(const uint64 *clients, u32 emitterPlayerIndex = 0)
 {
-	for (i32 recipientPlayerIndex = 1; recipientPlayerIndex < MAXPLAYERS + 1; recipientPlayerIndex++)
+	FOR_EACH_VEC(g_pKZPlayerManager->activePlayers, i)
 	{
-		KZPlayer *recipient = g_pKZPlayerManager->ToPlayer(recipientPlayerIndex);
+		KZPlayer *recipient = g_pKZPlayerManager->ToKZPlayer(g_pKZPlayerManager->activePlayers[i]);
 		if (recipient->quietService->ShouldHide() && (emitterPlayerIndex == 0 || recipient->quietService->ShouldHideIndex(emitterPlayerIndex)))
 		{
-			*(uint64 *)clients &= ~(1ull << (recipientPlayerIndex - 1));
+			*(uint64 *)clients &= ~(1ull << (recipient->index - 1));
 		}
 	}
 }
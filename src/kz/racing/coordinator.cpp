@@ -119,7 +119,6 @@ void KZRacingService::OnActivateServer()
 
 void KZRacingService::OnServerGamePostSimulate()
 {
-	KZRacingService::ProcessMainThreadCallbacks();
 	if (KZRacingService::currentRace.spec.maxDurationSeconds > 0
 		&& (KZRacingService::currentRace.earliestStartTick + KZRacingService::currentRace.spec.maxDurationSeconds * ENGINE_FIXED_TICK_RATE
 				<= g_pKZUtils->GetServerGlobals()->tickcount
@@ -131,22 +130,6 @@ void KZRacingService::OnServerGamePostSimulate()
 	}
 }
 
-void KZRacingService::ProcessMainThreadCallbacks()
-{
-	{
-		std::lock_guard _guard(KZRacingService::mainThreadCallbacks.mutex);
-		if (!KZRacingService::mainThreadCallbacks.queue.empty())
-		{
-			META_CONPRINTF("[KZ::Racing] Running callbacks...\n");
-			for (const std::function<void()> &callback : KZRacingService::mainThreadCallbacks.queue)
-			{
-				callback();
-			}
-			KZRacingService::mainThreadCallbacks.queue.clear();
-		}
-	}
-}
-
 void KZRacingService::OnWebSocketMessage(const ix::WebSocketMessagePtr &message)
 {
 	switch (message->type)
@@ -173,139 +156,113 @@ void KZRacingService::OnWebSocketMessage(const ix::WebSocketMessagePtr &message)
 				   "\n----------------------------------------\n",
 				   message->str.c_str());
 
-	Json payload(message->str);
-
-	if (!payload.IsValid())
-	{
-		META_CONPRINTF("[KZ::Racing] Incoming WebSocket message is not valid JSON.\n");
-		return;
-	}
-
 	switch (KZRacingService::state.load())
 	{
 		case KZRacingService::State::Connected:
 		{
+			// The event decides which type `data` is decoded into, so it is read on its own first.
 			std::string event;
-			if (!payload.Get("event", event))
+			if (!JsonDecodeField(message->str, "event", event))
 			{
 				META_CONPRINTF("[KZ::Racing] Incoming WebSocket message did not contain a valid `event` field.\n");
 				break;
 			}
 
-			Json data;
-			if (!payload.Get("data", data))
-			{
-				META_CONPRINTF("[KZ::Racing] Incoming WebSocket message did not contain a valid `data` field.\n");
-				break;
-			}
-
 			// Dispatch based on event type
 			if (event == "chat_message")
 			{
 				KZ::racing::events::ChatMessage event;
-				if (event.FromJson(data))
+				if (JsonDecodeField(message->str, "data", event))
 				{
-					std::lock_guard _guard(KZRacingService::mainThreadCallbacks.mutex);
-					KZRacingService::mainThreadCallbacks.queue.emplace_back([event]() { KZRacingService::OnChatMessage(event); });
+					KZRacingService::AddMainThreadCallback([event]() { KZRacingService::OnChatMessage(event); });
 				}
 			}
 			else if (event == "race_initialized")
 			{
 				KZ::racing::events::RaceInitialized event;
-				if (event.FromJson(data))
+				if (JsonDecodeField(message->str, "data", event))
 				{
-					std::lock_guard _guard(KZRacingService::mainThreadCallbacks.mutex);
-					KZRacingService::mainThreadCallbacks.queue.emplace_back([event]() { KZRacingService::OnRaceInitialized(event); });
+					KZRacingService::AddMainThreadCallback([event]() { KZRacingService::OnRaceInitialized(event); });
 				}
 			}
 			else if (event == "server_join_race")
 			{
 				KZ::racing::events::ServerJoinRace event;
-				if (event.FromJson(data))
+				if (JsonDecodeField(message->str, "data", event))
 				{
-					std::lock_guard _guard(KZRacingService::mainThreadCallbacks.mutex);
-					KZRacingService::mainThreadCallbacks.queue.emplace_back([event]() { KZRacingService::OnServerJoinRace(event); });
+					KZRacingService::AddMainThreadCallback([event]() { KZRacingService::OnServerJoinRace(event); });
 				}
 			}
 			else if (event == "server_leave_race")
 			{
 				KZ::racing::events::ServerLeaveRace event;
-				if (event.FromJson(data))
+				if (JsonDecodeField(message->str, "data", event))
 				{
-					std::lock_guard _guard(KZRacingService::mainThreadCallbacks.mutex);
-					KZRacingService::mainThreadCallbacks.queue.emplace_back([event]() { KZRacingService::OnServerLeaveRace(event); });
+					KZRacingService::AddMainThreadCallback([event]() { KZRacingService::OnServerLeaveRace(event); });
 				}
 			}
 			else if (event == "player_join_race")
 			{
 				KZ::racing::events::PlayerJoinRace event;
-				if (event.FromJson(data))
+				if (JsonDecodeField(message->str, "data", event))
 				{
-					std::lock_guard _guard(KZRacingService::mainThreadCallbacks.mutex);
-					KZRacingService::mainThreadCallbacks.queue.emplace_back([event]() { KZRacingService::OnPlayerJoinRace(event); });
+					KZRacingService::AddMainThreadCallback([event]() { KZRacingService::OnPlayerJoinRace(event); });
 				}
 			}
 			else if (event == "player_leave_race")
 			{
 				KZ::racing::events::PlayerLeaveRace event;
-				if (event.FromJson(data))
+				if (JsonDecodeField(message->str, "data", event))
 				{
-					std::lock_guard _guard(KZRacingService::mainThreadCallbacks.mutex);
-					KZRacingService::mainThreadCallbacks.queue.emplace_back([event]() { KZRacingService::OnPlayerLeaveRace(event); });
+					KZRacingService::AddMainThreadCallback([event]() { KZRacingService::OnPlayerLeaveRace(event); });
 				}
 			}
 			else if (event == "start_race")
 			{
 				KZ::racing::events::StartRace event;
-				if (event.FromJson(data))
+				if (JsonDecodeField(message->str, "data", event))
 				{
-					std::lock_guard _guard(KZRacingService::mainThreadCallbacks.mutex);
-					KZRacingService::mainThreadCallbacks.queue.emplace_back([event]() { KZRacingService::OnStartRace(event); });
+					KZRacingService::AddMainThreadCallback([event]() { KZRacingService::OnStartRace(event); });
 				}
 			}
 			else if (event == "player_finish")
 			{
 				KZ::racing::events::PlayerFinish event;
-				if (event.FromJson(data))
+				if (JsonDecodeField(message->str, "data", event))
 				{
-					std::lock_guard _guard(KZRacingService::mainThreadCallbacks.mutex);
-					KZRacingService::mainThreadCallbacks.queue.emplace_back([event]() { KZRacingService::OnPlayerFinish(event); });
+					KZRacingService::AddMainThreadCallback([event]() { KZRacingService::OnPlayerFinish(event); });
 				}
 			}
 			else if (event == "player_disconnect")
 			{
 				KZ::racing::events::PlayerDisconnect event;
-				if (event.FromJson(data))
+				if (JsonDecodeField(message->str, "data", event))
 				{
-					std::lock_guard _guard(KZRacingService::mainThreadCallbacks.mutex);
-					KZRacingService::mainThreadCallbacks.queue.emplace_back([event]() { KZRacingService::OnPlayerDisconnect(event); });
+					KZRacingService::AddMainThreadCallback([event]() { KZRacingService::OnPlayerDisconnect(event); });
 				}
 			}
 			else if (event == "player_surrender")
 			{
 				KZ::racing::events::PlayerSurrender event;
-				if (event.FromJson(data))
+				if (JsonDecodeField(message->str, "data", event))
 				{
-					std::lock_guard _guard(KZRacingService::mainThreadCallbacks.mutex);
-					KZRacingService::mainThreadCallbacks.queue.emplace_back([event]() { KZRacingService::OnPlayerSurrender(event); });
+					KZRacingService::AddMainThreadCallback([event]() { KZRacingService::OnPlayerSurrender(event); });
 				}
 			}
 			else if (event == "race_finished")
 			{
 				KZ::racing::events::RaceFinished event;
-				if (event.FromJson(data))
+				if (JsonDecodeField(message->str, "data", event))
 				{
-					std::lock_guard _guard(KZRacingService::mainThreadCallbacks.mutex);
-					KZRacingService::mainThreadCallbacks.queue.emplace_back([event]() { KZRacingService::OnRaceFinished(event); });
+					KZRacingService::AddMainThreadCallback([event]() { KZRacingService::OnRaceFinished(event); });
 				}
 			}
 			else if (event == "race_cancelled")
 			{
 				KZ::racing::events::RaceCancelled event;
-				if (event.FromJson(data))
+				if (JsonDecodeField(message->str, "data", event))
 				{
-					std::lock_guard _guard(KZRacingService::mainThreadCallbacks.mutex);
-					KZRacingService::mainThreadCallbacks.queue.emplace_back([event]() { KZRacingService::OnRaceCancelled(event); });
+					KZRacingService::AddMainThreadCallback([event]() { KZRacingService::OnRaceCancelled(event); });
 				}
 			}
 			else
@@ -1,5 +1,6 @@
 #pragma once
 #include "../kz.h"
+#include "utils/executor.h"
 #include "utils/json.h"
 #include "public/steam/isteamugc.h"
 #include <vendor/ixwebsocket/ixwebsocket/IXWebSocket.h>
@@ -11,8 +12,8 @@ namespace KZ::racing
 		u64 id {};
 		std::string name {};
 
-		bool ToJson(Json &json) const;
-		bool FromJson(const Json &json);
+		bool ToJson(JsonWriter &json) const;
+		static const JsonFieldTable &JsonFields();
 	};
 
 	struct RaceSpec
@@ -23,8 +24,8 @@ namespace KZ::racing
 		f64 maxDurationSeconds;
 		u32 maxTeleports;
 
-		bool ToJson(Json &json) const;
-		bool FromJson(const Json &json);
+		bool ToJson(JsonWriter &json) const;
+		static const JsonFieldTable &JsonFields();
 	};
 
 	namespace events
@@ -34,20 +35,20 @@ namespace KZ::racing
 			PlayerInfo player;
 			std::string content;
 
-			bool ToJson(Json &json) const;
-			bool FromJson(const Json &json);
+			bool ToJson(JsonWriter &json) const;
+			static const JsonFieldTable &JsonFields();
 		};
 
 		struct RaceInitialized
 		{
 			RaceSpec spec;
 
-			bool FromJson(const Json &json);
+			static const JsonFieldTable &JsonFields();
 		};
 
 		struct Ready
 		{
-			bool ToJson(Json &json) const
+			bool ToJson(JsonWriter &json) const
 			{
 				return true;
 			}
@@ -57,12 +58,12 @@ namespace KZ::racing
 		{
 			std::string name;
 
-			bool FromJson(const Json &json);
+			static const JsonFieldTable &JsonFields();
 		};
 
 		struct Unready
 		{
-			bool ToJson(Json &json) const
+			bool ToJson(JsonWriter &json) const
 			{
 				return true;
 			}
@@ -72,30 +73,30 @@ namespace KZ::racing
 		{
 			std::string name;
 
-			bool FromJson(const Json &json);
+			static const JsonFieldTable &JsonFields();
 		};
 
 		struct PlayerJoinRace
 		{
 			PlayerInfo player;
 
-			bool ToJson(Json &json) const;
-			bool FromJson(const Json &json);
+			bool ToJson(JsonWriter &json) const;
+			static const JsonFieldTable &JsonFields();
 		};
 
 		struct PlayerLeaveRace
 		{
 			PlayerInfo player;
 
-			bool ToJson(Json &json) const;
-			bool FromJson(const Json &json);
+			bool ToJson(JsonWriter &json) const;
+			static const JsonFieldTable &JsonFields();
 		};
 
 		struct StartRace
 		{
 			f64 countdownSeconds;
 
-			bool FromJson(const Json &json);
+			static const JsonFieldTable &JsonFields();
 		};
 
 		struct PlayerFinish
@@ -104,24 +105,24 @@ namespace KZ::racing
 			u32 teleports;
 			f64 timeSeconds;
 
-			bool ToJson(Json &json) const;
-			bool FromJson(const Json &json);
+			bool ToJson(JsonWriter &json) const;
+			static const JsonFieldTable &JsonFields();
 		};
 
 		struct PlayerDisconnect
 		{
 			PlayerInfo player;
 
-			bool ToJson(Json &json) const;
-			bool FromJson(const Json &json);
+			bool ToJson(JsonWriter &json) const;
+			static const JsonFieldTable &JsonFields();
 		};
 
 		struct PlayerSurrender
 		{
 			PlayerInfo player;
 
-			bool ToJson(Json &json) const;
-			bool FromJson(const Json &json);
+			bool ToJson(JsonWriter &json) const;
+			static const JsonFieldTable &JsonFields();
 		};
 
 		struct RaceResults
@@ -144,29 +145,29 @@ namespace KZ::racing
 				u32 teleports;
 				f64 timeSeconds;
 
-				bool FromJson(const Json &json);
+				static const JsonFieldTable &JsonFields();
 			};
 
 			std::vector<Participant> participants;
 
-			bool FromJson(const Json &json);
+			static const JsonFieldTable &JsonFields();
 		};
 
 		struct RaceFinished
 		{
 			RaceResults results;
 
-			bool ToJson(Json &json) const
+			bool ToJson(JsonWriter &json) const
 			{
 				return true;
 			}
 
-			bool FromJson(const Json &json);
+			static const JsonFieldTable &JsonFields();
 		};
 
 		struct CancelRace
 		{
-			bool ToJson(Json &json) const
+			bool ToJson(JsonWriter &json) const
 			{
 				return true;
 			}
@@ -174,9 +175,10 @@ namespace KZ::racing
 
 		struct RaceCancelled
 		{
-			bool FromJson(const Json &json)
+			static const JsonFieldTable &JsonFields()
 			{
-				return true;
+				static_persist constexpr JsonFieldTable table;
+				return table;
 			}
 		};
 
@@ -271,12 +273,6 @@ public:
 	static void OnPlayerDisconnect(const KZ::racing::events::PlayerDisconnect &message);
 	static void OnPlayerSurrender(const KZ::racing::events::PlayerSurrender &message);
 
-	/**
-	 * Process queued callbacks on the main thread.
-	 * Should be called every frame from the game loop.
-	 */
-	static void ProcessMainThreadCallbacks();
-
 private:
 	/**
 	 * Helper function called by `OnWebSocketMessage()` if we get an `Open` message.
@@ -334,7 +330,7 @@ private:
 	 * Prepares a message to be sent to the API.
 	 */
 	template<typename T>
-	static bool PrepareMessage(std::string_view event, const T &data, Json &payload)
+	static bool PrepareMessage(std::string_view event, const T &data, JsonWriter &payload)
 	{
 		bool success = payload.Set("event", event) && payload.Set("data", data);
 
@@ -357,33 +353,23 @@ private:
 			return false;
 		}
 
-		Json payload;
+		JsonWriter payload;
 
 		if (!KZRacingService::PrepareMessage(event, data, payload))
 		{
 			return false;
 		}
 
-		KZRacingService::socket->send(payload.ToString());
+		KZRacingService::socket->send(payload.Finish());
 		return true;
 	}
 
-	/**
-	 * Callbacks to execute on the main thread as soon as possible.
-	 */
-	static inline struct
-	{
-		std::mutex mutex;
-		std::vector<std::function<void()>> queue;
-	} mainThreadCallbacks {};
-
 	/**
 	 * Queues a callback to be executed on the main thread as soon as possible.
 	 */
 	template<typename CB>
 	static void AddMainThreadCallback(CB &&callback)
 	{
-		std::unique_lock lock(KZRacingService::mainThreadCallbacks.mutex);
-		KZRacingService::mainThreadCallbacks.queue.emplace_back(std::forward<CB>(callback));
+		executor::RunOnMainThread(std::forward<CB>(callback));
 	}
 };
@@ -2,27 +2,27 @@
 
 // ===== PlayerInfo =====
 
-bool KZ::racing::PlayerInfo::ToJson(Json &json) const
+bool KZ::racing::PlayerInfo::ToJson(JsonWriter &json) const
 {
 	std::string id = std::to_string(this->id);
 	return json.Set("id", id) && json.Set("name", this->name);
 }
 
-bool KZ::racing::PlayerInfo::FromJson(const Json &json)
+// The coordinator sends SteamIDs as strings.
+static_function bool DecodeSteamID(std::string_view value, u64 &id)
 {
-	std::string id;
-
-	if (!json.Get("id", id))
-	{
-		return false;
-	}
-
-	this->id = atoll(id.c_str());
+	id = strtoull(value.data(), nullptr, 10);
+	return true;
+}
 
-	return json.Get("name", this->name);
+const JsonFieldTable &KZ::racing::PlayerInfo::JsonFields()
+{
+	static_persist constexpr JsonField fields[] = {JSON_FIELD_DECODE("id", &PlayerInfo::id, &DecodeSteamID), JSON_FIELD("name", &PlayerInfo::name)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::racing::RaceSpec::ToJson(Json &json) const
+bool KZ::racing::RaceSpec::ToJson(JsonWriter &json) const
 {
 	// clang-format off
 	return json.Set("map_id", this->workshopID)
@@ -33,70 +33,88 @@ bool KZ::racing::RaceSpec::ToJson(Json &json) const
 	// clang-format on
 }
 
-bool KZ::racing::RaceSpec::FromJson(const Json &json)
+const JsonFieldTable &KZ::racing::RaceSpec::JsonFields()
 {
 	// clang-format off
-	return json.Get("map_id", this->workshopID)
-		&& json.Get("course", this->courseName)
-		&& json.Get("mode", this->modeName)
-		&& json.Get("max_duration", this->maxDurationSeconds)
-		&& json.Get("max_teleports", this->maxTeleports);
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD("map_id", &RaceSpec::workshopID),
+		JSON_FIELD("course", &RaceSpec::courseName),
+		JSON_FIELD("mode", &RaceSpec::modeName),
+		JSON_FIELD("max_duration", &RaceSpec::maxDurationSeconds),
+		JSON_FIELD("max_teleports", &RaceSpec::maxTeleports),
+	};
 	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
 // ===== Events =====
 
-bool KZ::racing::events::ChatMessage::ToJson(Json &json) const
+bool KZ::racing::events::ChatMessage::ToJson(JsonWriter &json) const
 {
 	return json.Set("player", this->player) && json.Set("content", this->content);
 }
 
-bool KZ::racing::events::ChatMessage::FromJson(const Json &json)
+const JsonFieldTable &KZ::racing::events::ChatMessage::JsonFields()
 {
-	return json.Get("player", this->player) && json.Get("content", this->content);
+	static_persist constexpr JsonField fields[] = {JSON_FIELD("player", &ChatMessage::player), JSON_FIELD("content", &ChatMessage::content)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::racing::events::RaceInitialized::FromJson(const Json &json)
+const JsonFieldTable &KZ::racing::events::RaceInitialized::JsonFields()
 {
-	return this->spec.FromJson(json);
+	static_persist constexpr JsonField fields[] = {JSON_EMBED(&RaceInitialized::spec)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::racing::events::ServerJoinRace::FromJson(const Json &json)
+const JsonFieldTable &KZ::racing::events::ServerJoinRace::JsonFields()
 {
-	return json.Get("name", this->name);
+	static_persist constexpr JsonField fields[] = {JSON_FIELD("name", &ServerJoinRace::name)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::racing::events::ServerLeaveRace::FromJson(const Json &json)
+const JsonFieldTable &KZ::racing::events::ServerLeaveRace::JsonFields()
 {
-	return json.Get("name", this->name);
+	static_persist constexpr JsonField fields[] = {JSON_FIELD("name", &ServerLeaveRace::name)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::racing::events::PlayerJoinRace::ToJson(Json &json) const
+bool KZ::racing::events::PlayerJoinRace::ToJson(JsonWriter &json) const
 {
 	return this->player.ToJson(json);
 }
 
-bool KZ::racing::events::PlayerJoinRace::FromJson(const Json &json)
+const JsonFieldTable &KZ::racing::events::PlayerJoinRace::JsonFields()
 {
-	return this->player.FromJson(json);
+	static_persist constexpr JsonField fields[] = {JSON_EMBED(&PlayerJoinRace::player)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::racing::events::PlayerLeaveRace::ToJson(Json &json) const
+bool KZ::racing::events::PlayerLeaveRace::ToJson(JsonWriter &json) const
 {
 	return this->player.ToJson(json);
 }
 
-bool KZ::racing::events::PlayerLeaveRace::FromJson(const Json &json)
+const JsonFieldTable &KZ::racing::events::PlayerLeaveRace::JsonFields()
 {
-	return this->player.FromJson(json);
+	static_persist constexpr JsonField fields[] = {JSON_EMBED(&PlayerLeaveRace::player)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::racing::events::StartRace::FromJson(const Json &json)
+const JsonFieldTable &KZ::racing::events::StartRace::JsonFields()
 {
-	return json.Get("countdown_duration", this->countdownSeconds);
+	static_persist constexpr JsonField fields[] = {JSON_FIELD("countdown_duration", &StartRace::countdownSeconds)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::racing::events::PlayerFinish::ToJson(Json &json) const
+bool KZ::racing::events::PlayerFinish::ToJson(JsonWriter &json) const
 {
 	// clang-format off
 	return this->player.ToJson(json)
@@ -105,85 +123,97 @@ bool KZ::racing::events::PlayerFinish::ToJson(Json &json) const
 	// clang-format on
 }
 
-bool KZ::racing::events::PlayerFinish::FromJson(const Json &json)
+const JsonFieldTable &KZ::racing::events::PlayerFinish::JsonFields()
 {
 	// clang-format off
-	return this->player.FromJson(json)
-		&& json.Get("teleports", this->teleports)
-		&& json.Get("time", this->timeSeconds);
+	static_persist constexpr JsonField fields[] = {
+		JSON_EMBED(&PlayerFinish::player),
+		JSON_FIELD("teleports", &PlayerFinish::teleports),
+		JSON_FIELD("time", &PlayerFinish::timeSeconds),
+	};
 	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::racing::events::PlayerDisconnect::ToJson(Json &json) const
+bool KZ::racing::events::PlayerDisconnect::ToJson(JsonWriter &json) const
 {
 	return this->player.ToJson(json);
 }
 
-bool KZ::racing::events::PlayerDisconnect::FromJson(const Json &json)
+const JsonFieldTable &KZ::racing::events::PlayerDisconnect::JsonFields()
 {
-	return this->player.FromJson(json);
+	static_persist constexpr JsonField fields[] = {JSON_EMBED(&PlayerDisconnect::player)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::racing::events::PlayerSurrender::ToJson(Json &json) const
+bool KZ::racing::events::PlayerSurrender::ToJson(JsonWriter &json) const
 {
 	return this->player.ToJson(json);
 }
 
-bool KZ::racing::events::PlayerSurrender::FromJson(const Json &json)
+const JsonFieldTable &KZ::racing::events::PlayerSurrender::JsonFields()
 {
-	return this->player.FromJson(json);
+	static_persist constexpr JsonField fields[] = {JSON_EMBED(&PlayerSurrender::player)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::racing::events::RaceResults::FromJson(const Json &json)
+const JsonFieldTable &KZ::racing::events::RaceResults::JsonFields()
 {
-	return json.Get("participants", this->participants);
+	static_persist constexpr JsonField fields[] = {JSON_FIELD("participants", &RaceResults::participants)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
 
-bool KZ::racing::events::RaceResults::Participant::FromJson(const Json &json)
+static_function bool DecodeParticipantState(std::string_view value, KZ::racing::events::RaceResults::Participant::State &state)
 {
-	std::string id;
-
-	if (!json.Get("id", id))
-	{
-		return false;
-	}
-
-	this->id = atoll(id.c_str());
+	using State = KZ::racing::events::RaceResults::Participant::State;
 
-	if (!json.Get("name", this->name))
+	if (value == "disconnected")
 	{
-		return false;
+		state = State::Disconnected;
 	}
-
-	std::string state;
-
-	if (!json.Get("state", state))
-	{
-		return false;
-	}
-
-	if (state == "disconnected")
+	else if (value == "surrendered")
 	{
-		this->state = State::Disconnected;
+		state = State::Surrendered;
 	}
-	else if (state == "surrendered")
+	else if (value == "did_not_finish")
 	{
-		this->state = State::Surrendered;
+		state = State::DidNotFinish;
 	}
-	else if (state == "did_not_finish")
+	else if (value == "finished")
 	{
-		this->state = State::DidNotFinish;
+		state = State::Finished;
 	}
-	else if (state == "finished")
+	else
 	{
-		this->state = State::Finished;
-		return json.Get("teleports", this->teleports) && json.Get("time", this->timeSeconds);
+		return false;
 	}
 
 	return true;
 }
 
-bool KZ::racing::events::RaceFinished::FromJson(const Json &json)
+const JsonFieldTable &KZ::racing::events::RaceResults::Participant::JsonFields()
+{
+	// `teleports` and `time` are only sent for participants that finished.
+	// clang-format off
+	static_persist constexpr JsonField fields[] = {
+		JSON_FIELD_DECODE("id", &Participant::id, &DecodeSteamID),
+		JSON_FIELD("name", &Participant::name),
+		JSON_FIELD_DECODE("state", &Participant::state, &DecodeParticipantState),
+		JSON_OPTIONAL_FIELD("teleports", &Participant::teleports),
+		JSON_OPTIONAL_FIELD("time", &Participant::timeSeconds),
+	};
+	// clang-format on
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
+}
+
+const JsonFieldTable &KZ::racing::events::RaceFinished::JsonFields()
 {
-	return this->results.FromJson(json);
+	static_persist constexpr JsonField fields[] = {JSON_EMBED(&RaceFinished::results)};
+	static_persist constexpr JsonFieldTable table(fields);
+	return table;
 }
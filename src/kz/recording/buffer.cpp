@@ -1,9 +1,63 @@
 #include "kz_recording.h"
 #include "kz/language/kz_language.h"
+#include "kz/global/kz_global.h"
 #include <unordered_set>
 extern CConVar<bool> kz_replay_recording_debug;
 
+// Recorders not used by any player. Only touched on the main thread.
+static_global std::vector<CircularRecorder *> recorderPool;
+// Set once the pool is freed, recorders released after that are deleted on the spot.
+static_global bool recorderPoolFreed;
+
 // CircularRecorder method implementations
+void CircularRecorder::Preallocate(u32 numRecorders)
+{
+	recorderPoolFreed = false;
+	while (recorderPool.size() < numRecorders)
+	{
+		recorderPool.push_back(new CircularRecorder());
+	}
+}
+
+CircularRecorder *CircularRecorder::Acquire()
+{
+	if (recorderPool.empty())
+	{
+		return new CircularRecorder();
+	}
+	// The most recently released recorder is the most likely to have its memory committed already.
+	CircularRecorder *recorder = recorderPool.back();
+	recorderPool.pop_back();
+	return recorder;
+}
+
+void CircularRecorder::Release(CircularRecorder *recorder)
+{
+	if (!recorder)
+	{
+		return;
+	}
+	if (recorderPoolFreed)
+	{
+		delete recorder;
+		return;
+	}
+	recorder->Clear();
+	recorder->earliestMode.reset();
+	recorder->earliestStyles.reset();
+	recorderPool.push_back(recorder);
+}
+
+void CircularRecorder::FreePool()
+{
+	for (CircularRecorder *recorder : recorderPool)
+	{
+		delete recorder;
+	}
+	recorderPool.clear();
+	recorderPoolFreed = true;
+}
+
 void CircularRecorder::TrimOldCommands(u32 currentTick)
 {
 	i32 numToRemove = 0;
@@ -99,6 +153,15 @@ void KZRecordingService::WriteCircularBufferToFileAsync(f32 duration, const char
 	if (strlen(cheaterReason) > 0)
 	{
 		recorder = std::make_unique<CheaterRecorder>(this->player, cheaterReason, saver);
+		// Cheater replays are always sent to the API for review.
+		onSuccess = [onSuccess](const UUID_t &uuid, f32 duration)
+		{
+			KZGlobalService::QueueReplayUpload(uuid);
+			if (onSuccess)
+			{
+				onSuccess(uuid, duration);
+			}
+		};
 	}
 	else
 	{
@@ -63,18 +63,19 @@ void KZRecordingService::Init()
 	if (!fileWriter)
 	{
 		fileWriter = new ReplayFileWriter();
-		fileWriter->Start();
 	}
+	CircularRecorder::Preallocate(MAXPLAYERS);
 }
 
 void KZRecordingService::Shutdown()
 {
 	if (fileWriter)
 	{
-		fileWriter->Stop();
+		fileWriter->Flush();
 		delete fileWriter;
 		fileWriter = nullptr;
 	}
+	CircularRecorder::FreePool();
 }
 
 void KZRecordingService::OnActivateServer()
@@ -89,14 +90,6 @@ void KZRecordingService::OnActivateServer()
 	}
 }
 
-void KZRecordingService::ProcessFileWriteCompletion()
-{
-	if (fileWriter)
-	{
-		fileWriter->RunFrame();
-	}
-}
-
 void KZRecordingService::OnProcessUsercmds(PlayerCommand *cmds, i32 numCmds)
 {
 	if (KZ::replaysystem::IsReplayBot(this->player))
@@ -174,11 +167,12 @@ void KZRecordingService::OnTimerEnd()
 	this->InsertTimerEvent(RpEvent::RpEventData::TimerEvent::TIMER_END, this->player->timerService->GetTime(),
 						   this->player->timerService->GetCourse()->id);
 
+	KZRunMetadata metadata = this->player->timerService->GetCurrentRunMetadata();
 	for (auto &recorder : this->runRecorders)
 	{
 		if (recorder.desiredStopTime < 0.0f)
 		{
-			recorder.End(this->player->timerService->GetTime(), this->player->checkpointService->GetTeleportCount());
+			recorder.End(this->player->timerService->GetTime(), this->player->checkpointService->GetTeleportCount(), metadata);
 			// Generate UUID now (at timer end) so it's available for RecordAnnounce
 			// File will be written later after breather time
 			recorder.uuid = UUID_t(true);
@@ -332,8 +326,8 @@ void KZRecordingService::OnClientDisconnect()
 	}
 	this->jumpRecorders.clear();
 
-	// Clean up circular recorder when player disconnects
-	delete this->circularRecording;
+	// Hand the circular recorder back when player disconnects
+	CircularRecorder::Release(this->circularRecording);
 	this->circularRecording = nullptr;
 }
 
@@ -83,12 +83,7 @@ void KZRecordingService::Reset()
 {
 	if (this->circularRecording)
 	{
-		this->circularRecording->tickData->Advance(this->circularRecording->tickData->GetReadAvailable());
-		this->circularRecording->subtickData->Advance(this->circularRecording->subtickData->GetReadAvailable());
-		this->circularRecording->cmdData->Advance(this->circularRecording->cmdData->GetReadAvailable());
-		this->circularRecording->cmdSubtickData->Advance(this->circularRecording->cmdSubtickData->GetReadAvailable());
-		this->circularRecording->rpEvents->Advance(this->circularRecording->rpEvents->GetReadAvailable());
-		this->circularRecording->jumps.clear();
+		this->circularRecording->Clear();
 	}
 	this->runRecorders.clear();
 	this->jumpRecorders.clear();
@@ -439,7 +434,7 @@ void KZRecordingService::EnsureCircularRecorderInitialized()
 {
 	if (!this->circularRecording)
 	{
-		this->circularRecording = new CircularRecorder();
+		this->circularRecording = CircularRecorder::Acquire();
 		META_CONPRINTF("[KZ] Initialized circular recorder for player %s\n", this->player->GetName());
 	}
 }
@@ -10,6 +10,7 @@
 #include "kz/kz.h"
 #include "kz/mode/kz_mode.h"
 #include "kz/style/kz_style.h"
+#include "kz/timer/run_metadata.h"
 #include "kz/replays/kz_replay.h"
 #include "circularbuffer.h"
 #include "utils/circularfifobuffer.h"
@@ -20,6 +21,7 @@ class Jump;
 
 // two minute replay buffer that constantly records
 //  used for replay breather and cheater replays.
+// The buffers only allocate memory as they fill up, see CFIFOCircularBuffer.
 struct CircularRecorder
 {
 	// This is only written as long as the player is alive.
@@ -55,6 +57,24 @@ struct CircularRecorder
 		delete this->rpEvents;
 	}
 
+	// Recorders are pooled server-wide: players take one when they become active and give it back when they disconnect.
+	// A recorder coming back is only reset, the memory its buffers committed is reused by the next player.
+	static void Preallocate(u32 numRecorders);
+	static CircularRecorder *Acquire();
+	static void Release(CircularRecorder *recorder);
+	static void FreePool();
+
+	// Drop all recorded data.
+	void Clear()
+	{
+		this->tickData->Clear();
+		this->subtickData->Clear();
+		this->cmdData->Clear();
+		this->cmdSubtickData->Clear();
+		this->rpEvents->Clear();
+		this->jumps.clear();
+	}
+
 	void TrimOldCommands(u32 currentTick);
 	// Also updates the earliest mode and styles info.
 	void TrimOldEvents(u32 currentTick);
@@ -93,7 +113,9 @@ struct Recorder
 		return desiredStopTime >= 0 && currentTime >= desiredStopTime;
 	}
 
+	// Appends the replay to the replay pack.
 	bool WriteToFile();
+	i32 WriteData(FileHandle_t file);
 	virtual i32 WriteHeader(FileHandle_t file);
 	virtual i32 WriteTickData(FileHandle_t file);
 	virtual i32 WriteWeapons(FileHandle_t file);
@@ -157,60 +179,24 @@ class KZPlayer;
 using WriteSuccessCallback = std::function<void(const UUID_t &uuid, f32 duration)>;
 using WriteFailureCallback = std::function<void(const char *error)>;
 
-// Write task with optional callbacks
-struct WriteTask
-{
-	std::unique_ptr<Recorder> recorder;
-	WriteSuccessCallback onSuccess;
-	WriteFailureCallback onFailure;
-};
-
-// Completed write result
-struct WriteResult
-{
-	bool success;
-	UUID_t uuid;
-	f32 duration;
-	std::string errorMessage;
-	WriteSuccessCallback onSuccess;
-	WriteFailureCallback onFailure;
-};
-
-// Thread-safe file writer for async replay file writing
+// Writes replay files in order on the executor, callbacks are invoked on the main thread.
 class ReplayFileWriter
 {
 public:
-	ReplayFileWriter();
-	~ReplayFileWriter();
-
-	void Start();
-	void Stop();
-
 	// Queue a recorder for async file writing (fire-and-forget)
 	void QueueWrite(std::unique_ptr<Recorder> recorder);
 
 	// Queue a recorder with callbacks
 	void QueueWrite(std::unique_ptr<Recorder> recorder, WriteSuccessCallback onSuccess, WriteFailureCallback onFailure);
 
-	// Run frame - process any completed writes and invoke callbacks on main thread
-	void RunFrame();
-
-private:
-	void ThreadRun();
-
-	std::unique_ptr<std::thread> m_thread;
-	std::queue<WriteTask> m_writeQueue;
-	std::queue<WriteResult> m_completedWrites;
-	std::mutex m_queueLock;
-	std::mutex m_completedLock;
-	std::condition_variable m_queueCV;
-	bool m_terminate = false;
+	// Block until every queued write has finished
+	void Flush();
 };
 
 struct RunRecorder : public Recorder
 {
 	RunRecorder(KZPlayer *player);
-	void End(f32 time, i32 numTeleports);
+	void End(f32 time, i32 numTeleports, const KZRunMetadata &metadata);
 	virtual i32 WriteHeader(FileHandle_t file) override;
 };
 
@@ -239,17 +225,13 @@ class KZRecordingService : public KZBaseService
 public:
 	~KZRecordingService()
 	{
-		if (circularRecording)
-		{
-			delete circularRecording;
-		}
+		CircularRecorder::Release(circularRecording);
 		circularRecording = nullptr;
 	}
 
 	static void Init();
 	static void Shutdown();
 	static void OnActivateServer();
-	static void ProcessFileWriteCompletion();
 	void OnProcessUsercmds(PlayerCommand *base, i32 numCmds);
 
 	void OnPhysicsSimulate();
@@ -291,7 +273,7 @@ public:
 	// Check the player's checkpoints/teleports and embed in tick data.
 	void CheckCheckpoints();
 
-	// Ensure circular recorder is initialized (lazy initialization)
+	// Ensure circular recorder is initialized (lazy initialization, taken from the pool)
 	void EnsureCircularRecorderInitialized();
 
 private:
@@ -381,5 +363,4 @@ public:
 	}
 
 	static ReplayFileWriter *fileWriter;
-	static inline std::vector<UUID_t> globalUploadQueue;
 };
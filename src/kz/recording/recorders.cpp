@@ -9,6 +9,8 @@
 #include "sdk/cskeletoninstance.h"
 #include "sdk/usercmd.h"
 #include "kz/replays/compression.h"
+#include "kz/replays/packfile.h"
+#include "kz/replays/dictionary.h"
 
 extern CConVar<bool> kz_replay_recording_debug;
 
@@ -57,7 +59,7 @@ JumpRecorder::JumpRecorder(Jump *jump) : Recorder(jump->player, 5.0f, RP_JUMPSTA
 	jumpProto->mutable_mode()->set_md5(modeInfo.md5);
 	jumpProto->set_jump_type(jump->jumpType);
 	jumpProto->set_distance(jump->GetDistance());
-	jumpProto->set_block_distance(-1);
+	jumpProto->set_block_distance((i32)jump->GetBlock());
 	jumpProto->set_num_strafes(jump->strafes.Count());
 	jumpProto->set_air_time(jump->airtime);
 	jumpProto->set_pre(jump->GetTakeoffSpeed());
@@ -89,11 +91,12 @@ RunRecorder::RunRecorder(KZPlayer *player) : Recorder(player, 5.0f, RP_RUN, true
 	}
 }
 
-void RunRecorder::End(f32 time, i32 numTeleports)
+void RunRecorder::End(f32 time, i32 numTeleports, const KZRunMetadata &metadata)
 {
 	auto *runProto = replayHeader.mutable_run();
 	runProto->set_time(time);
 	runProto->set_num_teleports(numTeleports);
+	runProto->set_zone_times(metadata.Serialize());
 	this->desiredStopTime = g_pKZUtils->GetServerGlobals()->curtime + 4.0f;
 }
 
@@ -269,24 +272,23 @@ bool Recorder::WriteToFile()
 	time_t unixTime = 0;
 	time(&unixTime);
 	replayHeader.set_timestamp((u64)unixTime);
+	// Runs on the replay write queue like dictionary training, so the set can't change while the sections are compressed.
+	replayHeader.set_dictionary_set(KZ::replaysystem::dictionary::GetCurrentSet());
 
-	std::string uuidStr = this->uuid.ToString();
-	char tempFilename[512];
-	char finalFilename[512];
-	V_snprintf(tempFilename, sizeof(tempFilename), "%s/%s.replay.tmp", KZ_REPLAY_PATH, uuidStr.c_str());
-	V_snprintf(finalFilename, sizeof(finalFilename), "%s/%s.replay", KZ_REPLAY_PATH, uuidStr.c_str());
+	bool success =
+		KZ::replaysystem::pack::Append(this->uuid, this->replayHeader, [this](FileHandle_t file) { return (u32)this->WriteData(file); });
 
-	g_pFullFileSystem->CreateDirHierarchy(KZ_REPLAY_PATH, "GAME");
-
-	// Write to temporary file first
-	FileHandle_t file = g_pFullFileSystem->Open(tempFilename, "wb", "GAME");
-	if (!file)
+	if (success && kz_replay_recording_debug.Get())
 	{
-		META_CONPRINTF("Failed to open replay file for writing: %s\n", tempFilename);
-		return false;
+		META_CONPRINTF("kz_replay_recording_debug: Saved replay %s to the replay pack\n", this->uuid.ToString().c_str());
 	}
 
-	// Order of writing must match order of reading in kz_replaydata.cpp
+	return success;
+}
+
+i32 Recorder::WriteData(FileHandle_t file)
+{
+	// Order of writing must match order of reading in data.cpp
 	i32 bytesWritten = 0;
 	bytesWritten += this->WriteHeader(file);
 
@@ -324,23 +326,7 @@ bool Recorder::WriteToFile()
 	{
 		META_CONPRINTF("kz_replay_recording_debug: Wrote cmd data (%d bytes)\n", bytesWritten);
 	}
-	// Close the file before renaming
-	g_pFullFileSystem->Close(file);
-
-	// Rename temp file to final name
-	if (!g_pFullFileSystem->RenameFile(tempFilename, finalFilename, "GAME"))
-	{
-		META_CONPRINTF("Failed to rename replay file from %s to %s\n", tempFilename, finalFilename);
-		g_pFullFileSystem->RemoveFile(tempFilename, "GAME");
-		return false;
-	}
-
-	if (kz_replay_recording_debug.Get())
-	{
-		META_CONPRINTF("kz_replay_recording_debug: Saved replay to %s (%d bytes)\n", finalFilename, bytesWritten);
-	}
-
-	return true;
+	return bytesWritten;
 }
 
 i32 Recorder::WriteHeader(FileHandle_t file)
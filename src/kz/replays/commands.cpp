@@ -78,10 +78,6 @@ namespace KZ::replaysystem::commands
 			parsedUuid = matches[0];
 		}
 
-		// Validate uuid format
-		char replayPath[512];
-		V_snprintf(replayPath, sizeof(replayPath), KZ_REPLAY_PATH "/%s.replay", parsedUuid.ToString().c_str());
-
 		// Show loading message
 		player->languageService->PrintChat(true, false, "Replay - Loading");
 
@@ -91,7 +87,7 @@ namespace KZ::replaysystem::commands
 		// Start async loading
 		// clang-format off
 		data::LoadReplayAsync(
-			replayPath,
+			parsedUuid,
 			// Success callback (runs on main thread via ProcessAsyncLoadCompletion)
 			data::LoadSuccessCallback([playerUserID]() {
 				KZPlayer* player = g_pKZPlayerManager->ToPlayer(playerUserID);
@@ -1,5 +1,6 @@
 #include "kz_replay.h"
 #include "compression.h"
+#include "dictionary.h"
 #include "filesystem.h"
 #include "vendor/zstd/lib/zstd.h"
 
@@ -21,7 +22,7 @@ static_function void AppendToBuffer(std::vector<char> &buffer, const void *data,
 // Compression utility functions
 // ========================================
 
-bool KZ::replaysystem::compression::Compress(const void *src, size_t srcSize, void **outDst, size_t *outDstSize)
+bool KZ::replaysystem::compression::Compress(const void *src, size_t srcSize, void **outDst, size_t *outDstSize, dictionary::Section section)
 {
 	// Get worst-case compressed size
 	size_t maxCompressedSize = ZSTD_compressBound(srcSize);
@@ -31,8 +32,19 @@ bool KZ::replaysystem::compression::Compress(const void *src, size_t srcSize, vo
 		return false;
 	}
 
-	// Compress using zstd level 3
-	size_t compressedSize = ZSTD_compress(*outDst, maxCompressedSize, src, srcSize, 3);
+	// Compress using zstd level 3, with the trained dictionary for this section if there is one
+	size_t compressedSize;
+	const ZSTD_CDict *cdict = dictionary::GetCompressionDictionary(section);
+	if (cdict)
+	{
+		ZSTD_CCtx *cctx = ZSTD_createCCtx();
+		compressedSize = ZSTD_compress_usingCDict(cctx, *outDst, maxCompressedSize, src, srcSize, cdict);
+		ZSTD_freeCCtx(cctx);
+	}
+	else
+	{
+		compressedSize = ZSTD_compress(*outDst, maxCompressedSize, src, srcSize, DEFAULT_LEVEL);
+	}
 	if (ZSTD_isError(compressedSize))
 	{
 		delete[] static_cast<char *>(*outDst);
@@ -46,7 +58,24 @@ bool KZ::replaysystem::compression::Compress(const void *src, size_t srcSize, vo
 
 bool KZ::replaysystem::compression::Decompress(const void *src, size_t srcSize, void *dst, size_t dstSize)
 {
-	size_t decompressedSize = ZSTD_decompress(dst, dstSize, src, srcSize);
+	// Frames written with a trained dictionary carry its ID
+	size_t decompressedSize;
+	u32 dictID = ZSTD_getDictID_fromFrame(src, srcSize);
+	if (dictID != 0)
+	{
+		const ZSTD_DDict *ddict = dictionary::GetDecompressionDictionary(dictID);
+		if (!ddict)
+		{
+			return false;
+		}
+		ZSTD_DCtx *dctx = ZSTD_createDCtx();
+		decompressedSize = ZSTD_decompress_usingDDict(dctx, dst, dstSize, src, srcSize, ddict);
+		ZSTD_freeDCtx(dctx);
+	}
+	else
+	{
+		decompressedSize = ZSTD_decompress(dst, dstSize, src, srcSize);
+	}
 	if (ZSTD_isError(decompressedSize))
 	{
 		return false;
@@ -336,7 +365,7 @@ i32 KZ::replaysystem::compression::WriteTickDataCompressed(FileHandle_t file, co
 	void *compressedData = nullptr;
 	size_t compressedSize = 0;
 
-	bool success = Compress(buffer.data(), buffer.size(), &compressedData, &compressedSize);
+	bool success = Compress(buffer.data(), buffer.size(), &compressedData, &compressedSize, dictionary::SECTION_TICKS);
 	if (!success)
 	{
 		return 0;
@@ -358,7 +387,7 @@ i32 KZ::replaysystem::compression::WriteTickDataCompressed(FileHandle_t file, co
 	size_t compressedSubtickSize = 0;
 	size_t uncompressedSubtickSize = subtickData.size() * sizeof(SubtickData);
 
-	success = Compress(subtickData.data(), uncompressedSubtickSize, &compressedSubtick, &compressedSubtickSize);
+	success = Compress(subtickData.data(), uncompressedSubtickSize, &compressedSubtick, &compressedSubtickSize, dictionary::SECTION_SUBTICKS);
 
 	if (success)
 	{
@@ -679,7 +708,7 @@ i32 KZ::replaysystem::compression::WriteEventsCompressed(FileHandle_t file, cons
 	size_t compressedSize = 0;
 	size_t uncompressedSize = events.size() * sizeof(RpEvent);
 
-	bool success = Compress(events.data(), uncompressedSize, &compressedData, &compressedSize);
+	bool success = Compress(events.data(), uncompressedSize, &compressedData, &compressedSize, dictionary::SECTION_EVENTS);
 	if (!success)
 	{
 		return 0;
@@ -820,7 +849,7 @@ i32 KZ::replaysystem::compression::WriteJumpsCompressed(FileHandle_t file, const
 	void *compressedData = nullptr;
 	size_t compressedSize = 0;
 
-	bool success = Compress(buffer.data(), buffer.size(), &compressedData, &compressedSize);
+	bool success = Compress(buffer.data(), buffer.size(), &compressedData, &compressedSize, dictionary::SECTION_JUMPS);
 	if (!success)
 	{
 		return 0;
@@ -1029,7 +1058,7 @@ i32 KZ::replaysystem::compression::WriteWeaponsCompressed(FileHandle_t file, con
 	void *compressedData = nullptr;
 	size_t compressedSize = 0;
 
-	bool success = Compress(buffer.data(), buffer.size(), &compressedData, &compressedSize);
+	bool success = Compress(buffer.data(), buffer.size(), &compressedData, &compressedSize, dictionary::SECTION_WEAPONS);
 	if (!success)
 	{
 		return 0;
@@ -1124,7 +1153,7 @@ i32 KZ::replaysystem::compression::WriteCmdDataCompressed(FileHandle_t file, con
 	void *compressedData = nullptr;
 	size_t compressedSize = 0;
 
-	bool success = Compress(buffer.data(), buffer.size(), &compressedData, &compressedSize);
+	bool success = Compress(buffer.data(), buffer.size(), &compressedData, &compressedSize, dictionary::SECTION_CMDS);
 	if (!success)
 	{
 		return 0;
@@ -1145,7 +1174,7 @@ i32 KZ::replaysystem::compression::WriteCmdDataCompressed(FileHandle_t file, con
 	size_t compressedSubtickSize = 0;
 	size_t uncompressedSubtickSize = cmdSubtickData.size() * sizeof(SubtickData);
 
-	success = Compress(cmdSubtickData.data(), uncompressedSubtickSize, &compressedSubtick, &compressedSubtickSize);
+	success = Compress(cmdSubtickData.data(), uncompressedSubtickSize, &compressedSubtick, &compressedSubtickSize, dictionary::SECTION_CMD_SUBTICKS);
 
 	if (success)
 	{
@@ -1162,3 +1191,125 @@ i32 KZ::replaysystem::compression::WriteCmdDataCompressed(FileHandle_t file, con
 
 	return bytesWritten;
 }
+
+// ========================================
+// Recompression
+// ========================================
+
+u32 KZ::replaysystem::compression::RecompressReplay(FileHandle_t in, u32 length, FileHandle_t out, i32 level, RecompressStats &stats)
+{
+	// The protobuf header is copied as is
+	u32 headerSize = 0;
+	if (g_pFullFileSystem->Read(&headerSize, sizeof(headerSize), in) != sizeof(headerSize) || sizeof(headerSize) + (u64)headerSize > length)
+	{
+		return 0;
+	}
+	std::vector<char> compressed(headerSize);
+	if ((u32)g_pFullFileSystem->Read(compressed.data(), headerSize, in) != headerSize)
+	{
+		return 0;
+	}
+	u32 bytesRead = sizeof(headerSize) + headerSize;
+	u32 bytesWritten = 0;
+	bytesWritten += g_pFullFileSystem->Write(&headerSize, sizeof(headerSize), out);
+	bytesWritten += g_pFullFileSystem->Write(compressed.data(), headerSize, out);
+
+	ZSTD_CCtx *cctx = ZSTD_createCCtx();
+	if (!cctx)
+	{
+		return 0;
+	}
+	ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+	ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching, level > DEFAULT_LEVEL ? 1 : 0);
+
+	std::vector<char> decompressed;
+	std::vector<char> recompressed;
+	std::vector<char> verify;
+	f64 decodeTimeBefore = 0.0;
+	f64 decodeTimeAfter = 0.0;
+	bool success = true;
+
+	// Every section is a CompressedSectionHeader followed by a single zstd frame
+	while (bytesRead < length)
+	{
+		CompressedSectionHeader header;
+		if (g_pFullFileSystem->Read(&header, sizeof(header), in) != sizeof(header)
+			|| bytesRead + sizeof(header) + (u64)header.compressedSize > length)
+		{
+			success = false;
+			break;
+		}
+		bytesRead += sizeof(header) + header.compressedSize;
+
+		compressed.resize(header.compressedSize);
+		decompressed.resize(header.uncompressedSize);
+		if ((u32)g_pFullFileSystem->Read(compressed.data(), header.compressedSize, in) != header.compressedSize)
+		{
+			success = false;
+			break;
+		}
+		f64 start = Plat_FloatTime();
+		if (!Decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()))
+		{
+			success = false;
+			break;
+		}
+		f64 sectionDecodeTime = Plat_FloatTime() - start;
+		decodeTimeBefore += sectionDecodeTime;
+
+		// Keep the dictionary the section was written with
+		const void *dictData = nullptr;
+		size_t dictSize = 0;
+		u32 dictID = ZSTD_getDictID_fromFrame(compressed.data(), compressed.size());
+		if (dictID != 0 && !dictionary::GetDictionaryContent(dictID, &dictData, &dictSize))
+		{
+			success = false;
+			break;
+		}
+		ZSTD_CCtx_loadDictionary_byReference(cctx, dictData, dictSize);
+
+		recompressed.resize(ZSTD_compressBound(decompressed.size()));
+		size_t size = ZSTD_compress2(cctx, recompressed.data(), recompressed.size(), decompressed.data(), decompressed.size());
+		if (ZSTD_isError(size))
+		{
+			success = false;
+			break;
+		}
+		recompressed.resize(size);
+
+		// Archiving never makes a section bigger, restoring to the default level always rewrites it
+		if (level > DEFAULT_LEVEL && recompressed.size() >= compressed.size())
+		{
+			recompressed.swap(compressed);
+		}
+		else
+		{
+			// Never drop the old frame before the new one is known to decode to the same data
+			verify.resize(decompressed.size());
+			start = Plat_FloatTime();
+			if (!Decompress(recompressed.data(), recompressed.size(), verify.data(), verify.size()) || verify != decompressed)
+			{
+				success = false;
+				break;
+			}
+			sectionDecodeTime = Plat_FloatTime() - start;
+		}
+		decodeTimeAfter += sectionDecodeTime;
+
+		header.compressedSize = (u32)recompressed.size();
+		bytesWritten += g_pFullFileSystem->Write(&header, sizeof(header), out);
+		bytesWritten += g_pFullFileSystem->Write(recompressed.data(), header.compressedSize, out);
+	}
+
+	ZSTD_freeCCtx(cctx);
+	if (!success)
+	{
+		return 0;
+	}
+
+	stats.bytesBefore += length;
+	stats.bytesAfter += bytesWritten;
+	stats.decodeTimeBefore += decodeTimeBefore;
+	stats.decodeTimeAfter += decodeTimeAfter;
+	return bytesWritten;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "kz_replay.h"
+#include "dictionary.h"
 
 namespace KZ::replaysystem::compression
 {
@@ -12,10 +13,23 @@ namespace KZ::replaysystem::compression
 		u32 elementCount;     // Number of elements (e.g., tick count)
 	};
 
-	// Compress a buffer using zstd level 3
-	bool Compress(const void *src, size_t srcSize, void **outDst, size_t *outDstSize);
+	// zstd level used when replays are written
+	inline constexpr i32 DEFAULT_LEVEL = 3;
 
-	// Decompress a buffer using zstd
+	// Totals collected while recompressing replays
+	struct RecompressStats
+	{
+		u64 bytesBefore;
+		u64 bytesAfter;
+		// Time spent decompressing the sections before and after recompression
+		f64 decodeTimeBefore;
+		f64 decodeTimeAfter;
+	};
+
+	// Compress a buffer using zstd level 3 and the current dictionary of the section
+	bool Compress(const void *src, size_t srcSize, void **outDst, size_t *outDstSize, dictionary::Section section);
+
+	// Decompress a buffer using zstd, with the dictionary the frame was written with if any
 	bool Decompress(const void *src, size_t srcSize, void *dst, size_t dstSize);
 
 	// Write compressed tick data with delta encoding
@@ -47,4 +61,8 @@ namespace KZ::replaysystem::compression
 
 	// Write compressed CmdData
 	i32 WriteCmdDataCompressed(FileHandle_t file, const std::vector<CmdData> &cmdData, const std::vector<SubtickData> &cmdSubtickData);
+
+	// Copy length bytes of replay data from in to out with every section recompressed at the given level.
+	// Levels above the default also enable long distance matching. Returns the number of bytes written, 0 on failure.
+	u32 RecompressReplay(FileHandle_t in, u32 length, FileHandle_t out, i32 level, RecompressStats &stats);
 } // namespace KZ::replaysystem::compression
@@ -4,6 +4,9 @@
 #include "utils/utils.h"
 #include "utils/uuid.h"
 #include "compression.h"
+#include "packfile.h"
+#include "dictionary.h"
+#include "utils/executor.h"
 #include <thread>
 #include <mutex>
 #include <atomic>
@@ -14,8 +17,9 @@ CConVar<bool> kz_replay_playback_skins_enable("kz_replay_playback_skins_enable",
 
 static KZ::replaysystem::data::ReplayPlayback g_currentReplay = {};
 static KZ::replaysystem::data::AsyncLoadStatus g_loadStatus = {};
-static std::thread g_loadThread;
 static std::atomic<bool> g_cancelLoad {false};
+// Bumped by every load request, a queued or running load that is no longer the latest one leaves the status alone.
+static std::atomic<u32> g_loadGeneration {0};
 
 namespace KZ::replaysystem::data
 {
@@ -147,12 +151,12 @@ namespace KZ::replaysystem::data
 		return g_currentReplay.paused;
 	}
 
-	static_function void UpdateProgress(FileHandle_t file, size_t fileSize, std::atomic<f32> &progress)
+	static_function void UpdateProgress(const pack::Reader &replay, std::atomic<f32> &progress)
 	{
-		if (fileSize > 0)
+		if (replay.length > 0)
 		{
-			size_t bytesRead = g_pFullFileSystem->Tell(file);
-			progress = static_cast<f32>(bytesRead) / static_cast<f32>(fileSize);
+			size_t bytesRead = g_pFullFileSystem->Tell(replay.file) - replay.offset;
+			progress = static_cast<f32>(bytesRead) / static_cast<f32>(replay.length);
 			if (kz_replay_playback_debug.Get())
 			{
 				META_CONPRINTF("Replay load progress: %zu bytes, %.2f%%\n", bytesRead, progress.load() * 100.0f);
@@ -161,24 +165,22 @@ namespace KZ::replaysystem::data
 	}
 
 	// Helper function to load replay data with progress reporting
-	static_function ReplayPlayback LoadReplayWithProgress(const char *path, std::atomic<f32> &progress, std::atomic<bool> &shouldCancel)
+	static_function ReplayPlayback LoadReplayWithProgress(const UUID_t &uuid, std::atomic<f32> &progress, std::atomic<bool> &shouldCancel)
 	{
 		ReplayPlayback result = {};
 		progress = 0.0f;
 
-		FileHandle_t file = g_pFullFileSystem->Open(path, "rb");
-		if (!file)
+		pack::Reader replay;
+		if (!pack::Open(uuid, replay))
 		{
 			return result;
 		}
-
-		// Get file size for progress calculation
-		size_t fileSize = g_pFullFileSystem->Size(file);
+		FileHandle_t file = replay.file;
 
 		// Read length-prefixed protobuf header
 		if (shouldCancel)
 		{
-			g_pFullFileSystem->Close(file);
+			pack::Close(replay);
 			return result;
 		}
 		if (kz_replay_playback_debug.Get())
@@ -188,38 +190,44 @@ namespace KZ::replaysystem::data
 		u32 headerSize = 0;
 		if (g_pFullFileSystem->Read(&headerSize, sizeof(headerSize), file) != sizeof(headerSize))
 		{
-			g_pFullFileSystem->Close(file);
+			pack::Close(replay);
 			return result;
 		}
 		if (headerSize == 0 || headerSize > 5 * 1024 * 1024) // sanity limit 5MB
 		{
-			g_pFullFileSystem->Close(file);
+			pack::Close(replay);
 			return result;
 		}
 		std::string serialized;
 		serialized.resize(headerSize);
 		if (g_pFullFileSystem->Read(serialized.data(), headerSize, file) != headerSize)
 		{
-			g_pFullFileSystem->Close(file);
+			pack::Close(replay);
 			return result;
 		}
 		if (!result.header.ParseFromString(serialized))
 		{
-			g_pFullFileSystem->Close(file);
+			pack::Close(replay);
 			return result;
 		}
-		UpdateProgress(file, fileSize, progress);
+		UpdateProgress(replay, progress);
 
 		if (result.header.version() != KZ_REPLAY_VERSION)
 		{
-			g_pFullFileSystem->Close(file);
+			pack::Close(replay);
+			return result;
+		}
+		if (result.header.dictionary_set() && !dictionary::RequireSet(result.header.dictionary_set()))
+		{
+			META_CONPRINTF("[KZ] Replay %s needs missing dictionary set %u\n", uuid.ToString().c_str(), result.header.dictionary_set());
+			pack::Close(replay);
 			return result;
 		}
 
 		// Load tick data
 		if (shouldCancel)
 		{
-			g_pFullFileSystem->Close(file);
+			pack::Close(replay);
 			return result;
 		}
 		if (kz_replay_playback_debug.Get())
@@ -232,7 +240,7 @@ namespace KZ::replaysystem::data
 
 		if (!KZ::replaysystem::compression::ReadTickDataCompressed(file, tickDataVec, subtickDataVec))
 		{
-			g_pFullFileSystem->Close(file);
+			pack::Close(replay);
 			return result;
 		}
 
@@ -250,14 +258,14 @@ namespace KZ::replaysystem::data
 		new (&tickDataVec) std::vector<TickData>();
 		new (&subtickDataVec) std::vector<SubtickData>();
 
-		UpdateProgress(file, fileSize, progress);
+		UpdateProgress(replay, progress);
 
 		// Load weapon data
 		if (shouldCancel)
 		{
 			delete[] result.tickData;
 			delete[] result.subtickData;
-			g_pFullFileSystem->Close(file);
+			pack::Close(replay);
 			return {};
 		}
 		if (kz_replay_playback_debug.Get())
@@ -271,7 +279,7 @@ namespace KZ::replaysystem::data
 		{
 			delete[] result.tickData;
 			delete[] result.subtickData;
-			g_pFullFileSystem->Close(file);
+			pack::Close(replay);
 			return {};
 		}
 
@@ -286,7 +294,7 @@ namespace KZ::replaysystem::data
 			result.weapons[i] = weaponTableVec[i].second;
 		}
 
-		UpdateProgress(file, fileSize, progress);
+		UpdateProgress(replay, progress);
 
 		// Load jump stats
 		if (shouldCancel)
@@ -295,7 +303,7 @@ namespace KZ::replaysystem::data
 			delete[] result.subtickData;
 			delete[] result.weaponIndices;
 			delete[] result.weapons;
-			g_pFullFileSystem->Close(file);
+			pack::Close(replay);
 			return {};
 		}
 		if (kz_replay_playback_debug.Get())
@@ -311,7 +319,7 @@ namespace KZ::replaysystem::data
 			delete[] result.subtickData;
 			delete[] result.weaponIndices;
 			delete[] result.weapons;
-			g_pFullFileSystem->Close(file);
+			pack::Close(replay);
 			return {};
 		}
 
@@ -331,7 +339,7 @@ namespace KZ::replaysystem::data
 			result.jumps = nullptr;
 		}
 
-		UpdateProgress(file, fileSize, progress);
+		UpdateProgress(replay, progress);
 
 		// Load events
 		if (shouldCancel)
@@ -341,7 +349,7 @@ namespace KZ::replaysystem::data
 			delete[] result.weaponIndices;
 			delete[] result.weapons;
 			delete[] result.jumps;
-			g_pFullFileSystem->Close(file);
+			pack::Close(replay);
 			return {};
 		}
 		if (kz_replay_playback_debug.Get())
@@ -358,7 +366,7 @@ namespace KZ::replaysystem::data
 			delete[] result.weaponIndices;
 			delete[] result.weapons;
 			delete[] result.jumps;
-			g_pFullFileSystem->Close(file);
+			pack::Close(replay);
 			return {};
 		}
 
@@ -369,16 +377,16 @@ namespace KZ::replaysystem::data
 		result.events = eventsVec.data();
 		new (&eventsVec) std::vector<RpEvent>();
 
-		UpdateProgress(file, fileSize, progress);
+		UpdateProgress(replay, progress);
 
-		result.valid = UUID_t::FromString(CUtlString(path).GetBaseFilename().StripExtension().Get(), &result.uuid);
-		assert(result.valid);
-		g_pFullFileSystem->Close(file);
+		result.uuid = uuid;
+		result.valid = true;
+		pack::Close(replay);
 		progress = 1.0f;
 		return result;
 	}
 
-	void LoadReplayAsync(std::string path, LoadSuccessCallback onSuccess, LoadFailureCallback onFailure)
+	void LoadReplayAsync(UUID_t uuid, LoadSuccessCallback onSuccess, LoadFailureCallback onFailure)
 	{
 		// Cancel any existing load
 		CancelAsyncLoad();
@@ -406,14 +414,24 @@ namespace KZ::replaysystem::data
 			g_loadStatus.completedReplay = {};
 		}
 
-		// Start loading thread
-		g_loadThread = std::thread(
+		// Loads run one at a time, a newer request skips any load still waiting in the queue.
+		u32 generation = ++g_loadGeneration;
+		executor::Submit(
+			executor::Queue::ReplayLoad,
 			[=]()
 			{
-				// Copy path to avoid potential lifetime issues
-				std::string pathCopy(path);
+				if (generation != g_loadGeneration.load())
+				{
+					return;
+				}
 
-				ReplayPlayback result = LoadReplayWithProgress(pathCopy.c_str(), g_loadStatus.progress, g_cancelLoad);
+				ReplayPlayback result = LoadReplayWithProgress(uuid, g_loadStatus.progress, g_cancelLoad);
+
+				if (generation != g_loadGeneration.load())
+				{
+					FreeReplayData(&result);
+					return;
+				}
 
 				if (g_cancelLoad)
 				{
@@ -444,9 +462,6 @@ namespace KZ::replaysystem::data
 				}
 				g_loadStatus.state = LoadingState::Completed;
 			});
-
-		// Detach the thread so it can run independently
-		g_loadThread.detach();
 	}
 
 	AsyncLoadStatus *GetLoadStatus()
@@ -0,0 +1,457 @@
+#include "dictionary.h"
+#include "compression.h"
+#include "packfile.h"
+#include "filesystem.h"
+#include "utils/executor.h"
+#define ZDICT_STATIC_LINKING_ONLY
+#include "vendor/zstd/lib/zdict.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#define KZ_REPLAY_DICTIONARY_PATH KZ_REPLAY_PATH "/dictionaries"
+
+enum : u32
+{
+	DICTIONARY_FILE_MAGIC = 0x43445A4B, // KZDC
+	DICTIONARY_FILE_VERSION = 1,
+	// Dictionary IDs below 32768 are reserved by the zstd format.
+	DICTIONARY_ID_BASE = 32768,
+};
+
+static_global constexpr u32 DICTIONARY_SIZE = 32 * 1024;
+// Large sections gain nothing from a dictionary and would crowd out the small ones.
+static_global constexpr u32 MAX_SAMPLE_SIZE = 128 * 1024;
+static_global constexpr u32 MAX_SAMPLES_SIZE = 16 * 1024 * 1024;
+static_global constexpr u32 MIN_SAMPLES = 16;
+static_global constexpr u32 DEFAULT_MAX_REPLAYS = 1000;
+
+static_global const char *sectionNames[] = {"ticks", "subticks", "weapons", "jumps", "events", "cmds", "cmd_subticks"};
+static_assert(KZ_ARRAYSIZE(sectionNames) == KZ::replaysystem::dictionary::SECTION_COUNT);
+
+struct DictionaryFileHeader
+{
+	u32 magic;
+	u32 version;
+	u32 set;
+	u32 count;
+};
+
+struct DictionaryEntryHeader
+{
+	u32 section;
+	u32 size;
+};
+
+struct Dictionary
+{
+	std::string content;
+	ZSTD_CDict *cdict {};
+	ZSTD_DDict *ddict {};
+};
+
+struct DictionarySet
+{
+	u32 id {};
+	Dictionary sections[KZ::replaysystem::dictionary::SECTION_COUNT];
+};
+
+// Sets are only added until Shutdown, pointers into them stay valid.
+static_global std::mutex setsMutex;
+static_global std::map<u32, std::unique_ptr<DictionarySet>> sets;
+static_global u32 currentSet;
+
+namespace KZ::replaysystem::dictionary
+{
+	static_function u32 GetDictionaryID(u32 set, u32 section)
+	{
+		return DICTIONARY_ID_BASE + (set << 4) + section;
+	}
+
+	static_function void GetSetPath(u32 set, char *buffer, u32 size)
+	{
+		V_snprintf(buffer, size, "%s/%04u.kzdict", KZ_REPLAY_DICTIONARY_PATH, set);
+	}
+
+	static_function std::unique_ptr<DictionarySet> ReadSet(u32 set)
+	{
+		char path[MAX_PATH];
+		GetSetPath(set, path, sizeof(path));
+		FileHandle_t file = g_pFullFileSystem->Open(path, "rb", "GAME");
+		if (!file)
+		{
+			return nullptr;
+		}
+
+		auto result = std::make_unique<DictionarySet>();
+		result->id = set;
+		DictionaryFileHeader header {};
+		bool valid = g_pFullFileSystem->Read(&header, sizeof(header), file) == sizeof(header) && header.magic == DICTIONARY_FILE_MAGIC
+					 && header.version == DICTIONARY_FILE_VERSION && header.set == set;
+		for (u32 i = 0; valid && i < header.count; i++)
+		{
+			DictionaryEntryHeader entry {};
+			valid = g_pFullFileSystem->Read(&entry, sizeof(entry), file) == sizeof(entry) && entry.section < SECTION_COUNT
+					&& entry.size <= DICTIONARY_SIZE;
+			if (!valid)
+			{
+				break;
+			}
+			std::string &content = result->sections[entry.section].content;
+			content.resize(entry.size);
+			valid = (u32)g_pFullFileSystem->Read(content.data(), entry.size, file) == entry.size
+					&& ZDICT_getDictID(content.data(), content.size()) == GetDictionaryID(set, entry.section);
+		}
+		g_pFullFileSystem->Close(file);
+
+		if (!valid)
+		{
+			META_CONPRINTF("[KZ] Replay dictionary set %s is invalid\n", path);
+			return nullptr;
+		}
+		return result;
+	}
+
+	static_function bool WriteSet(const DictionarySet &set)
+	{
+		char path[MAX_PATH];
+		char tempPath[MAX_PATH];
+		GetSetPath(set.id, path, sizeof(path));
+		V_snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+		g_pFullFileSystem->CreateDirHierarchy(KZ_REPLAY_DICTIONARY_PATH, "GAME");
+
+		FileHandle_t file = g_pFullFileSystem->Open(tempPath, "wb", "GAME");
+		if (!file)
+		{
+			return false;
+		}
+		DictionaryFileHeader header {DICTIONARY_FILE_MAGIC, DICTIONARY_FILE_VERSION, set.id, 0};
+		for (const Dictionary &dictionary : set.sections)
+		{
+			header.count += !dictionary.content.empty();
+		}
+		u32 expected = sizeof(header);
+		u32 written = g_pFullFileSystem->Write(&header, sizeof(header), file);
+		for (u32 i = 0; i < SECTION_COUNT; i++)
+		{
+			const std::string &content = set.sections[i].content;
+			if (content.empty())
+			{
+				continue;
+			}
+			DictionaryEntryHeader entry {i, (u32)content.size()};
+			expected += sizeof(entry) + entry.size;
+			written += g_pFullFileSystem->Write(&entry, sizeof(entry), file);
+			written += g_pFullFileSystem->Write(content.data(), entry.size, file);
+		}
+		g_pFullFileSystem->Close(file);
+
+		if (written != expected || !g_pFullFileSystem->RenameFile(tempPath, path, "GAME"))
+		{
+			g_pFullFileSystem->RemoveFile(tempPath, "GAME");
+			return false;
+		}
+		return true;
+	}
+
+	// Expects setsMutex to be held. Only the replay write queue (or the main thread before anything is written) may change the current set.
+	static_function void Install(std::unique_ptr<DictionarySet> set, bool makeCurrent)
+	{
+		for (Dictionary &dictionary : set->sections)
+		{
+			if (!dictionary.content.empty())
+			{
+				dictionary.ddict = ZSTD_createDDict(dictionary.content.data(), dictionary.content.size());
+			}
+		}
+
+		u32 id = set->id;
+		sets[id] = std::move(set);
+		if (!makeCurrent || id < currentSet)
+		{
+			return;
+		}
+
+		// Compression dictionaries are only used by the replay write queue.
+		auto previous = sets.find(currentSet);
+		if (previous != sets.end())
+		{
+			for (Dictionary &dictionary : previous->second->sections)
+			{
+				ZSTD_freeCDict(dictionary.cdict);
+				dictionary.cdict = nullptr;
+			}
+		}
+		for (Dictionary &dictionary : sets[id]->sections)
+		{
+			if (!dictionary.content.empty())
+			{
+				dictionary.cdict = ZSTD_createCDict(dictionary.content.data(), dictionary.content.size(), compression::DEFAULT_LEVEL);
+			}
+		}
+		currentSet = id;
+	}
+
+	void Init()
+	{
+		char searchPath[MAX_PATH];
+		V_snprintf(searchPath, sizeof(searchPath), "%s/*.kzdict", KZ_REPLAY_DICTIONARY_PATH);
+		std::vector<u32> ids;
+		FileFindHandle_t findHandle = {};
+		for (const char *fileName = g_pFullFileSystem->FindFirstEx(searchPath, "GAME", &findHandle); fileName;
+			 fileName = g_pFullFileSystem->FindNext(findHandle))
+		{
+			char *end = nullptr;
+			u32 id = strtoul(fileName, &end, 10);
+			if (end != fileName && KZ_STREQI(end, ".kzdict") && id > 0)
+			{
+				ids.push_back(id);
+			}
+		}
+		g_pFullFileSystem->FindClose(findHandle);
+
+		std::lock_guard<std::mutex> lock(setsMutex);
+		for (u32 id : ids)
+		{
+			if (sets.find(id) == sets.end())
+			{
+				if (auto set = ReadSet(id))
+				{
+					Install(std::move(set), true);
+				}
+			}
+		}
+		if (currentSet)
+		{
+			META_CONPRINTF("[KZ] Loaded %u replay dictionary sets, writing with set %u\n", (u32)sets.size(), currentSet);
+		}
+	}
+
+	void Shutdown()
+	{
+		executor::WaitIdle(executor::Queue::ReplayLoad);
+		executor::WaitIdle(executor::Queue::ReplayWrite);
+
+		std::lock_guard<std::mutex> lock(setsMutex);
+		for (auto &[id, set] : sets)
+		{
+			for (Dictionary &dictionary : set->sections)
+			{
+				ZSTD_freeCDict(dictionary.cdict);
+				ZSTD_freeDDict(dictionary.ddict);
+			}
+		}
+		sets.clear();
+		currentSet = 0;
+	}
+
+	u32 GetCurrentSet()
+	{
+		std::lock_guard<std::mutex> lock(setsMutex);
+		return currentSet;
+	}
+
+	bool RequireSet(u32 set)
+	{
+		std::lock_guard<std::mutex> lock(setsMutex);
+		if (sets.find(set) != sets.end())
+		{
+			return true;
+		}
+		// Replays copied from another server can bring their dictionaries along.
+		auto loaded = ReadSet(set);
+		if (!loaded)
+		{
+			return false;
+		}
+		Install(std::move(loaded), false);
+		return true;
+	}
+
+	const ZSTD_CDict *GetCompressionDictionary(Section section)
+	{
+		std::lock_guard<std::mutex> lock(setsMutex);
+		auto it = sets.find(currentSet);
+		return it == sets.end() ? nullptr : it->second->sections[section].cdict;
+	}
+
+	// Expects setsMutex to be held.
+	static_function const Dictionary *FindDictionary(u32 dictID)
+	{
+		if (dictID < DICTIONARY_ID_BASE || ((dictID - DICTIONARY_ID_BASE) & 0xF) >= SECTION_COUNT)
+		{
+			return nullptr;
+		}
+		auto it = sets.find((dictID - DICTIONARY_ID_BASE) >> 4);
+		if (it == sets.end())
+		{
+			return nullptr;
+		}
+		const Dictionary &dictionary = it->second->sections[(dictID - DICTIONARY_ID_BASE) & 0xF];
+		return dictionary.content.empty() ? nullptr : &dictionary;
+	}
+
+	const ZSTD_DDict *GetDecompressionDictionary(u32 dictID)
+	{
+		std::lock_guard<std::mutex> lock(setsMutex);
+		const Dictionary *dictionary = FindDictionary(dictID);
+		return dictionary ? dictionary->ddict : nullptr;
+	}
+
+	bool GetDictionaryContent(u32 dictID, const void **outData, size_t *outSize)
+	{
+		std::lock_guard<std::mutex> lock(setsMutex);
+		const Dictionary *dictionary = FindDictionary(dictID);
+		if (!dictionary)
+		{
+			return false;
+		}
+		*outData = dictionary->content.data();
+		*outSize = dictionary->content.size();
+		return true;
+	}
+
+	// Append the decompressed sections of the replay to the samples of their section type.
+	static_function void ReadSamples(pack::Reader &reader, std::string *samples, std::vector<size_t> *sampleSizes)
+	{
+		u32 headerSize = 0;
+		if (g_pFullFileSystem->Read(&headerSize, sizeof(headerSize), reader.file) != sizeof(headerSize) || headerSize > reader.length)
+		{
+			return;
+		}
+		g_pFullFileSystem->Seek(reader.file, headerSize, FILESYSTEM_SEEK_CURRENT);
+
+		std::vector<char> compressed;
+		for (u32 section = 0; section < SECTION_COUNT; section++)
+		{
+			compression::CompressedSectionHeader header;
+			if (g_pFullFileSystem->Read(&header, sizeof(header), reader.file) != sizeof(header) || header.compressedSize > reader.length)
+			{
+				return;
+			}
+			compressed.resize(header.compressedSize);
+			if ((u32)g_pFullFileSystem->Read(compressed.data(), header.compressedSize, reader.file) != header.compressedSize)
+			{
+				return;
+			}
+			if (header.uncompressedSize == 0 || header.uncompressedSize > MAX_SAMPLE_SIZE
+				|| samples[section].size() + header.uncompressedSize > MAX_SAMPLES_SIZE)
+			{
+				continue;
+			}
+			size_t offset = samples[section].size();
+			samples[section].resize(offset + header.uncompressedSize);
+			if (!compression::Decompress(compressed.data(), compressed.size(), samples[section].data() + offset, header.uncompressedSize))
+			{
+				samples[section].resize(offset);
+				return;
+			}
+			sampleSizes[section].push_back(header.uncompressedSize);
+		}
+	}
+
+	void Train(u32 maxReplays)
+	{
+		std::vector<std::pair<UUID_t, u32>> replays;
+		pack::ForEach([&](const UUID_t &uuid, const pack::Entry &entry) { replays.push_back({uuid, entry.length}); });
+		std::sort(replays.begin(), replays.end(), [](auto &a, auto &b) { return a.second < b.second; });
+		if (replays.size() > maxReplays)
+		{
+			replays.resize(maxReplays);
+		}
+
+		std::string samples[SECTION_COUNT];
+		std::vector<size_t> sampleSizes[SECTION_COUNT];
+		for (auto &[uuid, length] : replays)
+		{
+			pack::Reader reader;
+			if (pack::Open(uuid, reader))
+			{
+				ReadSamples(reader, samples, sampleSizes);
+				pack::Close(reader);
+			}
+		}
+
+		auto set = std::make_unique<DictionarySet>();
+		{
+			std::lock_guard<std::mutex> lock(setsMutex);
+			set->id = sets.empty() ? 1 : sets.rbegin()->first + 1;
+		}
+
+		META_CONPRINTF("[KZ] Training replay dictionary set %u from %u replays\n", set->id, (u32)replays.size());
+		META_CONPRINTF("%-13s %8s %12s %10s %12s %12s\n", "section", "samples", "sample KiB", "dict KiB", "plain KiB", "dict KiB");
+		u32 numTrained = 0;
+		ZSTD_CCtx *cctx = ZSTD_createCCtx();
+		for (u32 i = 0; i < SECTION_COUNT; i++)
+		{
+			if (sampleSizes[i].size() < MIN_SAMPLES)
+			{
+				META_CONPRINTF("%-13s %8u (not enough samples)\n", sectionNames[i], (u32)sampleSizes[i].size());
+				continue;
+			}
+
+			std::string content(DICTIONARY_SIZE, '\0');
+			ZDICT_fastCover_params_t params {};
+			params.d = 8;
+			params.steps = 4;
+			params.zParams.compressionLevel = compression::DEFAULT_LEVEL;
+			params.zParams.dictID = GetDictionaryID(set->id, i);
+			size_t size = ZDICT_optimizeTrainFromBuffer_fastCover(content.data(), content.size(), samples[i].data(), sampleSizes[i].data(),
+																  (u32)sampleSizes[i].size(), &params);
+			if (ZDICT_isError(size))
+			{
+				META_CONPRINTF("%-13s %8u (%s)\n", sectionNames[i], (u32)sampleSizes[i].size(), ZDICT_getErrorName(size));
+				continue;
+			}
+			content.resize(size);
+
+			// Compare the samples compressed on their own and with the new dictionary.
+			u64 plainSize = 0;
+			u64 dictionarySize = 0;
+			std::vector<char> buffer;
+			const char *sample = samples[i].data();
+			for (size_t sampleSize : sampleSizes[i])
+			{
+				buffer.resize(ZSTD_compressBound(sampleSize));
+				plainSize += ZSTD_compressCCtx(cctx, buffer.data(), buffer.size(), sample, sampleSize, compression::DEFAULT_LEVEL);
+				dictionarySize += ZSTD_compress_usingDict(cctx, buffer.data(), buffer.size(), sample, sampleSize, content.data(), content.size(),
+														  compression::DEFAULT_LEVEL);
+				sample += sampleSize;
+			}
+			META_CONPRINTF("%-13s %8u %12llu %10llu %12llu %12llu\n", sectionNames[i], (u32)sampleSizes[i].size(), (u64)samples[i].size() / 1024,
+						   (u64)content.size() / 1024, plainSize / 1024, dictionarySize / 1024);
+
+			// Only worth using if it actually helps.
+			if (dictionarySize < plainSize)
+			{
+				set->sections[i].content = std::move(content);
+				numTrained++;
+			}
+		}
+		ZSTD_freeCCtx(cctx);
+
+		if (numTrained == 0)
+		{
+			META_CONPRINTF("[KZ] No replay dictionary was trained, keeping the current set\n");
+			return;
+		}
+		if (!WriteSet(*set))
+		{
+			META_CONPRINTF("[KZ] Failed to save replay dictionary set %u\n", set->id);
+			return;
+		}
+		u32 id = set->id;
+		std::lock_guard<std::mutex> lock(setsMutex);
+		Install(std::move(set), true);
+		META_CONPRINTF("[KZ] New replays are written with dictionary set %u (%u sections)\n", id, numTrained);
+	}
+} // namespace KZ::replaysystem::dictionary
+
+CON_COMMAND_F(kz_replay_train_dictionaries, "Train new replay dictionaries from the smallest replays. Usage: kz_replay_train_dictionaries [replays]",
+			  FCVAR_NONE)
+{
+	u32 maxReplays = args.ArgC() >= 2 ? (u32)atoi(args.Arg(1)) : DEFAULT_MAX_REPLAYS;
+	META_CONPRINTF("[KZ] Training replay dictionaries in the background...\n");
+	executor::Submit(executor::Queue::ReplayWrite, [maxReplays]() { KZ::replaysystem::dictionary::Train(MAX(maxReplays, MIN_SAMPLES)); });
+}
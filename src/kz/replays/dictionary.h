@@ -0,0 +1,45 @@
+#pragma once
+
+#include "common.h"
+#include "vendor/zstd/lib/zstd.h"
+
+// Trained zstd dictionaries for replay sections. Small replays (jumps, short manual replays) barely compress on their own,
+// a dictionary trained on existing replays lets every section start from the data all replays have in common.
+// Dictionaries come in numbered sets, one dictionary per section type. A replay stores the set it was written with in its header,
+// and each compressed frame carries the ID of its dictionary so it can be decoded with any set that is loaded.
+namespace KZ::replaysystem::dictionary
+{
+	// In the order the sections are written.
+	enum Section : u32
+	{
+		SECTION_TICKS,
+		SECTION_SUBTICKS,
+		SECTION_WEAPONS,
+		SECTION_JUMPS,
+		SECTION_EVENTS,
+		SECTION_CMDS,
+		SECTION_CMD_SUBTICKS,
+		SECTION_COUNT
+	};
+
+	// Load every set on disk, the newest one is used for new replays.
+	void Init();
+	// Waits for replay loads to finish before freeing the dictionaries.
+	void Shutdown();
+
+	// Set new replays are written with, 0 if no dictionaries were trained.
+	u32 GetCurrentSet();
+	// Load the set from disk if it isn't loaded yet. Sets are never unloaded before Shutdown.
+	bool RequireSet(u32 set);
+
+	// Dictionary of the current set for the section, nullptr if there is none. Only used by the replay write queue.
+	const ZSTD_CDict *GetCompressionDictionary(Section section);
+	// nullptr if the set of the dictionary is not loaded.
+	const ZSTD_DDict *GetDecompressionDictionary(u32 dictID);
+	// Raw dictionary, for recompressing a frame with the dictionary it was written with.
+	bool GetDictionaryContent(u32 dictID, const void **outData, size_t *outSize);
+
+	// Sample up to maxReplays replays from the pack, smallest first, and train a new set from their sections.
+	// The new set is saved and used for new replays if at least one section could be trained. Runs on the replay write queue.
+	void Train(u32 maxReplays);
+} // namespace KZ::replaysystem::dictionary
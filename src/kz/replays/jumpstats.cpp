@@ -36,7 +36,7 @@ void RpJumpStats::FromJump(RpJumpStats &stats, Jump *jump)
 	stats.overall.duckDuration = jump->duckDuration;
 	stats.overall.duckEndDuration = jump->duckEndDuration;
 	stats.overall.release = jump->release;
-	stats.overall.block = -1.0f; // TODO
+	stats.overall.block = jump->GetBlock();
 	stats.overall.edge = jump->GetEdge(false);
 	stats.overall.landingEdge = jump->GetEdge(true);
 	V_strncpy(stats.overall.invalidateReason, jump->invalidateReason, sizeof(stats.overall.invalidateReason));
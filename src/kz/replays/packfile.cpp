@@ -0,0 +1,723 @@
+#include "packfile.h"
+#include "utils/executor.h"
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#define KZ_REPLAY_PACK_PATH KZ_REPLAY_PATH "/pack"
+
+static_global const char *INDEX_PATH = KZ_REPLAY_PACK_PATH "/index.kzidx";
+static_global const char *INDEX_TEMP_PATH = KZ_REPLAY_PACK_PATH "/index.kzidx.tmp";
+
+enum : u32
+{
+	PACK_VERSION = 1,
+	PACK_SEGMENT_MAGIC = 0x4B505A4B, // KZPK
+	PACK_RECORD_MAGIC = 0x52505A4B,  // KZPR
+	PACK_INDEX_MAGIC = 0x49505A4B,   // KZPI
+};
+
+enum IndexOp : u32
+{
+	INDEX_OP_ADD,
+	INDEX_OP_REMOVE,
+
+	INDEX_OP_MASK = 0xFFFF,
+	// Set on INDEX_OP_ADD for replays in the archive tier.
+	INDEX_FLAG_ARCHIVE = 1 << 16,
+};
+
+// Segments stop receiving new records past this size.
+static_global constexpr u32 SEGMENT_MAX_SIZE = 64 * 1024 * 1024;
+static_global constexpr u32 COPY_BUFFER_SIZE = 64 * 1024;
+static_global constexpr u32 HEADER_MAX_SIZE = 5 * 1024 * 1024;
+static_global constexpr f64 COMPACT_INTERVAL = 60.0;
+
+struct SegmentHeader
+{
+	u32 magic;
+	u32 version;
+};
+
+// Written before every replay in a segment, checked against the index when the replay is opened.
+struct RecordHeader
+{
+	u32 magic;
+	u8 uuid[16];
+};
+
+// Followed by headerSize bytes of serialized ReplayHeader for INDEX_OP_ADD.
+struct IndexRecord
+{
+	u32 magic;
+	u32 op;
+	u8 uuid[16];
+	u32 segment;
+	u32 offset;
+	u32 length;
+	u32 headerSize;
+};
+
+static_assert(sizeof(RecordHeader) == 20 && sizeof(IndexRecord) == 40, "Pack structures must not be padded");
+
+struct Segment
+{
+	u32 size {};
+	// Bytes of replay data still referenced by the index.
+	u32 liveBytes {};
+	u32 readers {};
+	// Compacted while a reader had it open, deleted once the last one closes.
+	bool retired {};
+};
+
+// Guards everything below.
+static_global std::mutex g_indexMutex;
+static_global bool g_loaded;
+static_global std::unordered_map<UUID_t, KZ::replaysystem::pack::Entry> g_entries;
+static_global std::map<u32, Segment> g_segments;
+static_global FileHandle_t g_indexFile;
+static_global u32 g_indexRecords;
+
+// Only one writer appends to segments at a time.
+static_global std::mutex g_appendMutex;
+static_global executor::TimerID g_compactTimer;
+
+namespace KZ::replaysystem::pack
+{
+	static_function void GetSegmentPath(u32 segment, char *buffer, u32 size)
+	{
+		V_snprintf(buffer, size, "%s/%06u.kzpack", KZ_REPLAY_PACK_PATH, segment);
+	}
+
+	static_function u32 CopyBytes(FileHandle_t from, FileHandle_t to, u32 length)
+	{
+		std::vector<u8> buffer(MIN(length, COPY_BUFFER_SIZE));
+		u32 copied = 0;
+		while (copied < length)
+		{
+			u32 chunk = MIN(length - copied, COPY_BUFFER_SIZE);
+			if ((u32)g_pFullFileSystem->Read(buffer.data(), chunk, from) != chunk || (u32)g_pFullFileSystem->Write(buffer.data(), chunk, to) != chunk)
+			{
+				break;
+			}
+			copied += chunk;
+		}
+		return copied;
+	}
+
+	static_function bool ReadReplayHeader(FileHandle_t file, ReplayHeader &header)
+	{
+		u32 size = 0;
+		if (g_pFullFileSystem->Read(&size, sizeof(size), file) != sizeof(size) || size == 0 || size > HEADER_MAX_SIZE)
+		{
+			return false;
+		}
+		std::string serialized;
+		serialized.resize(size);
+		return (u32)g_pFullFileSystem->Read(serialized.data(), size, file) == size && header.ParseFromString(serialized);
+	}
+
+	static_function bool WriteIndexRecord(FileHandle_t file, u32 op, const UUID_t &uuid, const Entry *entry)
+	{
+		IndexRecord record {};
+		record.magic = PACK_INDEX_MAGIC;
+		record.op = op;
+		V_memcpy(record.uuid, uuid.bytes, sizeof(record.uuid));
+		std::string serialized;
+		if (entry)
+		{
+			if (!entry->header.SerializeToString(&serialized))
+			{
+				return false;
+			}
+			if (entry->tier == TIER_ARCHIVE)
+			{
+				record.op |= INDEX_FLAG_ARCHIVE;
+			}
+			record.segment = entry->segment;
+			record.offset = entry->offset;
+			record.length = entry->length;
+			record.headerSize = (u32)serialized.size();
+		}
+		if (g_pFullFileSystem->Write(&record, sizeof(record), file) != sizeof(record))
+		{
+			return false;
+		}
+		return record.headerSize == 0 || (u32)g_pFullFileSystem->Write(serialized.data(), record.headerSize, file) == record.headerSize;
+	}
+
+	// The functions below expect g_indexMutex to be held.
+
+	static_function void AppendIndexRecord(u32 op, const UUID_t &uuid, const Entry *entry)
+	{
+		if (!g_indexFile)
+		{
+			g_indexFile = g_pFullFileSystem->Open(INDEX_PATH, "ab", "GAME");
+		}
+		// The replay stays usable until the next restart, after which it is dead weight for compaction.
+		if (!g_indexFile || !WriteIndexRecord(g_indexFile, op, uuid, entry))
+		{
+			META_CONPRINTF("[KZ] Failed to write replay pack index record for %s\n", uuid.ToString().c_str());
+			return;
+		}
+		g_pFullFileSystem->Flush(g_indexFile);
+		g_indexRecords++;
+	}
+
+	static_function bool UnlinkEntry(const UUID_t &uuid)
+	{
+		auto it = g_entries.find(uuid);
+		if (it == g_entries.end())
+		{
+			return false;
+		}
+		auto segment = g_segments.find(it->second.segment);
+		if (segment != g_segments.end())
+		{
+			segment->second.liveBytes -= it->second.length;
+		}
+		g_entries.erase(it);
+		return true;
+	}
+
+	static_function void LinkEntry(const UUID_t &uuid, Entry &&entry)
+	{
+		UnlinkEntry(uuid);
+		g_segments[entry.segment].liveBytes += entry.length;
+		g_entries[uuid] = std::move(entry);
+	}
+
+	static_function void RemoveSegment(std::map<u32, Segment>::iterator it)
+	{
+		char path[MAX_PATH];
+		GetSegmentPath(it->first, path, sizeof(path));
+		g_pFullFileSystem->RemoveFile(path, "GAME");
+		g_segments.erase(it);
+	}
+
+	// Replace the index with one record per live replay. The new index is complete on disk before the old one is removed.
+	static_function bool RewriteIndex()
+	{
+		FileHandle_t file = g_pFullFileSystem->Open(INDEX_TEMP_PATH, "wb", "GAME");
+		if (!file)
+		{
+			return false;
+		}
+		bool success = true;
+		for (auto &[uuid, entry] : g_entries)
+		{
+			if (!WriteIndexRecord(file, INDEX_OP_ADD, uuid, &entry))
+			{
+				success = false;
+				break;
+			}
+		}
+		g_pFullFileSystem->Close(file);
+		if (!success)
+		{
+			g_pFullFileSystem->RemoveFile(INDEX_TEMP_PATH, "GAME");
+			return false;
+		}
+
+		if (g_indexFile)
+		{
+			g_pFullFileSystem->Close(g_indexFile);
+			g_indexFile = nullptr;
+		}
+		g_pFullFileSystem->RemoveFile(INDEX_PATH, "GAME");
+		if (!g_pFullFileSystem->RenameFile(INDEX_TEMP_PATH, INDEX_PATH, "GAME"))
+		{
+			META_CONPRINTF("[KZ] Failed to replace the replay pack index, it will be recovered on the next load\n");
+			return false;
+		}
+		g_indexRecords = (u32)g_entries.size();
+		return true;
+	}
+
+	static_function void EnsureLoaded()
+	{
+		if (g_loaded)
+		{
+			return;
+		}
+		g_loaded = true;
+		g_pFullFileSystem->CreateDirHierarchy(KZ_REPLAY_PACK_PATH, "GAME");
+
+		char searchPath[MAX_PATH];
+		V_snprintf(searchPath, sizeof(searchPath), "%s/*.kzpack", KZ_REPLAY_PACK_PATH);
+		FileFindHandle_t findHandle = {};
+		for (const char *fileName = g_pFullFileSystem->FindFirstEx(searchPath, "GAME", &findHandle); fileName;
+			 fileName = g_pFullFileSystem->FindNext(findHandle))
+		{
+			char *end = nullptr;
+			u32 segment = strtoul(fileName, &end, 10);
+			if (end == fileName || !KZ_STREQI(end, ".kzpack"))
+			{
+				continue;
+			}
+			char path[MAX_PATH];
+			GetSegmentPath(segment, path, sizeof(path));
+			g_segments[segment].size = g_pFullFileSystem->Size(path, "GAME");
+		}
+		g_pFullFileSystem->FindClose(findHandle);
+
+		// A rewrite that was interrupted leaves the temporary index behind. It is only complete if the old index is already gone.
+		if (g_pFullFileSystem->FileExists(INDEX_TEMP_PATH, "GAME"))
+		{
+			if (g_pFullFileSystem->FileExists(INDEX_PATH, "GAME"))
+			{
+				g_pFullFileSystem->RemoveFile(INDEX_TEMP_PATH, "GAME");
+			}
+			else
+			{
+				g_pFullFileSystem->RenameFile(INDEX_TEMP_PATH, INDEX_PATH, "GAME");
+			}
+		}
+
+		// A torn record at the end means the server stopped mid append, everything before it is still valid.
+		bool dirty = false;
+		u32 records = 0;
+		FileHandle_t file = g_pFullFileSystem->Open(INDEX_PATH, "rb", "GAME");
+		if (file)
+		{
+			IndexRecord record;
+			std::string serialized;
+			while (!g_pFullFileSystem->EndOfFile(file))
+			{
+				if (g_pFullFileSystem->Read(&record, sizeof(record), file) != sizeof(record) || record.magic != PACK_INDEX_MAGIC
+					|| record.headerSize > HEADER_MAX_SIZE)
+				{
+					dirty = true;
+					break;
+				}
+				UUID_t uuid(false);
+				V_memcpy(uuid.bytes, record.uuid, sizeof(uuid.bytes));
+				if ((record.op & INDEX_OP_MASK) == INDEX_OP_REMOVE)
+				{
+					g_entries.erase(uuid);
+					records++;
+					continue;
+				}
+				Entry entry;
+				entry.tier = (record.op & INDEX_FLAG_ARCHIVE) ? TIER_ARCHIVE : TIER_FAST;
+				entry.segment = record.segment;
+				entry.offset = record.offset;
+				entry.length = record.length;
+				serialized.resize(record.headerSize);
+				if ((u32)g_pFullFileSystem->Read(serialized.data(), record.headerSize, file) != record.headerSize
+					|| !entry.header.ParseFromString(serialized))
+				{
+					dirty = true;
+					break;
+				}
+				g_entries[uuid] = std::move(entry);
+				records++;
+			}
+			g_pFullFileSystem->Close(file);
+		}
+		g_indexRecords = records;
+
+		for (auto it = g_entries.begin(); it != g_entries.end();)
+		{
+			auto segment = g_segments.find(it->second.segment);
+			if (segment == g_segments.end() || (u64)it->second.offset + it->second.length > segment->second.size)
+			{
+				META_CONPRINTF("[KZ] Dropping replay %s, its pack segment is missing or truncated\n", it->first.ToString().c_str());
+				it = g_entries.erase(it);
+				dirty = true;
+				continue;
+			}
+			segment->second.liveBytes += it->second.length;
+			++it;
+		}
+
+		if (dirty)
+		{
+			RewriteIndex();
+		}
+		META_CONPRINTF("[KZ] Loaded replay pack index: %u replays in %u segments\n", (u32)g_entries.size(), (u32)g_segments.size());
+	}
+
+	// The last segment receives new records until it is full.
+	static_function u32 GetActiveSegment()
+	{
+		if (!g_segments.empty())
+		{
+			auto last = std::prev(g_segments.end());
+			if (!last->second.retired && last->second.size < SEGMENT_MAX_SIZE)
+			{
+				return last->first;
+			}
+		}
+		u32 segment = g_segments.empty() ? 0 : g_segments.rbegin()->first + 1;
+		g_segments[segment] = {};
+		return segment;
+	}
+
+	// Expects g_appendMutex to be held. A failed append may still grow the segment, the bytes are reclaimed by compaction.
+	static_function bool AppendRecord(const UUID_t &uuid, const WriteFunc &write, Entry &outEntry)
+	{
+		u32 segment, size;
+		{
+			std::lock_guard<std::mutex> lock(g_indexMutex);
+			EnsureLoaded();
+			segment = GetActiveSegment();
+			size = g_segments[segment].size;
+		}
+
+		char path[MAX_PATH];
+		GetSegmentPath(segment, path, sizeof(path));
+		FileHandle_t file = g_pFullFileSystem->Open(path, "ab", "GAME");
+		if (!file)
+		{
+			META_CONPRINTF("[KZ] Failed to open replay pack segment for writing: %s\n", path);
+			return false;
+		}
+
+		u32 offset = size;
+		if (size == 0)
+		{
+			SegmentHeader header {PACK_SEGMENT_MAGIC, PACK_VERSION};
+			offset += g_pFullFileSystem->Write(&header, sizeof(header), file);
+		}
+		RecordHeader record {};
+		record.magic = PACK_RECORD_MAGIC;
+		V_memcpy(record.uuid, uuid.bytes, sizeof(record.uuid));
+		offset += g_pFullFileSystem->Write(&record, sizeof(record), file);
+		u32 length = write(file);
+		g_pFullFileSystem->Close(file);
+
+		u32 newSize = g_pFullFileSystem->Size(path, "GAME");
+		{
+			std::lock_guard<std::mutex> lock(g_indexMutex);
+			g_segments[segment].size = newSize;
+		}
+		if (length == 0 || newSize != (u64)offset + length)
+		{
+			META_CONPRINTF("[KZ] Failed to append replay %s to %s\n", uuid.ToString().c_str(), path);
+			return false;
+		}
+
+		outEntry.segment = segment;
+		outEntry.offset = offset;
+		outEntry.length = length;
+		return true;
+	}
+
+	void Init()
+	{
+		if (g_compactTimer)
+		{
+			return;
+		}
+		// Compaction shares the write queue so it never competes with replays being saved.
+		g_compactTimer = executor::AddTimer(executor::Queue::ReplayWrite, COMPACT_INTERVAL, COMPACT_INTERVAL, []() { Compact(); });
+	}
+
+	void Shutdown()
+	{
+		if (g_compactTimer)
+		{
+			executor::RemoveTimer(g_compactTimer);
+			g_compactTimer = 0;
+		}
+		executor::WaitIdle(executor::Queue::ReplayWrite);
+
+		std::lock_guard<std::mutex> lock(g_indexMutex);
+		if (g_indexFile)
+		{
+			g_pFullFileSystem->Close(g_indexFile);
+			g_indexFile = nullptr;
+		}
+	}
+
+	bool Append(const UUID_t &uuid, const ReplayHeader &header, const WriteFunc &write)
+	{
+		std::lock_guard<std::mutex> appendLock(g_appendMutex);
+		Entry entry;
+		if (!AppendRecord(uuid, write, entry))
+		{
+			return false;
+		}
+		entry.header = header;
+
+		std::lock_guard<std::mutex> lock(g_indexMutex);
+		AppendIndexRecord(INDEX_OP_ADD, uuid, &entry);
+		LinkEntry(uuid, std::move(entry));
+		return true;
+	}
+
+	bool Import(const char *path)
+	{
+		UUID_t uuid(false);
+		if (!UUID_t::FromString(CUtlString(path).GetBaseFilename().StripExtension().Get(), &uuid))
+		{
+			return false;
+		}
+		// Already imported, the server stopped before the loose file was removed.
+		if (Find(uuid))
+		{
+			g_pFullFileSystem->RemoveFile(path, "GAME");
+			return true;
+		}
+
+		FileHandle_t file = g_pFullFileSystem->Open(path, "rb", "GAME");
+		if (!file)
+		{
+			return false;
+		}
+		u32 fileSize = g_pFullFileSystem->Size(file);
+		ReplayHeader header;
+		if (!ReadReplayHeader(file, header))
+		{
+			g_pFullFileSystem->Close(file);
+			return false;
+		}
+		g_pFullFileSystem->Seek(file, 0, FILESYSTEM_SEEK_HEAD);
+		bool success = Append(uuid, header, [file, fileSize](FileHandle_t out) { return CopyBytes(file, out, fileSize); });
+		g_pFullFileSystem->Close(file);
+
+		if (success)
+		{
+			g_pFullFileSystem->RemoveFile(path, "GAME");
+		}
+		return success;
+	}
+
+	bool Rewrite(const UUID_t &uuid, Tier tier, const TransformFunc &transform)
+	{
+		std::lock_guard<std::mutex> appendLock(g_appendMutex);
+		Entry original;
+		Reader reader;
+		if (!Find(uuid, &original) || !Open(uuid, reader))
+		{
+			return false;
+		}
+		Entry entry;
+		bool success = AppendRecord(uuid, [&](FileHandle_t out) { return transform(reader.file, reader.length, out); }, entry);
+		Close(reader);
+		if (!success)
+		{
+			return false;
+		}
+		entry.tier = tier;
+		entry.header = std::move(original.header);
+
+		std::lock_guard<std::mutex> lock(g_indexMutex);
+		auto it = g_entries.find(uuid);
+		// The new record is reclaimed by compaction.
+		if (it == g_entries.end() || it->second.segment != original.segment || it->second.offset != original.offset)
+		{
+			return false;
+		}
+		AppendIndexRecord(INDEX_OP_ADD, uuid, &entry);
+		LinkEntry(uuid, std::move(entry));
+		return true;
+	}
+
+	bool Remove(const UUID_t &uuid)
+	{
+		std::lock_guard<std::mutex> lock(g_indexMutex);
+		EnsureLoaded();
+		if (!UnlinkEntry(uuid))
+		{
+			return false;
+		}
+		AppendIndexRecord(INDEX_OP_REMOVE, uuid, nullptr);
+		return true;
+	}
+
+	bool Find(const UUID_t &uuid, Entry *outEntry)
+	{
+		std::lock_guard<std::mutex> lock(g_indexMutex);
+		EnsureLoaded();
+		auto it = g_entries.find(uuid);
+		if (it == g_entries.end())
+		{
+			return false;
+		}
+		if (outEntry)
+		{
+			*outEntry = it->second;
+		}
+		return true;
+	}
+
+	void ForEach(const std::function<void(const UUID_t &uuid, const Entry &entry)> &callback)
+	{
+		std::lock_guard<std::mutex> lock(g_indexMutex);
+		EnsureLoaded();
+		for (auto &[uuid, entry] : g_entries)
+		{
+			callback(uuid, entry);
+		}
+	}
+
+	bool Open(const UUID_t &uuid, Reader &outReader)
+	{
+		outReader = {};
+		{
+			std::lock_guard<std::mutex> lock(g_indexMutex);
+			EnsureLoaded();
+			auto it = g_entries.find(uuid);
+			if (it != g_entries.end())
+			{
+				outReader.segment = it->second.segment;
+				outReader.offset = it->second.offset;
+				outReader.length = it->second.length;
+				g_segments[outReader.segment].readers++;
+			}
+		}
+
+		char path[MAX_PATH];
+		if (outReader.segment == INVALID_SEGMENT)
+		{
+			V_snprintf(path, sizeof(path), "%s/%s.replay", KZ_REPLAY_PATH, uuid.ToString().c_str());
+			outReader.file = g_pFullFileSystem->Open(path, "rb", "GAME");
+			if (!outReader.file)
+			{
+				// The loose file may have been imported in the meantime.
+				return Find(uuid) && Open(uuid, outReader);
+			}
+			outReader.length = g_pFullFileSystem->Size(outReader.file);
+			return true;
+		}
+
+		GetSegmentPath(outReader.segment, path, sizeof(path));
+		outReader.file = g_pFullFileSystem->Open(path, "rb", "GAME");
+		RecordHeader record {};
+		if (outReader.file)
+		{
+			g_pFullFileSystem->Seek(outReader.file, outReader.offset - sizeof(record), FILESYSTEM_SEEK_HEAD);
+			g_pFullFileSystem->Read(&record, sizeof(record), outReader.file);
+		}
+		if (record.magic != PACK_RECORD_MAGIC || V_memcmp(record.uuid, uuid.bytes, sizeof(record.uuid)))
+		{
+			META_CONPRINTF("[KZ] Replay %s does not match its pack record in %s\n", uuid.ToString().c_str(), path);
+			Close(outReader);
+			return false;
+		}
+		return true;
+	}
+
+	void Close(Reader &reader)
+	{
+		if (reader.file)
+		{
+			g_pFullFileSystem->Close(reader.file);
+		}
+		if (reader.segment != INVALID_SEGMENT)
+		{
+			std::lock_guard<std::mutex> lock(g_indexMutex);
+			auto it = g_segments.find(reader.segment);
+			if (it != g_segments.end() && --it->second.readers == 0 && it->second.retired)
+			{
+				RemoveSegment(it);
+			}
+		}
+		reader = {};
+	}
+
+	void Compact()
+	{
+		std::lock_guard<std::mutex> appendLock(g_appendMutex);
+		std::vector<u32> candidates;
+		{
+			std::lock_guard<std::mutex> lock(g_indexMutex);
+			EnsureLoaded();
+			if (g_segments.empty())
+			{
+				return;
+			}
+			u32 active = g_segments.rbegin()->first;
+			for (auto &[id, segment] : g_segments)
+			{
+				if (id != active && !segment.retired && (u64)segment.liveBytes * 2 < segment.size)
+				{
+					candidates.push_back(id);
+				}
+			}
+		}
+
+		u32 numCompacted = 0;
+		u32 numMoved = 0;
+		for (u32 id : candidates)
+		{
+			std::vector<std::pair<UUID_t, Entry>> records;
+			{
+				std::lock_guard<std::mutex> lock(g_indexMutex);
+				for (auto &[uuid, entry] : g_entries)
+				{
+					if (entry.segment == id)
+					{
+						records.push_back({uuid, entry});
+					}
+				}
+			}
+
+			char path[MAX_PATH];
+			GetSegmentPath(id, path, sizeof(path));
+			FileHandle_t source = records.empty() ? nullptr : g_pFullFileSystem->Open(path, "rb", "GAME");
+			if (!records.empty() && !source)
+			{
+				continue;
+			}
+
+			bool complete = true;
+			for (auto &[uuid, entry] : records)
+			{
+				g_pFullFileSystem->Seek(source, entry.offset, FILESYSTEM_SEEK_HEAD);
+				Entry moved;
+				u32 length = entry.length;
+				if (!AppendRecord(uuid, [source, length](FileHandle_t out) { return CopyBytes(source, out, length); }, moved))
+				{
+					complete = false;
+					break;
+				}
+				moved.tier = entry.tier;
+				moved.header = std::move(entry.header);
+
+				std::lock_guard<std::mutex> lock(g_indexMutex);
+				auto it = g_entries.find(uuid);
+				// Deleted while it was being copied, the copy is reclaimed by a later compaction.
+				if (it == g_entries.end() || it->second.segment != id)
+				{
+					continue;
+				}
+				AppendIndexRecord(INDEX_OP_ADD, uuid, &moved);
+				LinkEntry(uuid, std::move(moved));
+				numMoved++;
+			}
+			if (source)
+			{
+				g_pFullFileSystem->Close(source);
+			}
+			if (!complete)
+			{
+				break;
+			}
+
+			std::lock_guard<std::mutex> lock(g_indexMutex);
+			auto it = g_segments.find(id);
+			if (it->second.readers > 0)
+			{
+				it->second.retired = true;
+			}
+			else
+			{
+				RemoveSegment(it);
+			}
+			numCompacted++;
+		}
+
+		std::lock_guard<std::mutex> lock(g_indexMutex);
+		if (g_indexRecords > g_entries.size() * 2 + 1024)
+		{
+			RewriteIndex();
+		}
+		if (numCompacted > 0)
+		{
+			META_CONPRINTF("[KZ] Compacted %u replay pack segments, moved %u replays\n", numCompacted, numMoved);
+		}
+	}
+} // namespace KZ::replaysystem::pack
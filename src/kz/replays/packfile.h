@@ -0,0 +1,74 @@
+#pragma once
+
+#include <functional>
+#include "kz_replay.h"
+#include "filesystem.h"
+#include "utils/uuid.h"
+
+// Replays are stored as records appended to a few large segment files instead of one file per replay.
+// An append-only index maps every replay to its record and keeps a copy of its header, so listing, finding and deleting replays
+// never touch the segments. Deleted records are reclaimed by a background compaction that moves the live ones out of sparse segments.
+// A record holds exactly the bytes of a loose <uuid>.replay file, loose files are imported as they are found.
+namespace KZ::replaysystem::pack
+{
+	inline constexpr u32 INVALID_SEGMENT = 0xFFFFFFFF;
+
+	// How the sections of a replay are compressed. The data layout is the same for every tier, only the zstd frames differ.
+	enum Tier : u8
+	{
+		// Written at the default level, fast to write and decode.
+		TIER_FAST,
+		// Recompressed at a high level for storage.
+		TIER_ARCHIVE,
+	};
+
+	struct Entry
+	{
+		u32 segment = INVALID_SEGMENT;
+		Tier tier = TIER_FAST;
+		// Offset and length of the replay data, past the record header.
+		u32 offset {};
+		u32 length {};
+		ReplayHeader header;
+	};
+
+	// An open replay positioned at the start of its data. Loose files that were not imported yet have no segment.
+	struct Reader
+	{
+		FileHandle_t file {};
+		u32 segment = INVALID_SEGMENT;
+		u32 offset {};
+		u32 length {};
+	};
+
+	// Writes the replay data and returns the number of bytes written.
+	using WriteFunc = std::function<u32(FileHandle_t file)>;
+	// Reads length bytes of replay data from in, writes the new data to out and returns the number of bytes written.
+	using TransformFunc = std::function<u32(FileHandle_t in, u32 length, FileHandle_t out)>;
+
+	// Starts the compaction timer. The index is loaded by whichever thread needs it first.
+	void Init();
+	// Stops compaction and waits for pending writes. Must be called after the replay file writer is flushed.
+	void Shutdown();
+
+	// Append a replay to the current segment. Thread safe, appends are serialized.
+	bool Append(const UUID_t &uuid, const ReplayHeader &header, const WriteFunc &write);
+	// Move a loose replay file into the pack. The file is removed once its record is indexed.
+	bool Import(const char *path);
+
+	// Write a new version of an indexed replay. The index switches to it with a single record once it is complete,
+	// and not at all if the replay was removed or rewritten in the meantime.
+	bool Rewrite(const UUID_t &uuid, Tier tier, const TransformFunc &transform);
+
+	bool Remove(const UUID_t &uuid);
+	bool Find(const UUID_t &uuid, Entry *outEntry = nullptr);
+	// The index is locked while iterating, the callback must not call back into the pack.
+	void ForEach(const std::function<void(const UUID_t &uuid, const Entry &entry)> &callback);
+
+	// Segments stay on disk while a reader has them open, even if compaction has moved their records.
+	bool Open(const UUID_t &uuid, Reader &outReader);
+	void Close(Reader &reader);
+
+	// Move the live records out of sparse segments and delete them. Runs periodically on the replay write queue.
+	void Compact();
+} // namespace KZ::replaysystem::pack
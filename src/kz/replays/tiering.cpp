@@ -0,0 +1,204 @@
+#include "tiering.h"
+#include "packfile.h"
+#include "compression.h"
+#include "dictionary.h"
+#include "cs2kz.h"
+#include "utils/ctimer.h"
+#include "utils/executor.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+CConVar<i32> kz_replay_archive_age("kz_replay_archive_age", FCVAR_NONE,
+								   "Run and jump replays older than this many days are recompressed for storage, 0 to disable.", 7, true, 0,
+								   false, 0);
+CConVar<i32> kz_replay_archive_level("kz_replay_archive_level", FCVAR_NONE, "zstd level used for archived replays.", 19, true, 1, true, 22);
+
+static_global constexpr f64 TIERING_INTERVAL = 120.0;
+// Replays rewritten per run, keeps each run short enough not to hold up replays being saved.
+static_global constexpr u32 TIERING_BATCH_SIZE = 16;
+
+static_global CTimer<> *tieringTimer;
+static_global std::atomic<bool> tieringQueued;
+
+// Totals since the plugin was loaded, written by the replay write queue.
+static_global std::mutex statsMutex;
+static_global KZ::replaysystem::compression::RecompressStats archiveStats;
+static_global KZ::replaysystem::compression::RecompressStats restoreStats;
+static_global u32 numArchived;
+static_global u32 numRestored;
+
+namespace KZ::replaysystem::tiering
+{
+	// Replays of the same player on the same leaderboard compete for one personal best.
+	static_function std::string GetLeaderboardKey(const ReplayHeader &header)
+	{
+		const auto &run = header.run();
+		std::string key = std::to_string(header.player().steamid64());
+		key += '/';
+		key += run.course_name();
+		key += '/';
+		key += run.mode().name();
+		for (const auto &style : run.styles())
+		{
+			key += '+';
+			key += style.name();
+		}
+		key += run.num_teleports() == 0 ? "/pro" : "/nub";
+		return key;
+	}
+
+	static_function void RunTiering(std::string mapName, u64 archiveBefore, i32 level)
+	{
+		struct Candidate
+		{
+			UUID_t uuid;
+			u64 timestamp;
+			pack::Tier tier;
+			u32 dictionarySet;
+		};
+
+		std::vector<Candidate> candidates;
+		std::unordered_map<std::string, std::pair<UUID_t, f32>> personalBests;
+		pack::ForEach(
+			[&](const UUID_t &uuid, const pack::Entry &entry)
+			{
+				const ReplayHeader &header = entry.header;
+				ReplayType type = static_cast<ReplayType>(header.type());
+				if (type != RP_RUN && type != RP_JUMPSTATS)
+				{
+					return;
+				}
+				candidates.push_back({uuid, header.timestamp(), entry.tier, header.dictionary_set()});
+				if (type == RP_RUN && KZ_STREQI(header.map().name().c_str(), mapName.c_str()))
+				{
+					auto result = personalBests.try_emplace(GetLeaderboardKey(header), uuid, header.run().time());
+					if (!result.second && header.run().time() < result.first->second.second)
+					{
+						result.first->second = {uuid, header.run().time()};
+					}
+				}
+			});
+
+		std::unordered_set<UUID_t> hot;
+		for (auto &[key, best] : personalBests)
+		{
+			hot.insert(best.first);
+		}
+
+		// Restore hot replays first, then archive the oldest ones.
+		std::vector<std::pair<const Candidate *, pack::Tier>> work;
+		for (const Candidate &candidate : candidates)
+		{
+			bool isHot = hot.count(candidate.uuid) > 0;
+			if (isHot && candidate.tier == pack::TIER_ARCHIVE)
+			{
+				work.push_back({&candidate, pack::TIER_FAST});
+			}
+			else if (!isHot && candidate.tier == pack::TIER_FAST && candidate.timestamp < archiveBefore)
+			{
+				work.push_back({&candidate, pack::TIER_ARCHIVE});
+			}
+		}
+		std::sort(work.begin(), work.end(),
+				  [](auto &a, auto &b)
+				  {
+					  if (a.second != b.second)
+					  {
+						  return a.second == pack::TIER_FAST;
+					  }
+					  return a.first->timestamp < b.first->timestamp;
+				  });
+		if (work.size() > TIERING_BATCH_SIZE)
+		{
+			work.resize(TIERING_BATCH_SIZE);
+		}
+
+		for (auto &[candidate, tier] : work)
+		{
+			// Sections are recompressed with the dictionaries they were written with.
+			if (candidate->dictionarySet && !dictionary::RequireSet(candidate->dictionarySet))
+			{
+				continue;
+			}
+			compression::RecompressStats stats {};
+			i32 targetLevel = tier == pack::TIER_ARCHIVE ? level : compression::DEFAULT_LEVEL;
+			bool success = pack::Rewrite(candidate->uuid, tier,
+										 [&](FileHandle_t in, u32 length, FileHandle_t out)
+										 { return compression::RecompressReplay(in, length, out, targetLevel, stats); });
+			if (!success)
+			{
+				continue;
+			}
+
+			std::lock_guard<std::mutex> lock(statsMutex);
+			compression::RecompressStats &total = tier == pack::TIER_ARCHIVE ? archiveStats : restoreStats;
+			total.bytesBefore += stats.bytesBefore;
+			total.bytesAfter += stats.bytesAfter;
+			total.decodeTimeBefore += stats.decodeTimeBefore;
+			total.decodeTimeAfter += stats.decodeTimeAfter;
+			(tier == pack::TIER_ARCHIVE ? numArchived : numRestored)++;
+		}
+	}
+
+	static_function f64 ScheduleTiering()
+	{
+		if (kz_replay_archive_age.Get() <= 0 || tieringQueued.exchange(true))
+		{
+			return TIERING_INTERVAL;
+		}
+
+		time_t unixTime = 0;
+		time(&unixTime);
+		u64 archiveBefore = (u64)unixTime - kz_replay_archive_age.Get() * 86400ULL;
+		std::string mapName = g_pKZUtils->GetCurrentMapName().Get();
+		i32 level = kz_replay_archive_level.Get();
+		executor::Submit(executor::Queue::ReplayWrite,
+						 [mapName, archiveBefore, level]()
+						 {
+							 RunTiering(mapName, archiveBefore, level);
+							 tieringQueued = false;
+						 });
+		return TIERING_INTERVAL;
+	}
+
+	void Init()
+	{
+		if (!tieringTimer)
+		{
+			tieringTimer = StartTimer(ScheduleTiering, TIERING_INTERVAL, true, true);
+		}
+	}
+} // namespace KZ::replaysystem::tiering
+
+static_function void PrintRecompressStats(const char *name, u32 count, const KZ::replaysystem::compression::RecompressStats &stats)
+{
+	i64 saved = (i64)stats.bytesBefore - (i64)stats.bytesAfter;
+	f64 savedPercent = stats.bytesBefore ? saved * 100.0 / stats.bytesBefore : 0.0;
+	f64 decodeChange = stats.decodeTimeBefore > 0.0 ? (stats.decodeTimeAfter / stats.decodeTimeBefore - 1.0) * 100.0 : 0.0;
+	META_CONPRINTF("%-9s %8u %12llu %12llu %+12lld %+7.1f%% %10.3f %10.3f %+7.1f%%\n", name, count, stats.bytesBefore / 1024, stats.bytesAfter / 1024,
+				   saved / 1024, -savedPercent, stats.decodeTimeBefore * 1000.0, stats.decodeTimeAfter * 1000.0, decodeChange);
+}
+
+CON_COMMAND_F(kz_replay_tier_stats, "Print the size of each replay tier and the effect of recompression since the plugin was loaded.", FCVAR_NONE)
+{
+	u32 counts[2] {};
+	u64 bytes[2] {};
+	KZ::replaysystem::pack::ForEach(
+		[&](const UUID_t &uuid, const KZ::replaysystem::pack::Entry &entry)
+		{
+			counts[entry.tier]++;
+			bytes[entry.tier] += entry.length;
+		});
+	META_CONPRINTF("[KZ] Replay tiers: fast %u replays (%llu KiB), archive %u replays (%llu KiB)\n", counts[KZ::replaysystem::pack::TIER_FAST],
+				   bytes[KZ::replaysystem::pack::TIER_FAST] / 1024, counts[KZ::replaysystem::pack::TIER_ARCHIVE],
+				   bytes[KZ::replaysystem::pack::TIER_ARCHIVE] / 1024);
+
+	std::lock_guard<std::mutex> lock(statsMutex);
+	META_CONPRINTF("%-9s %8s %12s %12s %12s %8s %10s %10s %8s\n", "rewrite", "replays", "KiB before", "KiB after", "KiB saved", "size", "decode ms",
+				   "after ms", "decode");
+	PrintRecompressStats("archived", numArchived, archiveStats);
+	PrintRecompressStats("restored", numRestored, restoreStats);
+}
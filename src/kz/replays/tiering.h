@@ -0,0 +1,8 @@
+#pragma once
+
+// Run and jump replays that are older than kz_replay_archive_age days are recompressed into the archive tier in the background.
+// Personal bests on the current map, which include its records, are kept in (or restored to) the fast tier.
+namespace KZ::replaysystem::tiering
+{
+	void Init();
+} // namespace KZ::replaysystem::tiering
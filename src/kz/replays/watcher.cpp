@@ -5,7 +5,11 @@
 #include "kz/option/kz_option.h"
 #include "kz/timer/kz_timer.h"
 #include "filesystem.h"
+#include "keyvalues3.h"
 #include "utils/tables.h"
+#include "packfile.h"
+#include "tiering.h"
+#include "dictionary.h"
 
 static const char *ARCHIVE_INDEX_PATH = KZ_REPLAY_PATH "/archive_index.txt";
 
@@ -340,13 +344,13 @@ void ReplayWatcher::PrintUsage(KZPlayer *player)
 void ReplayWatcher::FindReplaysMatchingCriteria(const char *inputs, KZPlayer *player)
 {
 	// Parse inputs and filter replays accordingly.
-	KeyValues3 params;
-	utils::ParseArgsToKV3(inputs, params, const_cast<const char **>(generalParameters), KZ_ARRAYSIZE(generalParameters));
+	// Every type reads its own parameters from the same parse.
+	utils::ArgParams params(inputs);
 	ReplayFilterCriteria criteria;
 	// General parameters
-	KeyValues3 *kv = nullptr;
+	const utils::ArgParam *kv = nullptr;
 	// Type filter
-	kv = params.FindMember("type");
+	kv = params.Find("type");
 	if (kv)
 	{
 		const char *typeStr = kv->GetString();
@@ -368,32 +372,28 @@ void ReplayWatcher::FindReplaysMatchingCriteria(const char *inputs, KZPlayer *pl
 		}
 	}
 	// Player filter
-	kv = params.FindMember("player");
+	kv = params.Find("player");
 	if (kv)
 	{
 		criteria.player.nameSubString = kv->GetString();
 	}
-	kv = params.FindMember("steamid");
+	kv = params.Find("steamid");
 	if (kv)
 	{
 		criteria.player.steamID = kv->GetUInt64();
 	}
 	// Map filter
-	kv = params.FindMember("map");
-	if (!kv)
-	{
-		kv = params.FindMember("m");
-	}
+	kv = params.Find("map", "m");
 	criteria.mapName = kv ? kv->GetString() : g_pKZUtils->GetCurrentMapName().Get();
 
 	// Offset filter
-	kv = params.FindMember("offset");
+	kv = params.Find("offset");
 	if (kv)
 	{
 		criteria.offset = kv->GetInt();
 	}
 	// Limit filter
-	kv = params.FindMember("limit");
+	kv = params.Find("limit");
 	if (kv)
 	{
 		criteria.limit = MIN(kv->GetInt(), 20);
@@ -402,8 +402,7 @@ void ReplayWatcher::FindReplaysMatchingCriteria(const char *inputs, KZPlayer *pl
 	{
 		case RP_CHEATER:
 		{
-			utils::ParseArgsToKV3(inputs, params, const_cast<const char **>(cheaterParameters), KZ_ARRAYSIZE(cheaterParameters));
-			kv = params.FindMember("reason");
+			kv = params.Find("reason");
 			if (kv)
 			{
 				criteria.reasonSubString = kv->GetString();
@@ -415,29 +414,24 @@ void ReplayWatcher::FindReplaysMatchingCriteria(const char *inputs, KZPlayer *pl
 		}
 		case RP_RUN:
 		{
-			utils::ParseArgsToKV3(inputs, params, const_cast<const char **>(runParameters), KZ_ARRAYSIZE(runParameters));
-			kv = params.FindMember("mode");
+			kv = params.Find("mode");
 			criteria.modeNameSubString = kv ? kv->GetString() : player->modeService->GetModeName();
-			kv = params.FindMember("maxtime");
+			kv = params.Find("maxtime");
 			if (kv)
 			{
 				criteria.maxTime = kv->GetFloat();
 			}
-			kv = params.FindMember("maxteleports");
+			kv = params.Find("maxteleports");
 			if (kv)
 			{
 				criteria.maxTeleports = kv->GetInt();
 			}
-			kv = params.FindMember("numstyles");
+			kv = params.Find("numstyles");
 			if (kv)
 			{
 				criteria.numStyles = kv->GetInt();
 			}
-			kv = params.FindMember("course");
-			if (!kv)
-			{
-				kv = params.FindMember("c");
-			}
+			kv = params.Find("course", "c");
 			if (kv)
 			{
 				criteria.courseName = kv->GetString();
@@ -452,23 +446,14 @@ void ReplayWatcher::FindReplaysMatchingCriteria(const char *inputs, KZPlayer *pl
 		}
 		case RP_JUMPSTATS:
 		{
-			utils::ParseArgsToKV3(inputs, params, const_cast<const char **>(jumpParameters), KZ_ARRAYSIZE(jumpParameters));
-			kv = params.FindMember("mode");
+			kv = params.Find("mode");
 			criteria.modeNameSubString = kv ? kv->GetString() : player->modeService->GetModeName();
-			kv = params.FindMember("mindistance");
-			if (!kv)
-			{
-				kv = params.FindMember("mindist");
-			}
+			kv = params.Find("mindistance", "mindist");
 			if (kv)
 			{
 				criteria.minDistance = kv->GetFloat();
 			}
-			kv = params.FindMember("jumptype");
-			if (!kv)
-			{
-				kv = params.FindMember("jt");
-			}
+			kv = params.Find("jumptype", "jt");
 			if (kv)
 			{
 				criteria.jumpType = (u8)kv->GetInt();
@@ -479,21 +464,12 @@ void ReplayWatcher::FindReplaysMatchingCriteria(const char *inputs, KZPlayer *pl
 		}
 		case RP_MANUAL:
 		{
-			utils::ParseArgsToKV3(inputs, params, const_cast<const char **>(manualParameters), KZ_ARRAYSIZE(manualParameters));
-			kv = params.FindMember("saver");
-			if (!kv)
-			{
-				kv = params.FindMember("s");
-			}
+			kv = params.Find("saver", "s");
 			if (kv)
 			{
 				criteria.savedBy.nameSubString = kv->GetString();
 			}
-			kv = params.FindMember("ssid");
-			if (!kv)
-			{
-				kv = params.FindMember("saversteamid");
-			}
+			kv = params.Find("ssid", "saversteamid");
 			if (kv)
 			{
 				criteria.savedBy.steamID = kv->GetUInt64();
@@ -862,41 +838,63 @@ void ReplayWatcher::CleanupManualReplays(std::unordered_map<UUID_t, ReplayHeader
 			std::sort(vec.begin(), vec.end(), [](auto &a, auto &b) { return a.second > b.second; });
 			for (size_t i = maxManual; i < vec.size(); i++)
 			{
-				char fullPath[MAX_PATH];
-				V_snprintf(fullPath, sizeof(fullPath), "%s/%s.replay", KZ_REPLAY_PATH, vec[i].first.ToString().c_str());
-				g_pFullFileSystem->RemoveFile(fullPath, "GAME");
+				KZ::replaysystem::pack::Remove(vec[i].first);
 				map.erase(vec[i].first);
 			}
 		}
 	}
 }
 
-void ReplayWatcher::WatchLoop()
+void ReplayWatcher::Watch()
 {
-	LoadArchiveIndex();
-	ScanReplays();
-	while (this->running)
+	if (!this->archiveLoaded)
 	{
-		std::this_thread::sleep_for(std::chrono::seconds(5));
-		if (!this->running)
-		{
-			break;
-		}
+		LoadArchiveIndex();
+		this->archiveLoaded = true;
 		ScanReplays();
-		if (this->archiveDirty)
-		{
-			SaveArchiveIndex();
-		}
+		return;
+	}
+	ScanReplays();
+	if (this->archiveDirty)
+	{
+		SaveArchiveIndex();
 	}
 }
 
-void ReplayWatcher::ScanReplays()
+void ReplayWatcher::ImportLooseReplays()
 {
 	char searchPath[MAX_PATH];
 	V_snprintf(searchPath, sizeof(searchPath), "%s/*.replay", KZ_REPLAY_PATH);
 
+	std::vector<std::string> paths;
 	FileFindHandle_t findHandle = {};
-	const char *pFileName = g_pFullFileSystem->FindFirstEx(searchPath, "GAME", &findHandle);
+	for (const char *pFileName = g_pFullFileSystem->FindFirstEx(searchPath, "GAME", &findHandle); pFileName;
+		 pFileName = g_pFullFileSystem->FindNext(findHandle))
+	{
+		// Skip temporary files that are still being written
+		if (!g_pFullFileSystem->FindIsDirectory(findHandle) && !V_strstr(pFileName, ".replay.tmp"))
+		{
+			char fullPath[MAX_PATH];
+			V_snprintf(fullPath, sizeof(fullPath), "%s/%s", KZ_REPLAY_PATH, pFileName);
+			paths.push_back(fullPath);
+		}
+	}
+	g_pFullFileSystem->FindClose(findHandle);
+
+	u32 numImported = 0;
+	for (const std::string &path : paths)
+	{
+		numImported += KZ::replaysystem::pack::Import(path.c_str());
+	}
+	if (numImported > 0)
+	{
+		META_CONPRINTF("[KZ] Imported %u loose replay files into the replay pack\n", numImported);
+	}
+}
+
+void ReplayWatcher::ScanReplays()
+{
+	ImportLooseReplays();
 
 	std::unordered_map<UUID_t, ReplayHeader> newCheater;
 	std::map<UUID_t, ReplayHeader> newRun;
@@ -905,94 +903,57 @@ void ReplayWatcher::ScanReplays()
 	std::vector<std::tuple<UUID_t, ReplayHeader>> tempRun;
 	std::vector<std::tuple<UUID_t, ReplayHeader>> tempJump;
 	std::unordered_map<u64, std::vector<std::pair<UUID_t, u64>>> manualBySteam;
+	std::vector<UUID_t> expired;
 
 	time_t currentUnixTime = 0;
 	time(&currentUnixTime);
 	u32 retentionMinutes = MAX(KZOptionService::GetOptionInt("archiveRetentionMinutes", 2880), 1440);
 	u64 retentionSeconds = retentionMinutes * 60ULL;
 
-	while (pFileName)
-	{
-		if (!g_pFullFileSystem->FindIsDirectory(findHandle))
+	KZ::replaysystem::pack::ForEach(
+		[&](const UUID_t &uuid, const KZ::replaysystem::pack::Entry &entry)
 		{
-			// Skip temporary files that are still being written
-			if (V_strstr(pFileName, ".replay.tmp"))
+			const ReplayHeader &hdr = entry.header;
+			auto idxIt = this->archivedIndex.find(uuid);
+			if (idxIt != this->archivedIndex.end())
 			{
-				pFileName = g_pFullFileSystem->FindNext(findHandle);
-				continue;
-			}
-
-			char uuidStr[64];
-			V_strncpy(uuidStr, pFileName, sizeof(uuidStr));
-			char *ext = V_strstr(uuidStr, ".replay");
-			if (ext)
-			{
-				*ext = '\0';
+				u64 age = currentUnixTime - idxIt->second;
+				if (age >= retentionSeconds)
+				{
+					expired.push_back(uuid);
+					return;
+				}
 			}
-			UUID_t uuid;
-			if (UUID_t::FromString(uuidStr, &uuid))
+			switch (static_cast<ReplayType>(hdr.type()))
 			{
-				char fullPath[MAX_PATH];
-				V_snprintf(fullPath, sizeof(fullPath), "%s/%s", KZ_REPLAY_PATH, pFileName);
-				FileHandle_t file = g_pFullFileSystem->Open(fullPath, "rb", "GAME");
-				if (file)
-				{
-					u32 size = 0;
-					if (g_pFullFileSystem->Read(&size, sizeof(size), file) == sizeof(size) && size > 0 && size < 5 * 1024 * 1024)
+				case RP_CHEATER:
+					newCheater[uuid] = hdr;
+					break;
+				case RP_RUN:
+					tempRun.push_back({uuid, hdr});
+					break;
+				case RP_JUMPSTATS:
+					tempJump.push_back({uuid, hdr});
+					break;
+				case RP_MANUAL:
+					newManual[uuid] = hdr;
+					if (hdr.has_player())
 					{
-						std::string buf;
-						buf.resize(size);
-						if (g_pFullFileSystem->Read(buf.data(), size, file) == size)
-						{
-							ReplayHeader hdr;
-							if (hdr.ParseFromString(buf))
-							{
-								auto idxIt = this->archivedIndex.find(uuid);
-								if (idxIt != this->archivedIndex.end())
-								{
-									u64 age = currentUnixTime - idxIt->second;
-									if (age >= retentionSeconds)
-									{
-										g_pFullFileSystem->Close(file);
-										g_pFullFileSystem->RemoveFile(fullPath, "GAME");
-										this->archivedIndex.erase(idxIt);
-										this->archiveDirty = true;
-										pFileName = g_pFullFileSystem->FindNext(findHandle);
-										continue;
-									}
-								}
-								switch (static_cast<ReplayType>(hdr.type()))
-								{
-									case RP_CHEATER:
-										newCheater[uuid] = hdr;
-										break;
-									case RP_RUN:
-										tempRun.push_back({uuid, hdr});
-										break;
-									case RP_JUMPSTATS:
-										tempJump.push_back({uuid, hdr});
-										break;
-									case RP_MANUAL:
-										newManual[uuid] = hdr;
-										if (hdr.has_player())
-										{
-											manualBySteam[hdr.player().steamid64()].push_back({uuid, hdr.timestamp()});
-										}
-										break;
-									default:
-										break;
-								}
-							}
-						}
+						manualBySteam[hdr.player().steamid64()].push_back({uuid, hdr.timestamp()});
 					}
-					g_pFullFileSystem->Close(file);
-				}
+					break;
+				default:
+					break;
 			}
-		}
-		pFileName = g_pFullFileSystem->FindNext(findHandle);
-	}
+		});
 
-	g_pFullFileSystem->FindClose(findHandle);
+	// The pack cannot be modified while it is being iterated.
+	for (const UUID_t &uuid : expired)
+	{
+		KZ::replaysystem::pack::Remove(uuid);
+		this->archivedIndex.erase(uuid);
+		this->archiveDirty = true;
+	}
 
 	// Process each replay type with dedicated functions
 	ProcessCheaterReplays(newCheater, currentUnixTime);
@@ -1041,10 +1002,15 @@ std::vector<UUID_t> ReplayWatcher::FindReplaysByUUIDSubstring(const char *uuidSu
 
 void KZ::replaysystem::InitWatcher()
 {
+	KZ::replaysystem::pack::Init();
+	KZ::replaysystem::dictionary::Init();
+	KZ::replaysystem::tiering::Init();
 	g_ReplayWatcher.Start();
 }
 
 void KZ::replaysystem::CleanupWatcher()
 {
 	g_ReplayWatcher.Stop();
+	KZ::replaysystem::pack::Shutdown();
+	KZ::replaysystem::dictionary::Shutdown();
 }
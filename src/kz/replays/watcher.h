@@ -4,6 +4,7 @@
 #include "utils/utils.h"
 #include "utils/uuid.h"
 #include "utils/argparse.h"
+#include "utils/executor.h"
 
 class KZPlayer;
 
@@ -49,12 +50,12 @@ struct ReplayFilterCriteria
 	bool PassFilters(const ReplayHeader &header) const;
 };
 
-// Keep track of replays on disk and their headers.
+// Keep track of replays in the replay pack and their headers.
 class ReplayWatcher
 {
 	std::mutex replayMapsMutex;
-	std::thread watcherThread;
-	std::atomic<bool> running;
+	executor::TimerID watchTimer = 0;
+	bool archiveLoaded = false;
 	std::unordered_map<UUID_t, ReplayHeader> cheaterReplays;
 	std::unordered_map<UUID_t, ReplayHeader> manualReplays;
 	std::map<UUID_t, ReplayHeader> runReplays;
@@ -63,8 +64,11 @@ class ReplayWatcher
 	std::unordered_map<UUID_t, u64> archivedIndex;
 	bool archiveDirty = false;
 
-	void WatchLoop();
+	// Runs every few seconds on the executor, loads the archive index on the first run.
+	void Watch();
 
+	// Loose replay files are moved into the replay pack, everything else works off the pack index.
+	void ImportLooseReplays();
 	void ScanReplays();
 
 	void MarkArchived(const UUID_t &uuid, u64 archiveTimestamp);
@@ -81,31 +85,24 @@ class ReplayWatcher
 public:
 	void Start()
 	{
-		running = true;
-		watcherThread = std::thread(&ReplayWatcher::WatchLoop, this);
+		if (watchTimer)
+		{
+			return;
+		}
+		watchTimer = executor::AddTimer(executor::Queue::ReplayWatch, 0.0, 5.0, [this]() { this->Watch(); });
 	}
 
 	void Stop()
 	{
-		if (!running)
+		if (!watchTimer)
 		{
 			return;
 		}
-		running = false;
-		if (watcherThread.joinable())
-		{
-			watcherThread.join();
-		}
+		executor::RemoveTimer(watchTimer);
+		watchTimer = 0;
+		executor::WaitIdle(executor::Queue::ReplayWatch);
 	}
 
-private:
-	static inline constexpr const char *generalParameters[] = {"type", "t", "player", "p", "steamid", "sid", "map", "m", "offset", "o", "limit", "l"};
-	static inline constexpr const char *cheaterParameters[] = {"reason", "r"};
-	static inline constexpr const char *runParameters[] = {"maxtime", "maxteleports", "numstyles", "mode", "course", "c"};
-	static inline constexpr const char *jumpParameters[] = {"mode", "mindistance", "mindist", "jumptype", "jt"};
-	static inline constexpr const char *manualParameters[] = {"saver", "s", "ssid", "saversteamid"};
-
-public:
 	static void PrintUsage(KZPlayer *player);
 
 	void FilterAndPrintMatchingCheaterReplays(ReplayFilterCriteria &criteria, KZPlayer *player);
@@ -0,0 +1,30 @@
+#include "kz_saveloc.h"
+#include "utils/simplecmds.h"
+#include "utils/utils.h"
+
+SCMD(kz_saveloc, SCFL_SAVELOC)
+{
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
+	player->savelocService->SaveLocation();
+	return MRES_SUPERCEDE;
+}
+
+SCMD_LINK(kz_sl, kz_saveloc);
+
+SCMD(kz_loadloc, SCFL_SAVELOC)
+{
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
+	i32 index = args->ArgC() >= 2 && utils::IsNumeric(args->Arg(1)) ? atoi(args->Arg(1)) : 0;
+	player->savelocService->LoadLocation(index);
+	return MRES_SUPERCEDE;
+}
+
+SCMD_LINK(kz_ll, kz_loadloc);
+
+SCMD(kz_savelocs, SCFL_SAVELOC)
+{
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
+	i32 page = args->ArgC() >= 2 && utils::IsNumeric(args->Arg(1)) ? atoi(args->Arg(1)) : 1;
+	player->savelocService->ListLocations(page);
+	return MRES_SUPERCEDE;
+}
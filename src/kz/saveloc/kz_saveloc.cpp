@@ -1 +1,460 @@
+#include <algorithm>
+#include <ctime>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "kz_saveloc.h"
+#include "kz/checkpoint/kz_checkpoint.h"
+#include "kz/language/kz_language.h"
+#include "kz/mappingapi/kz_mappingapi.h"
+#include "kz/noclip/kz_noclip.h"
+#include "kz/racing/kz_racing.h"
+#include "kz/timer/kz_timer.h"
+#include "kz/trigger/kz_trigger.h"
+#include "utils/utils.h"
+#include "utils/executor.h"
+#include "filesystem.h"
+
+#include "tier0/memdbgon.h"
+
+#define SAVELOC_PATH "addons/cs2kz/data/savelocs"
+
+enum : u32
+{
+	SAVELOC_MAGIC = 0x4C535A4B, // KZSL
+	SAVELOC_VERSION = 1,
+	// Saving never grows the owner list while there is room left.
+	SAVELOC_RESERVE = 1024,
+	// The records of a player are a ring, past this many a new saveloc takes the place of their oldest one.
+	SAVELOC_MAX_PER_PLAYER = 100,
+	// Once the file has this many records, new savelocs take the place of the oldest record on the map.
+	SAVELOC_MAX_RECORDS = 1 << 18,
+};
+
+struct SavelocHeader
+{
+	u32 magic;
+	u32 version;
+	char md5[33];
+};
+
+static_global struct
+{
+	FileHandle_t file;
+	char path[MAX_PATH];
+	// Owner and creation time of every record in the file, in file order.
+	CUtlVector<u64> owners;
+	CUtlVector<u64> createdAt;
+	// Changes every time a store is opened or records change owner, per player lists built before are stale.
+	u32 serial;
+
+	// Guards the file and the writes below, records are written on the executor.
+	std::mutex mutex;
+	// Records that are not on disk yet, by record number. Reads look here first.
+	std::unordered_map<u32, SavelocRecord> pendingWrites;
+} savelocStore;
+
+static_function u32 GetRecordOffset(u32 record)
+{
+	return sizeof(SavelocHeader) + record * sizeof(SavelocRecord);
+}
+
+static_function bool ReadRecord(u32 record, SavelocRecord &out)
+{
+	if (record >= (u32)savelocStore.owners.Count())
+	{
+		return false;
+	}
+	std::lock_guard lock(savelocStore.mutex);
+	auto it = savelocStore.pendingWrites.find(record);
+	if (it != savelocStore.pendingWrites.end())
+	{
+		out = it->second;
+		return true;
+	}
+	if (!savelocStore.file)
+	{
+		return false;
+	}
+	g_pFullFileSystem->Seek(savelocStore.file, GetRecordOffset(record), FILESYSTEM_SEEK_HEAD);
+	return g_pFullFileSystem->Read(&out, sizeof(out), savelocStore.file) == sizeof(out);
+}
+
+// Write every pending record and flush once. Runs on the executor, and on the main thread before the store is closed.
+static_function void FlushPendingWrites()
+{
+	std::lock_guard lock(savelocStore.mutex);
+	if (savelocStore.pendingWrites.empty() || !savelocStore.file)
+	{
+		return;
+	}
+	// In file order, so a record past the end of the file that was torn by a crash is overwritten next time.
+	std::vector<std::pair<u32, SavelocRecord>> writes(savelocStore.pendingWrites.begin(), savelocStore.pendingWrites.end());
+	std::sort(writes.begin(), writes.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+	for (const auto &[number, record] : writes)
+	{
+		g_pFullFileSystem->Seek(savelocStore.file, GetRecordOffset(number), FILESYSTEM_SEEK_HEAD);
+		if (g_pFullFileSystem->Write(&record, sizeof(record), savelocStore.file) != sizeof(record))
+		{
+			META_CONPRINTF("[KZ] Failed to write a saveloc to %s.\n", savelocStore.path);
+			break;
+		}
+	}
+	g_pFullFileSystem->Flush(savelocStore.file);
+	savelocStore.pendingWrites.clear();
+}
+
+// Pick the record number for a new saveloc and queue its write. ownRecords is the list of its owner, oldest first.
+static_function void StoreRecord(const SavelocRecord &record, CUtlVector<u32> &ownRecords)
+{
+	u32 number;
+	if (ownRecords.Count() >= SAVELOC_MAX_PER_PLAYER)
+	{
+		number = ownRecords[0];
+		ownRecords.Remove(0);
+	}
+	else if ((u32)savelocStore.owners.Count() < SAVELOC_MAX_RECORDS)
+	{
+		number = savelocStore.owners.Count();
+		savelocStore.owners.AddToTail(0);
+		savelocStore.createdAt.AddToTail(0);
+	}
+	else
+	{
+		// The file is full, take the oldest record on the map. Lists of its owner have to be built again.
+		number = 0;
+		FOR_EACH_VEC(savelocStore.createdAt, i)
+		{
+			if (savelocStore.createdAt[i] < savelocStore.createdAt[number])
+			{
+				number = i;
+			}
+		}
+		ownRecords.FindAndRemove(number);
+		savelocStore.serial++;
+	}
+	savelocStore.owners[number] = record.steamID64;
+	savelocStore.createdAt[number] = record.createdAt;
+	ownRecords.AddToTail(number);
+	{
+		std::lock_guard lock(savelocStore.mutex);
+		savelocStore.pendingWrites[number] = record;
+	}
+	executor::Submit(executor::Queue::ReplayWrite, FlushPendingWrites);
+}
+
+// Start a new store, savelocs of another version of the map would put players in the wrong places.
+static_function bool CreateStore(const char *md5)
+{
+	FileHandle_t file = g_pFullFileSystem->Open(savelocStore.path, "wb", "GAME");
+	if (!file)
+	{
+		return false;
+	}
+	SavelocHeader header = {SAVELOC_MAGIC, SAVELOC_VERSION, {}};
+	V_strncpy(header.md5, md5, sizeof(header.md5));
+	bool success = g_pFullFileSystem->Write(&header, sizeof(header), file) == sizeof(header);
+	g_pFullFileSystem->Close(file);
+	return success;
+}
+
+static_function void LoadOwners()
+{
+	u32 size = g_pFullFileSystem->Size(savelocStore.file);
+	u32 count = size > sizeof(SavelocHeader) ? (size - sizeof(SavelocHeader)) / sizeof(SavelocRecord) : 0;
+	savelocStore.owners.EnsureCapacity(count + SAVELOC_RESERVE);
+	savelocStore.createdAt.EnsureCapacity(count + SAVELOC_RESERVE);
+
+	// Only the owners are kept, the records pass through a small buffer.
+	static_persist SavelocRecord buffer[64];
+	g_pFullFileSystem->Seek(savelocStore.file, GetRecordOffset(0), FILESYSTEM_SEEK_HEAD);
+	for (u32 i = 0; i < count;)
+	{
+		u32 batch = MIN(count - i, (u32)Q_ARRAYSIZE(buffer));
+		u32 read = g_pFullFileSystem->Read(buffer, batch * sizeof(SavelocRecord), savelocStore.file) / sizeof(SavelocRecord);
+		for (u32 j = 0; j < read; j++)
+		{
+			savelocStore.owners.AddToTail(buffer[j].steamID64);
+			savelocStore.createdAt.AddToTail(buffer[j].createdAt);
+		}
+		if (read != batch)
+		{
+			break;
+		}
+		i += batch;
+	}
+}
+
+void KZSavelocService::OnActivateServer()
+{
+	KZSavelocService::Cleanup();
+	savelocStore.serial++;
+
+	bool success = false;
+	CUtlString mapName = g_pKZUtils->GetCurrentMapName(&success);
+	char md5[33];
+	if (!success || !g_pKZUtils->GetCurrentMapMD5(md5, sizeof(md5)))
+	{
+		return;
+	}
+	// Workshop maps can be loaded by path.
+	char fileName[MAX_PATH];
+	V_strncpy(fileName, mapName.Get(), sizeof(fileName));
+	V_FixSlashes(fileName, '_');
+	V_snprintf(savelocStore.path, sizeof(savelocStore.path), SAVELOC_PATH "/%s.bin", fileName);
+	g_pFullFileSystem->CreateDirHierarchy(SAVELOC_PATH, "GAME");
+
+	savelocStore.file = g_pFullFileSystem->Open(savelocStore.path, "r+b", "GAME");
+	SavelocHeader header;
+	if (savelocStore.file)
+	{
+		bool valid = g_pFullFileSystem->Read(&header, sizeof(header), savelocStore.file) == sizeof(header) && header.magic == SAVELOC_MAGIC
+					 && header.version == SAVELOC_VERSION && KZ_STREQ(header.md5, md5);
+		if (!valid)
+		{
+			g_pFullFileSystem->Close(savelocStore.file);
+			savelocStore.file = nullptr;
+		}
+	}
+	if (!savelocStore.file)
+	{
+		if (!CreateStore(md5) || !(savelocStore.file = g_pFullFileSystem->Open(savelocStore.path, "r+b", "GAME")))
+		{
+			META_CONPRINTF("[KZ] Failed to open the saveloc store at %s.\n", savelocStore.path);
+			return;
+		}
+	}
+	LoadOwners();
+}
+
+void KZSavelocService::Cleanup()
+{
+	// Queued writes may still be waiting for the executor, they belong to this store.
+	FlushPendingWrites();
+	{
+		std::lock_guard lock(savelocStore.mutex);
+		if (savelocStore.file)
+		{
+			g_pFullFileSystem->Close(savelocStore.file);
+			savelocStore.file = nullptr;
+		}
+	}
+	savelocStore.owners.Purge();
+	savelocStore.createdAt.Purge();
+}
+
+void KZSavelocService::Reset()
+{
+	this->savelocs.RemoveAll();
+	this->storeSerial = 0;
+}
+
+void KZSavelocService::UpdateSavelocList()
+{
+	u64 steamID64 = this->player->GetSteamId64();
+	// Players that are not authenticated yet get their list once they are.
+	if (this->storeSerial == savelocStore.serial || !steamID64)
+	{
+		return;
+	}
+	this->storeSerial = savelocStore.serial;
+	this->savelocs.RemoveAll();
+
+	FOR_EACH_VEC(savelocStore.owners, i)
+	{
+		if (savelocStore.owners[i] == steamID64)
+		{
+			this->savelocs.AddToTail(i);
+		}
+	}
+	// Records taking the place of older ones are not in file order.
+	std::stable_sort(this->savelocs.Base(), this->savelocs.Base() + this->savelocs.Count(),
+					 [](u32 a, u32 b) { return savelocStore.createdAt[a] < savelocStore.createdAt[b]; });
+}
+
+void KZSavelocService::SaveLocation()
+{
+	CCSPlayerPawn *pawn = this->player->GetPlayerPawn();
+	if (!pawn || !pawn->IsAlive())
+	{
+		return;
+	}
+	u64 steamID64 = this->player->GetSteamId64();
+	if (!savelocStore.file || !steamID64)
+	{
+		this->player->languageService->PrintChat(true, false, "Saveloc - Error Message (Unavailable)");
+		this->player->PlayErrorSound();
+		return;
+	}
+
+	SavelocRecord record = {};
+	record.steamID64 = steamID64;
+	record.createdAt = (u64)time(nullptr);
+	this->player->GetOrigin(&record.origin);
+	this->player->GetAngles(&record.angles);
+	this->player->GetVelocity(&record.velocity);
+	record.slopeDropOffset = pawn->m_flSlopeDropOffset();
+	record.slopeDropHeight = pawn->m_flSlopeDropHeight();
+	CCSPlayer_MovementServices *ms = this->player->GetMoveServices();
+	if (ms)
+	{
+		record.flags |= ms->m_bDucked() ? SavelocRecord::SAVELOC_DUCKED : 0;
+		record.duckAmount = ms->m_flDuckAmount();
+		record.ladderNormal = ms->m_vecLadderNormal();
+	}
+	record.flags |= pawn->m_MoveType() == MOVETYPE_LADDER ? SavelocRecord::SAVELOC_ON_LADDER : 0;
+
+	const KZCourseDescriptor *course = this->player->timerService->GetCourse();
+	if (this->player->timerService->GetTimerRunning() && course)
+	{
+		record.flags |= SavelocRecord::SAVELOC_TIMER_RUNNING;
+		record.time = this->player->timerService->GetTime();
+		record.courseID = course->id;
+		record.teleportCount = this->player->checkpointService->GetTeleportCount();
+	}
+
+	// The list has to be up to date before the new record is added to it.
+	this->UpdateSavelocList();
+	StoreRecord(record, this->savelocs);
+	this->storeSerial = savelocStore.serial;
+	this->player->languageService->PrintChat(true, false, "Saveloc - Saved", this->savelocs.Count());
+}
+
+void KZSavelocService::LoadLocation(i32 index)
+{
+	CCSPlayerPawn *pawn = this->player->GetPlayerPawn();
+	if (!pawn || !pawn->IsAlive())
+	{
+		return;
+	}
+
+	this->UpdateSavelocList();
+	if (this->savelocs.Count() == 0)
+	{
+		this->player->languageService->PrintChat(true, false, "Saveloc - Error Message (No Savelocs)");
+		this->player->PlayErrorSound();
+		return;
+	}
+	if (index == 0)
+	{
+		index = this->savelocs.Count();
+	}
+	if (index < 1 || index > this->savelocs.Count())
+	{
+		this->player->languageService->PrintChat(true, false, "Saveloc - Error Message (Invalid Index)", this->savelocs.Count());
+		this->player->PlayErrorSound();
+		return;
+	}
+	if (!this->player->triggerService->CanTeleportToCheckpoints())
+	{
+		this->player->languageService->PrintChat(true, false, "Can't Teleport (Map)");
+		this->player->PlayErrorSound();
+		return;
+	}
+	if (!this->player->racingService->CanTeleport())
+	{
+		this->player->languageService->PrintChat(true, false, "Can't Teleport (Limit Reached)");
+		this->player->PlayErrorSound();
+		return;
+	}
+
+	SavelocRecord record;
+	if (!ReadRecord(this->savelocs[index - 1], record) || record.steamID64 != this->player->GetSteamId64())
+	{
+		this->player->languageService->PrintChat(true, false, "Saveloc - Error Message (Unavailable)");
+		this->player->PlayErrorSound();
+		return;
+	}
+	this->LoadRecord(record);
+	this->player->languageService->PrintChat(true, false, "Saveloc - Loaded", index);
+}
+
+void KZSavelocService::LoadRecord(const SavelocRecord &record)
+{
+	CCSPlayerPawn *pawn = this->player->GetPlayerPawn();
+	CCSPlayer_MovementServices *ms = this->player->GetMoveServices();
+	if (!pawn || !ms)
+	{
+		return;
+	}
+
+	this->player->noclipService->DisableNoclip();
+	this->player->Teleport(&record.origin, &record.angles, &record.velocity);
+	ms->m_bDucked(record.flags & SavelocRecord::SAVELOC_DUCKED);
+	ms->m_flDuckAmount(record.duckAmount);
+	pawn->m_flSlopeDropOffset(record.slopeDropOffset);
+	pawn->m_flSlopeDropHeight(record.slopeDropHeight);
+
+	if (record.flags & SavelocRecord::SAVELOC_ON_LADDER)
+	{
+		ms->m_vecLadderNormal(record.ladderNormal);
+		if (!this->player->timerService->GetPaused())
+		{
+			this->player->SetMoveType(MOVETYPE_LADDER);
+		}
+		else
+		{
+			this->player->timerService->SetPausedOnLadder(true);
+		}
+	}
+	else
+	{
+		ms->m_vecLadderNormal(vec3_origin);
+		if (this->player->timerService->GetPaused())
+		{
+			this->player->timerService->SetPausedOnLadder(false);
+		}
+		else if (pawn->m_MoveType() == MOVETYPE_LADDER)
+		{
+			this->player->SetMoveType(MOVETYPE_WALK);
+		}
+	}
+
+	// The run continues where it was saved, but it can no longer count as a record.
+	const KZCourseDescriptor *course = KZ::course::GetCourseByCourseID(record.courseID);
+	if ((record.flags & SavelocRecord::SAVELOC_TIMER_RUNNING) && course)
+	{
+		this->player->timerService->RestoreRun(course, record.time);
+		this->player->checkpointService->SetTeleportCount(record.teleportCount);
+	}
+	else
+	{
+		this->player->timerService->TimerStop(false);
+	}
+}
+
+void KZSavelocService::ListLocations(i32 page)
+{
+	this->UpdateSavelocList();
+	if (this->savelocs.Count() == 0)
+	{
+		this->player->languageService->PrintChat(true, false, "Saveloc - Error Message (No Savelocs)");
+		return;
+	}
+
+	i32 pageCount = (this->savelocs.Count() + KZ_SAVELOCS_PER_PAGE - 1) / KZ_SAVELOCS_PER_PAGE;
+	page = Clamp(page, 1, pageCount);
+	this->player->languageService->PrintChat(true, false, "Saveloc - List Header", page, pageCount);
+
+	// Only the records on this page are read.
+	i32 end = MIN(page * KZ_SAVELOCS_PER_PAGE, this->savelocs.Count());
+	for (i32 i = (page - 1) * KZ_SAVELOCS_PER_PAGE; i < end; i++)
+	{
+		SavelocRecord record;
+		if (!ReadRecord(this->savelocs[i], record))
+		{
+			break;
+		}
+		const KZCourseDescriptor *course = KZ::course::GetCourseByCourseID(record.courseID);
+		if ((record.flags & SavelocRecord::SAVELOC_TIMER_RUNNING) && course)
+		{
+			CUtlString time = utils::FormatTime(record.time);
+			this->player->languageService->PrintChat(false, false, "Saveloc - List Entry", i + 1, course->name, time.Get());
+		}
+		else
+		{
+			this->player->languageService->PrintChat(false, false, "Saveloc - List Entry (No Timer)", i + 1);
+		}
+	}
+}
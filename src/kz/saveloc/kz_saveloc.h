@@ -1,7 +1,60 @@
 #pragma once
 #include "../kz.h"
 
+#define KZ_SAVELOCS_PER_PAGE 5
+
+// Everything needed to resume movement from a saved location. Records are written to disk as they are, so the layout is fixed.
+struct SavelocRecord
+{
+	enum Flags : u32
+	{
+		SAVELOC_DUCKED = 1 << 0,
+		SAVELOC_ON_LADDER = 1 << 1,
+		SAVELOC_TIMER_RUNNING = 1 << 2,
+	};
+
+	u64 steamID64;
+	// Unix time.
+	u64 createdAt;
+	Vector origin;
+	QAngle angles;
+	Vector velocity;
+	Vector ladderNormal;
+	f32 duckAmount;
+	f32 slopeDropOffset;
+	f32 slopeDropHeight;
+	u32 flags;
+	f64 time;
+	// Map-defined course ID, GUIDs are not stable across map loads.
+	i32 courseID;
+	u32 teleportCount;
+};
+
+static_assert(sizeof(SavelocRecord) == 96, "Saveloc records are stored on disk and must not change size.");
+
+// Savelocs are kept in a file per map and never loaded as a whole, each player has a ring of records that overwrites their oldest one.
+// Only the owner and age of every record are kept in memory, the records themselves are read one by one when they are used.
 class KZSavelocService : public KZBaseService
 {
 	using KZBaseService::KZBaseService;
+
+	// Record numbers in the store, oldest first.
+	CUtlVector<u32> savelocs;
+	// Store generation the list above was built for.
+	u32 storeSerial {};
+
+	void UpdateSavelocList();
+	void LoadRecord(const SavelocRecord &record);
+
+public:
+	static void OnActivateServer();
+	static void Cleanup();
+
+	virtual void Reset() override;
+
+	void SaveLocation();
+	// Index starts at 1, 0 is the latest saveloc.
+	void LoadLocation(i32 index = 0);
+	// Page starts at 1.
+	void ListLocations(i32 page = 1);
 };
@@ -1,7 +1,7 @@
 #pragma once
 #include "../kz.h"
 
-#define KZ_STYLE_MANAGER_INTERFACE "KZStyleManagerInterface"
+#define KZ_STYLE_MANAGER_INTERFACE "KZStyleManagerInterface002"
 
 // TODO styles: normal, backwards, sw, hsw, w only, lowgrav, autobhop, 250 speed, high gravity, notrigger, alivestrafe
 class KZStyleService : public KZBaseService
@@ -165,6 +165,12 @@ public:
 	{
 		return true;
 	}
+
+	// Movement hooks this style overrides, the others are skipped by the player.
+	virtual u64 GetMovementHooks()
+	{
+		return MOVEMENT_HOOK_ALL;
+	}
 };
 
 typedef KZStyleService *(*StyleServiceFactory)(KZPlayer *player);
@@ -3,6 +3,7 @@
 #include "utils/addresses.h"
 #include "utils/interfaces.h"
 #include "utils/gameconfig.h"
+#include "utils/schema.h"
 
 KZAutoBhopStylePlugin g_KZAutoBhopStylePlugin;
 
@@ -37,6 +38,7 @@ bool KZAutoBhopStylePlugin::Load(PluginId id, ISmmAPI *ismm, char *error, size_t
 		V_snprintf(error, maxlen, "Failed to initialize interfaces");
 		return false;
 	}
+	schema::ResolveFields();
 
 	if (nullptr == (g_pGameConfig = g_pKZUtils->GetGameConfig()))
 	{
@@ -69,6 +69,11 @@ public:
 		return STYLE_NAME_SHORT;
 	}
 
+	virtual u64 GetMovementHooks() override
+	{
+		return MOVEMENT_HOOK_PROCESS_MOVEMENT;
+	}
+
 	virtual const CVValue_t *GetTweakedConvarValue(const char *name) override;
 	virtual void Init() override;
 	virtual void Cleanup() override;
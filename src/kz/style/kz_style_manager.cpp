@@ -267,6 +267,7 @@ void KZStyleManager::AddStyle(KZPlayer *player, const char *styleName, bool sile
 	player->styleServices.AddToTail(info.factory(player));
 	player->timerService->TimerStop();
 	player->styleServices.Tail()->Init();
+	player->UpdateMovementHooks();
 	if (updatePreference)
 	{
 		player->optionService->SetPreferenceStr("preferredStyles", styleManager.GetStylesString(player));
@@ -299,6 +300,7 @@ void KZStyleManager::RemoveStyle(KZPlayer *player, const char *styleName, bool s
 			}
 			player->styleServices.Remove(i);
 			delete style;
+			player->UpdateMovementHooks();
 			if (updatePreference)
 			{
 				player->optionService->SetPreferenceStr("preferredStyles", styleManager.GetStylesString(player));
@@ -337,6 +339,7 @@ void KZStyleManager::ToggleStyle(KZPlayer *player, const char *styleName, bool s
 			}
 			player->styleServices.Remove(i);
 			delete style;
+			player->UpdateMovementHooks();
 			if (updatePreference)
 			{
 				player->optionService->SetPreferenceStr("preferredStyles", styleManager.GetStylesString(player));
@@ -379,6 +382,7 @@ void KZStyleManager::ToggleStyle(KZPlayer *player, const char *styleName, bool s
 	player->styleServices.AddToTail(info.factory(player));
 	player->timerService->TimerStop();
 	player->styleServices.Tail()->Init();
+	player->UpdateMovementHooks();
 	if (updatePreference)
 	{
 		player->optionService->SetPreferenceStr("preferredStyles", styleManager.GetStylesString(player));
@@ -398,6 +402,7 @@ void KZStyleManager::ClearStyles(KZPlayer *player, bool silent, bool updatePrefe
 		player->styleServices[i]->Cleanup();
 	}
 	player->styleServices.PurgeAndDeleteElements();
+	player->UpdateMovementHooks();
 	if (updatePreference)
 	{
 		player->optionService->SetPreferenceStr("preferredStyles", styleManager.GetStylesString(player));
@@ -135,9 +135,9 @@ void KZTelemetryService::ActiveCheck()
 {
 	f64 currentTime = g_pKZUtils->GetServerGlobals()->realtime;
 	f64 duration = currentTime - KZTelemetryService::lastActiveCheckTime;
-	for (u32 i = 0; i < MAXPLAYERS + 1; i++)
+	FOR_EACH_VEC(g_pKZPlayerManager->activePlayers, i)
 	{
-		KZPlayer *player = g_pKZPlayerManager->ToPlayer(i);
+		KZPlayer *player = g_pKZPlayerManager->ToKZPlayer(g_pKZPlayerManager->activePlayers[i]);
 		if (!player->IsInGame() || player->IsFakeClient() || player->IsCSTV())
 		{
 			continue;
@@ -8,6 +8,7 @@
 #include "kz/recording/kz_recording.h"
 #include "kz/style/kz_style.h"
 #include "kz/option/kz_option.h"
+#include "queries/query_cache.h"
 
 #include "vendor/sql_mm/src/public/sql_mm.h"
 
@@ -128,7 +129,7 @@ RecordAnnounce::RecordAnnounce(KZPlayer *player)
 	}
 
 	// Metadata
-	this->metadata = player->timerService->GetCurrentRunMetadata().Get();
+	this->metadata = player->timerService->GetCurrentRunMetadata();
 
 	// Cheaters should not submit locally.
 	if (player->anticheatService->isBanned)
@@ -173,6 +174,9 @@ void RecordAnnounce::SubmitGlobal()
 	{
 		META_CONPRINTF("[KZ::Global - %u] Record submitted under ID %d\n", uid, ack.recordId);
 
+		// Global leaderboards of this map changed no matter what happens to the announcement.
+		QueryCacheBase::InvalidateMap(g_pKZUtils->GetCurrentMapName().Get());
+
 		RecordAnnounce *rec = RecordAnnounce::Get(uid);
 		if (!rec)
 		{
@@ -189,6 +193,13 @@ void RecordAnnounce::SubmitGlobal()
 		rec->globalResponse.pro.points = ack.proData.points;
 		rec->globalResponse.pro.maxRank = ack.proData.leaderboardSize;
 
+		// New world records need their replay on the API.
+		UUID_t runUUID(false);
+		if ((ack.overallData.rank == 1 || ack.proData.rank == 1) && UUID_t::FromString(rec->runUUID.c_str(), &runUUID))
+		{
+			KZGlobalService::QueueReplayUpload(runUUID, ack.recordId);
+		}
+
 		// cache should not be overwritten by styled runs
 		if (rec->styles.empty())
 		{
@@ -196,9 +207,10 @@ void RecordAnnounce::SubmitGlobal()
 		}
 	};
 
+	this->globalMetadata = this->metadata.ToJSON();
 	// Dirty hack since nested forward declaration isn't possible.
 	KZGlobalService::SubmitRecordResult submissionResult = player->globalService->SubmitRecord(
-		this->globalFilterID, this->time, this->teleports, this->mode.md5, (void *)(&this->styles), this->metadata.c_str(), callback);
+		this->globalFilterID, this->time, this->teleports, this->mode.md5, (void *)(&this->styles), this->globalMetadata, callback);
 
 	if (kz_debug_announce_global.Get())
 	{
@@ -233,12 +245,12 @@ void RecordAnnounce::UpdateGlobalCache()
 		{
 			if (this->time < this->oldGPB.overall.time || this->oldGPB.overall.time == 0)
 			{
-				player->timerService->InsertPBToCache(this->time, course, mode.id, true, true, this->metadata.c_str(),
+				player->timerService->InsertPBToCache(this->time, course, mode.id, true, true, &this->metadata,
 													  this->globalResponse.overall.points);
 			}
 			if (this->time < this->oldGPB.pro.time || this->oldGPB.pro.time == 0)
 			{
-				player->timerService->InsertPBToCache(this->time, course, mode.id, false, true, this->metadata.c_str(),
+				player->timerService->InsertPBToCache(this->time, course, mode.id, false, true, &this->metadata,
 													  this->globalResponse.pro.points);
 			}
 		}
@@ -322,7 +334,7 @@ void RecordAnnounce::SubmitLocal()
 		rec->UpdateLocalCache();
 	};
 	KZDatabaseService::SaveTime(this->runUUID.c_str(), this->player.steamid64, this->course.localID, this->mode.localID, this->time, this->teleports,
-								this->styleIDs, this->metadata, onSuccess, onFailure);
+								this->styleIDs, this->metadata.Encode(), onSuccess, onFailure);
 }
 
 void RecordAnnounce::UpdateLocalCache()
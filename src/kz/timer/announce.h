@@ -68,7 +68,9 @@ struct RecordAnnounce
 	std::vector<StyleInfo> styles;
 	u64 styleIDs {};
 
-	std::string metadata;
+	KZRunMetadata metadata;
+	// The global API still expects the legacy JSON metadata.
+	std::string globalMetadata;
 
 	bool global {};
 
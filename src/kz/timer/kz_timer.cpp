@@ -11,6 +11,7 @@
 #include "kz/spec/kz_spec.h"
 #include "kz/recording/kz_recording.h"
 #include "announce.h"
+#include "queries/query_cache.h"
 
 #include "utils/utils.h"
 #include "utils/simplecmds.h"
@@ -64,6 +65,9 @@ static_global class KZDatabaseServiceEventListener_Timer : public KZDatabaseServ
 public:
 	virtual void OnMapSetup() override;
 	virtual void OnClientSetup(Player *player, u64 steamID64, bool isBanned) override;
+	virtual void OnTimeInserted(Player *player, u64 steamID64, u32 mapID, u32 course, u64 mode, u64 styles, u64 runtimeMS,
+								u32 teleportsUsed) override;
+	virtual void OnNewRecord(Player *player, u64 steamID64, u32 mapID, u32 course, u64 mode, u64 styles, u32 teleportsUsed) override;
 } databaseEventListener;
 
 static_global class KZOptionServiceEventListener_Timer : public KZOptionServiceEventListener
@@ -74,8 +78,85 @@ static_global class KZOptionServiceEventListener_Timer : public KZOptionServiceE
 	}
 } optionEventListener;
 
-std::unordered_map<PBDataKey, PBData> KZTimerService::srCache;
-std::unordered_map<PBDataKey, PBData> KZTimerService::wrCache;
+PBDataCache KZTimerService::srCache;
+PBDataCache KZTimerService::wrCache;
+
+i32 PBDataCache::GetModeSlot(PluginId modeID, bool create)
+{
+	// Plugin IDs are handed out again when plugins reload, so slots are tied to the mode itself instead.
+	i32 modeIndex = KZ::mode::GetModeIndex(modeID);
+	if (modeIndex < 0)
+	{
+		return -1;
+	}
+	static_persist i32 modeSlots[KZ_MAX_CACHED_MODES];
+	static_persist i32 modeSlotCount = 0;
+	for (i32 i = 0; i < modeSlotCount; i++)
+	{
+		if (modeSlots[i] == modeIndex)
+		{
+			return i;
+		}
+	}
+	if (!create || modeSlotCount >= KZ_MAX_CACHED_MODES)
+	{
+		return -1;
+	}
+	modeSlots[modeSlotCount] = modeIndex;
+	return modeSlotCount++;
+}
+
+bool PBDataCache::GetIndices(PBDataKey key, bool create, u32 &courseIndex, i32 &modeSlot)
+{
+	u32 modeID;
+	ConvertFromPBDataKey(key, &modeID, &courseIndex);
+	if (courseIndex > KZ_MAX_COURSE_COUNT)
+	{
+		return false;
+	}
+	modeSlot = PBDataCache::GetModeSlot((PluginId)modeID, create);
+	return modeSlot >= 0;
+}
+
+const PBData *PBDataCache::Find(PBDataKey key) const
+{
+	u32 courseIndex;
+	i32 modeSlot;
+	if (!PBDataCache::GetIndices(key, false, courseIndex, modeSlot) || this->entries[courseIndex][modeSlot] == invalidEntry)
+	{
+		return nullptr;
+	}
+	return &this->data[this->entries[courseIndex][modeSlot]];
+}
+
+PBData *PBDataCache::FindOrCreate(PBDataKey key)
+{
+	u32 courseIndex;
+	i32 modeSlot;
+	if (!PBDataCache::GetIndices(key, true, courseIndex, modeSlot))
+	{
+		return nullptr;
+	}
+	i16 &entry = this->entries[courseIndex][modeSlot];
+	if (entry == invalidEntry)
+	{
+		entry = (i16)this->data.size();
+		this->data.emplace_back();
+	}
+	return &this->data[entry];
+}
+
+void PBDataCache::Clear()
+{
+	for (u32 i = 0; i < KZ_MAX_COURSE_COUNT + 1; i++)
+	{
+		for (u32 j = 0; j < KZ_MAX_CACHED_MODES; j++)
+		{
+			this->entries[i][j] = invalidEntry;
+		}
+	}
+	this->data.clear();
+}
 
 static_global CUtlVector<KZTimerServiceEventListener *> eventListeners;
 
@@ -369,10 +450,15 @@ bool KZTimerService::TimerEnd(const KZCourseDescriptor *courseDesc)
 		eventListeners[i]->OnTimerEndPost(this->player, this->currentCourseGUID, time, teleportsUsed);
 	}
 	// This must be called after OnTimerEndPost so that the run UUID is set correctly.
-	if (!this->player->GetPlayerPawn()->IsBot())
+	// Invalidated runs (e.g. resumed from a saveloc) finish normally but are never submitted.
+	if (!this->player->GetPlayerPawn()->IsBot() && this->validTime)
 	{
 		RecordAnnounce::Create(this->player);
 	}
+	else if (!this->validTime)
+	{
+		this->player->languageService->PrintChat(true, false, "Run Not Submitted (Invalidated)");
+	}
 
 	return true;
 }
@@ -443,6 +529,31 @@ void KZTimerService::InvalidateRun()
 	}
 }
 
+void KZTimerService::RestoreRun(const KZCourseDescriptor *course, f64 time)
+{
+	this->currentTime = time;
+	this->timerRunning = true;
+	this->SetCourse(course->guid);
+	// Zones reached before the saveloc are unknown.
+	this->currentStage = 0;
+	this->reachedCheckpoints = 0;
+	this->lastCheckpoint = 0;
+	this->lastSplit = 0;
+
+	f64 invalidTime = -1;
+	this->splitZoneTimes.SetSize(course->splitCount);
+	this->cpZoneTimes.SetSize(course->checkpointCount);
+	this->stageZoneTimes.SetSize(course->stageCount);
+
+	this->splitZoneTimes.FillWithValue(invalidTime);
+	this->cpZoneTimes.FillWithValue(invalidTime);
+	this->stageZoneTimes.FillWithValue(invalidTime);
+
+	// Listeners are only told when a valid run turns invalid.
+	this->validTime = true;
+	this->InvalidateRun();
+}
+
 bool KZTimerService::HasValidMoveType()
 {
 	return KZTimerService::IsValidMoveType(this->player->GetMoveType());
@@ -951,35 +1062,19 @@ const PBData *KZTimerService::GetCompareTargetForType(CompareType type, PBDataKe
 	{
 		case COMPARE_WR:
 		{
-			if (KZTimerService::wrCache.find(key) != KZTimerService::wrCache.end())
-			{
-				return &KZTimerService::wrCache[key];
-			}
-			break;
+			return KZTimerService::wrCache.Find(key);
 		}
 		case COMPARE_SR:
 		{
-			if (KZTimerService::srCache.find(key) != KZTimerService::srCache.end())
-			{
-				return &KZTimerService::srCache[key];
-			}
-			break;
+			return KZTimerService::srCache.Find(key);
 		}
 		case COMPARE_GPB:
 		{
-			if (KZTimerService::globalPBCache.find(key) != KZTimerService::globalPBCache.end())
-			{
-				return &this->globalPBCache[key];
-			}
-			break;
+			return this->globalPBCache.Find(key);
 		}
 		case COMPARE_SPB:
 		{
-			if (KZTimerService::localPBCache.find(key) != KZTimerService::localPBCache.end())
-			{
-				return &this->localPBCache[key];
-			}
-			break;
+			return this->localPBCache.Find(key);
 		}
 	}
 	return nullptr;
@@ -991,35 +1086,19 @@ const PBData *KZTimerService::GetCompareTarget(PBDataKey key)
 	{
 		case COMPARE_WR:
 		{
-			if (KZTimerService::wrCache.find(key) != KZTimerService::wrCache.end())
-			{
-				return &KZTimerService::wrCache[key];
-			}
-			break;
+			return KZTimerService::wrCache.Find(key);
 		}
 		case COMPARE_SR:
 		{
-			if (KZTimerService::srCache.find(key) != KZTimerService::srCache.end())
-			{
-				return &KZTimerService::srCache[key];
-			}
-			break;
+			return KZTimerService::srCache.Find(key);
 		}
 		case COMPARE_GPB:
 		{
-			if (KZTimerService::globalPBCache.find(key) != KZTimerService::globalPBCache.end())
-			{
-				return &this->globalPBCache[key];
-			}
-			break;
+			return this->globalPBCache.Find(key);
 		}
 		case COMPARE_SPB:
 		{
-			if (KZTimerService::localPBCache.find(key) != KZTimerService::localPBCache.end())
-			{
-				return &this->localPBCache[key];
-			}
-			break;
+			return this->localPBCache.Find(key);
 		}
 	}
 	return nullptr;
@@ -1027,8 +1106,8 @@ const PBData *KZTimerService::GetCompareTarget(PBDataKey key)
 
 void KZTimerService::ClearRecordCache()
 {
-	KZTimerService::srCache.clear();
-	KZTimerService::wrCache.clear();
+	KZTimerService::srCache.Clear();
+	KZTimerService::wrCache.Clear();
 	for (i32 i = 0; i < MAXPLAYERS + 1; i++)
 	{
 		KZPlayer *player = g_pKZPlayerManager->ToPlayer(i);
@@ -1058,7 +1137,9 @@ void KZTimerService::UpdateLocalRecordCache()
 				{
 					continue;
 				}
-				KZTimerService::InsertRecordToCache(result->GetFloat(0), course, modeInfo.id, true, false, result->GetString(3));
+				KZRunMetadata metadata;
+				metadata.Decode(result->GetString(3));
+				KZTimerService::InsertRecordToCache(result->GetFloat(0), course, modeInfo.id, true, false, &metadata);
 			}
 		}
 		result = queries[1]->GetResultSet();
@@ -1076,159 +1157,77 @@ void KZTimerService::UpdateLocalRecordCache()
 				{
 					continue;
 				}
-				KZTimerService::InsertRecordToCache(result->GetFloat(0), course, modeInfo.id, false, false, result->GetString(3));
+				KZRunMetadata metadata;
+				metadata.Decode(result->GetString(3));
+				KZTimerService::InsertRecordToCache(result->GetFloat(0), course, modeInfo.id, false, false, &metadata);
 			}
 		}
 	};
 	KZDatabaseService::QueryAllRecords(g_pKZUtils->GetCurrentMapName(), onQuerySuccess, KZDatabaseService::OnGenericTxnFailure);
 }
 
-void KZTimerService::InsertRecordToCache(f64 time, const KZCourseDescriptor *course, PluginId modeID, bool overall, bool global, CUtlString metadata)
+void KZTimerService::InsertRecordToCache(f64 time, const KZCourseDescriptor *course, PluginId modeID, bool overall, bool global,
+										 const KZRunMetadata *metadata)
 {
-	PBData &pb = global ? KZTimerService::wrCache[ToPBDataKey(modeID, course->guid)] : KZTimerService::srCache[ToPBDataKey(modeID, course->guid)];
-
-	overall ? pb.overall.pbTime = time : pb.pro.pbTime = time;
-	KeyValues3 kv(KV3_TYPEEX_TABLE, KV3_SUBTYPE_UNSPECIFIED);
-	CUtlString error = "";
-	if (metadata.IsEmpty())
+	PBData *pb = global ? KZTimerService::wrCache.FindOrCreate(ToPBDataKey(modeID, course->guid))
+						: KZTimerService::srCache.FindOrCreate(ToPBDataKey(modeID, course->guid));
+	if (!pb)
 	{
 		return;
 	}
-	LoadKV3FromJSON(&kv, &error, metadata.Get(), "");
-	if (!error.IsEmpty())
+
+	overall ? pb->overall.pbTime = time : pb->pro.pbTime = time;
+	KZTimerService::CopyZoneTimes(overall ? pb->overall.zoneTimes : pb->pro.zoneTimes, course, metadata);
+}
+
+void KZTimerService::CopyZoneTimes(KZRunMetadata &target, const KZCourseDescriptor *course, const KZRunMetadata *metadata)
+{
+	// Pad to the zone counts of the course so that comparisons can index directly.
+	target.splitZoneTimes.assign(course->splitCount, -1.0);
+	target.cpZoneTimes.assign(course->checkpointCount, -1.0);
+	target.stageZoneTimes.assign(course->stageCount, -1.0);
+	if (!metadata)
 	{
-		META_CONPRINTF("[KZ::Timer] Failed to insert PB to cache due to metadata error: %s\n", error.Get());
 		return;
 	}
-
-	KeyValues3 *data = kv.FindMember("splitZoneTimes");
-	if (data && data->GetType() == KV3_TYPE_ARRAY)
+	for (i32 i = 0; i < course->splitCount; i++)
 	{
-		for (i32 i = 0; i < course->splitCount; i++)
-		{
-			f64 time = -1.0f;
-			KeyValues3 *element = data->GetArrayElement(i);
-			if (element)
-			{
-				time = element->GetDouble(-1.0);
-			}
-			overall ? pb.overall.pbSplitZoneTimes[i] = time : pb.pro.pbSplitZoneTimes[i] = time;
-		}
+		target.splitZoneTimes[i] = KZRunMetadata::GetTime(metadata->splitZoneTimes, i);
 	}
-
-	data = kv.FindMember("cpZoneTimes");
-	if (data && data->GetType() == KV3_TYPE_ARRAY)
+	for (i32 i = 0; i < course->checkpointCount; i++)
 	{
-		for (i32 i = 0; i < course->checkpointCount; i++)
-		{
-			f64 time = -1.0f;
-			KeyValues3 *element = data->GetArrayElement(i);
-			if (element)
-			{
-				time = element->GetDouble(-1.0);
-			}
-			overall ? pb.overall.pbCpZoneTimes[i] = time : pb.pro.pbCpZoneTimes[i] = time;
-		}
+		target.cpZoneTimes[i] = KZRunMetadata::GetTime(metadata->cpZoneTimes, i);
 	}
-
-	data = kv.FindMember("stageZoneTimes");
-	if (data && data->GetType() == KV3_TYPE_ARRAY)
+	for (i32 i = 0; i < course->stageCount; i++)
 	{
-		for (i32 i = 0; i < course->stageCount; i++)
-		{
-			f64 time = -1.0f;
-			KeyValues3 *element = data->GetArrayElement(i);
-			if (element)
-			{
-				time = element->GetDouble(-1.0);
-			}
-			overall ? pb.overall.pbStageZoneTimes[i] = time : pb.pro.pbStageZoneTimes[i] = time;
-		}
+		target.stageZoneTimes[i] = KZRunMetadata::GetTime(metadata->stageZoneTimes, i);
 	}
 }
 
 void KZTimerService::ClearPBCache()
 {
-	this->localPBCache.clear();
-	this->globalPBCache.clear();
+	this->localPBCache.Clear();
+	this->globalPBCache.Clear();
 }
 
 const PBData *KZTimerService::GetGlobalCachedPB(const KZCourseDescriptor *course, PluginId modeID)
 {
-	PBDataKey key = ToPBDataKey(modeID, course->guid);
-
-	if (this->globalPBCache.find(key) == this->globalPBCache.end())
-	{
-		return nullptr;
-	}
-
-	return &this->globalPBCache[key];
+	return this->globalPBCache.Find(ToPBDataKey(modeID, course->guid));
 }
 
-void KZTimerService::InsertPBToCache(f64 time, const KZCourseDescriptor *course, PluginId modeID, bool overall, bool global, CUtlString metadata,
-									 f64 points)
+void KZTimerService::InsertPBToCache(f64 time, const KZCourseDescriptor *course, PluginId modeID, bool overall, bool global,
+									 const KZRunMetadata *metadata, f64 points)
 {
-	PBData &pb = global ? this->globalPBCache[ToPBDataKey(modeID, course->guid)] : this->localPBCache[ToPBDataKey(modeID, course->guid)];
-
-	overall ? pb.overall.points = points : pb.pro.points = points;
-	overall ? pb.overall.pbTime = time : pb.pro.pbTime = time;
-	KeyValues3 kv(KV3_TYPEEX_TABLE, KV3_SUBTYPE_UNSPECIFIED);
-	CUtlString error = "";
-	if (metadata.IsEmpty())
-	{
-		return;
-	}
-	LoadKV3FromJSON(&kv, &error, metadata.Get(), "");
-	if (!error.IsEmpty())
+	PBData *pb = global ? this->globalPBCache.FindOrCreate(ToPBDataKey(modeID, course->guid))
+						: this->localPBCache.FindOrCreate(ToPBDataKey(modeID, course->guid));
+	if (!pb)
 	{
-		META_CONPRINTF("[KZ::Timer] Failed to insert server record to cache due to metadata error: %s\n", error.Get());
 		return;
 	}
 
-	KeyValues3 *data = kv.FindMember("splitZoneTimes");
-	if (data && data->GetType() == KV3_TYPE_ARRAY)
-	{
-		for (i32 i = 0; i < course->splitCount; i++)
-		{
-			f64 time = -1.0f;
-			KeyValues3 *element = data->GetArrayElement(i);
-			if (element)
-			{
-				time = element->GetDouble(-1.0);
-			}
-			overall ? pb.overall.pbSplitZoneTimes[i] = time : pb.pro.pbSplitZoneTimes[i] = time;
-		}
-	}
-
-	data = kv.FindMember("cpZoneTimes");
-	if (data && data->GetType() == KV3_TYPE_ARRAY)
-	{
-		for (i32 i = 0; i < course->checkpointCount; i++)
-		{
-			f64 time = -1.0f;
-			KeyValues3 *element = data->GetArrayElement(i);
-			if (element)
-			{
-				time = element->GetDouble(-1.0);
-			}
-			overall ? pb.overall.pbCpZoneTimes[i] = time : pb.pro.pbCpZoneTimes[i] = time;
-		}
-	}
-
-	data = kv.FindMember("stageZoneTimes");
-	if (data && data->GetType() == KV3_TYPE_ARRAY)
-	{
-		for (i32 i = 0; i < course->stageCount; i++)
-		{
-			f64 time = -1.0f;
-			KeyValues3 *element = data->GetArrayElement(i);
-			if (element)
-			{
-				time = element->GetDouble(-1.0);
-			}
-			overall ? pb.overall.pbStageZoneTimes[i] = time : pb.pro.pbStageZoneTimes[i] = time;
-		}
-	}
+	overall ? pb->overall.points = points : pb->pro.points = points;
+	overall ? pb->overall.pbTime = time : pb->pro.pbTime = time;
+	KZTimerService::CopyZoneTimes(overall ? pb->overall.zoneTimes : pb->pro.zoneTimes, course, metadata);
 }
 
 void KZTimerService::CheckMissedTime()
@@ -1318,17 +1317,16 @@ void KZTimerService::ShowSplitText(u32 currentSplit)
 	const PBData *pb = this->GetCompareTarget(key);
 	if (pb)
 	{
-		if (pb->overall.pbSplitZoneTimes[currentSplit - 1] > 0)
+		if (KZRunMetadata::GetTime(pb->overall.zoneTimes.splitZoneTimes, currentSplit - 1) > 0)
 		{
-			META_CONPRINTF("pb->overall.pbSplitZoneTimes[currentSplit - 1] = %lf\n", pb->overall.pbSplitZoneTimes[currentSplit - 1]);
-			f64 diff = this->splitZoneTimes[currentSplit - 1] - pb->overall.pbSplitZoneTimes[currentSplit - 1];
+			f64 diff = this->splitZoneTimes[currentSplit - 1] - KZRunMetadata::GetTime(pb->overall.zoneTimes.splitZoneTimes, currentSplit - 1);
 			CUtlString diffText = KZTimerService::FormatDiffTime(diff);
 			diffText.Format("{grey}%s%s{grey}", diff < 0 ? "{green}" : "{lightred}", diffText.Get());
 			pbDiff = this->player->languageService->PrepareMessage(diffTextKeys[this->currentCompareType], diffText.Get());
 		}
-		if (this->player->checkpointService->GetTeleportCount() == 0 && pb->pro.pbTime > 0 && pb->pro.pbSplitZoneTimes[currentSplit - 1] > 0)
+		if (this->player->checkpointService->GetTeleportCount() == 0 && pb->pro.pbTime > 0 && KZRunMetadata::GetTime(pb->pro.zoneTimes.splitZoneTimes, currentSplit - 1) > 0)
 		{
-			f64 diff = this->splitZoneTimes[currentSplit - 1] - pb->pro.pbSplitZoneTimes[currentSplit - 1];
+			f64 diff = this->splitZoneTimes[currentSplit - 1] - KZRunMetadata::GetTime(pb->pro.zoneTimes.splitZoneTimes, currentSplit - 1);
 			CUtlString diffText = KZTimerService::FormatDiffTime(diff);
 			diffText.Format("{grey}%s%s{grey}", diff < 0 ? "{green}" : "{lightred}", diffText.Get());
 			pbDiffPro = this->player->languageService->PrepareMessage(diffTextKeysPro[this->currentCompareType], diffText.Get());
@@ -1371,16 +1369,16 @@ void KZTimerService::ShowCheckpointText(u32 currentCheckpoint)
 	const PBData *pb = this->GetCompareTarget(key);
 	if (pb)
 	{
-		if (pb->overall.pbCpZoneTimes[currentCheckpoint - 1] > 0)
+		if (KZRunMetadata::GetTime(pb->overall.zoneTimes.cpZoneTimes, currentCheckpoint - 1) > 0)
 		{
-			f64 diff = this->cpZoneTimes[currentCheckpoint - 1] - pb->overall.pbCpZoneTimes[currentCheckpoint - 1];
+			f64 diff = this->cpZoneTimes[currentCheckpoint - 1] - KZRunMetadata::GetTime(pb->overall.zoneTimes.cpZoneTimes, currentCheckpoint - 1);
 			CUtlString diffText = KZTimerService::FormatDiffTime(diff);
 			diffText.Format("{grey}%s%s{grey}", diff < 0 ? "{green}" : "{lightred}", diffText.Get());
 			pbDiff = this->player->languageService->PrepareMessage(diffTextKeys[this->currentCompareType], diffText.Get());
 		}
-		if (this->player->checkpointService->GetTeleportCount() == 0 && pb->pro.pbTime > 0 && pb->pro.pbCpZoneTimes[currentCheckpoint - 1] > 0)
+		if (this->player->checkpointService->GetTeleportCount() == 0 && pb->pro.pbTime > 0 && KZRunMetadata::GetTime(pb->pro.zoneTimes.cpZoneTimes, currentCheckpoint - 1) > 0)
 		{
-			f64 diff = this->cpZoneTimes[currentCheckpoint - 1] - pb->pro.pbCpZoneTimes[currentCheckpoint - 1];
+			f64 diff = this->cpZoneTimes[currentCheckpoint - 1] - KZRunMetadata::GetTime(pb->pro.zoneTimes.cpZoneTimes, currentCheckpoint - 1);
 			CUtlString diffText = KZTimerService::FormatDiffTime(diff);
 			diffText.Format("{grey}%s%s{grey}", diff < 0 ? "{green}" : "{lightred}", diffText.Get());
 			pbDiffPro = this->player->languageService->PrepareMessage(diffTextKeysPro[this->currentCompareType], diffText.Get());
@@ -1424,16 +1422,16 @@ void KZTimerService::ShowStageText()
 	const PBData *pb = this->GetCompareTarget(key);
 	if (pb)
 	{
-		if (pb->overall.pbStageZoneTimes[this->currentStage] > 0)
+		if (KZRunMetadata::GetTime(pb->overall.zoneTimes.stageZoneTimes, this->currentStage) > 0)
 		{
-			f64 diff = this->stageZoneTimes[this->currentStage] - pb->overall.pbStageZoneTimes[this->currentStage];
+			f64 diff = this->stageZoneTimes[this->currentStage] - KZRunMetadata::GetTime(pb->overall.zoneTimes.stageZoneTimes, this->currentStage);
 			CUtlString diffText = KZTimerService::FormatDiffTime(diff);
 			diffText.Format("{grey}%s%s{grey}", diff < 0 ? "{green}" : "{lightred}", diffText.Get());
 			pbDiff = this->player->languageService->PrepareMessage(diffTextKeys[this->currentCompareType], diffText.Get());
 		}
-		if (this->player->checkpointService->GetTeleportCount() == 0 && pb->pro.pbTime > 0 && pb->pro.pbStageZoneTimes[this->currentStage] > 0)
+		if (this->player->checkpointService->GetTeleportCount() == 0 && pb->pro.pbTime > 0 && KZRunMetadata::GetTime(pb->pro.zoneTimes.stageZoneTimes, this->currentStage) > 0)
 		{
-			f64 diff = this->stageZoneTimes[this->currentStage] - pb->pro.pbStageZoneTimes[this->currentStage];
+			f64 diff = this->stageZoneTimes[this->currentStage] - KZRunMetadata::GetTime(pb->pro.zoneTimes.stageZoneTimes, this->currentStage);
 			CUtlString diffText = KZTimerService::FormatDiffTime(diff);
 			diffText.Format("{grey}%s%s{grey}", diff < 0 ? "{green}" : "{lightred}", diffText.Get());
 			pbDiffPro = this->player->languageService->PrepareMessage(diffTextKeysPro[this->currentCompareType], diffText.Get());
@@ -1444,43 +1442,13 @@ void KZTimerService::ShowStageText()
 											 pbDiffPro.c_str());
 }
 
-CUtlString KZTimerService::GetCurrentRunMetadata()
+KZRunMetadata KZTimerService::GetCurrentRunMetadata()
 {
-	KeyValues3 kv(KV3_TYPEEX_TABLE, KV3_SUBTYPE_UNSPECIFIED);
-
-	KeyValues3 *splitZoneTimesKV = kv.FindOrCreateMember("splitZoneTimes");
-
-	splitZoneTimesKV->SetToEmptyArray();
-	FOR_EACH_VEC(this->splitZoneTimes, i)
-	{
-		KeyValues3 *time = splitZoneTimesKV->ArrayAddElementToTail();
-		time->SetDouble(this->splitZoneTimes[i]);
-	}
-
-	KeyValues3 *cpZoneTimesKV = kv.FindOrCreateMember("cpZoneTimes");
-	cpZoneTimesKV->SetToEmptyArray();
-	FOR_EACH_VEC(this->cpZoneTimes, i)
-	{
-		KeyValues3 *time = cpZoneTimesKV->ArrayAddElementToTail();
-		time->SetDouble(this->cpZoneTimes[i]);
-	}
-
-	splitZoneTimesKV->SetToEmptyArray();
-
-	KeyValues3 *stageZoneTimesKV = kv.FindOrCreateMember("stageZoneTimes");
-	FOR_EACH_VEC(this->stageZoneTimes, i)
-	{
-		KeyValues3 *time = stageZoneTimesKV->ArrayAddElementToTail();
-		time->SetDouble(this->stageZoneTimes[i]);
-	}
-
-	CUtlString result, error;
-	if (SaveKV3AsJSON(&kv, &error, &result))
-	{
-		return result;
-	}
-	META_CONPRINTF("[KZ::Timer] Failed to obtain current run's metadata! (%s)\n", error.Get());
-	return "";
+	KZRunMetadata metadata;
+	metadata.splitZoneTimes.assign(this->splitZoneTimes.Base(), this->splitZoneTimes.Base() + this->splitZoneTimes.Count());
+	metadata.cpZoneTimes.assign(this->cpZoneTimes.Base(), this->cpZoneTimes.Base() + this->cpZoneTimes.Count());
+	metadata.stageZoneTimes.assign(this->stageZoneTimes.Base(), this->stageZoneTimes.Base() + this->stageZoneTimes.Count());
+	return metadata;
 }
 
 void KZTimerService::UpdateLocalPBCache()
@@ -1509,7 +1477,9 @@ void KZTimerService::UpdateLocalPBCache()
 				{
 					continue;
 				}
-				pl->timerService->InsertPBToCache(result->GetFloat(0), course, modeInfo.id, true, false, result->GetString(3));
+				KZRunMetadata metadata;
+				metadata.Decode(result->GetString(3));
+				pl->timerService->InsertPBToCache(result->GetFloat(0), course, modeInfo.id, true, false, &metadata);
 			}
 		}
 		result = queries[1]->GetResultSet();
@@ -1527,7 +1497,9 @@ void KZTimerService::UpdateLocalPBCache()
 				{
 					continue;
 				}
-				pl->timerService->InsertPBToCache(result->GetFloat(0), course, modeInfo.id, false, false, result->GetString(3));
+				KZRunMetadata metadata;
+				metadata.Decode(result->GetString(3));
+				pl->timerService->InsertPBToCache(result->GetFloat(0), course, modeInfo.id, false, false, &metadata);
 			}
 		}
 	};
@@ -1563,6 +1535,18 @@ void KZDatabaseServiceEventListener_Timer::OnClientSetup(Player *player, u64 ste
 	kzPlayer->timerService->UpdateLocalPBCache();
 }
 
+// Times are only ever inserted for the current map.
+void KZDatabaseServiceEventListener_Timer::OnTimeInserted(Player *player, u64 steamID64, u32 mapID, u32 course, u64 mode, u64 styles,
+														  u64 runtimeMS, u32 teleportsUsed)
+{
+	QueryCacheBase::InvalidateMap(g_pKZUtils->GetCurrentMapName().Get());
+}
+
+void KZDatabaseServiceEventListener_Timer::OnNewRecord(Player *player, u64 steamID64, u32 mapID, u32 course, u64 mode, u64 styles, u32 teleportsUsed)
+{
+	QueryCacheBase::InvalidateMap(g_pKZUtils->GetCurrentMapName().Get());
+}
+
 SCMD(kz_recordvolume, SCFL_TIMER | SCFL_GLOBAL | SCFL_PREFERENCE)
 {
 	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
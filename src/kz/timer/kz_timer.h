@@ -4,6 +4,8 @@
 #include "../checkpoint/kz_checkpoint.h"
 #include "kz/mappingapi/kz_mappingapi.h"
 #include "utils/uuid.h"
+#include "run_metadata.h"
+#include <deque>
 
 #define KZ_MAX_MODE_NAME_LENGTH 128
 
@@ -22,6 +24,8 @@
 
 #define KZ_PAUSE_COOLDOWN 1.0f
 
+#define KZ_MAX_CACHED_MODES 16
+
 struct PBData
 {
 	PBData()
@@ -32,22 +36,19 @@ struct PBData
 	void Reset()
 	{
 		overall.pbTime = {};
-		overall.pbSplitZoneTimes.FillWithValue(-1.0);
-		overall.pbCpZoneTimes.FillWithValue(-1.0);
-		overall.pbStageZoneTimes.FillWithValue(-1.0);
+		overall.points = {};
+		overall.zoneTimes.Clear();
 		pro.pbTime = {};
-		pro.pbSplitZoneTimes.FillWithValue(-1.0);
-		pro.pbCpZoneTimes.FillWithValue(-1.0);
-		pro.pbStageZoneTimes.FillWithValue(-1.0);
+		pro.points = {};
+		pro.zoneTimes.Clear();
 	}
 
 	struct
 	{
 		f64 pbTime {};
 		f64 points {};
-		CUtlVectorFixed<f64, KZ_MAX_SPLIT_ZONES> pbSplitZoneTimes;
-		CUtlVectorFixed<f64, KZ_MAX_CHECKPOINT_ZONES> pbCpZoneTimes;
-		CUtlVectorFixed<f64, KZ_MAX_STAGE_ZONES> pbStageZoneTimes;
+		// Decoded once when inserted, so that split comparisons don't have to touch the metadata again.
+		KZRunMetadata zoneTimes;
 	} overall, pro;
 };
 
@@ -71,6 +72,30 @@ inline void ConvertFromPBDataKey(PBDataKey key, uint32_t *modeID, uint32_t *cour
 	}
 }
 
+// PB/record cache laid out as a flat (course, mode) table. Courses are indexed by their GUID, modes by a slot assigned the first time they are seen.
+class PBDataCache
+{
+public:
+	PBDataCache()
+	{
+		Clear();
+	}
+
+	const PBData *Find(PBDataKey key) const;
+	PBData *FindOrCreate(PBDataKey key);
+	void Clear();
+
+private:
+	static constexpr i16 invalidEntry = -1;
+	// Shared by all caches, the set of modes barely changes over the lifetime of the server.
+	static i32 GetModeSlot(PluginId modeID, bool create);
+	static bool GetIndices(PBDataKey key, bool create, u32 &courseIndex, i32 &modeSlot);
+
+	i16 entries[KZ_MAX_COURSE_COUNT + 1][KZ_MAX_CACHED_MODES];
+	// std::deque so that references handed out stay valid when new entries are added.
+	std::deque<PBData> data;
+};
+
 class KZTimerServiceEventListener
 {
 public:
@@ -138,13 +163,13 @@ private:
 	CUtlVectorFixed<f64, KZ_MAX_STAGE_ZONES> stageZoneTimes {};
 
 	// PB cache per mode and per course.
-	std::unordered_map<PBDataKey, PBData> localPBCache;
-	std::unordered_map<PBDataKey, PBData> globalPBCache;
+	PBDataCache localPBCache;
+	PBDataCache globalPBCache;
 
 	// SR cache should be loaded upon map start, every time !wr is queried and every time a run beats the server record.
-	static std::unordered_map<PBDataKey, PBData> srCache;
+	static PBDataCache srCache;
 
-	static std::unordered_map<PBDataKey, PBData> wrCache;
+	static PBDataCache wrCache;
 
 public:
 	enum CompareType : u8
@@ -170,6 +195,7 @@ private:
 	void UpdateCurrentCompareType(PBDataKey key);
 	const PBData *GetCompareTargetForType(CompareType type, PBDataKey key);
 	const PBData *GetCompareTarget(PBDataKey key);
+	static void CopyZoneTimes(KZRunMetadata &target, const KZCourseDescriptor *course, const KZRunMetadata *metadata);
 
 	bool shouldAnnounceMissedTime = true;
 	bool shouldAnnounceMissedProTime = true;
@@ -178,13 +204,13 @@ public:
 	static void ClearRecordCache();
 	static void UpdateLocalRecordCache();
 	static void InsertRecordToCache(f64 time, const KZCourseDescriptor *courseName, PluginId modeID, bool hasTeleports, bool global,
-									CUtlString metadata = "");
+									const KZRunMetadata *metadata = nullptr);
 
 	void ClearPBCache();
 	const PBData *GetGlobalCachedPB(const KZCourseDescriptor *course, PluginId modeID);
 	void UpdateLocalPBCache();
-	void InsertPBToCache(f64 time, const KZCourseDescriptor *courseName, PluginId modeID, bool overall, bool global, CUtlString metadata = "",
-						 f64 points = 0);
+	void InsertPBToCache(f64 time, const KZCourseDescriptor *courseName, PluginId modeID, bool overall, bool global,
+						 const KZRunMetadata *metadata = nullptr, f64 points = 0);
 	void SetCompareTarget(const char *typeString);
 
 	void CheckMissedTime();
@@ -193,7 +219,7 @@ public:
 	void ShowCheckpointText(u32 currentCheckpoint);
 	void ShowStageText();
 
-	CUtlString GetCurrentRunMetadata();
+	KZRunMetadata GetCurrentRunMetadata();
 
 private:
 	bool validJump {};
@@ -288,6 +314,8 @@ public:
 
 	// To be used for saveloc.
 	void InvalidateRun();
+	// Continue a run on the given course from the given time. The run is invalidated.
+	void RestoreRun(const KZCourseDescriptor *course, f64 time);
 
 private:
 	bool HasValidMoveType();
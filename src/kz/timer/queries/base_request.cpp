@@ -8,6 +8,10 @@
 
 #include "vendor/sql_mm/src/public/sql_mm.h"
 
+CConVar<f32> kz_query_cache_ttl("kz_query_cache_ttl", FCVAR_NONE,
+								"Seconds leaderboard query results are reused for. 0 only merges identical queries in flight.", 15.0f, true, 0.0f, true,
+								300.0f);
+
 BaseRequest::BaseRequest(u64 uid, KZPlayer *player)
 	: uid(uid), userID(player->GetClient()->GetUserID()), timestamp(g_pKZUtils->GetServerGlobals()->realtime)
 {
@@ -29,8 +33,8 @@ BaseRequest::~BaseRequest()
 void BaseRequest::Init(u64 features, const CCommand *args, bool queryLocal, bool queryGlobal)
 {
 	this->features = features;
-	KeyValues3 params;
-	if (!utils::ParseArgsToKV3(args->ArgS(), params, const_cast<const char **>(paramKeys), KZ_ARRAYSIZE(paramKeys)))
+	utils::ArgParams params(args->ArgS(), const_cast<const char **>(paramKeys), KZ_ARRAYSIZE(paramKeys));
+	if (!params.IsValid())
 	{
 		this->Invalidate("");
 		this->PrintInstructions();
@@ -40,11 +44,11 @@ void BaseRequest::Init(u64 features, const CCommand *args, bool queryLocal, bool
 
 	this->globalStatus = (queryGlobal && KZGlobalService::IsAvailable() ? ResponseStatus::ENABLED : ResponseStatus::DISABLED);
 
-	KeyValues3 *kv = NULL;
+	const utils::ArgParam *kv = NULL;
 
 	if (this->HasFeature(RequestFeature::Map))
 	{
-		kv = params.FindMember("map");
+		kv = params.Find("map");
 		this->mapName = kv ? kv->GetString() : "";
 		// If a map is not specified, use the current map.
 		if (this->mapName.IsEmpty())
@@ -61,37 +65,29 @@ void BaseRequest::Init(u64 features, const CCommand *args, bool queryLocal, bool
 	}
 	if (this->HasFeature(RequestFeature::Course))
 	{
-		kv = params.FindMember("course");
-		if (!kv)
-		{
-			kv = params.FindMember("c");
-		}
+		kv = params.Find("course", "c");
 		this->SetupCourse(kv ? kv->GetString() : "");
 	}
 	if (this->HasFeature(RequestFeature::Mode))
 	{
-		kv = params.FindMember("mode");
+		kv = params.Find("mode");
 		this->SetupMode(kv ? kv->GetString() : "");
 	}
-	if (this->HasFeature(RequestFeature::Offset) && (kv = params.FindMember("offset")) || (kv = params.FindMember("o")))
+	if (this->HasFeature(RequestFeature::Offset) && (kv = params.Find("offset", "o")))
 	{
 		this->offset = atoll(kv->GetString());
 	}
-	if (this->HasFeature(RequestFeature::Limit) && ((kv = params.FindMember("limit")) || (kv = params.FindMember("l"))))
+	if (this->HasFeature(RequestFeature::Limit) && (kv = params.Find("limit", "l")))
 	{
 		this->limit = atoll(kv->GetString());
 	}
-	if (this->HasFeature(RequestFeature::Style) && ((kv = params.FindMember("style")) || (kv = params.FindMember("s"))))
+	if (this->HasFeature(RequestFeature::Style) && (kv = params.Find("style", "s")))
 	{
 		this->SetupStyles(kv->GetString());
 	}
 	if (this->HasFeature(RequestFeature::Player))
 	{
-		kv = params.FindMember("player");
-		if (!kv)
-		{
-			kv = params.FindMember("p");
-		}
+		kv = params.Find("player", "p");
 		this->SetupPlayer(kv ? kv->GetString() : "");
 	}
 	if (localStatus != ResponseStatus::ENABLED && globalStatus != ResponseStatus::ENABLED)
@@ -100,12 +96,22 @@ void BaseRequest::Init(u64 features, const CCommand *args, bool queryLocal, bool
 	}
 }
 
-BaseRequest *BaseRequest::Find(u64 uid)
+BaseRequest *BaseRequest::Get(u64 uid)
 {
 	auto it = std::find_if(instances.begin(), instances.end(), [uid](BaseRequest *instance) { return instance->uid == uid; });
 	return (it != instances.end()) ? *it : nullptr;
 }
 
+BaseRequest *BaseRequest::Find(u64 uid)
+{
+	BaseRequest *req = BaseRequest::Get(uid);
+	if (req)
+	{
+		pendingUpdates.push_back(uid);
+	}
+	return req;
+}
+
 void BaseRequest::Remove(u64 uid)
 {
 	auto it = std::find_if(instances.begin(), instances.end(), [uid](BaseRequest *instance) { return instance->uid == uid; });
@@ -116,31 +122,133 @@ void BaseRequest::Remove(u64 uid)
 	}
 }
 
+bool BaseRequest::Update(BaseRequest *request)
+{
+	request->QueryLocal();
+	request->QueryGlobal();
+	request->CheckReply();
+	if (!request->isValid)
+	{
+		BaseRequest::Remove(request->uid);
+		return false;
+	}
+	return true;
+}
+
+// Timeouts are kept in a coarse timer wheel so only the slot that expires this frame is looked at.
+static_global constexpr u32 TIMEOUT_WHEEL_SLOTS = 64;
+static_global constexpr f64 TIMEOUT_WHEEL_RESOLUTION = 0.25;
+static_global std::vector<u64> timeoutWheel[TIMEOUT_WHEEL_SLOTS];
+static_global u64 timeoutWheelTick;
+
+void BaseRequest::ScheduleTimeout(BaseRequest *request)
+{
+	f64 now = g_pKZUtils->GetServerGlobals()->realtime;
+	if (!timeoutWheelTick)
+	{
+		timeoutWheelTick = (u64)(now / TIMEOUT_WHEEL_RESOLUTION);
+	}
+	u64 tick = (u64)ceil((request->timestamp + request->timeout) / TIMEOUT_WHEEL_RESOLUTION);
+	// Anything past one turn of the wheel gets rescheduled when its slot comes around.
+	tick = Clamp(tick, timeoutWheelTick + 1, timeoutWheelTick + TIMEOUT_WHEEL_SLOTS);
+	timeoutWheel[tick % TIMEOUT_WHEEL_SLOTS].push_back(request->uid);
+}
+
 void BaseRequest::CheckRequests()
 {
-	// clang-format off
-	instances.erase(std::remove_if(instances.begin(), instances.end(),
-		[](BaseRequest *instance)
+	// Cached queries answer immediately, so an update can queue the same request again. Let those finish this frame.
+	for (u32 pass = 0; pass < 4 && !pendingUpdates.empty(); pass++)
+	{
+		std::vector<u64> updates;
+		updates.swap(pendingUpdates);
+		std::sort(updates.begin(), updates.end());
+		updates.erase(std::unique(updates.begin(), updates.end()), updates.end());
+		for (u64 uid : updates)
+		{
+			BaseRequest *req = BaseRequest::Get(uid);
+			if (req)
+			{
+				BaseRequest::Update(req);
+			}
+		}
+	}
+
+	if (!timeoutWheelTick)
+	{
+		return;
+	}
+	f64 now = g_pKZUtils->GetServerGlobals()->realtime;
+	u64 targetTick = (u64)(now / TIMEOUT_WHEEL_RESOLUTION);
+	// After a long stall every slot is due, there is no point turning the wheel more than once.
+	if (targetTick > timeoutWheelTick + TIMEOUT_WHEEL_SLOTS)
+	{
+		timeoutWheelTick = targetTick - TIMEOUT_WHEEL_SLOTS;
+	}
+	while (timeoutWheelTick < targetTick)
+	{
+		timeoutWheelTick++;
+		std::vector<u64> expired;
+		expired.swap(timeoutWheel[timeoutWheelTick % TIMEOUT_WHEEL_SLOTS]);
+		for (u64 uid : expired)
 		{
-			instance->QueryLocal();
-			instance->QueryGlobal();
-			instance->CheckReply();
-			if (!instance->isValid)
+			BaseRequest *req = BaseRequest::Get(uid);
+			if (!req)
+			{
+				continue; // Already finished.
+			}
+			if (req->timestamp + req->timeout >= now)
 			{
-				delete instance;
-				return true;
+				BaseRequest::ScheduleTimeout(req);
+				continue;
 			}
-			else if (instance->timestamp + instance->timeout < g_pKZUtils->GetServerGlobals()->realtime)
+			// Force a reply with whatever data the instance has obtained.
+			if (req->isValid)
 			{
-				// Force a reply with whatever data the instance has obtained.
-				instance->Reply();
-				delete instance;
-				return true;
+				req->Reply();
 			}
-			return false;
-		}),
-		instances.end());
-	// clang-format on
+			BaseRequest::Remove(uid);
+		}
+	}
+}
+
+std::string BaseRequest::GetQueryKey(const char *query, bool global) const
+{
+	char key[512];
+	if (global)
+	{
+		CUtlString styles;
+		FOR_EACH_VEC(this->styleList, i)
+		{
+			styles.Append(this->styleList[i].Get());
+			styles.Append(",");
+		}
+		V_snprintf(key, sizeof(key), "%s|%s|%s|%i|%s|%llu|%llu|%llu", query, this->mapName.Get(), this->courseName.Get(), (i32)this->apiMode,
+				   styles.Get(), this->offset, this->limit, this->targetSteamID64);
+	}
+	else
+	{
+		V_snprintf(key, sizeof(key), "%s|%s|%s|%llu|%llu|%llu|%llu|%llu", query, this->mapName.Get(), this->courseName.Get(), this->localModeID,
+				   this->localStyleIDs, this->offset, this->limit, this->targetSteamID64);
+	}
+	// Map and course names are matched case insensitively by both the database and the API.
+	V_strlower(key);
+	return key;
+}
+
+void QueryCacheBase::InvalidateMap(const char *mapName)
+{
+	for (QueryCacheBase *cache : GetCaches())
+	{
+		cache->Invalidate(mapName);
+	}
+}
+
+void QueryCacheBase::InvalidateAll()
+{
+	for (QueryCacheBase *cache : GetCaches())
+	{
+		cache->Invalidate(nullptr);
+	}
 }
 
 /*
@@ -9,6 +9,7 @@
 #include "utils/tables.h"
 #include "kz/global/api.h"
 #include "kz/language/kz_language.h"
+#include "query_cache.h"
 
 struct BaseRequest
 {
@@ -22,6 +23,8 @@ public:
 protected:
 	static inline u64 idCount = 0;
 	static inline std::vector<BaseRequest *> instances;
+	// Requests to advance on the next check, either new or touched by a query callback.
+	static inline std::vector<u64> pendingUpdates;
 	static inline constexpr const char *paramKeys[] = {"c", "course", "mode", "map", "o", "offset", "l", "limit", "s", "style"};
 	f64 timeout = 5.0f;
 
@@ -32,13 +35,23 @@ public:
 		auto obj = new T(idCount++, player);
 		obj->Init(features, args, queryLocal, queryGlobal);
 		instances.push_back(obj);
+		pendingUpdates.push_back(obj->uid);
+		ScheduleTimeout(obj);
 		return obj;
 	}
 
+	// Query callbacks look their request up with this, which also queues it for an update.
 	static BaseRequest *Find(u64 uid);
 	static void Remove(u64 uid);
+	// Advance the requests that received something since the last call and time out expired ones.
 	static void CheckRequests();
 
+private:
+	static BaseRequest *Get(u64 uid);
+	static void ScheduleTimeout(BaseRequest *request);
+	// Returns false once the request is done and has been deleted.
+	static bool Update(BaseRequest *request);
+
 public:
 	const u64 uid;
 	// UserID for callback.
@@ -141,6 +154,9 @@ public:
 
 	void SetupStyles(CUtlString styleNames);
 
+	// Identifies the query of this request for the query caches, global is false for the local database.
+	std::string GetQueryKey(const char *query, bool global) const;
+
 	virtual void PrintInstructions() {}
 
 	virtual void QueryLocal() = 0;
@@ -108,6 +108,15 @@ struct CourseTopRequest : public BaseRequest
 		CUtlVector<RunStats> proData;
 	} srData, wrData;
 
+	struct LocalCourseTop
+	{
+		std::vector<RunStats> overallData;
+		std::vector<RunStats> proData;
+	};
+
+	static inline QueryCache<LocalCourseTop> localCache;
+	static inline QueryCache<KZ::API::events::CourseTop> globalCache;
+
 	virtual void PrintInstructions() override
 	{
 		KZPlayer *player = g_pKZPlayerManager->ToPlayer(this->userID);
@@ -138,47 +147,62 @@ struct CourseTopRequest : public BaseRequest
 
 			this->localStatus = ResponseStatus::PENDING;
 
-			u64 uid = this->uid;
-
-			auto onQuerySuccess = [uid](std::vector<ISQLQuery *> queries)
+			auto fetch = [mapName = this->mapName, courseName = this->courseName, modeID = this->localModeID, limit = this->limit,
+						  offset = this->offset](std::function<void(const LocalCourseTop *)> done)
 			{
-				CourseTopRequest *req = (CourseTopRequest *)CourseTopRequest::Find(uid);
-				if (!req)
+				auto onQuerySuccess = [done](std::vector<ISQLQuery *> queries)
 				{
-					return;
-				}
-
-				req->localStatus = ResponseStatus::RECEIVED;
-				ISQLResult *result = queries[0]->GetResultSet();
-				if (result && result->GetRowCount() > 0)
-				{
-					while (result->FetchRow())
+					LocalCourseTop data;
+					ISQLResult *result = queries[0]->GetResultSet();
+					if (result && result->GetRowCount() > 0)
 					{
-						req->srData.overallData.AddToTail(
-							{result->GetString(0), result->GetString(2), (u64)result->GetInt64(4), result->GetFloat(3), (u64)result->GetInt64(1)});
+						while (result->FetchRow())
+						{
+							data.overallData.push_back({result->GetString(0), result->GetString(2), (u64)result->GetInt64(4), result->GetFloat(3),
+														(u64)result->GetInt64(1)});
+						}
 					}
-				}
 
-				if ((result = queries[1]->GetResultSet()) && result->GetRowCount() > 0)
-				{
-					while (result->FetchRow())
+					if ((result = queries[1]->GetResultSet()) && result->GetRowCount() > 0)
 					{
-						req->srData.proData.AddToTail({result->GetString(0), result->GetString(2), 0, result->GetFloat(3), (u64)result->GetInt64(1)});
+						while (result->FetchRow())
+						{
+							data.proData.push_back({result->GetString(0), result->GetString(2), 0, result->GetFloat(3), (u64)result->GetInt64(1)});
+						}
 					}
-				}
+					done(&data);
+				};
+
+				auto onQueryFailure = [done](std::string, int) { done(nullptr); };
+
+				KZDatabaseService::QueryRecords(mapName, courseName, modeID, limit, offset, onQuerySuccess, onQueryFailure);
 			};
 
-			auto onQueryFailure = [uid](std::string, int)
+			auto callback = [uid = this->uid](const LocalCourseTop *data)
 			{
 				CourseTopRequest *req = (CourseTopRequest *)CourseTopRequest::Find(uid);
-				if (req)
+				if (!req)
+				{
+					return;
+				}
+				if (!data)
 				{
 					req->localStatus = ResponseStatus::DISABLED;
+					return;
+				}
+
+				req->localStatus = ResponseStatus::RECEIVED;
+				for (const RunStats &stats : data->overallData)
+				{
+					req->srData.overallData.AddToTail(stats);
+				}
+				for (const RunStats &stats : data->proData)
+				{
+					req->srData.proData.AddToTail(stats);
 				}
 			};
 
-			KZDatabaseService::QueryRecords(this->mapName, this->courseName, this->localModeID, this->limit, this->offset, onQuerySuccess,
-											onQueryFailure);
+			localCache.Query(this->mapName.Get(), this->GetQueryKey("ctop", false), fetch, callback);
 		}
 	}
 
@@ -191,7 +215,18 @@ struct CourseTopRequest : public BaseRequest
 
 		if (this->globalStatus == ResponseStatus::ENABLED)
 		{
-			auto callback = [uid = this->uid](KZ::API::events::CourseTop &ctops)
+			auto fetch = [mapName = this->mapName, courseName = this->courseName, apiMode = this->apiMode, limit = this->limit,
+						  offset = this->offset](std::function<void(const KZ::API::events::CourseTop *)> done)
+			{
+				auto onResponse = [done](KZ::API::events::CourseTop &ctops) { done(&ctops); };
+				if (!KZGlobalService::QueryCourseTop(std::string_view(mapName.Get(), mapName.Length()),
+													 std::string_view(courseName.Get(), courseName.Length()), apiMode, limit, offset, onResponse))
+				{
+					done(nullptr);
+				}
+			};
+
+			auto callback = [uid = this->uid](const KZ::API::events::CourseTop *response)
 			{
 				CourseTopRequest *req = (CourseTopRequest *)CourseTopRequest::Find(uid);
 				if (!req)
@@ -199,10 +234,10 @@ struct CourseTopRequest : public BaseRequest
 					return;
 				}
 
-				if (ctops.map.has_value() && ctops.course.has_value())
+				if (response && response->map.has_value() && response->course.has_value())
 				{
-					req->mapName = ctops.map->name.c_str();
-					req->courseName = ctops.course->name.c_str();
+					req->mapName = response->map->name.c_str();
+					req->courseName = response->course->name.c_str();
 					req->globalStatus = ResponseStatus::RECEIVED;
 				}
 				else
@@ -210,6 +245,7 @@ struct CourseTopRequest : public BaseRequest
 					req->globalStatus = ResponseStatus::DISABLED;
 					return;
 				}
+				const KZ::API::events::CourseTop &ctops = *response;
 				for (const auto &record : ctops.overall)
 				{
 					CUtlString id;
@@ -225,9 +261,7 @@ struct CourseTopRequest : public BaseRequest
 				}
 			};
 			this->globalStatus = ResponseStatus::PENDING;
-			KZGlobalService::QueryCourseTop(std::string_view(this->mapName.Get(), this->mapName.Length()),
-											std::string_view(this->courseName.Get(), this->courseName.Length()), this->apiMode, this->limit,
-											this->offset, callback);
+			globalCache.Query(this->mapName.Get(), this->GetQueryKey("ctop", true), fetch, callback);
 		}
 	}
 
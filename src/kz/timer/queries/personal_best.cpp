@@ -15,7 +15,7 @@ struct PBRequest : public BaseRequest
 	static constexpr u64 pbFeatures =
 		RequestFeature::Course | RequestFeature::Map | RequestFeature::Mode | RequestFeature::Player | RequestFeature::Style;
 
-	struct
+	struct PBData
 	{
 		bool hasPB {};
 		f32 runTime {};
@@ -31,6 +31,9 @@ struct PBRequest : public BaseRequest
 		u32 pointsPro {}; // Global only.
 	} pbData, gpbData;
 
+	static inline QueryCache<PBData> localCache;
+	static inline QueryCache<KZ::API::events::PersonalBest> globalCache;
+
 	bool globallyBanned = false;
 	bool queryLocalRanking = true;
 
@@ -107,13 +110,41 @@ struct PBRequest : public BaseRequest
 			return;
 		}
 		this->globalStatus = ResponseStatus::PENDING;
-		auto callback = [uid = this->uid](KZ::API::events::PersonalBest &pb)
+		std::vector<CUtlString> styles;
+		FOR_EACH_VEC(this->styleList, i)
+		{
+			styles.push_back(this->styleList[i]);
+		}
+		auto fetch = [steamID64 = this->targetSteamID64, playerName = this->targetPlayerName, mapName = this->mapName, courseName = this->courseName,
+					  apiMode = this->apiMode, styles](std::function<void(const KZ::API::events::PersonalBest *)> done)
+		{
+			CUtlVector<CUtlString> styleList;
+			for (const CUtlString &style : styles)
+			{
+				styleList.AddToTail(style);
+			}
+			auto onResponse = [done](KZ::API::events::PersonalBest &pb) { done(&pb); };
+			if (!KZGlobalService::QueryPB(steamID64, std::string_view(playerName.Get(), playerName.Length()),
+										  std::string_view(mapName.Get(), mapName.Length()), std::string_view(courseName.Get(), courseName.Length()),
+										  apiMode, styleList, onResponse))
+			{
+				done(nullptr);
+			}
+		};
+
+		auto callback = [uid = this->uid](const KZ::API::events::PersonalBest *response)
 		{
 			PBRequest *req = (PBRequest *)PBRequest::Find(uid);
 			if (!req)
 			{
 				return;
 			}
+			if (!response)
+			{
+				req->globalStatus = ResponseStatus::DISABLED;
+				return;
+			}
+			const KZ::API::events::PersonalBest &pb = *response;
 
 			if (req->requestingGlobalPlayer && req->localStatus == ResponseStatus::ENABLED && pb.player.has_value())
 			{
@@ -151,9 +182,7 @@ struct PBRequest : public BaseRequest
 				req->gpbData.pointsPro = pb.pro->proPoints;
 			}
 		};
-		KZGlobalService::QueryPB(this->targetSteamID64, std::string_view(this->targetPlayerName.Get(), this->targetPlayerName.Length()),
-								 std::string_view(this->mapName.Get(), this->mapName.Length()),
-								 std::string_view(this->courseName.Get(), this->courseName.Length()), this->apiMode, this->styleList, callback);
+		globalCache.Query(this->mapName.Get(), this->GetQueryKey("pb", true), fetch, callback);
 	}
 
 	virtual void Reply()
@@ -326,101 +355,111 @@ struct PBRequest : public BaseRequest
 
 	void ExecuteStandardLocalQuery()
 	{
-		u64 uid = this->uid;
-
-		auto onQuerySuccess = [uid](std::vector<ISQLQuery *> queries)
+		auto fetch = [steamID64 = this->targetSteamID64, mapName = this->mapName, courseName = this->courseName,
+					  modeID = this->localModeID](std::function<void(const PBData *)> done)
 		{
-			PBRequest *req = (PBRequest *)PBRequest::Find(uid);
-			if (req)
+			auto onQuerySuccess = [done](std::vector<ISQLQuery *> queries)
 			{
+				PBData data;
 				ISQLResult *result = queries[0]->GetResultSet();
 				if (result && result->GetRowCount() > 0)
 				{
-					req->pbData.hasPB = true;
+					data.hasPB = true;
 					if (result->FetchRow())
 					{
-						req->pbData.runTime = result->GetFloat(0);
-						req->pbData.teleportsUsed = result->GetInt(1);
+						data.runTime = result->GetFloat(0);
+						data.teleportsUsed = result->GetInt(1);
 					}
 					if ((result = queries[1]->GetResultSet()) && result->FetchRow())
 					{
-						req->pbData.rank = result->GetInt(0);
+						data.rank = result->GetInt(0);
 					}
 					if ((result = queries[2]->GetResultSet()) && result->FetchRow())
 					{
-						req->pbData.maxRank = result->GetInt(0);
+						data.maxRank = result->GetInt(0);
 					}
 				}
 				if ((result = queries[3]->GetResultSet()) && result->GetRowCount() > 0)
 				{
-					req->pbData.hasPBPro = true;
+					data.hasPBPro = true;
 					if (result->FetchRow())
 					{
-						req->pbData.runTimePro = result->GetFloat(0);
+						data.runTimePro = result->GetFloat(0);
 					}
 					if ((result = queries[4]->GetResultSet()) && result->FetchRow())
 					{
-						req->pbData.rankPro = result->GetInt(0);
+						data.rankPro = result->GetInt(0);
 					}
 					if ((result = queries[5]->GetResultSet()) && result->FetchRow())
 					{
-						req->pbData.maxRankPro = result->GetInt(0);
+						data.maxRankPro = result->GetInt(0);
 					}
 				}
-				req->localStatus = ResponseStatus::RECEIVED;
-			}
-		};
+				done(&data);
+			};
 
-		auto onQueryFailure = [uid](std::string, int)
-		{
-			PBRequest *req = (PBRequest *)PBRequest::Find(uid);
-			if (req)
-			{
-				req->localStatus = ResponseStatus::DISABLED;
-			}
+			auto onQueryFailure = [done](std::string, int) { done(nullptr); };
+
+			KZDatabaseService::QueryPB(steamID64, mapName, courseName, modeID, onQuerySuccess, onQueryFailure);
 		};
 
-		KZDatabaseService::QueryPB(targetSteamID64, this->mapName, this->courseName, this->localModeID, onQuerySuccess, onQueryFailure);
+		localCache.Query(this->mapName.Get(), this->GetQueryKey("pb", false), fetch, OnLocalQueryResult(this->uid));
 	}
 
 	void ExecuteRanklessLocalQuery()
 	{
-		u64 uid = this->uid;
-		auto onQuerySuccess = [uid](std::vector<ISQLQuery *> queries)
+		auto fetch = [steamID64 = this->targetSteamID64, mapName = this->mapName, courseName = this->courseName, modeID = this->localModeID,
+					  styleIDs = this->localStyleIDs](std::function<void(const PBData *)> done)
 		{
-			PBRequest *req = (PBRequest *)PBRequest::Find(uid);
-			if (req)
+			auto onQuerySuccess = [done](std::vector<ISQLQuery *> queries)
 			{
+				PBData data;
 				ISQLResult *result = queries[0]->GetResultSet();
 				if (result && result->GetRowCount() > 0)
 				{
-					req->pbData.hasPB = true;
+					data.hasPB = true;
 					if (result->FetchRow())
 					{
-						req->pbData.runTime = result->GetFloat(0);
-						req->pbData.teleportsUsed = result->GetInt(1);
+						data.runTime = result->GetFloat(0);
+						data.teleportsUsed = result->GetInt(1);
 					}
 				}
 				if ((result = queries[1]->GetResultSet()) && result->GetRowCount() > 0)
 				{
-					req->pbData.hasPBPro = true;
+					data.hasPBPro = true;
 					if (result->FetchRow())
 					{
-						req->pbData.runTimePro = result->GetFloat(0);
+						data.runTimePro = result->GetFloat(0);
 					}
 				}
-			}
+				done(&data);
+			};
+
+			auto onQueryFailure = [done](std::string, int) { done(nullptr); };
+
+			KZDatabaseService::QueryPBRankless(steamID64, mapName, courseName, modeID, styleIDs, onQuerySuccess, onQueryFailure);
 		};
 
-		auto onQueryFailure = [uid](std::string, int)
+		localCache.Query(this->mapName.Get(), this->GetQueryKey("pb_rankless", false), fetch, OnLocalQueryResult(this->uid));
+	}
+
+	static QueryCache<PBData>::Callback OnLocalQueryResult(u64 uid)
+	{
+		return [uid](const PBData *data)
 		{
 			PBRequest *req = (PBRequest *)PBRequest::Find(uid);
-			if (req)
+			if (!req)
+			{
+				return;
+			}
+			if (!data)
 			{
 				req->localStatus = ResponseStatus::DISABLED;
+				return;
 			}
+			req->pbData = *data;
+			req->localStatus = ResponseStatus::RECEIVED;
 		};
-		KZDatabaseService::QueryPBRankless(targetSteamID64, mapName, courseName, localModeID, localStyleIDs, onQuerySuccess, onQueryFailure);
 	}
 };
 
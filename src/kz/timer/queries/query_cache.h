@@ -0,0 +1,149 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common.h"
+#include "utils/utils.h"
+
+extern CConVar<f32> kz_query_cache_ttl;
+
+// Results of leaderboard queries shared between requests.
+// Identical queries issued while one is in flight wait for its result instead of hitting the database or the API again,
+// and successful results are served from memory until they expire or a new time is set on their map.
+class QueryCacheBase
+{
+public:
+	// Drop every cached result for the map. Queries still in flight complete normally but their result is not kept.
+	static void InvalidateMap(const char *mapName);
+	static void InvalidateAll();
+
+protected:
+	QueryCacheBase()
+	{
+		GetCaches().push_back(this);
+	}
+
+	virtual ~QueryCacheBase() = default;
+
+	virtual void Invalidate(const char *mapName) = 0;
+
+	// Caches are static objects spread over several files, construct the list on first use.
+	static std::vector<QueryCacheBase *> &GetCaches()
+	{
+		static_persist std::vector<QueryCacheBase *> caches;
+		return caches;
+	}
+
+	// A query that never answered (e.g. the connection dropped) stops blocking new ones after this long.
+	static inline constexpr f64 PENDING_TIMEOUT = 10.0;
+};
+
+template<typename T>
+class QueryCache : public QueryCacheBase
+{
+public:
+	// Receives nullptr if the query failed.
+	using Callback = std::function<void(const T *result)>;
+
+	// fetch is called with a completion function if the query has to be sent, it must call it exactly once with the result or nullptr.
+	// The callback may run before Query returns if the result is cached.
+	template<typename Fetch>
+	void Query(const char *mapName, const std::string &key, Fetch &&fetch, Callback callback)
+	{
+		f64 now = g_pKZUtils->GetServerGlobals()->realtime;
+		auto it = this->entries.find(key);
+		if (it != this->entries.end())
+		{
+			Entry &entry = it->second;
+			if (!entry.pending && entry.expiry > now)
+			{
+				callback(&entry.value);
+				return;
+			}
+			if (entry.pending && entry.startTime + PENDING_TIMEOUT > now)
+			{
+				entry.waiters.push_back(std::move(callback));
+				return;
+			}
+		}
+
+		Entry &entry = this->entries[key];
+		entry.mapName = mapName;
+		entry.pending = true;
+		entry.stale = false;
+		entry.startTime = now;
+		entry.ticket = ++this->lastTicket;
+		// Waiters of a query that timed out stay and get the result of this one.
+		entry.waiters.push_back(std::move(callback));
+		fetch([this, key, ticket = entry.ticket](const T *result) { this->Complete(key, ticket, result); });
+	}
+
+protected:
+	virtual void Invalidate(const char *mapName) override
+	{
+		for (auto it = this->entries.begin(); it != this->entries.end();)
+		{
+			if (mapName && !KZ_STREQI(it->second.mapName.c_str(), mapName))
+			{
+				++it;
+			}
+			else if (it->second.pending)
+			{
+				it->second.stale = true;
+				++it;
+			}
+			else
+			{
+				it = this->entries.erase(it);
+			}
+		}
+	}
+
+private:
+	struct Entry
+	{
+		std::string mapName;
+		bool pending {};
+		// Invalidated while in flight, the result is handed to the waiters but not cached.
+		bool stale {};
+		f64 startTime {};
+		f64 expiry {};
+		u32 ticket {};
+		T value {};
+		std::vector<Callback> waiters;
+	};
+
+	std::unordered_map<std::string, Entry> entries;
+	u32 lastTicket {};
+
+	void Complete(const std::string &key, u32 ticket, const T *result)
+	{
+		auto it = this->entries.find(key);
+		// The entry was replaced by a newer query after this one timed out.
+		if (it == this->entries.end() || it->second.ticket != ticket)
+		{
+			return;
+		}
+
+		std::vector<Callback> waiters;
+		waiters.swap(it->second.waiters);
+		if (result && !it->second.stale && kz_query_cache_ttl.Get() > 0.0f)
+		{
+			it->second.value = *result;
+			it->second.pending = false;
+			it->second.expiry = g_pKZUtils->GetServerGlobals()->realtime + kz_query_cache_ttl.Get();
+		}
+		else
+		{
+			this->entries.erase(it);
+		}
+
+		// The result stays valid for the duration of this call, unlike the entry which new queries from the callbacks may move.
+		for (Callback &waiter : waiters)
+		{
+			waiter(result);
+		}
+	}
+};
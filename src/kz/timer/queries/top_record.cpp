@@ -25,6 +25,9 @@ struct TopRecordRequest : public BaseRequest
 		f32 runTimePro {};
 	} srData, wrData;
 
+	static inline QueryCache<RecordData> localCache;
+	static inline QueryCache<KZ::API::events::WorldRecords> globalCache;
+
 	virtual void PrintInstructions() override
 	{
 		KZPlayer *player = g_pKZPlayerManager->ToPlayer(userID);
@@ -44,7 +47,18 @@ struct TopRecordRequest : public BaseRequest
 		}
 		if (this->globalStatus == ResponseStatus::ENABLED)
 		{
-			auto callback = [uid = this->uid](KZ::API::events::WorldRecords &wrs)
+			auto fetch = [mapName = this->mapName, courseName = this->courseName,
+						  apiMode = this->apiMode](std::function<void(const KZ::API::events::WorldRecords *)> done)
+			{
+				auto onResponse = [done](KZ::API::events::WorldRecords &wrs) { done(&wrs); };
+				if (!KZGlobalService::QueryWorldRecords(std::string_view(mapName.Get(), mapName.Length()),
+														std::string_view(courseName.Get(), courseName.Length()), apiMode, onResponse))
+				{
+					done(nullptr);
+				}
+			};
+
+			auto callback = [uid = this->uid](const KZ::API::events::WorldRecords *response)
 			{
 				TopRecordRequest *req = (TopRecordRequest *)TopRecordRequest::Find(uid);
 				if (!req)
@@ -52,10 +66,10 @@ struct TopRecordRequest : public BaseRequest
 					return;
 				}
 
-				if (wrs.map.has_value() && wrs.course.has_value())
+				if (response && response->map.has_value() && response->course.has_value())
 				{
-					req->mapName = wrs.map->name.c_str();
-					req->courseName = wrs.course->name.c_str();
+					req->mapName = response->map->name.c_str();
+					req->courseName = response->course->name.c_str();
 					req->globalStatus = ResponseStatus::RECEIVED;
 				}
 				else
@@ -63,6 +77,7 @@ struct TopRecordRequest : public BaseRequest
 					req->globalStatus = ResponseStatus::DISABLED;
 					return;
 				}
+				const KZ::API::events::WorldRecords &wrs = *response;
 
 				req->wrData.hasRecord = wrs.overall.has_value();
 				if (req->wrData.hasRecord)
@@ -79,8 +94,7 @@ struct TopRecordRequest : public BaseRequest
 				}
 			};
 			this->globalStatus = ResponseStatus::PENDING;
-			KZGlobalService::QueryWorldRecords(std::string_view(this->mapName.Get(), this->mapName.Length()),
-											   std::string_view(this->courseName.Get(), this->courseName.Length()), this->apiMode, callback);
+			globalCache.Query(this->mapName.Get(), this->GetQueryKey("wr", true), fetch, callback);
 		}
 	}
 
@@ -101,48 +115,57 @@ struct TopRecordRequest : public BaseRequest
 				return;
 			}
 
-			u64 uid = this->uid;
-
-			auto onQuerySuccess = [uid](std::vector<ISQLQuery *> queries)
+			auto fetch = [mapName = this->mapName, courseName = this->courseName,
+						  modeID = this->localModeID](std::function<void(const RecordData *)> done)
 			{
-				TopRecordRequest *req = (TopRecordRequest *)TopRecordRequest::Find(uid);
-				if (!req)
-				{
-					return;
-				}
-				req->localStatus = ResponseStatus::RECEIVED;
-				ISQLResult *result = queries[0]->GetResultSet();
-				if (result && result->GetRowCount() > 0)
+				auto onQuerySuccess = [done](std::vector<ISQLQuery *> queries)
 				{
-					req->srData.hasRecord = true;
-					if (result->FetchRow())
+					RecordData data;
+					ISQLResult *result = queries[0]->GetResultSet();
+					if (result && result->GetRowCount() > 0)
 					{
-						req->srData.holder = result->GetString(2);
-						req->srData.runTime = result->GetFloat(3);
-						req->srData.teleportsUsed = result->GetInt(4);
+						data.hasRecord = true;
+						if (result->FetchRow())
+						{
+							data.holder = result->GetString(2);
+							data.runTime = result->GetFloat(3);
+							data.teleportsUsed = result->GetInt(4);
+						}
 					}
-				}
-				if ((result = queries[1]->GetResultSet()) && result->GetRowCount() > 0)
-				{
-					req->srData.hasRecordPro = true;
-					if (result->FetchRow())
+					if ((result = queries[1]->GetResultSet()) && result->GetRowCount() > 0)
 					{
-						req->srData.holderPro = result->GetString(2);
-						req->srData.runTimePro = result->GetFloat(3);
+						data.hasRecordPro = true;
+						if (result->FetchRow())
+						{
+							data.holderPro = result->GetString(2);
+							data.runTimePro = result->GetFloat(3);
+						}
 					}
-				}
+					done(&data);
+				};
+
+				auto onQueryFailure = [done](std::string, int) { done(nullptr); };
+
+				KZDatabaseService::QueryRecords(mapName, courseName, modeID, 1, 0, onQuerySuccess, onQueryFailure);
 			};
 
-			auto onQueryFailure = [uid](std::string, int)
+			auto callback = [uid = this->uid](const RecordData *data)
 			{
 				TopRecordRequest *req = (TopRecordRequest *)TopRecordRequest::Find(uid);
-				if (req)
+				if (!req)
+				{
+					return;
+				}
+				if (!data)
 				{
 					req->localStatus = ResponseStatus::DISABLED;
+					return;
 				}
+				req->localStatus = ResponseStatus::RECEIVED;
+				req->srData = *data;
 			};
 
-			KZDatabaseService::QueryRecords(this->mapName, this->courseName, this->localModeID, 1, 0, onQuerySuccess, onQueryFailure);
+			localCache.Query(this->mapName.Get(), this->GetQueryKey("wr", false), fetch, callback);
 		}
 	}
 
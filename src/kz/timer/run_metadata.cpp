@@ -0,0 +1,162 @@
+#include "run_metadata.h"
+#include "keyvalues3.h"
+
+#include <algorithm>
+#include <ixwebsocket/IXBase64.h>
+
+#include "tier0/memdbgon.h"
+
+// Layout (little endian):
+//   char magic[3] = "KZM"
+//   u8   version
+//   u8   splitCount, cpCount, stageCount
+//   u8   reserved
+//   f64  splitZoneTimes[splitCount], cpZoneTimes[cpCount], stageZoneTimes[stageCount]
+static_global constexpr char metadataMagic[3] = {'K', 'Z', 'M'};
+static_global constexpr size_t metadataHeaderSize = 8;
+static_global constexpr size_t metadataMaxZones = 255;
+
+static_function void AppendTimes(std::string &out, const std::vector<f64> &times, size_t count)
+{
+	out.append(reinterpret_cast<const char *>(times.data()), count * sizeof(f64));
+}
+
+static_function void ReadTimes(const char *data, u8 count, std::vector<f64> &times)
+{
+	times.resize(count);
+	memcpy(times.data(), data, count * sizeof(f64));
+}
+
+std::string KZRunMetadata::Serialize() const
+{
+	size_t splitCount = std::min(this->splitZoneTimes.size(), metadataMaxZones);
+	size_t cpCount = std::min(this->cpZoneTimes.size(), metadataMaxZones);
+	size_t stageCount = std::min(this->stageZoneTimes.size(), metadataMaxZones);
+
+	std::string out;
+	out.reserve(metadataHeaderSize + (splitCount + cpCount + stageCount) * sizeof(f64));
+	out.append(metadataMagic, sizeof(metadataMagic));
+	out.push_back((char)KZRunMetadata::VERSION);
+	out.push_back((char)splitCount);
+	out.push_back((char)cpCount);
+	out.push_back((char)stageCount);
+	out.push_back(0);
+	AppendTimes(out, this->splitZoneTimes, splitCount);
+	AppendTimes(out, this->cpZoneTimes, cpCount);
+	AppendTimes(out, this->stageZoneTimes, stageCount);
+	return out;
+}
+
+bool KZRunMetadata::Deserialize(std::string_view data)
+{
+	this->Clear();
+	if (data.size() < metadataHeaderSize || memcmp(data.data(), metadataMagic, sizeof(metadataMagic)) != 0)
+	{
+		return false;
+	}
+
+	u8 version = (u8)data[3];
+	if (version != KZRunMetadata::VERSION)
+	{
+		return false;
+	}
+
+	u8 splitCount = (u8)data[4];
+	u8 cpCount = (u8)data[5];
+	u8 stageCount = (u8)data[6];
+	if (data.size() != metadataHeaderSize + (splitCount + cpCount + stageCount) * sizeof(f64))
+	{
+		return false;
+	}
+
+	const char *times = data.data() + metadataHeaderSize;
+	ReadTimes(times, splitCount, this->splitZoneTimes);
+	times += splitCount * sizeof(f64);
+	ReadTimes(times, cpCount, this->cpZoneTimes);
+	times += cpCount * sizeof(f64);
+	ReadTimes(times, stageCount, this->stageZoneTimes);
+	return true;
+}
+
+std::string KZRunMetadata::Encode() const
+{
+	return macaron::Base64::Encode(this->Serialize());
+}
+
+static_function void ReadLegacyTimes(KeyValues3 &kv, const char *key, std::vector<f64> &times)
+{
+	KeyValues3 *data = kv.FindMember(key);
+	if (!data || data->GetType() != KV3_TYPE_ARRAY)
+	{
+		return;
+	}
+	times.resize(data->GetArrayElementCount());
+	for (i32 i = 0; i < data->GetArrayElementCount(); i++)
+	{
+		KeyValues3 *element = data->GetArrayElement(i);
+		times[i] = element ? element->GetDouble(-1.0) : -1.0;
+	}
+}
+
+bool KZRunMetadata::Decode(std::string_view metadata)
+{
+	this->Clear();
+	size_t start = metadata.find_first_not_of(" \t\r\n");
+	if (start == std::string_view::npos)
+	{
+		return false;
+	}
+
+	// Rows written before the binary layout existed.
+	if (metadata[start] == '{')
+	{
+		KeyValues3 kv(KV3_TYPEEX_TABLE, KV3_SUBTYPE_UNSPECIFIED);
+		CUtlString error = "";
+		std::string json(metadata);
+		LoadKV3FromJSON(&kv, &error, json.c_str(), "");
+		if (!error.IsEmpty())
+		{
+			META_CONPRINTF("[KZ::Timer] Failed to parse legacy run metadata: %s\n", error.Get());
+			return false;
+		}
+		ReadLegacyTimes(kv, "splitZoneTimes", this->splitZoneTimes);
+		ReadLegacyTimes(kv, "cpZoneTimes", this->cpZoneTimes);
+		ReadLegacyTimes(kv, "stageZoneTimes", this->stageZoneTimes);
+		return true;
+	}
+
+	std::string binary;
+	std::string error = macaron::Base64::Decode(std::string(metadata.substr(start)), binary);
+	if (!error.empty())
+	{
+		META_CONPRINTF("[KZ::Timer] Failed to decode run metadata: %s\n", error.c_str());
+		return false;
+	}
+	return this->Deserialize(binary);
+}
+
+static_function void WriteLegacyTimes(KeyValues3 &kv, const char *key, const std::vector<f64> &times)
+{
+	KeyValues3 *array = kv.FindOrCreateMember(key);
+	array->SetToEmptyArray();
+	for (f64 time : times)
+	{
+		array->ArrayAddElementToTail()->SetDouble(time);
+	}
+}
+
+std::string KZRunMetadata::ToJSON() const
+{
+	KeyValues3 kv(KV3_TYPEEX_TABLE, KV3_SUBTYPE_UNSPECIFIED);
+	WriteLegacyTimes(kv, "splitZoneTimes", this->splitZoneTimes);
+	WriteLegacyTimes(kv, "cpZoneTimes", this->cpZoneTimes);
+	WriteLegacyTimes(kv, "stageZoneTimes", this->stageZoneTimes);
+
+	CUtlString result, error;
+	if (SaveKV3AsJSON(&kv, &error, &result))
+	{
+		return result.Get();
+	}
+	META_CONPRINTF("[KZ::Timer] Failed to convert run metadata to JSON! (%s)\n", error.Get());
+	return "";
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "common.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Zone times of a finished run.
+// The database and replay headers store a compact binary layout, the global API still receives the legacy KeyValues3 JSON.
+struct KZRunMetadata
+{
+	// Bump this when changing the binary layout, and keep the reader for older versions around.
+	static constexpr u8 VERSION = 1;
+
+	std::vector<f64> splitZoneTimes;
+	std::vector<f64> cpZoneTimes;
+	std::vector<f64> stageZoneTimes;
+
+	void Clear()
+	{
+		splitZoneTimes.clear();
+		cpZoneTimes.clear();
+		stageZoneTimes.clear();
+	}
+
+	bool IsEmpty() const
+	{
+		return splitZoneTimes.empty() && cpZoneTimes.empty() && stageZoneTimes.empty();
+	}
+
+	// Binary layout, used as is in replay headers.
+	std::string Serialize() const;
+	bool Deserialize(std::string_view data);
+
+	// Base64 of the binary layout, used for the database.
+	std::string Encode() const;
+	// Accepts both the encoded binary layout and the legacy KeyValues3 JSON metadata of older rows.
+	bool Decode(std::string_view metadata);
+
+	// Legacy KeyValues3 JSON layout.
+	std::string ToJSON() const;
+
+	// Returns -1 for zones without a time.
+	static f64 GetTime(const std::vector<f64> &times, u32 index)
+	{
+		return index < times.size() ? times[index] : -1.0;
+	}
+};
@@ -5,6 +5,7 @@
 #include "sdk/services.h"
 #include "sdk/entity/ccsplayercontroller.h"
 #include "utils/utils.h"
+#include "utlvector.h"
 
 class ns_address;
 class C2S_CONNECT_Message;
@@ -221,8 +222,13 @@ public:
 private:
 	bool callbackRegistered {};
 
+	void AddActivePlayer(Player *player);
+	void RemoveActivePlayer(Player *player);
+
 public:
 	Player *players[MAXPLAYERS + 1];
+	// Players between OnClientActive and OnClientDisconnect, so per-frame loops don't have to walk every slot.
+	CUtlVector<Player *> activePlayers;
 };
 
 extern PlayerManager *g_pPlayerManager;
@@ -117,6 +117,7 @@ void PlayerManager::OnClientPutInServer(CPlayerSlot slot, char const *pszName, i
 
 void PlayerManager::OnClientActive(CPlayerSlot slot, bool bLoadGame, const char *pszName, uint64 xuid)
 {
+	this->AddActivePlayer(this->ToPlayer(slot));
 	this->ToPlayer(slot)->SetUnauthenticatedSteamID(xuid);
 	this->ToPlayer(slot)->OnPlayerActive();
 }
@@ -124,9 +125,24 @@ void PlayerManager::OnClientActive(CPlayerSlot slot, bool bLoadGame, const char
 void PlayerManager::OnClientDisconnect(CPlayerSlot slot, ENetworkDisconnectionReason reason, const char *pszName, uint64 xuid,
 									   const char *pszNetworkID)
 {
+	this->RemoveActivePlayer(this->ToPlayer(slot));
 	this->ToPlayer(slot)->Reset();
 }
 
+void PlayerManager::AddActivePlayer(Player *player)
+{
+	// ClientActive fires again for players that stay connected through a map change.
+	if (this->activePlayers.Find(player) == this->activePlayers.InvalidIndex())
+	{
+		this->activePlayers.AddToTail(player);
+	}
+}
+
+void PlayerManager::RemoveActivePlayer(Player *player)
+{
+	this->activePlayers.FindAndFastRemove(player);
+}
+
 void PlayerManager::OnClientVoice(CPlayerSlot slot) {}
 
 void PlayerManager::OnClientSettingsChanged(CPlayerSlot slot) {}
@@ -152,6 +168,10 @@ void PlayerManager::OnLateLoad()
 	}
 	for (auto player : players)
 	{
+		if (player->IsInGame())
+		{
+			this->AddActivePlayer(player);
+		}
 		if (player->IsAuthenticated())
 		{
 			player->OnAuthorized();
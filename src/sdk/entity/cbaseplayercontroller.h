@@ -36,12 +36,7 @@ public:
 		{
 			V_strncpy(this->m_iszPlayerName(), name, 128);
 		}
-		static constexpr auto datatable_hash = hash_32_fnv1a_const("CBasePlayerController");
-		static constexpr auto prop_hash = hash_32_fnv1a_const("m_iszPlayerName");
-		static const auto m_key = schema::GetOffset(m_className, datatable_hash, "m_iszPlayerName", prop_hash);
-		static const auto m_chain = schema::FindChainOffset(m_className, m_classNameHash);
-
-		this->NetworkStateChanged({m_key.offset});
+		this->NetworkStateChanged({m_iszPlayerName.GetKey().offset});
 	}
 
 	CBasePlayerPawn *GetCurrentPawn()
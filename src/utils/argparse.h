@@ -1,46 +1,166 @@
 #pragma once
 #include "common.h"
-#include "keyvalues3.h"
-#include <string>
-#include <regex>
+
+#define ARGPARSE_MAX_LENGTH 512
+#define ARGPARSE_MAX_PARAMS 32
 
 namespace utils
 {
-	// Return false if a non whitelisted key is found.
-	inline bool ParseArgsToKV3(std::string input, KeyValues3 &kv, const char **wlKeys = NULL, u32 wlKeysLength = 0)
+	struct ArgParam
 	{
-		bool allValid = true;
-		// Regex for "key=value"
-		const static std::regex pattern(R"((\w+)=(.*?)(?=\s+\w+=|$))");
-		auto words_begin = std::sregex_iterator(input.begin(), input.end(), pattern);
-		auto words_end = std::sregex_iterator();
+		const char *key;
+		const char *value;
 
-		for (std::sregex_iterator i = words_begin; i != words_end; i++)
+		const char *GetString() const
 		{
-			std::smatch match = *i;
-			std::string key = match[1];
-			// Check if the key is in the whitelist.
-			bool hasValidKey = wlKeysLength == 0;
-			for (u32 i = 0; i < wlKeysLength; i++)
+			return value;
+		}
+
+		i32 GetInt() const
+		{
+			return (i32)strtol(value, nullptr, 10);
+		}
+
+		u64 GetUInt64() const
+		{
+			return strtoull(value, nullptr, 10);
+		}
+
+		f32 GetFloat() const
+		{
+			return strtof(value, nullptr);
+		}
+	};
+
+	// Parses "key=value" pairs out of command arguments, e.g. "map=kz_grotto course=Main Course mode=vnl".
+	// Values run until the next whitespace separated "key=", so they may contain spaces. Anything before the first key is ignored.
+	// Keys and values point into a copy of the input held by this object, nothing is allocated.
+	class ArgParams
+	{
+	public:
+		// Whitelisted keys only affect IsValid(), parameters with other keys are still parsed.
+		ArgParams(const char *input, const char **wlKeys = nullptr, u32 wlKeysLength = 0)
+		{
+			V_strncpy(buffer, input ? input : "", sizeof(buffer));
+
+			char *p = buffer;
+			char *key = FindKey(p, true);
+			while (key)
 			{
-				if (!V_stricmp(wlKeys[i], key.c_str()))
+				char *separator = key;
+				while (IsKeyChar(*separator))
+				{
+					separator++;
+				}
+				*separator = '\0';
+
+				// The value ends at the whitespace in front of the next key.
+				char *value = separator + 1;
+				char *next = nullptr;
+				for (p = value; *p; p++)
+				{
+					if (IsSpace(*p) && (next = FindKey(p, false)))
+					{
+						break;
+					}
+				}
+				*p = '\0';
+
+				if (!IsWhitelisted(key, wlKeys, wlKeysLength))
+				{
+					allValid = false;
+				}
+				if (*value && count < ARGPARSE_MAX_PARAMS)
 				{
-					hasValidKey = true;
-					break;
+					params[count++] = {key, value};
 				}
+				key = next;
 			}
-			if (!hasValidKey)
+		}
+
+		// Return false if a non whitelisted key was found.
+		bool IsValid() const
+		{
+			return allValid;
+		}
+
+		// Keys are case insensitive, the last value given for a key wins.
+		const ArgParam *Find(const char *key, const char *alias = nullptr) const
+		{
+			for (i32 i = (i32)count - 1; i >= 0; i--)
 			{
-				allValid = false;
+				if (!V_stricmp(params[i].key, key) || (alias && !V_stricmp(params[i].key, alias)))
+				{
+					return &params[i];
+				}
 			}
+			return nullptr;
+		}
+
+	private:
+		static bool IsKeyChar(char c)
+		{
+			return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+		}
+
+		static bool IsSpace(char c)
+		{
+			return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+		}
 
-			std::string value = match[2];
-			if (value.empty())
+		// Find the next run of key characters directly followed by '='.
+		// After a value, only a key right behind the whitespace it starts at counts.
+		static char *FindKey(char *p, bool anywhere)
+		{
+			while (*p)
 			{
-				continue;
+				if (!anywhere)
+				{
+					while (IsSpace(*p))
+					{
+						p++;
+					}
+				}
+				char *start = p;
+				while (IsKeyChar(*p))
+				{
+					p++;
+				}
+				if (p != start && *p == '=')
+				{
+					return start;
+				}
+				if (!anywhere)
+				{
+					return nullptr;
+				}
+				if (p == start)
+				{
+					p++;
+				}
 			}
-			kv.FindOrCreateMember(key.c_str())->SetString(value.c_str());
+			return nullptr;
 		}
-		return allValid;
-	}
+
+		static bool IsWhitelisted(const char *key, const char **wlKeys, u32 wlKeysLength)
+		{
+			if (wlKeysLength == 0)
+			{
+				return true;
+			}
+			for (u32 i = 0; i < wlKeysLength; i++)
+			{
+				if (!V_stricmp(wlKeys[i], key))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		char buffer[ARGPARSE_MAX_LENGTH];
+		ArgParam params[ARGPARSE_MAX_PARAMS];
+		u32 count {};
+		bool allValid = true;
+	};
 } // namespace utils
@@ -5,6 +5,9 @@
 #include "filesystem.h"
 #include "vprof.h"
 
+// The ring is stored in power of two sized chunks that are only allocated once the ring first reaches them,
+// so a buffer that never fills only costs what it holds. Chunks of trivial types are left uninitialized.
+// Positions never go past SIZE, wrapping around is a comparison instead of a modulo.
 template<typename T, size_t SIZE>
 struct CFIFOCircularBuffer
 {
@@ -14,110 +17,72 @@ struct CFIFOCircularBuffer
 	static_assert(std::is_trivially_destructible_v<T>, "CFIFOCircularBuffer requires trivially destructible types.");
 
 private:
-	std::unique_ptr<T[]> buffer;
-	size_t capacity;
+	static constexpr size_t CHUNK_SHIFT = 8;
+	static constexpr size_t CHUNK_SIZE = 1 << CHUNK_SHIFT;
+	static constexpr size_t CHUNK_MASK = CHUNK_SIZE - 1;
+	static constexpr size_t NUM_CHUNKS = (SIZE + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+	std::unique_ptr<T[]> chunks[NUM_CHUNKS];
 	size_t readPos;
 	size_t writePos;
 	size_t count; // Number of elements currently in buffer
 
-	// Helper to detect if T is a vector
-	template<typename U>
-	struct is_vector : std::false_type
+	// Only valid for positions that were written to.
+	T &At(size_t pos)
 	{
-	};
+		return chunks[pos >> CHUNK_SHIFT][pos & CHUNK_MASK];
+	}
 
-	template<typename U>
-	struct is_vector<std::vector<U>> : std::true_type
+	const T &At(size_t pos) const
 	{
-	};
-
-public:
-	CFIFOCircularBuffer() : capacity(SIZE), readPos(0), writePos(0), count(0)
-	{
-		buffer = std::make_unique<T[]>(capacity);
+		return chunks[pos >> CHUNK_SHIFT][pos & CHUNK_MASK];
 	}
 
-	~CFIFOCircularBuffer()
+	// Wrap a position that is less than two laps ahead.
+	static size_t Wrap(size_t pos)
 	{
-		// Destructor for elements with non-trivial destructors
-		if constexpr (!std::is_trivially_destructible_v<T>)
-		{
-			Clear();
-		}
+		return pos >= SIZE ? pos - SIZE : pos;
 	}
 
-	// Resize the buffer to hold newSize elements of type T
-	void Resize(size_t newSize)
+	// Commit the slot at the write position and move past it.
+	T &NextWriteSlot()
 	{
-		if (newSize == capacity)
+		std::unique_ptr<T[]> &chunk = chunks[writePos >> CHUNK_SHIFT];
+		if (!chunk)
 		{
-			return; // No change needed
+			chunk.reset(new T[CHUNK_SIZE]);
 		}
+		T &ref = chunk[writePos & CHUNK_MASK];
+		writePos = Wrap(writePos + 1);
 
-		auto newBuffer = std::make_unique<T[]>(newSize);
-		size_t elementsToMove = MIN(count, newSize);
-
-		// Copy existing elements to new buffer
-		for (size_t i = 0; i < elementsToMove; ++i)
+		if (count < SIZE)
 		{
-			size_t srcIndex = (readPos + i) % capacity;
-			if constexpr (std::is_move_constructible_v<T>)
-			{
-				new (&newBuffer[i]) T(std::move(buffer[srcIndex]));
-			}
-			else
-			{
-				new (&newBuffer[i]) T(buffer[srcIndex]);
-			}
+			++count;
 		}
-
-		// Clean up old buffer if necessary
-		if constexpr (!std::is_trivially_destructible_v<T>)
+		else
 		{
-			for (size_t i = 0; i < count; ++i)
-			{
-				size_t index = (readPos + i) % capacity;
-				buffer[index].~T();
-			}
+			// Buffer is full, advance read position (overwrite oldest)
+			readPos = Wrap(readPos + 1);
 		}
-
-		buffer = std::move(newBuffer);
-		capacity = newSize;
-		readPos = 0;
-		writePos = elementsToMove % capacity;
-		count = elementsToMove;
+		return ref;
 	}
 
+public:
+	CFIFOCircularBuffer() : readPos(0), writePos(0), count(0) {}
+
 	// Write a single element of type T to the buffer
 	void Write(const T &data)
 	{
-		buffer[writePos] = data;
-		writePos = (writePos + 1) % capacity;
-
-		if (count < capacity)
-		{
-			++count;
-		}
-		else
-		{
-			// Buffer is full, advance read position (overwrite oldest)
-			readPos = (readPos + 1) % capacity;
-		}
+		NextWriteSlot() = data;
 	}
 
 	// Get a reference to the next write position, automatically advance, and ensure it's clean
-	// The returned reference is ready for writing (vectors are cleared, objects are reset)
+	// The returned reference is ready for writing (objects are reset)
 	T &GetNextWriteRef()
 	{
-		T &ref = buffer[writePos];
+		T &ref = NextWriteSlot();
 
-		// Clean the slot before returning reference
-		if constexpr (is_vector<T>::value)
-		{
-			// For vectors, clear them
-			ref.clear();
-		}
-		else if constexpr (std::is_trivially_copyable_v<T>)
+		if constexpr (std::is_trivially_copyable_v<T>)
 		{
 			// For POD types, zero them out
 			std::memset(&ref, 0, sizeof(T));
@@ -127,19 +92,6 @@ public:
 			// For other types, use assignment to reset
 			ref = T {};
 		}
-
-		writePos = (writePos + 1) % capacity;
-
-		if (count < capacity)
-		{
-			++count;
-		}
-		else
-		{
-			// Buffer is full, advance read position (overwrite oldest)
-			readPos = (readPos + 1) % capacity;
-		}
-
 		return ref;
 	}
 
@@ -157,8 +109,7 @@ public:
 
 		for (size_t i = 0; i < elementsToPeek; ++i)
 		{
-			size_t index = (readPos + offset + i) % capacity;
-			out[i] = buffer[index];
+			out[i] = At(Wrap(readPos + offset + i));
 		}
 
 		return static_cast<int>(elementsToPeek);
@@ -172,8 +123,7 @@ public:
 			return nullptr;
 		}
 
-		size_t index = (readPos + offset) % capacity;
-		return &buffer[index];
+		return &At(Wrap(readPos + offset));
 	}
 
 	T *PeekSingle(int offset = 0)
@@ -183,8 +133,7 @@ public:
 			return nullptr;
 		}
 
-		size_t index = (readPos + offset) % capacity;
-		return &buffer[index];
+		return &At(Wrap(readPos + offset));
 	}
 
 	// Read and consume a single element of type T from the buffer
@@ -196,8 +145,8 @@ public:
 			return false;
 		}
 
-		*out = buffer[readPos];
-		readPos = (readPos + 1) % capacity;
+		*out = At(readPos);
+		readPos = Wrap(readPos + 1);
 		--count;
 
 		return true;
@@ -208,7 +157,7 @@ public:
 	size_t Advance(size_t count)
 	{
 		size_t elementsToAdvance = MIN(count, this->count);
-		readPos = (readPos + elementsToAdvance) % capacity;
+		readPos = Wrap(readPos + elementsToAdvance);
 		this->count -= elementsToAdvance;
 		return elementsToAdvance;
 	}
@@ -222,7 +171,7 @@ public:
 	// Gets the number of elements of type T that can be written without overwriting unread data
 	size_t GetWriteAvailable() const
 	{
-		return capacity - count;
+		return SIZE - count;
 	}
 
 	// Write the n latest elements from the buffer to a file
@@ -237,40 +186,28 @@ public:
 		size_t elementsToWrite = MIN(n, count);
 		size_t elementsWritten = 0;
 
-		// Calculate starting position for the n latest elements
 		// Latest elements are those closest to writePos
-		size_t startOffset = count - elementsToWrite;
+		size_t pos = Wrap(readPos + count - elementsToWrite);
 
-		for (size_t i = 0; i < elementsToWrite; ++i)
+		// Write contiguous runs, which end at the end of a chunk or of the ring.
+		while (elementsWritten < elementsToWrite)
 		{
-			size_t index = (readPos + startOffset + i) % capacity;
-
-			// Use the external Write function
-			if (fs->Write(&buffer[index], sizeof(T), file))
-			{
-				++elementsWritten;
-			}
-			else
+			size_t run = MIN(elementsToWrite - elementsWritten, MIN(CHUNK_SIZE - (pos & CHUNK_MASK), SIZE - pos));
+			size_t bytes = fs->Write(&At(pos), run * sizeof(T), file);
+			elementsWritten += bytes / sizeof(T);
+			if (bytes != run * sizeof(T))
 			{
 				break; // Stop on write error
 			}
+			pos = Wrap(pos + run);
 		}
 
 		return elementsWritten;
 	}
 
-private:
-	// Helper method to clear all elements
+	// Forget every element. Committed memory is kept for reuse.
 	void Clear()
 	{
-		if constexpr (!std::is_trivially_destructible_v<T>)
-		{
-			for (size_t i = 0; i < count; ++i)
-			{
-				size_t index = (readPos + i) % capacity;
-				buffer[index].~T();
-			}
-		}
 		count = 0;
 		readPos = 0;
 		writePos = 0;
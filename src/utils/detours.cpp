@@ -8,6 +8,7 @@
 #include "fmtstr.h"
 #include "tier0/memdbgon.h"
 #include "sdk/physicsgamesystem.h"
+#include "kz/jumpstats/collision.h"
 
 CUtlVector<CDetourBase *> g_vecDetours;
 extern CGameConfig *g_pGameConfig;
@@ -143,4 +144,5 @@ void Detour_CPhysicsGameSystemFrameBoundary(void *pThis)
 {
 	CPhysicsGameSystemFrameBoundary(pThis);
 	KZ::misc::OnPhysicsGameSystemFrameBoundary(pThis);
+	KZ::collision::OnPhysicsGameSystemFrameBoundary((CPhysicsGameSystem *)pThis);
 }
@@ -0,0 +1,516 @@
+#include "executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "tier0/memdbgon.h"
+
+CConVar<f32> kz_executor_frame_budget("kz_executor_frame_budget", FCVAR_NONE,
+									  "Milliseconds per server frame spent running callbacks from background work. At least one runs every frame.", 1.0f,
+									  true, 0.05f, true, 50.0f);
+
+using namespace executor;
+using Clock = std::chrono::steady_clock;
+
+static_global constexpr u32 MAX_WORKERS = 4;
+
+struct QueueInfo
+{
+	const char *name;
+	Priority priority;
+	u32 concurrency;
+};
+
+static_global constexpr QueueInfo queueInfo[] = {
+#define EXECUTOR_QUEUE_INFO(queue, name, priority, concurrency) {name, Priority::priority, concurrency},
+	EXECUTOR_QUEUES(EXECUTOR_QUEUE_INFO)
+#undef EXECUTOR_QUEUE_INFO
+};
+
+struct QueueState
+{
+	std::mutex mutex;
+	std::condition_variable idle;
+	// Tasks waiting for a free slot, only used by queues with a concurrency limit.
+	std::deque<Task> pending;
+	u32 running {};
+
+	std::atomic<u64> submitted {};
+	std::atomic<u64> completed {};
+	std::atomic<u64> totalNanoseconds {};
+	std::atomic<u64> maxNanoseconds {};
+	std::atomic<u64> maxWaitNanoseconds {};
+};
+
+struct Job
+{
+	Queue queue;
+	Task task;
+	Clock::time_point submitTime;
+};
+
+// Every worker owns one deque per priority. Owners take from the front, idle workers steal from the back of the others.
+struct Worker
+{
+	std::mutex mutex;
+	std::deque<Job> jobs[(u32)Priority::Count];
+	std::thread thread;
+};
+
+struct TimerEvent
+{
+	Clock::time_point due;
+	TimerID id;
+
+	bool operator>(const TimerEvent &other) const
+	{
+		return this->due > other.due;
+	}
+};
+
+struct TimerData
+{
+	Queue queue;
+	Clock::duration interval;
+	std::shared_ptr<Task> task;
+	// A repeating timer is skipped while its previous run is still queued or running.
+	std::shared_ptr<std::atomic<bool>> inFlight;
+};
+
+struct MainThreadNode
+{
+	Task task;
+	MainThreadNode *next;
+};
+
+static_global QueueState queueStates[(u32)Queue::Count];
+static_global std::unique_ptr<Worker[]> workers;
+static_global u32 workerCount;
+static_global std::atomic<u32> nextWorker;
+static_global thread_local i32 currentWorker = -1;
+
+static_global std::mutex sleepMutex;
+static_global std::condition_variable sleepCV;
+static_global std::atomic<u32> queuedJobs;
+static_global std::atomic<bool> running;
+// Set once the workers are gone, nothing may run on behalf of the unloading plugin after that.
+static_global std::atomic<bool> shutDown;
+// Held shared from the running check until a task reached a worker, Shutdown holds it exclusively while it stops them.
+static_global std::shared_mutex submitMutex;
+
+static_global std::mutex timerMutex;
+static_global std::condition_variable timerCV;
+static_global std::priority_queue<TimerEvent, std::vector<TimerEvent>, std::greater<TimerEvent>> timerEvents;
+static_global std::unordered_map<TimerID, TimerData> timers;
+static_global TimerID lastTimerID;
+static_global std::thread timerThread;
+
+// Producers push onto a lock free stack, the main thread takes the whole stack at once and appends it in submission order to its own list.
+static_global std::atomic<MainThreadNode *> mainThreadHead;
+static_global MainThreadNode *mainThreadFirst;
+static_global MainThreadNode *mainThreadLast;
+static_global std::atomic<u64> mainThreadSubmitted;
+static_global u64 mainThreadCompleted;
+static_global u64 mainThreadDeferredFrames;
+static_global u64 mainThreadMaxNanoseconds;
+
+static_function u64 ElapsedNanoseconds(Clock::time_point start, Clock::time_point end)
+{
+	return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+static_function void AtomicMax(std::atomic<u64> &target, u64 value)
+{
+	u64 current = target.load(std::memory_order_relaxed);
+	while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+	{
+	}
+}
+
+static_function void Dispatch(Job job)
+{
+	u32 index = currentWorker >= 0 ? (u32)currentWorker : nextWorker.fetch_add(1, std::memory_order_relaxed) % workerCount;
+	Worker &worker = workers[index];
+	u32 priority = (u32)queueInfo[(u32)job.queue].priority;
+	{
+		std::lock_guard lock(worker.mutex);
+		worker.jobs[priority].push_back(std::move(job));
+	}
+	queuedJobs.fetch_add(1);
+	{
+		std::lock_guard lock(sleepMutex);
+	}
+	sleepCV.notify_one();
+}
+
+static_function bool TakeJob(u32 self, Job &job)
+{
+	for (u32 priority = 0; priority < (u32)Priority::Count; priority++)
+	{
+		{
+			Worker &worker = workers[self];
+			std::lock_guard lock(worker.mutex);
+			if (!worker.jobs[priority].empty())
+			{
+				job = std::move(worker.jobs[priority].front());
+				worker.jobs[priority].pop_front();
+				queuedJobs.fetch_sub(1);
+				return true;
+			}
+		}
+		for (u32 offset = 1; offset < workerCount; offset++)
+		{
+			Worker &victim = workers[(self + offset) % workerCount];
+			std::lock_guard lock(victim.mutex);
+			if (!victim.jobs[priority].empty())
+			{
+				job = std::move(victim.jobs[priority].back());
+				victim.jobs[priority].pop_back();
+				queuedJobs.fetch_sub(1);
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+static_function void RunJob(Job &job)
+{
+	QueueState &state = queueStates[(u32)job.queue];
+	Clock::time_point start = Clock::now();
+	job.task();
+	Clock::time_point end = Clock::now();
+
+	u64 elapsed = ElapsedNanoseconds(start, end);
+	state.totalNanoseconds.fetch_add(elapsed, std::memory_order_relaxed);
+	AtomicMax(state.maxNanoseconds, elapsed);
+	AtomicMax(state.maxWaitNanoseconds, ElapsedNanoseconds(job.submitTime, start));
+	state.completed.fetch_add(1, std::memory_order_relaxed);
+
+	Job next;
+	bool hasNext = false;
+	{
+		std::lock_guard lock(state.mutex);
+		if (!state.pending.empty())
+		{
+			// Hand the slot straight to the next waiting task so the queue keeps its order.
+			next = {job.queue, std::move(state.pending.front()), Clock::now()};
+			state.pending.pop_front();
+			hasNext = true;
+		}
+		else
+		{
+			state.running--;
+			if (state.running == 0)
+			{
+				state.idle.notify_all();
+			}
+		}
+	}
+	if (hasNext)
+	{
+		Dispatch(std::move(next));
+	}
+}
+
+static_function void WorkerRun(u32 index)
+{
+	currentWorker = (i32)index;
+	while (true)
+	{
+		Job job;
+		if (TakeJob(index, job))
+		{
+			RunJob(job);
+			continue;
+		}
+
+		std::unique_lock lock(sleepMutex);
+		sleepCV.wait(lock, [] { return queuedJobs.load() > 0 || !running.load(); });
+		if (!running.load() && queuedJobs.load() == 0)
+		{
+			break;
+		}
+	}
+}
+
+static_function void TimerRun()
+{
+	std::unique_lock lock(timerMutex);
+	while (running.load())
+	{
+		if (timerEvents.empty())
+		{
+			timerCV.wait(lock);
+			continue;
+		}
+		TimerEvent event = timerEvents.top();
+		if (Clock::now() < event.due)
+		{
+			timerCV.wait_until(lock, event.due);
+			continue;
+		}
+		timerEvents.pop();
+
+		auto it = timers.find(event.id);
+		if (it == timers.end())
+		{
+			continue; // Removed
+		}
+		TimerData &data = it->second;
+		Queue queue = data.queue;
+		std::shared_ptr<Task> task = data.task;
+		std::shared_ptr<std::atomic<bool>> inFlight = data.inFlight;
+		if (data.interval > Clock::duration::zero())
+		{
+			// Skip missed runs instead of bursting to catch up.
+			Clock::time_point due = event.due + data.interval;
+			timerEvents.push({std::max(due, Clock::now()), event.id});
+		}
+		else
+		{
+			timers.erase(it);
+		}
+
+		if (inFlight->exchange(true))
+		{
+			continue;
+		}
+		lock.unlock();
+		Submit(queue,
+			   [task, inFlight]()
+			   {
+				   (*task)();
+				   inFlight->store(false);
+			   });
+		lock.lock();
+	}
+}
+
+void executor::Init()
+{
+	if (running.load())
+	{
+		return;
+	}
+	u32 hardwareThreads = std::thread::hardware_concurrency();
+	// Leave most of the machine to the game, the pool only does I/O and the occasional rebuild.
+	workerCount = std::clamp<u32>(hardwareThreads / 2, 2, MAX_WORKERS);
+	workers = std::make_unique<Worker[]>(workerCount);
+	shutDown.store(false);
+	running.store(true);
+	for (u32 i = 0; i < workerCount; i++)
+	{
+		workers[i].thread = std::thread(WorkerRun, i);
+	}
+	timerThread = std::thread(TimerRun);
+}
+
+void executor::Shutdown()
+{
+	if (!running.load())
+	{
+		return;
+	}
+	{
+		std::lock_guard lock(timerMutex);
+		timers.clear();
+		timerEvents = {};
+	}
+	for (u32 i = 0; i < (u32)Queue::Count; i++)
+	{
+		WaitIdle((Queue)i);
+	}
+
+	{
+		std::unique_lock submitLock(submitMutex);
+		std::lock_guard lock(timerMutex);
+		std::lock_guard sleepLock(sleepMutex);
+		shutDown.store(true);
+		running.store(false);
+	}
+	timerCV.notify_all();
+	sleepCV.notify_all();
+	timerThread.join();
+	for (u32 i = 0; i < workerCount; i++)
+	{
+		workers[i].thread.join();
+	}
+	workers.reset();
+	workerCount = 0;
+
+	// Whatever the background work still wanted to do on the main thread belongs to the plugin being unloaded.
+	MainThreadNode *node = mainThreadHead.exchange(nullptr, std::memory_order_acquire);
+	while (node)
+	{
+		MainThreadNode *next = node->next;
+		delete node;
+		node = next;
+	}
+	node = mainThreadFirst;
+	while (node)
+	{
+		MainThreadNode *next = node->next;
+		delete node;
+		node = next;
+	}
+	mainThreadFirst = mainThreadLast = nullptr;
+}
+
+void executor::Submit(Queue queue, Task task)
+{
+	{
+		std::shared_lock submitLock(submitMutex);
+		if (running.load())
+		{
+			QueueState &state = queueStates[(u32)queue];
+			state.submitted.fetch_add(1, std::memory_order_relaxed);
+			{
+				std::lock_guard lock(state.mutex);
+				u32 concurrency = queueInfo[(u32)queue].concurrency;
+				if (concurrency && state.running >= concurrency)
+				{
+					state.pending.push_back(std::move(task));
+					return;
+				}
+				state.running++;
+			}
+			Dispatch({queue, std::move(task), Clock::now()});
+			return;
+		}
+	}
+	if (shutDown.load())
+	{
+		META_CONPRINTF("[KZ::Executor] Dropped a task submitted to the %s queue after shutdown.\n", queueInfo[(u32)queue].name);
+		return;
+	}
+	// Not initialized yet, there is nobody to hand the task to.
+	task();
+}
+
+TimerID executor::AddTimer(Queue queue, f64 delay, f64 interval, Task task)
+{
+	auto toDuration = [](f64 seconds) { return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<f64>(seconds)); };
+
+	TimerID id;
+	{
+		std::lock_guard lock(timerMutex);
+		id = ++lastTimerID;
+		TimerData data;
+		data.queue = queue;
+		data.interval = interval > 0.0 ? toDuration(interval) : Clock::duration::zero();
+		data.task = std::make_shared<Task>(std::move(task));
+		data.inFlight = std::make_shared<std::atomic<bool>>(false);
+		timers.emplace(id, std::move(data));
+		timerEvents.push({Clock::now() + toDuration(MAX(delay, 0.0)), id});
+	}
+	timerCV.notify_one();
+	return id;
+}
+
+void executor::RemoveTimer(TimerID id)
+{
+	std::lock_guard lock(timerMutex);
+	timers.erase(id);
+}
+
+void executor::WaitIdle(Queue queue)
+{
+	QueueState &state = queueStates[(u32)queue];
+	std::unique_lock lock(state.mutex);
+	state.idle.wait(lock, [&state] { return state.running == 0 && state.pending.empty(); });
+}
+
+void executor::RunOnMainThread(Task task)
+{
+	MainThreadNode *node = new MainThreadNode {std::move(task), mainThreadHead.load(std::memory_order_relaxed)};
+	while (!mainThreadHead.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+	{
+	}
+	mainThreadSubmitted.fetch_add(1, std::memory_order_relaxed);
+}
+
+void executor::OnServerGamePostSimulate()
+{
+	MainThreadNode *stack = mainThreadHead.exchange(nullptr, std::memory_order_acquire);
+	if (stack)
+	{
+		// The stack holds the newest node first, reverse it to run callbacks in the order they were submitted.
+		MainThreadNode *first = nullptr;
+		MainThreadNode *last = stack;
+		while (stack)
+		{
+			MainThreadNode *next = stack->next;
+			stack->next = first;
+			first = stack;
+			stack = next;
+		}
+		if (mainThreadLast)
+		{
+			mainThreadLast->next = first;
+		}
+		else
+		{
+			mainThreadFirst = first;
+		}
+		mainThreadLast = last;
+	}
+
+	if (!mainThreadFirst)
+	{
+		return;
+	}
+
+	Clock::time_point start = Clock::now();
+	std::chrono::duration<f64, std::milli> budget(kz_executor_frame_budget.Get());
+	Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(budget);
+	do
+	{
+		MainThreadNode *node = mainThreadFirst;
+		mainThreadFirst = node->next;
+		if (!mainThreadFirst)
+		{
+			mainThreadLast = nullptr;
+		}
+		node->task();
+		delete node;
+		mainThreadCompleted++;
+	} while (mainThreadFirst && Clock::now() < deadline);
+
+	mainThreadMaxNanoseconds = MAX(mainThreadMaxNanoseconds, ElapsedNanoseconds(start, Clock::now()));
+	if (mainThreadFirst)
+	{
+		mainThreadDeferredFrames++;
+	}
+}
+
+CON_COMMAND_F(kz_executor_stats, "Print task counts and timings of the background worker pool.", FCVAR_NONE)
+{
+	META_CONPRINTF("[KZ::Executor] %u workers, %u jobs waiting for a worker.\n", workerCount, queuedJobs.load());
+	META_CONPRINTF("%-14s %10s %10s %8s %10s %10s %10s\n", "queue", "submitted", "completed", "pending", "avg ms", "max ms", "max wait");
+	for (u32 i = 0; i < (u32)Queue::Count; i++)
+	{
+		QueueState &state = queueStates[i];
+		u64 completed = state.completed.load();
+		u32 pending;
+		{
+			std::lock_guard lock(state.mutex);
+			pending = (u32)state.pending.size();
+		}
+		f64 average = completed ? state.totalNanoseconds.load() / (f64)completed / 1e6 : 0.0;
+		META_CONPRINTF("%-14s %10llu %10llu %8u %10.3f %10.3f %10.3f\n", queueInfo[i].name, state.submitted.load(), completed, pending, average,
+					   state.maxNanoseconds.load() / 1e6, state.maxWaitNanoseconds.load() / 1e6);
+	}
+	META_CONPRINTF("%-14s %10llu %10llu %8s %10s %10.3f (deferred on %llu frames)\n", "main_thread", mainThreadSubmitted.load(), mainThreadCompleted,
+				   "-", "-", mainThreadMaxNanoseconds / 1e6, mainThreadDeferredFrames);
+}
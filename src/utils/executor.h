@@ -0,0 +1,61 @@
+#pragma once
+#include "common.h"
+#include <functional>
+
+// Shared worker pool for everything the plugin does off the game thread.
+// Tasks are submitted to named queues, a queue with a concurrency of 1 runs its tasks in order.
+// Results are handed back through a single main thread queue which is drained at the end of every server frame within a time budget.
+namespace executor
+{
+	using Task = std::function<void()>;
+	using TimerID = u64;
+
+	enum class Priority : u8
+	{
+		High,
+		Normal,
+		Low,
+		Count
+	};
+
+	// clang-format off
+	// Queue, name, priority, maximum number of tasks running at once (0 for no limit).
+#define EXECUTOR_QUEUES(X) \
+	X(Global,       "global",        High,   0) \
+	X(Racing,       "racing",        High,   0) \
+	X(ReplayUpload, "replay_upload", Normal, 1) \
+	X(ReplayWrite,  "replay_write",  Normal, 1) \
+	X(ReplayLoad,   "replay_load",   Normal, 1) \
+	X(ReplayWatch,  "replay_watch",  Low,    1) \
+	X(Collision,    "collision",     Low,    1)
+	// clang-format on
+
+	enum class Queue : u8
+	{
+#define EXECUTOR_QUEUE_ENUM(queue, name, priority, concurrency) queue,
+		EXECUTOR_QUEUES(EXECUTOR_QUEUE_ENUM)
+#undef EXECUTOR_QUEUE_ENUM
+			Count
+	};
+
+	void Init();
+	// Cancels all timers, waits for queued tasks to finish and drops any pending main thread callbacks.
+	void Shutdown();
+
+	// Runs the task right away before Init, and drops it after Shutdown.
+	void Submit(Queue queue, Task task);
+
+	// Submit the task to the queue after delay seconds, then every interval seconds if interval is positive.
+	TimerID AddTimer(Queue queue, f64 delay, f64 interval, Task task);
+	// Safe to call from the task of the timer itself. A task that is already running is not interrupted.
+	void RemoveTimer(TimerID id);
+
+	// Block until every task submitted to the queue so far has finished. Must not be called from that queue.
+	void WaitIdle(Queue queue);
+
+	// Thread safe and lock free, can be called from any thread including library owned ones.
+	void RunOnMainThread(Task task);
+
+	// Run main thread callbacks until the frame budget is spent, the rest is kept for the next frame.
+	void OnServerGamePostSimulate();
+} // namespace executor
@@ -7,6 +7,7 @@
 #include "gamesystems/spawngroup_manager.h"
 #include "utils/simplecmds.h"
 #include "utils/gamesystem.h"
+#include "utils/executor.h"
 #include "steam/steam_gameserver.h"
 
 #include "cs2kz.h"
@@ -14,6 +15,7 @@
 #include "kz/kz.h"
 #include "kz/beam/kz_beam.h"
 #include "kz/jumpstats/kz_jumpstats.h"
+#include "kz/jumpstats/collision.h"
 #include "kz/option/kz_option.h"
 #include "kz/quiet/kz_quiet.h"
 #include "kz/timer/kz_timer.h"
@@ -25,10 +27,12 @@
 #include "kz/mappingapi/kz_mappingapi.h"
 #include "kz/global/kz_global.h"
 #include "kz/profile/kz_profile.h"
+#include "kz/profiler/kz_profiler.h"
 #include "kz/pistol/kz_pistol.h"
 #include "kz/recording/kz_recording.h"
 #include "kz/replays/kz_replaysystem.h"
 #include "kz/racing/kz_racing.h"
+#include "kz/saveloc/kz_saveloc.h"
 #include "utils/utils.h"
 #include "sdk/entity/cbasetrigger.h"
 #include "sdk/usercmd.h"
@@ -277,10 +281,17 @@ void hooks::Initialize()
 		false
 	);
 	// clang-format on
+
+	// Flushed at the end of every ServerGamePostSimulate, before snapshots are built.
+	schema::batchNetworkStateChanges = true;
 }
 
 void hooks::Cleanup()
 {
+	schema::FlushNetworkStateChanges();
+	utils::FlushConVarValues();
+	schema::batchNetworkStateChanges = false;
+
 	SH_REMOVE_HOOK(ISource2GameEntities, CheckTransmit, g_pSource2GameEntities, SH_STATIC(Hook_CheckTransmit), true);
 
 	SH_REMOVE_HOOK(ISource2Server, GameFrame, interfaces::pServer, SH_STATIC(Hook_GameFrame), false);
@@ -501,6 +512,7 @@ static_function void Hook_GameFrame(bool simulating, bool bFirstTick, bool bLast
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	g_KZPlugin.serverGlobals = *(g_pKZUtils->GetGlobals());
+	KZ::profiler::OnGameFrame();
 	RecordAnnounce::Check();
 	BaseRequest::CheckRequests();
 	KZTelemetryService::ActiveCheck();
@@ -523,6 +535,7 @@ static_function void Hook_GameServerSteamAPIDeactivated() {}
 static_function bool Hook_ClientConnect(CPlayerSlot slot, const char *pszName, uint64 xuid, const char *pszNetworkID, bool unk1,
 										CBufferString *pRejectReason)
 {
+	utils::ResetReplicatedConVars(slot);
 	g_pKZPlayerManager->OnClientConnect(slot, pszName, xuid, pszNetworkID, unk1, pRejectReason);
 	RETURN_META_VALUE(MRES_IGNORED, true);
 }
@@ -710,11 +723,15 @@ static_function bool Hook_ActivateServer()
 	META_CONPRINTF("[KZ] Loading map %s, workshop ID %llu, size %llu\n", g_pKZUtils->GetCurrentMapVPK().Get(), id, size);
 
 	RecordAnnounce::Clear();
+	// Clients get the server's values again when they load the new map.
+	utils::ResetReplicatedConVars();
 	KZ::misc::OnActivateServer();
+	KZ::collision::OnActivateServer();
 	KZDatabaseService::SetupMap();
 	KZGlobalService::OnActivateServer();
 	KZRecordingService::OnActivateServer();
 	KZRacingService::OnActivateServer();
+	KZSavelocService::OnActivateServer();
 
 	char md5[33];
 	g_pKZUtils->GetCurrentMapMD5(md5, sizeof(md5));
@@ -745,9 +762,11 @@ static_function CServerSideClientBase *Hook_ConnectClientPost(const char *pszNam
 static_function void Hook_ServerGamePostSimulate(const EventServerGamePostSimulate_t *)
 {
 	ProcessTimers();
-	KZRecordingService::ProcessFileWriteCompletion();
 	KZGlobalService::OnServerGamePostSimulate();
 	KZRacingService::OnServerGamePostSimulate();
+	executor::OnServerGamePostSimulate();
+	schema::FlushNetworkStateChanges();
+	utils::FlushConVarValues();
 }
 
 static_function void Hook_BuildGameSessionManifest(const EventBuildGameSessionManifest_t *msg)
@@ -0,0 +1,586 @@
+#include "json.h"
+
+#include <cmath>
+#include <vendor/json/single_include/nlohmann/json.hpp>
+
+#include "tier0/memdbgon.h"
+
+static_global constexpr u32 JSON_MAX_DEPTH = 32;
+
+static_function void AppendSeparator(std::string &out)
+{
+	if (!out.empty() && out.back() != '{' && out.back() != '[' && out.back() != ':')
+	{
+		out.push_back(',');
+	}
+}
+
+static_function void AppendString(std::string &out, std::string_view value)
+{
+	static_persist const char hex[] = "0123456789abcdef";
+
+	out.push_back('"');
+	for (char c : value)
+	{
+		switch (c)
+		{
+			case '"':
+				out.append("\\\"");
+				break;
+			case '\\':
+				out.append("\\\\");
+				break;
+			case '\n':
+				out.append("\\n");
+				break;
+			case '\r':
+				out.append("\\r");
+				break;
+			case '\t':
+				out.append("\\t");
+				break;
+			default:
+				if ((u8)c < 0x20)
+				{
+					out.append("\\u00");
+					out.push_back(hex[(u8)c >> 4]);
+					out.push_back(hex[(u8)c & 0xf]);
+				}
+				else
+				{
+					out.push_back(c);
+				}
+		}
+	}
+	out.push_back('"');
+}
+
+static_function void AppendFloat(std::string &out, f64 value)
+{
+	if (!std::isfinite(value))
+	{
+		out.append("null");
+		return;
+	}
+
+	// Shortest representation that reads back as the same value.
+	char buffer[32];
+	i32 length = 0;
+	for (i32 precision = 15; precision <= 17; precision++)
+	{
+		length = snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+		if (strtod(buffer, nullptr) == value)
+		{
+			break;
+		}
+	}
+	out.append(buffer, length);
+}
+
+void json::AppendScalar(std::string &out, const JsonScalar &value)
+{
+	switch (value.type)
+	{
+		case JsonScalar::Type::Null:
+			out.append("null");
+			break;
+		case JsonScalar::Type::Boolean:
+			out.append(value.boolean ? "true" : "false");
+			break;
+		case JsonScalar::Type::Integer:
+			out.append(std::to_string(value.integer));
+			break;
+		case JsonScalar::Type::Unsigned:
+			out.append(std::to_string(value.uinteger));
+			break;
+		case JsonScalar::Type::Float:
+			AppendFloat(out, value.number);
+			break;
+		case JsonScalar::Type::String:
+			AppendString(out, value.string);
+			break;
+	}
+}
+
+bool json::DecodeScalar(bool &out, const JsonScalar &value)
+{
+	if (value.type != JsonScalar::Type::Boolean)
+	{
+		return false;
+	}
+	out = value.boolean;
+	return true;
+}
+
+bool json::DecodeScalar(std::string &out, const JsonScalar &value)
+{
+	if (value.type != JsonScalar::Type::String)
+	{
+		return false;
+	}
+	out.assign(value.string);
+	return true;
+}
+
+// Looks up a key in a field table, descending into embedded members.
+// Fields are numbered in declaration order so that the required ones can be checked once the object ends.
+static_function bool FindField(const JsonFieldTable &table, void *object, std::string_view key, u32 &index, const JsonField *&field, JsonSink &sink)
+{
+	for (u32 i = 0; i < table.count; i++)
+	{
+		const JsonField &entry = table.fields[i];
+		if (entry.embedded)
+		{
+			JsonSink embedded = entry.bind(object);
+			const JsonFieldTable *fields = nullptr;
+			void *inner = embedded.ops->object(embedded.target, &fields);
+			if (FindField(*fields, inner, key, index, field, sink))
+			{
+				return true;
+			}
+			continue;
+		}
+
+		if (entry.name == key)
+		{
+			field = &entry;
+			sink = entry.bind(object);
+			return true;
+		}
+		index++;
+	}
+	return false;
+}
+
+static_function bool CheckRequired(const JsonFieldTable &table, void *object, u64 seen, u32 &index)
+{
+	for (u32 i = 0; i < table.count; i++)
+	{
+		const JsonField &entry = table.fields[i];
+		if (entry.embedded)
+		{
+			JsonSink embedded = entry.bind(object);
+			const JsonFieldTable *fields = nullptr;
+			void *inner = embedded.ops->object(embedded.target, &fields);
+			if (!CheckRequired(*fields, inner, seen, index))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		if (entry.required && index < 64 && !(seen & (1ull << index)))
+		{
+			META_CONPRINTF("[JSON] Key `%.*s` does not exist.\n", (i32)entry.name.size(), entry.name.data());
+			return false;
+		}
+		index++;
+	}
+	return true;
+}
+
+// Receives the SAX events of nlohmann::json and routes every value to the sink it belongs to.
+// Values without a sink are skipped, values with a raw sink are copied as text.
+class JsonSaxDecoder
+{
+public:
+	using string_t = nlohmann::json::string_t;
+	using binary_t = nlohmann::json::binary_t;
+
+	JsonSaxDecoder(JsonSink root) : root(root) {}
+
+	bool null()
+	{
+		return this->Scalar({});
+	}
+
+	bool boolean(bool value)
+	{
+		JsonScalar scalar;
+		scalar.type = JsonScalar::Type::Boolean;
+		scalar.boolean = value;
+		return this->Scalar(scalar);
+	}
+
+	bool number_integer(i64 value)
+	{
+		JsonScalar scalar;
+		scalar.type = JsonScalar::Type::Integer;
+		scalar.integer = value;
+		return this->Scalar(scalar);
+	}
+
+	bool number_unsigned(u64 value)
+	{
+		JsonScalar scalar;
+		scalar.type = JsonScalar::Type::Unsigned;
+		scalar.uinteger = value;
+		return this->Scalar(scalar);
+	}
+
+	bool number_float(f64 value, const string_t &)
+	{
+		JsonScalar scalar;
+		scalar.type = JsonScalar::Type::Float;
+		scalar.number = value;
+		return this->Scalar(scalar);
+	}
+
+	bool string(string_t &value)
+	{
+		JsonScalar scalar;
+		scalar.type = JsonScalar::Type::String;
+		scalar.string = value;
+		return this->Scalar(scalar);
+	}
+
+	bool binary(binary_t &)
+	{
+		return this->Fail("Binary values are not supported");
+	}
+
+	bool start_object(size_t)
+	{
+		return this->Begin(true);
+	}
+
+	bool end_object()
+	{
+		return this->End();
+	}
+
+	bool start_array(size_t)
+	{
+		return this->Begin(false);
+	}
+
+	bool end_array()
+	{
+		return this->End();
+	}
+
+	bool key(string_t &key)
+	{
+		if (this->raw)
+		{
+			AppendSeparator(*this->raw);
+			AppendString(*this->raw, key);
+			this->raw->push_back(':');
+			return true;
+		}
+		if (this->skipDepth)
+		{
+			return true;
+		}
+
+		Frame &frame = this->frames[this->depth - 1];
+		u32 index = 0;
+		frame.field = nullptr;
+		frame.pending = {};
+		if (FindField(*frame.fields, frame.object, key, index, frame.field, frame.pending) && index < 64)
+		{
+			frame.seen |= 1ull << index;
+		}
+		return true;
+	}
+
+	bool parse_error(size_t position, const std::string &, const nlohmann::json::exception &error)
+	{
+		META_CONPRINTF("[JSON] Parse error at byte %zu: %s\n", position, error.what());
+		return false;
+	}
+
+private:
+	struct Frame
+	{
+		const JsonField *field;
+		// Objects
+		const JsonFieldTable *fields;
+		void *object;
+		u64 seen;
+		JsonSink pending;
+		// Arrays
+		JsonSink array;
+	};
+
+	JsonSink root;
+	bool rootConsumed {};
+	Frame frames[JSON_MAX_DEPTH];
+	u32 depth {};
+	u32 skipDepth {};
+	std::string *raw {};
+	u32 rawDepth {};
+	// One bit per open raw container, set for arrays.
+	u64 rawArrays {};
+
+	bool Fail(const char *reason)
+	{
+		const JsonField *field = this->depth ? this->frames[this->depth - 1].field : nullptr;
+		if (field)
+		{
+			META_CONPRINTF("[JSON] Key `%.*s`: %s.\n", (i32)field->name.size(), field->name.data(), reason);
+		}
+		else
+		{
+			META_CONPRINTF("[JSON] %s.\n", reason);
+		}
+		return false;
+	}
+
+	// The sink of the next value, a null `ops` means the value is skipped.
+	JsonSink NextSink()
+	{
+		if (!this->depth)
+		{
+			if (this->rootConsumed)
+			{
+				return {};
+			}
+			this->rootConsumed = true;
+			return this->root;
+		}
+
+		Frame &frame = this->frames[this->depth - 1];
+		if (frame.fields)
+		{
+			JsonSink sink = frame.pending;
+			frame.pending = {};
+			return sink;
+		}
+		return frame.array.ops->element(frame.array.target);
+	}
+
+	bool IsOptionalField() const
+	{
+		if (!this->depth || !this->frames[this->depth - 1].fields)
+		{
+			return false;
+		}
+		const JsonField *field = this->frames[this->depth - 1].field;
+		return field && !field->required;
+	}
+
+	bool Scalar(const JsonScalar &value)
+	{
+		if (this->raw)
+		{
+			AppendSeparator(*this->raw);
+			json::AppendScalar(*this->raw, value);
+			return true;
+		}
+		if (this->skipDepth)
+		{
+			return true;
+		}
+
+		JsonSink sink = this->NextSink();
+		if (!sink.ops)
+		{
+			return true;
+		}
+		if (sink.ops->scalar && sink.ops->scalar(sink.target, value))
+		{
+			return true;
+		}
+		if (value.type == JsonScalar::Type::Null)
+		{
+			return this->IsOptionalField() || this->Fail("Value is null");
+		}
+		return this->Fail("Value has an unexpected type");
+	}
+
+	bool Begin(bool object)
+	{
+		if (this->raw)
+		{
+			if (this->rawDepth == 64)
+			{
+				return this->Fail("Nesting is too deep");
+			}
+			AppendSeparator(*this->raw);
+			this->raw->push_back(object ? '{' : '[');
+			this->rawArrays = (this->rawArrays << 1) | !object;
+			this->rawDepth++;
+			return true;
+		}
+		if (this->skipDepth)
+		{
+			this->skipDepth++;
+			return true;
+		}
+
+		JsonSink sink = this->NextSink();
+		if (!sink.ops)
+		{
+			this->skipDepth = 1;
+			return true;
+		}
+		if (sink.ops->raw)
+		{
+			this->raw = sink.ops->raw(sink.target);
+			this->raw->clear();
+			this->raw->push_back(object ? '{' : '[');
+			this->rawArrays = !object;
+			this->rawDepth = 1;
+			return true;
+		}
+		if (this->depth == JSON_MAX_DEPTH)
+		{
+			return this->Fail("Nesting is too deep");
+		}
+
+		Frame frame {};
+		// Arrays keep the key they belong to for error messages, objects set it per key.
+		frame.field = this->depth ? this->frames[this->depth - 1].field : nullptr;
+		if (object)
+		{
+			frame.object = sink.ops->object ? sink.ops->object(sink.target, &frame.fields) : nullptr;
+			if (!frame.object)
+			{
+				return this->Fail("Value is not an object");
+			}
+		}
+		else
+		{
+			if (!sink.ops->array)
+			{
+				return this->Fail("Value is not an array");
+			}
+			sink.ops->array(sink.target);
+			frame.array = sink;
+		}
+		this->frames[this->depth++] = frame;
+		return true;
+	}
+
+	bool End()
+	{
+		if (this->raw)
+		{
+			this->raw->push_back((this->rawArrays & 1) ? ']' : '}');
+			this->rawArrays >>= 1;
+			if (--this->rawDepth == 0)
+			{
+				this->raw = nullptr;
+			}
+			return true;
+		}
+		if (this->skipDepth)
+		{
+			this->skipDepth--;
+			return true;
+		}
+
+		Frame &frame = this->frames[--this->depth];
+		if (frame.fields)
+		{
+			u32 index = 0;
+			return CheckRequired(*frame.fields, frame.object, frame.seen, index);
+		}
+		return true;
+	}
+};
+
+bool JsonDecode(std::string_view text, JsonSink root)
+{
+	JsonSaxDecoder decoder(root);
+	return nlohmann::json::sax_parse(text.begin(), text.end(), &decoder);
+}
+
+struct JsonRootObject
+{
+	const JsonFieldTable *fields;
+	void *object;
+
+	static void *Object(void *target, const JsonFieldTable **fields)
+	{
+		JsonRootObject *root = static_cast<JsonRootObject *>(target);
+		*fields = root->fields;
+		return root->object;
+	}
+
+	static constexpr JsonSink::Ops ops = {nullptr, &Object, nullptr, nullptr, nullptr};
+};
+
+bool JsonDecodeObject(std::string_view text, const JsonFieldTable &fields, void *object)
+{
+	JsonRootObject root {&fields, object};
+	return JsonDecode(text, {&root, &JsonRootObject::ops});
+}
+
+void JsonWriter::Key(std::string_view key)
+{
+	AppendSeparator(this->text);
+	AppendString(this->text, key);
+	this->text.push_back(':');
+}
+
+void JsonWriter::BeginObject()
+{
+	AppendSeparator(this->text);
+	this->text.push_back('{');
+}
+
+void JsonWriter::EndObject()
+{
+	this->text.push_back('}');
+}
+
+void JsonWriter::BeginArray()
+{
+	AppendSeparator(this->text);
+	this->text.push_back('[');
+}
+
+void JsonWriter::EndArray()
+{
+	this->text.push_back(']');
+}
+
+void JsonWriter::Null()
+{
+	AppendSeparator(this->text);
+	this->text.append("null");
+}
+
+void JsonWriter::Bool(bool value)
+{
+	AppendSeparator(this->text);
+	this->text.append(value ? "true" : "false");
+}
+
+void JsonWriter::Integer(i64 value)
+{
+	AppendSeparator(this->text);
+	this->text.append(std::to_string(value));
+}
+
+void JsonWriter::Unsigned(u64 value)
+{
+	AppendSeparator(this->text);
+	this->text.append(std::to_string(value));
+}
+
+void JsonWriter::Float(f64 value)
+{
+	AppendSeparator(this->text);
+	AppendFloat(this->text, value);
+}
+
+void JsonWriter::String(std::string_view value)
+{
+	AppendSeparator(this->text);
+	AppendString(this->text, value);
+}
+
+bool JsonWriter::Write(const RawJson &value)
+{
+	if (value.text.empty())
+	{
+		this->Null();
+		return true;
+	}
+	AppendSeparator(this->text);
+	this->text.append(value.text);
+	return true;
+}
@@ -1,443 +1,543 @@
 #pragma once
 #include "common.h"
 
-#include <vendor/json/single_include/nlohmann/json.hpp>
-#include <vendor/json/single_include/nlohmann/json_fwd.hpp>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// Streaming JSON for the global API and racing messages.
+//
+// Decoding feeds the SAX parser straight into the target struct. Every type lists its keys once in a field table
+// (see JSON_FIELD below), so no document is built in between and keys nobody asked for are skipped.
+// Encoding goes through JsonWriter, which appends to a single string while ToJson() sets the fields.
+
+struct JsonScalar
+{
+	enum class Type : u8
+	{
+		Null,
+		Boolean,
+		Integer,
+		Unsigned,
+		Float,
+		String,
+	};
+
+	Type type = Type::Null;
+	bool boolean {};
+	i64 integer {};
+	u64 uinteger {};
+	f64 number {};
+	std::string_view string;
+};
+
+struct JsonFieldTable;
 
-class Json
+// Where a decoded value goes. `ops` is shared by every value of the same type, unsupported operations are null.
+struct JsonSink
 {
-public:
-	Json() : inner(nlohmann::json::object()) {}
+	struct Ops
+	{
+		bool (*scalar)(void *target, const JsonScalar &value);
+		// Returns the object whose fields are listed in `fields`.
+		void *(*object)(void *target, const JsonFieldTable **fields);
+		// Clears the target before the elements are decoded.
+		void (*array)(void *target);
+		JsonSink (*element)(void *target);
+		// Returns the string an object or array is copied into as text, for values we forward rather than read.
+		std::string *(*raw)(void *target);
+	};
+
+	void *target;
+	const Ops *ops;
+};
+
+struct JsonField
+{
+	std::string_view name;
+	JsonSink (*bind)(void *object);
+	bool required;
+	// The fields of an embedded member are read from the enclosing object, `name` is unused.
+	bool embedded;
+};
 
-	Json(const char *text) : inner(nlohmann::json::parse(text, nullptr, false)) {}
+struct JsonFieldTable
+{
+	const JsonField *fields;
+	u32 count;
 
-	Json(const std::string &text) : inner(nlohmann::json::parse(text, nullptr, false)) {}
+	constexpr JsonFieldTable() : fields(nullptr), count(0) {}
 
-	template<typename T>
-	Json(const T &value)
+	template<size_t N>
+	constexpr JsonFieldTable(const JsonField (&fields)[N]) : fields(fields), count((u32)N)
 	{
-		this->inner = nlohmann::json::object();
-		value.ToJson(*this);
 	}
+};
+
+// A value kept as JSON text, for payloads that are passed along instead of read.
+struct RawJson
+{
+	std::string text;
+
+	RawJson() = default;
 
-	std::string ToString() const
+	RawJson(std::string text) : text(std::move(text)) {}
+
+	const std::string &ToString() const
 	{
-		return this->inner.dump();
+		return this->text;
 	}
+};
+
+namespace json
+{
+	void AppendScalar(std::string &out, const JsonScalar &value);
+
+	template<typename T, typename = void>
+	struct HasFields : std::false_type
+	{
+	};
+
+	template<typename T>
+	struct HasFields<T, std::void_t<decltype(T::JsonFields())>> : std::true_type
+	{
+	};
+
+	bool DecodeScalar(bool &out, const JsonScalar &value);
+	bool DecodeScalar(std::string &out, const JsonScalar &value);
 
-	bool ContainsKey(const std::string &key) const
+	template<typename T>
+	bool DecodeScalar(T &out, const JsonScalar &value)
 	{
-		if (!this->inner.is_object())
+		if constexpr (std::is_integral_v<T>)
 		{
-			META_CONPRINTF("[JSON] Cannot extract value from non-object.\n");
+			if (value.type == JsonScalar::Type::Unsigned)
+			{
+				if (value.uinteger > (u64)std::numeric_limits<T>::max())
+				{
+					return false;
+				}
+				out = (T)value.uinteger;
+				return true;
+			}
+			if constexpr (std::is_signed_v<T>)
+			{
+				if (value.type == JsonScalar::Type::Integer && value.integer >= (i64)std::numeric_limits<T>::min()
+					&& value.integer <= (i64)std::numeric_limits<T>::max())
+				{
+					out = (T)value.integer;
+					return true;
+				}
+			}
 			return false;
 		}
-
-		if (!this->inner.contains(key))
+		else if constexpr (std::is_floating_point_v<T>)
 		{
-			META_CONPRINTF("[JSON] Key `%s` does not exist.\n", key.c_str());
-			return false;
+			switch (value.type)
+			{
+				case JsonScalar::Type::Integer:
+					out = (T)value.integer;
+					return true;
+				case JsonScalar::Type::Unsigned:
+					out = (T)value.uinteger;
+					return true;
+				case JsonScalar::Type::Float:
+					out = (T)value.number;
+					return true;
+				default:
+					return false;
+			}
 		}
-
-		if (this->inner[key].is_null())
+		else
 		{
-			META_CONPRINTF("[JSON] Key `%s` is null.\n", key.c_str());
 			return false;
 		}
-
-		return true;
 	}
 
 	template<typename T>
-	bool Set(const std::string &key, const T &value)
+	struct Codec
 	{
-		if (!this->inner.is_object())
+		static bool Scalar(void *target, const JsonScalar &value)
 		{
-			return false;
+			return DecodeScalar(*static_cast<T *>(target), value);
 		}
 
-		Json json;
-
-		if (!value.ToJson(json))
+		static void *Object(void *target, const JsonFieldTable **fields)
 		{
-			return false;
+			if constexpr (HasFields<T>::value)
+			{
+				*fields = &T::JsonFields();
+				return target;
+			}
+			else
+			{
+				return nullptr;
+			}
 		}
 
-		this->inner[key] = json.inner;
-
-		return true;
-	}
+		static constexpr JsonSink::Ops ops = {&Scalar, &Object, nullptr, nullptr, nullptr};
+	};
 
-	bool Set(const std::string &key, const Json &value)
+	template<typename T>
+	struct IsVector : std::false_type
 	{
-		if (!this->inner.is_object())
-		{
-			return false;
-		}
+	};
 
-		this->inner[key] = value.inner;
-		return true;
-	}
+	template<typename T>
+	struct IsVector<std::vector<T>> : std::true_type
+	{
+	};
 
-	bool Set(const std::string &key, const bool &value)
+	template<typename T>
+	struct Codec<std::optional<T>>
 	{
-		if (!this->inner.is_object())
+		static bool Scalar(void *target, const JsonScalar &value)
 		{
-			return false;
+			std::optional<T> &out = *static_cast<std::optional<T> *>(target);
+			if (value.type == JsonScalar::Type::Null)
+			{
+				out.reset();
+				return true;
+			}
+			return Codec<T>::ops.scalar && Codec<T>::ops.scalar(&out.emplace(), value);
 		}
 
-		this->inner[key] = value;
-		return true;
-	}
+		static constexpr bool isArray = IsVector<T>::value;
+		static constexpr bool isRaw = std::is_same_v<T, RawJson>;
 
-	bool Set(const std::string &key, const u8 &value)
-	{
-		if (!this->inner.is_object())
+		static void *Object(void *target, const JsonFieldTable **fields)
 		{
-			return false;
+			if constexpr (!isArray && !isRaw)
+			{
+				return Codec<T>::Object(&static_cast<std::optional<T> *>(target)->emplace(), fields);
+			}
+			return nullptr;
 		}
 
-		this->inner[key] = value;
-		return true;
-	}
-
-	bool Set(const std::string &key, const u16 &value)
-	{
-		if (!this->inner.is_object())
+		static void Array(void *target)
 		{
-			return false;
+			if constexpr (isArray)
+			{
+				Codec<T>::Array(&static_cast<std::optional<T> *>(target)->emplace());
+			}
 		}
 
-		this->inner[key] = value;
-		return true;
-	}
+		static JsonSink Element(void *target)
+		{
+			if constexpr (isArray)
+			{
+				return Codec<T>::Element(&**static_cast<std::optional<T> *>(target));
+			}
+			return {};
+		}
 
-	bool Set(const std::string &key, const u32 &value)
-	{
-		if (!this->inner.is_object())
+		static std::string *Raw(void *target)
 		{
-			return false;
+			if constexpr (isRaw)
+			{
+				return Codec<T>::Raw(&static_cast<std::optional<T> *>(target)->emplace());
+			}
+			return nullptr;
 		}
 
-		this->inner[key] = value;
-		return true;
-	}
+		static constexpr JsonSink::Ops ops = {
+			&Scalar,
+			isArray || isRaw ? nullptr : &Object,
+			isArray ? &Array : nullptr,
+			isArray ? &Element : nullptr,
+			isRaw ? &Raw : nullptr,
+		};
+	};
 
-	bool Set(const std::string &key, const u64 &value)
+	template<typename T>
+	struct Codec<std::vector<T>>
 	{
-		if (!this->inner.is_object())
+		static void Array(void *target)
 		{
-			return false;
+			static_cast<std::vector<T> *>(target)->clear();
 		}
 
-		this->inner[key] = value;
-		return true;
-	}
-
-	bool Set(const std::string &key, const f32 &value)
-	{
-		if (!this->inner.is_object())
+		static JsonSink Element(void *target)
 		{
-			return false;
+			return {&static_cast<std::vector<T> *>(target)->emplace_back(), &Codec<T>::ops};
 		}
 
-		this->inner[key] = value;
-		return true;
-	}
+		static constexpr JsonSink::Ops ops = {nullptr, nullptr, &Array, &Element, nullptr};
+	};
 
-	bool Set(const std::string &key, const f64 &value)
+	template<>
+	struct Codec<RawJson>
 	{
-		if (!this->inner.is_object())
+		static bool Scalar(void *target, const JsonScalar &value)
 		{
-			return false;
+			if (value.type == JsonScalar::Type::Null)
+			{
+				return false;
+			}
+			std::string &out = static_cast<RawJson *>(target)->text;
+			out.clear();
+			AppendScalar(out, value);
+			return true;
 		}
 
-		this->inner[key] = value;
-		return true;
-	}
-
-	bool Set(const std::string &key, const char *value)
-	{
-		if (!this->inner.is_object())
+		static std::string *Raw(void *target)
 		{
-			return false;
+			return &static_cast<RawJson *>(target)->text;
 		}
 
-		this->inner[key] = std::string(value);
-		return true;
-	}
+		static constexpr JsonSink::Ops ops = {&Scalar, nullptr, nullptr, nullptr, &Raw};
+	};
 
-	bool Set(const std::string &key, const std::string &value)
+	// Scalars converted by a function, either `bool(std::string_view, T &)` for strings or `bool(const JsonScalar &, T &)`.
+	template<typename T, auto Decode>
+	struct Decoder
 	{
-		if (!this->inner.is_object())
+		static bool Scalar(void *target, const JsonScalar &value)
 		{
-			return false;
+			T &out = *static_cast<T *>(target);
+			if constexpr (std::is_invocable_r_v<bool, decltype(Decode), std::string_view, T &>)
+			{
+				return value.type == JsonScalar::Type::String && Decode(value.string, out);
+			}
+			else
+			{
+				return Decode(value, out);
+			}
 		}
 
-		this->inner[key] = value;
-		return true;
-	}
+		static constexpr JsonSink::Ops ops = {&Scalar, nullptr, nullptr, nullptr, nullptr};
+	};
 
-	bool Set(const std::string &key, std::string_view value)
+	// An object whose fields belong to the enclosing type. A null value is the same as a missing one.
+	template<const JsonFieldTable &(*Fields)()>
+	struct Nested
 	{
-		if (!this->inner.is_object())
+		static bool Scalar(void *target, const JsonScalar &value)
 		{
-			return false;
+			return value.type == JsonScalar::Type::Null;
 		}
 
-		this->inner[key] = value;
-		return true;
-	}
-
-	template<typename T>
-	bool Set(const std::string &key, const std::vector<T> &value)
-	{
-		if (!this->inner.is_object())
+		static void *Object(void *target, const JsonFieldTable **fields)
 		{
-			return false;
+			*fields = &Fields();
+			return target;
 		}
 
-		this->inner[key] = nlohmann::json::array();
+		static constexpr JsonSink::Ops ops = {&Scalar, &Object, nullptr, nullptr, nullptr};
+	};
 
-		for (const auto &item : value)
-		{
-			Json json;
+	template<typename>
+	struct Member;
 
-			if (!json.Set("value", item))
-			{
-				return false;
-			}
+	template<typename C, typename M>
+	struct Member<M C::*>
+	{
+		using Class = C;
+		using Value = M;
+	};
 
-			this->inner[key].push_back(json.inner["value"]);
-		}
+	template<typename T>
+	struct IsOptional : std::false_type
+	{
+	};
 
-		return true;
-	}
+	template<typename T>
+	struct IsOptional<std::optional<T>> : std::true_type
+	{
+	};
 
-	template<typename K, typename V>
-	bool Set(const std::string &key, const std::unordered_map<K, V> &value)
+	// Follows a path of member pointers, e.g. <&Ack::overallData, &Ack::RecordData::rank>.
+	template<auto M, auto... Rest>
+	auto *Resolve(void *object)
 	{
-		if (!this->inner.is_object())
+		auto *member = &(static_cast<typename Member<decltype(M)>::Class *>(object)->*M);
+		if constexpr (sizeof...(Rest) == 0)
 		{
-			return false;
+			return member;
 		}
-
-		this->inner[key] = nlohmann::json::object();
-
-		for (const auto &[k, v] : value)
+		else
 		{
-			Json json;
-
-			if (!v.ToJson(json))
-			{
-				return false;
-			}
-
-			this->inner[key][std::to_string(k)] = json.inner;
+			return Resolve<Rest...>(member);
 		}
-
-		return true;
 	}
 
-	bool IsValid() const
+	template<auto... Path>
+	using ResolvedType = std::remove_pointer_t<decltype(Resolve<Path...>(nullptr))>;
+
+	template<auto... Path>
+	constexpr bool IsRequired()
 	{
-		return !this->inner.is_discarded();
+		return !IsOptional<ResolvedType<Path...>>::value;
 	}
 
-	bool Get(const std::string &key, Json &out) const
+	template<auto... Path>
+	JsonSink Bind(void *object)
 	{
-		if (!this->ContainsKey(key))
-		{
-			return false;
-		}
-
-		out.inner = this->inner[key];
-		return true;
+		return {Resolve<Path...>(object), &Codec<ResolvedType<Path...>>::ops};
 	}
 
-	bool Get(const std::string &key, bool &out) const
+	template<auto M, auto Decode>
+	JsonSink BindDecoder(void *object)
 	{
-		if (!this->ContainsKey(key))
-		{
-			return false;
-		}
-
-		if (!this->inner[key].is_boolean())
-		{
-			META_CONPRINTF("[JSON] Key `%s` is not a boolean.\n", key.c_str());
-			return false;
-		}
+		return {Resolve<M>(object), &Decoder<ResolvedType<M>, Decode>::ops};
+	}
 
-		out = this->inner[key];
-		return true;
+	template<const JsonFieldTable &(*Fields)()>
+	JsonSink BindNested(void *object)
+	{
+		return {object, &Nested<Fields>::ops};
 	}
 
-	bool Get(const std::string &key, u16 &out) const
+	template<typename T>
+	JsonSink BindSelf(void *object)
 	{
-		if (!this->ContainsKey(key))
-		{
-			return false;
-		}
+		return {object, &Codec<T>::ops};
+	}
+} // namespace json
 
-		if (!this->inner[key].is_number_unsigned())
-		{
-			META_CONPRINTF("[JSON] Key `%s` is not an unsigned integer.\n", key.c_str());
-			return false;
-		}
+// A member decoded from `name`. Required unless it is a std::optional, which is reset by a missing or null value.
+#define JSON_FIELD(name, ...) JsonField {name, &json::Bind<__VA_ARGS__>, json::IsRequired<__VA_ARGS__>(), false}
 
-		out = this->inner[key];
-		return true;
-	}
+// A member that keeps its default value if `name` is missing or null.
+#define JSON_OPTIONAL_FIELD(name, ...) JsonField {name, &json::Bind<__VA_ARGS__>, false, false}
 
-	bool Get(const std::string &key, u32 &out) const
-	{
-		if (!this->ContainsKey(key))
-		{
-			return false;
-		}
+// A member converted from a scalar by `decode`, see json::Decoder.
+#define JSON_FIELD_DECODE(name, member, decode) JsonField {name, &json::BindDecoder<member, decode>, json::IsRequired<member>(), false}
 
-		if (!this->inner[key].is_number_unsigned())
-		{
-			META_CONPRINTF("[JSON] Key `%s` is not an unsigned integer.\n", key.c_str());
-			return false;
-		}
+// A member whose own fields are read from the enclosing object.
+#define JSON_EMBED(member) JsonField {{}, &json::Bind<member>, true, true}
 
-		out = this->inner[key];
-		return true;
-	}
+// An optional object under `name` whose keys are listed by `fields` and decoded into the enclosing type.
+#define JSON_NESTED(name, fields) JsonField {name, &json::BindNested<fields>, false, false}
 
-	bool Get(const std::string &key, u64 &out) const
-	{
-		if (!this->ContainsKey(key))
-		{
-			return false;
-		}
+// Decodes a whole document.
+bool JsonDecode(std::string_view text, JsonSink root);
 
-		if (!this->inner[key].is_number_unsigned())
-		{
-			META_CONPRINTF("[JSON] Key `%s` is not an unsigned integer.\n", key.c_str());
-			return false;
-		}
+// Decodes the fields of a top-level object, any other value or key in the document is skipped.
+bool JsonDecodeObject(std::string_view text, const JsonFieldTable &fields, void *object);
 
-		out = this->inner[key];
-		return true;
-	}
+template<typename T>
+bool JsonDecode(std::string_view text, T &out)
+{
+	return JsonDecode(text, JsonSink {&out, &json::Codec<T>::ops});
+}
 
-	bool Get(const std::string &key, f32 &out) const
-	{
-		if (!this->ContainsKey(key))
-		{
-			return false;
-		}
+// Decodes the value of a single top-level key, e.g. the id or event of a message before its payload.
+template<typename T>
+bool JsonDecodeField(std::string_view text, std::string_view key, T &out)
+{
+	const JsonField fields[] = {{key, &json::BindSelf<T>, true, false}};
+	return JsonDecodeObject(text, JsonFieldTable(fields), &out);
+}
+
+class JsonWriter
+{
+public:
+	JsonWriter() : text("{") {}
 
-		if (!this->inner[key].is_number())
+	// Closes the top-level object, nothing can be set afterwards.
+	const std::string &Finish()
+	{
+		if (!this->finished)
 		{
-			META_CONPRINTF("[JSON] Key `%s` is not a float.\n", key.c_str());
-			return false;
+			this->text.push_back('}');
+			this->finished = true;
 		}
+		return this->text;
+	}
 
-		out = this->inner[key];
-		return true;
+	template<typename T>
+	bool Set(std::string_view key, const T &value)
+	{
+		this->Key(key);
+		return this->Write(value);
 	}
 
-	bool Get(const std::string &key, f64 &out) const
+	template<typename T>
+	bool Write(const T &value)
 	{
-		if (!this->ContainsKey(key))
+		if constexpr (std::is_same_v<T, bool>)
 		{
-			return false;
+			this->Bool(value);
 		}
-
-		if (!this->inner[key].is_number())
+		else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
 		{
-			META_CONPRINTF("[JSON] Key `%s` is not a float.\n", key.c_str());
-			return false;
+			this->Integer(value);
 		}
-
-		out = this->inner[key];
-		return true;
-	}
-
-	bool Get(const std::string &key, std::string &out) const
-	{
-		if (!this->ContainsKey(key))
+		else if constexpr (std::is_integral_v<T>)
 		{
-			return false;
+			this->Unsigned(value);
 		}
-
-		if (!this->inner[key].is_string())
+		else if constexpr (std::is_floating_point_v<T>)
 		{
-			META_CONPRINTF("[JSON] Key `%s` is not a string.\n", key.c_str());
-			return false;
+			this->Float(value);
 		}
-
-		out = this->inner[key];
-		return true;
-	}
-
-	template<typename T>
-	bool Get(const std::string &key, std::optional<T> &out) const
-	{
-		if (!this->ContainsKey(key) || this->inner[key].is_null())
+		else if constexpr (std::is_convertible_v<const T &, std::string_view>)
 		{
-			out = std::nullopt;
-			return true;
+			this->String(value);
 		}
-
-		T value;
-
-		if (!this->Get(key, value))
+		else
 		{
-			return false;
+			this->BeginObject();
+			if (!value.ToJson(*this))
+			{
+				return false;
+			}
+			this->EndObject();
 		}
-
-		out = std::make_optional(std::move(value));
 		return true;
 	}
 
 	template<typename T>
-	bool Get(const std::string &key, std::vector<T> &out) const
+	bool Write(const std::vector<T> &value)
 	{
-		if (!this->ContainsKey(key))
-		{
-			return false;
-		}
-
-		if (!this->inner[key].is_array())
-		{
-			META_CONPRINTF("[JSON] Key `%s` is not an array.\n", key.c_str());
-			return false;
-		}
-
-		for (const auto &item : this->inner[key])
+		this->BeginArray();
+		for (const auto &item : value)
 		{
-			T value;
-
-			if (!value.FromJson(item))
+			if (!this->Write(item))
 			{
 				return false;
 			}
-
-			out.push_back(value);
 		}
-
+		this->EndArray();
 		return true;
 	}
 
-	template<typename T>
-	bool Get(const std::string &key, T &out) const
+	template<typename K, typename V>
+	bool Write(const std::unordered_map<K, V> &value)
 	{
-		if (!this->ContainsKey(key))
+		this->BeginObject();
+		for (const auto &[k, v] : value)
 		{
-			return false;
+			this->Key(std::to_string(k));
+			if (!this->Write(v))
+			{
+				return false;
+			}
 		}
+		this->EndObject();
+		return true;
+	}
 
-		Json json = Json(this->inner[key]);
+	bool Write(const RawJson &value);
 
-		return out.FromJson(json);
-	}
+	void Key(std::string_view key);
+	void BeginObject();
+	void EndObject();
+	void BeginArray();
+	void EndArray();
+	void Null();
+	void Bool(bool value);
+	void Integer(i64 value);
+	void Unsigned(u64 value);
+	void Float(f64 value);
+	void String(std::string_view value);
 
 private:
-	nlohmann::json inner;
-
-	Json(nlohmann::json json) : inner(json) {}
+	std::string text;
+	bool finished {};
 };
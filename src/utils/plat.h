@@ -2,6 +2,7 @@
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <cstdio>
 #include "metamod_oslink.h"
 
 // Needs to be here because later MSVC versions don't need this anymore
@@ -46,3 +47,9 @@ int GetModuleInformation(HINSTANCE module, void **base, size_t *length, std::vec
 #endif
 
 void Plat_WriteMemory(void *pPatchAddress, uint8_t *pPatch, int iPatchSize);
+
+// Flush the stream and wait until its data is on disk.
+bool Plat_SyncFile(FILE *file);
+
+// Atomically replace the file at newPath with the one at oldPath.
+bool Plat_ReplaceFile(const char *oldPath, const char *newPath);
@@ -13,6 +13,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 #include "tier0/memdbgon.h"
 
@@ -191,6 +192,16 @@ void Plat_WriteMemory(void *pPatchAddress, uint8_t *pPatch, int iPatchSize)
 	result = mprotect(align_addr, align_size, old_prot);
 }
 
+bool Plat_SyncFile(FILE *file)
+{
+	return fflush(file) == 0 && fsync(fileno(file)) == 0;
+}
+
+bool Plat_ReplaceFile(const char *oldPath, const char *newPath)
+{
+	return rename(oldPath, newPath) == 0;
+}
+
 void *CModule::FindVirtualTable(const std::string &name)
 {
 	auto readOnlyData = GetSection(".rodata");
@@ -1,5 +1,6 @@
 #include "plat.h"
 #include "module.h"
+#include <io.h>
 
 #include "tier0/memdbgon.h"
 
@@ -8,6 +9,16 @@ void Plat_WriteMemory(void *pPatchAddress, uint8_t *pPatch, int iPatchSize)
 	WriteProcessMemory(GetCurrentProcess(), pPatchAddress, (void *)pPatch, iPatchSize, nullptr);
 }
 
+bool Plat_SyncFile(FILE *file)
+{
+	return fflush(file) == 0 && _commit(_fileno(file)) == 0;
+}
+
+bool Plat_ReplaceFile(const char *oldPath, const char *newPath)
+{
+	return MoveFileExA(oldPath, newPath, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
 void CModule::InitializeSections()
 {
 	IMAGE_DOS_HEADER *pDosHeader = reinterpret_cast<IMAGE_DOS_HEADER *>(m_hModule);
@@ -5,6 +5,7 @@
 #include "utils/interfaces.h"
 // #include <unordered_map>
 #include "tier1/utlmap.h"
+#include <set>
 #include "plat.h"
 #include "sdk/entity/cbaseentity.h"
 
@@ -147,23 +148,25 @@ int16_t schema::FindChainOffset(const char *className, uint32_t classNameHash)
 	return schema::GetOffset(className, classNameHash, "__m_pChainEntity", g_ChainKey).offset;
 }
 
-SchemaKey schema::GetOffset(const char *className, uint32_t classKey, const char *memberName, uint32_t memberKey)
+static SchemaKey LookupOffset(const char *className, uint32_t classKey, const char *memberName, uint32_t memberKey, bool &found)
 {
 	static SchemaTableMap_t schemaTableMap;
 
+	found = false;
 	if (schemaTableMap.find(classKey) == schemaTableMap.end())
 	{
 		if (InitSchemaFieldsForClass(schemaTableMap, className, classKey))
 		{
-			return GetOffset(className, classKey, memberName, memberKey);
+			return LookupOffset(className, classKey, memberName, memberKey, found);
 		}
 
 		return {0, 0};
 	}
 
-	SchemaKeyValueMap_t tableMap = schemaTableMap[classKey];
+	SchemaKeyValueMap_t &tableMap = schemaTableMap[classKey];
 
-	if (tableMap.find(memberKey) == tableMap.end())
+	auto it = tableMap.find(memberKey);
+	if (it == tableMap.end())
 	{
 		if (memberKey != g_ChainKey)
 		{
@@ -173,7 +176,194 @@ SchemaKey schema::GetOffset(const char *className, uint32_t classKey, const char
 		return {0, 0};
 	}
 
-	return tableMap[memberKey];
+	found = true;
+	return it->second;
+}
+
+SchemaKey schema::GetOffset(const char *className, uint32_t classKey, const char *memberName, uint32_t memberKey)
+{
+	bool found;
+	return LookupOffset(className, classKey, memberName, memberKey, found);
+}
+
+struct SchemaFieldRegistration
+{
+	const char *className;
+	uint32_t classKey;
+	const char *memberName;
+	uint32_t memberKey;
+};
+
+// Function-local so that it is constructed before the first SCHEMA_FIELD registers itself, regardless of static init order.
+static std::vector<SchemaFieldRegistration> &GetFieldRegistrations()
+{
+	static_persist std::vector<SchemaFieldRegistration> registrations;
+	return registrations;
+}
+
+uint32_t schema::RegisterField(const char *className, uint32_t classKey, const char *memberName, uint32_t memberKey)
+{
+	auto &registrations = GetFieldRegistrations();
+	if (registrations.size() >= schema::MAX_FIELDS)
+	{
+		// Can't use the engine's Error() here, tier0 might not be ready during static initialization.
+		fprintf(stderr, "schema::RegisterField(): too many schema fields, increase schema::MAX_FIELDS! (%s::%s)\n", className, memberName);
+		abort();
+	}
+	registrations.push_back({className, classKey, memberName, memberKey});
+	return static_cast<uint32_t>(registrations.size() - 1);
+}
+
+bool schema::ResolveFields()
+{
+	f64 startTime = Plat_FloatTime();
+
+	auto &registrations = GetFieldRegistrations();
+	std::set<uint32_t> classes;
+	u32 missingFields = 0;
+
+	for (u32 i = 0; i < registrations.size(); i++)
+	{
+		const SchemaFieldRegistration &field = registrations[i];
+		bool found;
+		SchemaKey key = LookupOffset(field.className, field.classKey, field.memberName, field.memberKey, found);
+		schema::fieldTable[i].offset = key.offset;
+		schema::fieldTable[i].networked = key.networked;
+		schema::fieldTable[i].chainOffset = schema::FindChainOffset(field.className, field.classKey);
+		classes.insert(field.classKey);
+
+		// LookupOffset already warned about the specifics.
+		if (!found)
+		{
+			missingFields++;
+		}
+	}
+
+	f64 elapsed = (Plat_FloatTime() - startTime) * 1000.0;
+	if (missingFields > 0)
+	{
+		Warning("[Schema] %u of %u fields could not be resolved, the game was likely updated!\n", missingFields, (u32)registrations.size());
+	}
+	Msg("[Schema] Resolved %u fields across %u classes in %.3fms.\n", (u32)registrations.size(), (u32)classes.size(), elapsed);
+	return missingFields == 0;
+}
+
+struct PendingNetworkStateChange
+{
+	CEntityHandle entity;
+	uint32_t offset;
+	bool chained;
+	ChangeAccessorFieldPathIndex_t pathIndex;
+	uintptr_t pField;
+	// Number of bytes in original, 0 if the field is always reported.
+	uint32_t size;
+	// Value of the field before the first write this tick.
+	uint8 original[schema::MAX_BATCHED_FIELD_SIZE];
+};
+
+// Open addressing slot of the lookup table below. Slots from older ticks are recognized by their generation, so clearing is free.
+struct PendingNetworkStateChangeSlot
+{
+	uintptr_t pField;
+	uint32_t generation;
+};
+
+static PendingNetworkStateChange pendingStateChanges[schema::MAX_PENDING_STATE_CHANGES];
+static uint32_t numPendingStateChanges;
+// Field address -> queued change, so repeated writes to the same field are only queued once.
+static PendingNetworkStateChangeSlot pendingStateChangeLookup[schema::MAX_PENDING_STATE_CHANGES * 2];
+static uint32_t pendingStateChangeGeneration = 1;
+
+static_assert((schema::MAX_PENDING_STATE_CHANGES & (schema::MAX_PENDING_STATE_CHANGES - 1)) == 0, "Lookup table size must be a power of two.");
+
+static bool QueueStateChange(CEntityInstance *pEntity, uintptr_t pField, uint32_t offset, uint32_t size, bool chained,
+							 ChangeAccessorFieldPathIndex_t pathIndex)
+{
+	// Nothing to keep track of, let the caller deal with it.
+	if (!pEntity)
+	{
+		return false;
+	}
+
+	constexpr uint32_t mask = schema::MAX_PENDING_STATE_CHANGES * 2 - 1;
+	uint32_t slot = static_cast<uint32_t>((pField >> 2) * 0x9E3779B1u) & mask;
+	while (pendingStateChangeLookup[slot].generation == pendingStateChangeGeneration)
+	{
+		if (pendingStateChangeLookup[slot].pField == pField)
+		{
+			return true;
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	// Table is full, fire this one right away instead.
+	if (numPendingStateChanges == schema::MAX_PENDING_STATE_CHANGES)
+	{
+		return false;
+	}
+
+	pendingStateChangeLookup[slot] = {pField, pendingStateChangeGeneration};
+	PendingNetworkStateChange &change = pendingStateChanges[numPendingStateChanges++];
+	change.entity = pEntity->GetRefEHandle();
+	change.offset = offset;
+	change.chained = chained;
+	change.pathIndex = pathIndex;
+	change.pField = pField;
+	change.size = MIN(size, schema::MAX_BATCHED_FIELD_SIZE);
+	memcpy(change.original, reinterpret_cast<void *>(pField), change.size);
+	return true;
+}
+
+bool schema::QueueEntityNetworkStateChanged(CEntityInstance *pEntity, uint32_t offset, uint32_t size)
+{
+	return QueueStateChange(pEntity, reinterpret_cast<uintptr_t>(pEntity) + offset, offset, size, false, {});
+}
+
+bool schema::QueueChainNetworkStateChanged(uintptr_t pNetworkVarChainer, uintptr_t pField, uint32_t offset, uint32_t size)
+{
+	CNetworkVarChainer *pChainer = reinterpret_cast<CNetworkVarChainer *>(pNetworkVarChainer);
+	return QueueStateChange(pChainer->GetObject(), pField, offset, size, true, pChainer->m_PathIndex);
+}
+
+void schema::FlushNetworkStateChanges()
+{
+	for (uint32_t i = 0; i < numPendingStateChanges; i++)
+	{
+		const PendingNetworkStateChange &change = pendingStateChanges[i];
+		CEntityInstance *pEntity = change.entity.Get();
+		// Entity got removed since the write, the field memory is gone with it.
+		if (!pEntity)
+		{
+			continue;
+		}
+
+		// The field was written back to what it was before, the client already has this value.
+		if (change.size != 0 && memcmp(change.original, reinterpret_cast<void *>(change.pField), change.size) == 0)
+		{
+			continue;
+		}
+
+		if (change.chained)
+		{
+			pEntity->NetworkStateChanged(NetworkStateChangedData(change.offset, -1, change.pathIndex));
+		}
+		else
+		{
+			pEntity->NetworkStateChanged(NetworkStateChangedData(change.offset));
+		}
+	}
+	schema::ClearNetworkStateChanges();
+}
+
+void schema::ClearNetworkStateChanges()
+{
+	numPendingStateChanges = 0;
+	// Generation 0 is what the zero-initialized table starts with, never treat it as current.
+	if (++pendingStateChangeGeneration == 0)
+	{
+		memset(pendingStateChangeLookup, 0, sizeof(pendingStateChangeLookup));
+		pendingStateChangeGeneration = 1;
+	}
 }
 
 void NetworkVarStateChanged(uintptr_t pNetworkVar, uint32_t nOffset, uint32 nNetworkStateChangedOffset)
@@ -14,6 +14,14 @@ struct SchemaKey
 	bool networked;
 };
 
+// Resolved entry of the flat schema field table, filled once by schema::ResolveFields().
+struct SchemaFieldKey
+{
+	uint32 offset;
+	int16_t chainOffset;
+	bool networked;
+};
+
 struct CNetworkVarChainer : public CSmartPtr<CEntityInstance>
 {
 	struct UnkStruct
@@ -35,8 +43,42 @@ void NetworkVarStateChanged(uintptr_t pNetworkVar, uint32_t nOffset, uint32 nNet
 
 namespace schema
 {
+	// Upper bound of SCHEMA_FIELD declarations per module, bump this if RegisterField starts complaining.
+	inline constexpr uint32_t MAX_FIELDS = 1024;
+	// Every declared schema field gets a slot here, accessors index into it directly.
+	inline SchemaFieldKey fieldTable[MAX_FIELDS];
+
 	int16_t FindChainOffset(const char *className, uint32_t classNameHash);
 	SchemaKey GetOffset(const char *className, uint32_t classKey, const char *memberName, uint32_t memberKey);
+
+	// Called during static initialization by each SCHEMA_FIELD, returns the field's slot in fieldTable.
+	uint32_t RegisterField(const char *className, uint32_t classKey, const char *memberName, uint32_t memberKey);
+	// Upper bound of deferred NetworkStateChanged calls per tick, further writes notify right away.
+	inline constexpr uint32_t MAX_PENDING_STATE_CHANGES = 4096;
+	// Fields up to this size keep a copy of their value from before the first write of the tick, see FlushNetworkStateChanges().
+	inline constexpr uint32_t MAX_BATCHED_FIELD_SIZE = 16;
+	// Number of bytes of a field type to snapshot, 0 for types that cannot be compared byte by byte.
+	template<typename T>
+	inline constexpr uint32_t snapshotSize = std::is_trivially_copyable_v<T> && sizeof(T) <= MAX_BATCHED_FIELD_SIZE ? sizeof(T) : 0;
+	// When enabled, Set() queues its NetworkStateChanged call instead of firing it right away. The owner of the flag is responsible for
+	// calling FlushNetworkStateChanges() before the server builds its snapshots, mode/style plugins leave this off.
+	inline bool batchNetworkStateChanges = false;
+
+	// Return false if the change cannot be deferred and NetworkStateChanged must be called immediately.
+	// Must be called before the field is written, the first `size` bytes of the field are kept to compare against when flushing.
+	// Only for fields declared directly on an entity class.
+	bool QueueEntityNetworkStateChanged(CEntityInstance *pEntity, uint32_t offset, uint32_t size);
+	// For fields of classes embedded in an entity through a network var chainer.
+	bool QueueChainNetworkStateChanged(uintptr_t pNetworkVarChainer, uintptr_t pField, uint32_t offset, uint32_t size);
+	// Fire the queued NetworkStateChanged calls. Fields written multiple times are only reported once,
+	// and snapshotted fields that ended up with their original value are skipped entirely.
+	void FlushNetworkStateChanges();
+	// Drop the queued changes without firing them, e.g. when the plugin is unloading.
+	void ClearNetworkStateChanges();
+
+	// Resolve all registered fields in one go. Must be called once the schema system is available and before any field is accessed.
+	// Returns false if any field could not be found, which usually means the game got updated.
+	bool ResolveFields();
 } // namespace schema
 
 constexpr uint32_t val_32_const = 0x811c9dc5;
@@ -61,7 +103,7 @@ inline constexpr uint64_t hash_64_fnv1a_const(const char *const str, const uint6
 	public:                                                                                                                  \
 		std::add_lvalue_reference_t<type> Get()                                                                              \
 		{                                                                                                                    \
-			static const auto m_key = schema::GetOffset(m_className, m_classNameHash, #varName, m_varNameHash);              \
+			const auto &m_key = schema::fieldTable[m_fieldIndex];                                                            \
 			static const auto m_offset = offsetof(ThisClass, varName);                                                       \
 																															 \
 			uintptr_t pThisClass = ((uintptr_t)this - m_offset);                                                             \
@@ -70,26 +112,47 @@ inline constexpr uint64_t hash_64_fnv1a_const(const char *const str, const uint6
 		}                                                                                                                    \
 		void Set(type& val)                                                                                                  \
 		{                                                                                                                    \
-			static const auto m_key = schema::GetOffset(m_className, m_classNameHash, #varName, m_varNameHash);              \
-			static const auto m_chain = schema::FindChainOffset(m_className, m_classNameHash);                               \
+			const auto &m_key = schema::fieldTable[m_fieldIndex];                                                            \
 			static const auto m_offset = offsetof(ThisClass, varName);                                                       \
 																															 \
 			uintptr_t pThisClass = ((uintptr_t)this - m_offset);                                                             \
                                                                                                                              \
-			NetworkStateChanged();                                                                                           \
+			bool queued = false;                                                                                             \
+			if (schema::batchNetworkStateChanges && m_key.networked)                                                         \
+			{                                                                                                                \
+				if (m_key.chainOffset != 0)                                                                                  \
+				{                                                                                                            \
+					queued = schema::QueueChainNetworkStateChanged(pThisClass + m_key.chainOffset,                           \
+																   pThisClass + m_key.offset + extra_offset,                 \
+																   m_key.offset + extra_offset, schema::snapshotSize<type>); \
+				}                                                                                                            \
+				/* Anything else only has an entity to notify if the owner actually is one. */                               \
+				else if constexpr (std::is_base_of_v<CEntityInstance, ThisClass>)                                            \
+				{                                                                                                            \
+					if (m_networkStateChangedOffset == -1)                                                                   \
+					{                                                                                                        \
+						queued = schema::QueueEntityNetworkStateChanged(reinterpret_cast<ThisClass *>(pThisClass),           \
+																		m_key.offset + extra_offset,                         \
+																		schema::snapshotSize<type>);                         \
+					}                                                                                                        \
+				}                                                                                                            \
+			}                                                                                                                \
+			if (!queued)                                                                                                     \
+			{                                                                                                                \
+				NetworkStateChanged();                                                                                       \
+			}                                                                                                                \
 			*reinterpret_cast<std::add_pointer_t<type>>(pThisClass + m_key.offset + extra_offset) = val;                     \
 		}                                                                                                                    \
 		void NetworkStateChanged()                                                                                           \
 		{                                                                                                                    \
-			static const auto m_key = schema::GetOffset(m_className, m_classNameHash, #varName, m_varNameHash);				 \
-			static const auto m_chain = schema::FindChainOffset(m_className, m_classNameHash);								 \
-			static const auto m_offset = offsetof(ThisClass, varName);														 \
+			const auto &m_key = schema::fieldTable[m_fieldIndex];                                                            \
+			static const auto m_offset = offsetof(ThisClass, varName);                                                       \
 																															 \
 			uintptr_t pThisClass = ((uintptr_t)this - m_offset);                                                             \
                                                                                                                              \
-			if (m_chain != 0 && m_key.networked)                                                                             \
+			if (m_key.chainOffset != 0 && m_key.networked)                                                                   \
 			{                                                                                                                \
-				::ChainNetworkStateChanged(pThisClass + m_chain, m_key.offset + extra_offset);                               \
+				::ChainNetworkStateChanged(pThisClass + m_key.chainOffset, m_key.offset + extra_offset);                     \
 			}                                                                                                                \
 			else if (m_key.networked)                                                                                        \
 			{                                                                                                                \
@@ -129,6 +192,13 @@ inline constexpr uint64_t hash_64_fnv1a_const(const char *const str, const uint6
 		/*Prevent accidentally copying this wrapper class instead of the underlying field*/                                  \
 		varName##_prop(const varName##_prop&) = delete;                                                                      \
 		static constexpr auto m_varNameHash = hash_32_fnv1a_const(#varName);                                                 \
+		static inline const uint32_t m_fieldIndex = schema::RegisterField(m_className, m_classNameHash, #varName, m_varNameHash); \
+                                                                                                                             \
+	public:                                                                                                                  \
+		static const SchemaFieldKey &GetKey()                                                                                \
+		{                                                                                                                    \
+			return schema::fieldTable[m_fieldIndex];                                                                         \
+		}                                                                                                                    \
 	} varName;
 
 #define SCHEMA_FIELD_POINTER_OFFSET(type, varName, extra_offset)                                                             \
@@ -137,7 +207,7 @@ inline constexpr uint64_t hash_64_fnv1a_const(const char *const str, const uint6
 	public:                                                                                                                  \
 		type* Get()                                                                                                          \
 		{                                                                                                                    \
-			static const auto m_key = schema::GetOffset(m_className, m_classNameHash, #varName, m_varNameHash);              \
+			const auto &m_key = schema::fieldTable[m_fieldIndex];                                                            \
 			static const auto m_offset = offsetof(ThisClass, varName);                                                       \
 																															 \
 			uintptr_t pThisClass = ((uintptr_t)this - m_offset);                                                             \
@@ -146,15 +216,14 @@ inline constexpr uint64_t hash_64_fnv1a_const(const char *const str, const uint6
 		}                                                                                                                    \
 		void NetworkStateChanged() /*Call this after editing the field*/                                                     \
 		{                                                                                                                    \
-			static const auto m_key = schema::GetOffset(m_className, m_classNameHash, #varName, m_varNameHash);              \
-			static const auto m_chain = schema::FindChainOffset(m_className, m_classNameHash);                               \
+			const auto &m_key = schema::fieldTable[m_fieldIndex];                                                            \
 			static const auto m_offset = offsetof(ThisClass, varName);                                                       \
 																															 \
 			uintptr_t pThisClass = ((uintptr_t)this - m_offset);                                                             \
 																															 \
-			if (m_chain != 0 && m_key.networked)                                                                             \
+			if (m_key.chainOffset != 0 && m_key.networked)                                                                   \
 			{                                                                                                                \
-				::ChainNetworkStateChanged(pThisClass + m_chain, m_key.offset + extra_offset);                               \
+				::ChainNetworkStateChanged(pThisClass + m_key.chainOffset, m_key.offset + extra_offset);                     \
 			}                                                                                                                \
 			else if (m_key.networked)                                                                                        \
 			{                                                                                                                \
@@ -180,6 +249,13 @@ inline constexpr uint64_t hash_64_fnv1a_const(const char *const str, const uint6
 		/*Prevent accidentally copying this wrapper class instead of the underlying field*/                                  \
 		varName##_prop(const varName##_prop&) = delete;                                                                      \
 		static constexpr auto m_varNameHash = hash_32_fnv1a_const(#varName);                                                 \
+		static inline const uint32_t m_fieldIndex = schema::RegisterField(m_className, m_classNameHash, #varName, m_varNameHash); \
+                                                                                                                             \
+	public:                                                                                                                  \
+		static const SchemaFieldKey &GetKey()                                                                                \
+		{                                                                                                                    \
+			return schema::fieldTable[m_fieldIndex];                                                                         \
+		}                                                                                                                    \
 	} varName;
 
 // Use this when you want the member's value itself
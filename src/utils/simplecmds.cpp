@@ -7,6 +7,8 @@
 #include "../kz/option/kz_option.h"
 #include "utils/tables.h"
 
+#include <algorithm>
+
 #include "tier0/memdbgon.h"
 // private structs
 #define SCMD_MAX_NAME_LEN 128
@@ -49,14 +51,122 @@ static_global const char *columnKeys[] = {
 
 // clang-format on
 
+// Open addressing tables of command indices + 1, 0 is an empty slot. Must be a power of two.
+#define SCMD_TABLE_SIZE (SCMD_MAX_CMDS * 4)
+
 struct ScmdManager
 {
 	i32 cmdCount;
 	Scmd cmds[SCMD_MAX_CMDS];
+	// Commands by their full name, for client commands.
+	u16 byName[SCMD_TABLE_SIZE];
+	// Commands by the name used in chat and to override console commands, which drops the console prefix.
+	// Commands with the same name follow each other in registration order along the probe sequence.
+	u16 byChatName[SCMD_TABLE_SIZE];
+	// Command indices sorted by chat name, for prefix matching. Sorted again on the next lookup after the commands change.
+	u16 sortedByChatName[SCMD_MAX_CMDS];
+	bool chatNamesSorted;
 };
 
 static_global ScmdManager g_cmdManager = {};
 
+static_function const char *GetChatName(const Scmd &cmd)
+{
+	return cmd.hasConsolePrefix ? cmd.name + strlen(SCMD_CONSOLE_PREFIX) : cmd.name;
+}
+
+static_function u32 HashName(const char *name)
+{
+	// FNV-1a, case insensitive
+	u32 hash = 2166136261u;
+	for (; *name; name++)
+	{
+		hash = (hash ^ (u8)tolower((u8)*name)) * 16777619u;
+	}
+	return hash;
+}
+
+static_function void InsertCmd(u16 *table, const char *name, i32 index)
+{
+	u32 slot = HashName(name) & (SCMD_TABLE_SIZE - 1);
+	while (table[slot])
+	{
+		slot = (slot + 1) & (SCMD_TABLE_SIZE - 1);
+	}
+	table[slot] = index + 1;
+}
+
+// Returns the next command named `name` along the probe sequence starting at `slot`, which should be set to HashName(name) for the first call.
+static_function Scmd *FindNextCmd(const u16 *table, bool chatName, const char *name, u32 &slot)
+{
+	for (;; slot++)
+	{
+		u16 entry = table[slot & (SCMD_TABLE_SIZE - 1)];
+		if (!entry)
+		{
+			return nullptr;
+		}
+		Scmd *cmd = &g_cmdManager.cmds[entry - 1];
+		if (!V_stricmp(chatName ? GetChatName(*cmd) : cmd->name, name))
+		{
+			slot++;
+			return cmd;
+		}
+	}
+}
+
+static_function Scmd *FindCmd(const char *name)
+{
+	u32 slot = HashName(name);
+	return FindNextCmd(g_cmdManager.byName, false, name, slot);
+}
+
+// Chat commands can be shortened to any prefix that only matches one command, or several names for the same command.
+static_function Scmd *FindCmdByChatPrefix(const char *prefix)
+{
+	i32 length = strlen(prefix);
+	if (length == 0)
+	{
+		return nullptr;
+	}
+	Scmd *cmds = g_cmdManager.cmds;
+	u16 *begin = g_cmdManager.sortedByChatName;
+	u16 *end = begin + g_cmdManager.cmdCount;
+	if (!g_cmdManager.chatNamesSorted)
+	{
+		for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+		{
+			begin[i] = i;
+		}
+		std::sort(begin, end, [cmds](u16 a, u16 b) { return V_stricmp(GetChatName(cmds[a]), GetChatName(cmds[b])) < 0; });
+		g_cmdManager.chatNamesSorted = true;
+	}
+
+	u16 *it = std::lower_bound(begin, end, prefix, [cmds](u16 index, const char *name) { return V_stricmp(GetChatName(cmds[index]), name) < 0; });
+	Scmd *match = nullptr;
+	for (; it != end && !V_strnicmp(GetChatName(cmds[*it]), prefix, length); it++)
+	{
+		if (match && match->callback != cmds[*it].callback)
+		{
+			// Ambiguous
+			return nullptr;
+		}
+		match = &cmds[*it];
+	}
+	return match;
+}
+
+static_function void RebuildCmdTables()
+{
+	V_memset(g_cmdManager.byName, 0, sizeof(g_cmdManager.byName));
+	V_memset(g_cmdManager.byChatName, 0, sizeof(g_cmdManager.byChatName));
+	for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+	{
+		InsertCmd(g_cmdManager.byName, g_cmdManager.cmds[i].name, i);
+		InsertCmd(g_cmdManager.byChatName, GetChatName(g_cmdManager.cmds[i]), i);
+	}
+}
+
 static_global void PrintCategoryCommands(KZPlayer *player, i32 category, bool printEmpty)
 {
 	char tableName[64];
@@ -179,21 +289,12 @@ bool scmd::RegisterCmd(const char *name, scmd::Callback_t *callback, const char
 	}
 
 	// Check if command with this name already exists
-	Scmd *cmds = g_cmdManager.cmds;
-	for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+	if (FindCmd(name))
 	{
-		if (nameLength != g_cmdManager.cmds[i].nameLength)
-		{
-			continue;
-		}
-
-		if (!V_stricmp(g_cmdManager.cmds[i].name, name))
-		{
-			// TODO: print warning? error? segfault?
-			// Command already exists
-			// Assert(0);
-			return false;
-		}
+		// TODO: print warning? error? segfault?
+		// Command already exists
+		// Assert(0);
+		return false;
 	}
 
 	// Command name is unique!
@@ -210,44 +311,43 @@ bool scmd::RegisterCmd(const char *name, scmd::Callback_t *callback, const char
 		V_snprintf(cmd.descKey, SCMD_MAX_NAME_LEN, "%s", descKey);
 	}
 
-	g_cmdManager.cmds[g_cmdManager.cmdCount++] = cmd;
+	i32 index = g_cmdManager.cmdCount++;
+	g_cmdManager.cmds[index] = cmd;
+	InsertCmd(g_cmdManager.byName, cmd.name, index);
+	InsertCmd(g_cmdManager.byChatName, GetChatName(cmd), index);
+	g_cmdManager.chatNamesSorted = false;
 
 	return true;
 }
 
 bool scmd::LinkCmd(const char *name, const char *linkedName)
 {
-	for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+	Scmd *linkedCmd = FindCmd(linkedName);
+	if (!linkedCmd)
 	{
-		if (!V_stricmp(g_cmdManager.cmds[i].name, linkedName))
-		{
-			return scmd::RegisterCmd(name, g_cmdManager.cmds[i].callback, g_cmdManager.cmds[i].descKey, g_cmdManager.cmds[i].flags);
-		}
+		return false;
 	}
-	return false;
+	return scmd::RegisterCmd(name, linkedCmd->callback, linkedCmd->descKey, linkedCmd->flags);
 }
 
 bool scmd::UnregisterCmd(const char *name)
 {
-	i32 indexToDelete = -1;
-	for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+	Scmd *cmd = FindCmd(name);
+	if (!cmd)
 	{
-		if (!V_stricmp(g_cmdManager.cmds[i].name, name))
-		{
-			indexToDelete = i;
-			break;
-		}
+		return false;
 	}
-	if (indexToDelete != -1)
+
+	i32 indexToDelete = cmd - g_cmdManager.cmds;
+	for (i32 i = indexToDelete; i < g_cmdManager.cmdCount - 1; i++)
 	{
-		for (i32 i = indexToDelete; i < g_cmdManager.cmdCount; i++)
-		{
-			g_cmdManager.cmds[i] = g_cmdManager.cmds[i + 1];
-		}
-		g_cmdManager.cmdCount--;
-		return true;
+		g_cmdManager.cmds[i] = g_cmdManager.cmds[i + 1];
 	}
-	return false;
+	g_cmdManager.cmdCount--;
+	// Every command after the deleted one moved, which is rare enough to just start over.
+	RebuildCmdTables();
+	g_cmdManager.chatNamesSorted = false;
+	return true;
 }
 
 META_RES scmd::OnClientCommand(CPlayerSlot &slot, const CCommand &args)
@@ -265,22 +365,20 @@ META_RES scmd::OnClientCommand(CPlayerSlot &slot, const CCommand &args)
 		return MRES_IGNORED;
 	}
 
-	for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+	u32 probe = HashName(args[0]);
+	for (Scmd *cmd; (cmd = FindNextCmd(g_cmdManager.byName, false, args[0], probe));)
 	{
-		if (!g_cmdManager.cmds[i].callback)
+		if (!cmd->callback)
 		{
 			// TODO: error?
-			Assert(g_cmdManager.cmds[i].callback);
+			Assert(cmd->callback);
 			continue;
 		}
 
-		if (!V_stricmp(g_cmdManager.cmds[i].name, args[0]))
+		result = cmd->callback(controller, &args);
+		if (result == MRES_SUPERCEDE)
 		{
-			result = g_cmdManager.cmds[i].callback(controller, &args);
-			if (result == MRES_SUPERCEDE)
-			{
-				return result;
-			}
+			return result;
 		}
 	}
 	return result;
@@ -323,53 +421,60 @@ META_RES scmd::OnDispatchConCommand(ConCommandRef cmd, const CCommandContext &ct
 			// arg is too short!
 			return MRES_IGNORED;
 		}
-		Scmd *cmds = g_cmdManager.cmds;
 
 		CCommand cmdArgs;
 		cmdArgs.Tokenize(args[1]);
 
-		for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+		const char *arg = cmdArgs[0] + 1; // skip chat trigger
+		u32 probe = HashName(arg);
+		Scmd *found = FindNextCmd(g_cmdManager.byChatName, true, arg, probe);
+		if (!found)
+		{
+			// Only an exact name can reach several commands, a prefix runs the one it matches.
+			found = FindCmdByChatPrefix(arg);
+			if (found && found->callback)
+			{
+				META_RES result = found->callback(controller, &cmdArgs);
+				if (args[1][0] == SCMD_CHAT_SILENT_TRIGGER || result == MRES_SUPERCEDE)
+				{
+					return MRES_SUPERCEDE;
+				}
+			}
+			return MRES_IGNORED;
+		}
+		for (Scmd *cmd = found; cmd; cmd = FindNextCmd(g_cmdManager.byChatName, true, arg, probe))
 		{
-			if (!cmds[i].callback)
+			if (!cmd->callback)
 			{
 				// TODO: error?
-				Assert(cmds[i].callback);
+				Assert(cmd->callback);
 				continue;
 			}
 
-			const char *arg = cmdArgs[0] + 1; // skip chat trigger
-			const char *cmdName = cmds[i].hasConsolePrefix ? cmds[i].name + strlen(SCMD_CONSOLE_PREFIX) : cmds[i].name;
-			if (!V_stricmp(arg, cmdName))
+			META_RES result = cmd->callback(controller, &cmdArgs);
+			if (args[1][0] == SCMD_CHAT_SILENT_TRIGGER || result == MRES_SUPERCEDE)
 			{
-				META_RES result = cmds[i].callback(controller, &cmdArgs);
-				if (args[1][0] == SCMD_CHAT_SILENT_TRIGGER || result == MRES_SUPERCEDE)
-				{
-					// don't send chat message
-					return MRES_SUPERCEDE;
-				}
+				// don't send chat message
+				return MRES_SUPERCEDE;
 			}
 		}
 	}
 	else // Are we overriding a console command?
 	{
-		for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+		u32 probe = HashName(commandName);
+		for (Scmd *cmd; (cmd = FindNextCmd(g_cmdManager.byChatName, true, commandName, probe));)
 		{
-			Scmd *cmds = g_cmdManager.cmds;
-			if (!cmds[i].callback)
+			if (!cmd->callback)
 			{
 				// TODO: error?
-				Assert(cmds[i].callback);
+				Assert(cmd->callback);
 				continue;
 			}
 
-			const char *cmdName = cmds[i].hasConsolePrefix ? cmds[i].name + strlen(SCMD_CONSOLE_PREFIX) : cmds[i].name;
-			if (!V_stricmp(commandName, cmdName))
+			META_RES result = cmd->callback(controller, &args);
+			if (result == MRES_SUPERCEDE)
 			{
-				META_RES result = g_cmdManager.cmds[i].callback(controller, &args);
-				if (result == MRES_SUPERCEDE)
-				{
-					return result;
-				}
+				return result;
 			}
 		}
 	}
@@ -15,6 +15,7 @@
 
 #include "module.h"
 #include "detours.h"
+#include "schema.h"
 #include "virtual.h"
 
 #include "steam/steam_gameserver.h"
@@ -46,6 +47,7 @@ bool utils::Initialize(ISmmAPI *ismm, char *error, size_t maxlen)
 	{
 		return false;
 	}
+	schema::ResolveFields();
 
 	CBufferStringGrowable<256> gamedirpath;
 	interfaces::pEngine->GetGameDir(gamedirpath);
@@ -368,19 +370,30 @@ bool utils::SetConVarValue(CPlayerSlot slot, ConVarRefAbstract conVarRef, const
 	return true;
 }
 
-void utils::SendConVarValue(CPlayerSlot slot, const char *conVar, const char *value)
+// Last value sent to and value wanted by a client for one convar.
+struct ReplicatedConVar
 {
-	INetworkMessageInternal *netmsg = g_pNetworkMessages->FindNetworkMessagePartial("SetConVar");
-	auto msg = netmsg->AllocateMessage()->ToPB<CNETMsg_SetConVar>();
-	CMsg_CVars_CVar *cvar = msg->mutable_convars()->add_cvars();
-	cvar->set_name(conVar);
-	cvar->set_value(value);
-	CSingleRecipientFilter filter(slot.Get());
-	interfaces::pGameEventSystem->PostEventAbstract(0, false, &filter, netmsg, msg, 0);
-	delete msg;
-}
+	char name[64];
+	char sent[64];
+	char desired[64];
+	bool hasSent;
+	bool pending;
+};
+
+static_global struct
+{
+	CUtlVector<ReplicatedConVar> conVars;
+	bool pending;
+} replicatedConVars[MAXPLAYERS + 1];
 
-void utils::SendMultipleConVarValues(CPlayerSlot slot, const char **cvars, const char **values, u32 size)
+static_global struct
+{
+	u64 queued;
+	u64 sent;
+	u64 messages;
+} replicationStats;
+
+static_function void PostConVarMessage(CPlayerSlot slot, const char **cvars, const char **values, u32 size)
 {
 	INetworkMessageInternal *netmsg = g_pNetworkMessages->FindNetworkMessagePartial("SetConVar");
 	auto msg = netmsg->AllocateMessage()->ToPB<CNETMsg_SetConVar>();
@@ -393,6 +406,127 @@ void utils::SendMultipleConVarValues(CPlayerSlot slot, const char **cvars, const
 	CSingleRecipientFilter filter(slot.Get());
 	interfaces::pGameEventSystem->PostEventAbstract(0, false, &filter, netmsg, msg, 0);
 	delete msg;
+	replicationStats.sent += size;
+	replicationStats.messages++;
+}
+
+void utils::SendConVarValue(CPlayerSlot slot, const char *conVar, const char *value)
+{
+	if (slot.Get() < 0 || slot.Get() > MAXPLAYERS)
+	{
+		return;
+	}
+	replicationStats.queued++;
+
+	auto &client = replicatedConVars[slot.Get()];
+	ReplicatedConVar *entry = nullptr;
+	FOR_EACH_VEC(client.conVars, i)
+	{
+		if (KZ_STREQ(client.conVars[i].name, conVar))
+		{
+			entry = &client.conVars[i];
+			break;
+		}
+	}
+	if (!entry && (u32)V_strlen(conVar) < sizeof(entry->name))
+	{
+		entry = &client.conVars[client.conVars.AddToTail()];
+		V_strncpy(entry->name, conVar, sizeof(entry->name));
+		entry->hasSent = false;
+		entry->pending = false;
+	}
+	// Too long to keep track of, the client gets it right away.
+	if (!entry || (u32)V_strlen(value) >= sizeof(entry->desired))
+	{
+		if (entry)
+		{
+			entry->hasSent = false;
+			entry->pending = false;
+		}
+		PostConVarMessage(slot, &conVar, &value, 1);
+		return;
+	}
+
+	V_strncpy(entry->desired, value, sizeof(entry->desired));
+	entry->pending = true;
+	client.pending = true;
+}
+
+void utils::SendMultipleConVarValues(CPlayerSlot slot, const char **cvars, const char **values, u32 size)
+{
+	for (u32 i = 0; i < size; i++)
+	{
+		utils::SendConVarValue(slot, cvars[i], values[i]);
+	}
+}
+
+void utils::FlushConVarValues()
+{
+	const char *cvars[64];
+	const char *values[64];
+	for (i32 slot = 0; slot <= MAXPLAYERS; slot++)
+	{
+		auto &client = replicatedConVars[slot];
+		if (!client.pending)
+		{
+			continue;
+		}
+		client.pending = false;
+
+		u32 count = 0;
+		FOR_EACH_VEC(client.conVars, i)
+		{
+			ReplicatedConVar &entry = client.conVars[i];
+			if (!entry.pending)
+			{
+				continue;
+			}
+			entry.pending = false;
+			// The client already has this value, e.g. it was changed back within the same tick.
+			if (entry.hasSent && KZ_STREQ(entry.sent, entry.desired))
+			{
+				continue;
+			}
+			V_strncpy(entry.sent, entry.desired, sizeof(entry.sent));
+			entry.hasSent = true;
+
+			cvars[count] = entry.name;
+			values[count] = entry.sent;
+			if (++count == Q_ARRAYSIZE(cvars))
+			{
+				PostConVarMessage(CPlayerSlot(slot), cvars, values, count);
+				count = 0;
+			}
+		}
+		if (count > 0)
+		{
+			PostConVarMessage(CPlayerSlot(slot), cvars, values, count);
+		}
+	}
+}
+
+void utils::ResetReplicatedConVars(CPlayerSlot slot)
+{
+	if (slot.Get() < 0 || slot.Get() > MAXPLAYERS)
+	{
+		return;
+	}
+	replicatedConVars[slot.Get()].conVars.RemoveAll();
+	replicatedConVars[slot.Get()].pending = false;
+}
+
+void utils::ResetReplicatedConVars()
+{
+	for (i32 slot = 0; slot <= MAXPLAYERS; slot++)
+	{
+		utils::ResetReplicatedConVars(CPlayerSlot(slot));
+	}
+}
+
+CON_COMMAND_F(kz_cvar_replication_stats, "Print how many replicated convar values were queued and actually sent to clients.", FCVAR_NONE)
+{
+	META_CONPRINTF("[KZ] Replicated convars: %llu values queued, %llu sent in %llu messages.\n", replicationStats.queued, replicationStats.sent,
+				   replicationStats.messages);
 }
 
 void utils::SendConVarValue(CPlayerSlot slot, ConVarRefAbstract conVarRef, const char *value)
@@ -417,44 +551,34 @@ void utils::SendConVarValue(CPlayerSlot slot, ConVarRefAbstract conVarRef, const
 
 void utils::SendMultipleConVarValues(CPlayerSlot slot, ConVarRefAbstract **conVarRefs, const char **values, u32 size)
 {
-	INetworkMessageInternal *netmsg = g_pNetworkMessages->FindNetworkMessagePartial("SetConVar");
-	auto msg = netmsg->AllocateMessage()->ToPB<CNETMsg_SetConVar>();
 	for (u32 i = 0; i < size; i++)
 	{
 		if (!conVarRefs[i]->IsValidRef())
 		{
-			delete msg;
 			return;
 		}
-		CMsg_CVars_CVar *cvar = msg->mutable_convars()->add_cvars();
-		cvar->set_name(conVarRefs[i]->GetName());
-		cvar->set_value(values[i]);
 	}
-	CSingleRecipientFilter filter(slot.Get());
-	interfaces::pGameEventSystem->PostEventAbstract(0, false, &filter, netmsg, msg, 0);
-	delete msg;
+	for (u32 i = 0; i < size; i++)
+	{
+		utils::SendConVarValue(slot, conVarRefs[i]->GetName(), values[i]);
+	}
 }
 
 void utils::SendMultipleConVarValues(CPlayerSlot slot, ConVarRefAbstract **conVarRefs, const CVValue_t *values, u32 size)
 {
-	INetworkMessageInternal *netmsg = g_pNetworkMessages->FindNetworkMessagePartial("SetConVar");
-	auto msg = netmsg->AllocateMessage()->ToPB<CNETMsg_SetConVar>();
 	for (u32 i = 0; i < size; i++)
 	{
 		if (!conVarRefs[i]->IsValidRef())
 		{
-			delete msg;
 			return;
 		}
+	}
+	for (u32 i = 0; i < size; i++)
+	{
 		CBufferString buf;
 		conVarRefs[i]->TypeTraits()->ValueToString(&values[i], buf);
-		CMsg_CVars_CVar *cvar = msg->mutable_convars()->add_cvars();
-		cvar->set_name(conVarRefs[i]->GetName());
-		cvar->set_value(buf.Get());
+		utils::SendConVarValue(slot, conVarRefs[i]->GetName(), buf.Get());
 	}
-	CSingleRecipientFilter filter(slot.Get());
-	interfaces::pGameEventSystem->PostEventAbstract(0, false, &filter, netmsg, msg, 0);
-	delete msg;
 }
 
 bool utils::IsSpawnValid(const Vector &origin)
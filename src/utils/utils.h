@@ -30,6 +30,12 @@ namespace utils
 	// These two functions require all valid convar references as well.
 	void SendMultipleConVarValues(CPlayerSlot slot, ConVarRefAbstract **conVarRefs, const char **values, u32 size);
 	void SendMultipleConVarValues(CPlayerSlot slot, ConVarRefAbstract **conVarRefs, const CVValue_t *values, u32 size);
+	// Values sent above are queued per client and only the ones that differ from what the client last received are sent,
+	// in one message per client. Called once per tick before snapshots are built.
+	void FlushConVarValues();
+	// The client lost its replicated values (new client, map change), forget what was sent to it.
+	void ResetReplicatedConVars(CPlayerSlot slot);
+	void ResetReplicatedConVars();
 
 	CBaseEntity *FindEntityByClassname(CEntityInstance *start, const char *name);
 